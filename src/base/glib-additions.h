@@ -32,6 +32,18 @@
 #define g_variant_builder_add_dictentry_object_path(b, key, val)        \
         g_variant_builder_add(b, "{sv}", key, g_variant_new_object_path(val))
 
+#define g_variant_builder_add_dictentry_boolean(b, key, val)            \
+        g_variant_builder_add(b, "{sv}", key, g_variant_new_boolean(val))
+
+#define g_variant_builder_add_dictentry_int64(b, key, val)              \
+        g_variant_builder_add(b, "{sv}", key, g_variant_new_int64(val))
+
+#define g_variant_builder_add_dictentry_uint32(b, key, val)             \
+        g_variant_builder_add(b, "{sv}", key, g_variant_new_uint32(val))
+
+#define g_variant_builder_add_dictentry_uint64(b, key, val)             \
+        g_variant_builder_add(b, "{sv}", key, g_variant_new_uint64(val))
+
 void g_variant_builder_add_dictentry_array_string(GVariantBuilder *b,
                                                   const gchar     *key,
                                                   ...) G_GNUC_NULL_TERMINATED;
@@ -119,6 +119,38 @@ gv_get_app_user_data_dir(void)
 	return dir;
 }
 
+const gchar *
+gv_get_app_user_cache_dir(void)
+{
+	static gchar *dir;
+
+	if (dir == NULL) {
+		const gchar *user_dir;
+
+		user_dir = g_get_user_cache_dir();
+		dir = g_build_filename(user_dir, PACKAGE_NAME, NULL);
+	}
+
+	return dir;
+}
+
+const gchar *
+gv_get_app_user_music_dir(void)
+{
+	static gchar *dir;
+
+	if (dir == NULL) {
+		const gchar *user_dir;
+
+		user_dir = g_get_user_special_dir(G_USER_DIRECTORY_MUSIC);
+		if (user_dir == NULL)
+			user_dir = g_get_home_dir();
+		dir = g_build_filename(user_dir, PACKAGE_NAME, NULL);
+	}
+
+	return dir;
+}
+
 const gchar *const *
 gv_get_app_system_config_dirs(void)
 {
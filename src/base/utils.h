@@ -34,6 +34,8 @@ gboolean gv_get_uri_extension_lowercase(const gchar *uri, gchar **extension, GEr
 
 const gchar *gv_get_app_user_config_dir(void);
 const gchar *gv_get_app_user_data_dir(void);
+const gchar *gv_get_app_user_cache_dir(void);
+const gchar *gv_get_app_user_music_dir(void);
 const gchar *const *gv_get_app_system_config_dirs(void);
 const gchar *const *gv_get_app_system_data_dirs(void);
 
@@ -85,6 +85,8 @@ help_and_exit(int exit_code)
 	COMMAND("shuffle [true/false]", "Get/set shuffle");
 	COMMAND("current", "Get info on current station");
 	COMMAND("playing", "Get playback status");
+	COMMAND("stats", "Get statistics on the current stream");
+	COMMAND("record  [true/false]", "Get/set recording");
 	NL();
 
 	HEADING("Station list");
@@ -464,6 +466,25 @@ print_current(GVariant *result)
 	g_free(comment);
 }
 
+void
+print_stats(GVariant *result)
+{
+	GVariantIter *iter;
+	GVariant *value;
+	gchar *key;
+
+	g_variant_get(result, "a{sv}", &iter);
+
+	while (g_variant_iter_loop(iter, "{sv}", &key, &value)) {
+		if (g_variant_is_of_type(value, G_VARIANT_TYPE_UINT64))
+			print("%-18s %" G_GUINT64_FORMAT, key, g_variant_get_uint64(value));
+		else if (g_variant_is_of_type(value, G_VARIANT_TYPE_UINT32))
+			print("%-18s %u", key, g_variant_get_uint32(value));
+	}
+
+	g_variant_iter_free(iter);
+}
+
 void
 print_list_result(GVariant *result)
 {
@@ -543,6 +564,8 @@ struct cmd player_cmds[] = {
 	{ PROPERTY, "shuffle",   "Shuffle",  parse_boolean,   print_boolean },
 	{ PROPERTY, "volume",    "Volume",   parse_volume,    print_volume  },
 	{ PROPERTY, "mute",      "Mute",     parse_boolean,   print_boolean },
+	{ PROPERTY, "stats",     "Stats",    NULL,            print_stats   },
+	{ PROPERTY, "record",    "Recording", parse_boolean,  print_boolean },
 	{ PROPERTY, NULL,        NULL,       NULL,            NULL          }
 	// clang-format on
 };
@@ -27,6 +27,9 @@
 #include <gio/gio.h>
 
 #include "core/gv-engine.h"
+#include "core/gv-http-pool.h"
+#include "core/gv-redirect-cache.h"
+#include "core/gv-station-history.h"
 
 /* Global variables */
 
@@ -35,3 +38,6 @@ extern GSettings   *gv_core_settings;
 extern const gchar *gv_core_user_agent;
 
 extern GvEngine      *gv_core_engine;
+extern GvHttpPool    *gv_core_http_pool;
+extern GvRedirectCache *gv_core_redirect_cache;
+extern GvStationHistory *gv_core_station_history;
@@ -26,8 +26,13 @@
 #include "base/gv-base.h"
 
 #include "core/gv-engine.h"
+#include "core/gv-http-pool.h"
+#include "core/gv-monitor.h"
 #include "core/gv-playback.h"
 #include "core/gv-player.h"
+#include "core/gv-prober.h"
+#include "core/gv-redirect-cache.h"
+#include "core/gv-station-history.h"
 #include "core/gv-station-list.h"
 
 #define CORE_SCHEMA_ID_SUFFIX "Core"
@@ -41,8 +46,13 @@ GSettings *gv_core_settings;
 
 GvStationList *gv_core_station_list;
 GvEngine *gv_core_engine;
+GvHttpPool *gv_core_http_pool;
+GvRedirectCache *gv_core_redirect_cache;
+GvStationHistory *gv_core_station_history;
 GvPlayer *gv_core_player;
 GvPlayback *gv_core_playback;
+GvMonitor *gv_core_monitor;
+GvProber *gv_core_prober;
 
 gchar *gv_core_user_agent;
 
@@ -143,6 +153,7 @@ void
 gv_core_init(GApplication *application, const gchar *default_stations)
 {
 	GList *item;
+	gchar *filename;
 
 	/* Create strings */
 	gv_core_user_agent = make_user_agent();
@@ -158,6 +169,20 @@ gv_core_init(GApplication *application, const gchar *default_stations)
 	gv_core_station_list = gv_station_list_new_from_xdg_dirs(default_stations);
 	core_objects = g_list_append(core_objects, gv_core_station_list);
 
+	gv_core_http_pool = gv_http_pool_new();
+	core_objects = g_list_append(core_objects, gv_core_http_pool);
+
+	filename = g_build_filename(gv_get_app_user_cache_dir(), "redirects", NULL);
+	gv_core_redirect_cache = gv_redirect_cache_new(filename);
+	core_objects = g_list_append(core_objects, gv_core_redirect_cache);
+	g_free(filename);
+
+	/* The history lives next to the station list */
+	filename = g_build_filename(gv_get_app_user_data_dir(), "history", NULL);
+	gv_core_station_history = gv_station_history_new(filename);
+	core_objects = g_list_append(core_objects, gv_core_station_history);
+	g_free(filename);
+
 	gv_core_engine = gv_engine_new();
 	core_objects = g_list_append(core_objects, gv_core_engine);
 
@@ -167,6 +192,11 @@ gv_core_init(GApplication *application, const gchar *default_stations)
 	gv_core_player = gv_player_new(gv_core_engine, gv_core_playback, gv_core_station_list);
 	core_objects = g_list_append(core_objects, gv_core_player);
 
+	filename = g_build_filename(gv_get_app_user_cache_dir(), "probes", NULL);
+	gv_core_prober = gv_prober_new(gv_core_station_list, filename);
+	core_objects = g_list_append(core_objects, gv_core_prober);
+	g_free(filename);
+
 	/* Register objects in the base */
 	for (item = core_objects; item; item = item->next) {
 		GObject *object = G_OBJECT(item->data);
@@ -174,6 +204,22 @@ gv_core_init(GApplication *application, const gchar *default_stations)
 	}
 }
 
+/* The monitor is only needed with --monitor, so it's created on first use.
+ * Call it before the features are initialized, so that they know about it. */
+GvMonitor *
+gv_core_get_monitor(void)
+{
+	if (gv_core_monitor != NULL)
+		return gv_core_monitor;
+
+	/* Monitoring is about following what's on air, no need to decode */
+	gv_core_monitor = gv_monitor_new(TRUE);
+	core_objects = g_list_append(core_objects, gv_core_monitor);
+	gv_base_register_object(G_OBJECT(gv_core_monitor));
+
+	return gv_core_monitor;
+}
+
 const gchar *
 gv_core_glib_version_string(void)
 {
@@ -29,9 +29,11 @@
 #include <libsoup/soup.h>
 
 #include "core/gv-metadata.h"
+#include "core/gv-monitor.h"
 #include "core/gv-playback.h"
 #include "core/gv-player.h"
 #include "core/gv-playlist.h"
+#include "core/gv-prober.h"
 #include "core/gv-station.h"
 #include "core/gv-station-list.h"
 #include "core/gv-streaminfo.h"
@@ -67,6 +69,8 @@ extern GApplication  *gv_core_application;
 
 extern GvPlayer      *gv_core_player;
 extern GvPlayback    *gv_core_playback;
+extern GvMonitor     *gv_core_monitor;
+extern GvProber      *gv_core_prober;
 extern GvStationList *gv_core_station_list;
 
 /* Functions */
@@ -75,6 +79,8 @@ void gv_core_init     (GApplication *app, const gchar *default_stations);
 void gv_core_cleanup  (void);
 void gv_core_configure(void);
 
+GvMonitor *gv_core_get_monitor(void);
+
 void gv_core_quit     (void);
 
 const gchar *gv_core_glib_version_string(void);
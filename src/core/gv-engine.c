@@ -32,8 +32,124 @@
  * it matters, when we report a TLS error, we must also say precisely what was
  * the URL requested. Hence, we do NOT stop playback, we let it complete (it
  * will stop anyway), so that we can be notified of a redirection, if any.
+ *
+ * On the standby engine: an engine can own a second engine, used to pre-roll
+ * the station that is likely to be played next (see gv_engine_preroll()). The
+ * standby engine brings its pipeline to PAUSED and stays there, it never
+ * plays. Then, if gv_engine_play() is called with the stream that is standing
+ * by, the two engines swap their playbins, and the pre-rolled pipeline only
+ * has to be set to PLAYING, rather than connecting and buffering from scratch.
+ * Standby engines can also be created on their own (see
+ * gv_engine_preroll_new()), to pre-roll several streams at once, and the one
+ * that is kept is then handed back with gv_engine_set_standby().
+ *
+ * On stopping: when the playback is stopped, the playbin is only brought down
+ * to READY, and it's released (ie. set to NULL) a bit later, if nothing else
+ * happened in-between. In READY, playbin3 drops the source and the decodebin,
+ * these are rebuilt for every stream anyway. What survives is the audio sink,
+ * which stays open. So if we start playing another stream right away (which
+ * is what happens when we switch station), we don't need to open the audio
+ * device again. This applies to the custom pipeline as well.
+ *
+ * On custom pipelines: the audio sink can be replaced by a pipeline given as
+ * a string. Parsing it, and checking that it prerolls, can block for a while
+ * (think network sinks), so it's done in a worker thread. Until it's done,
+ * playback goes on with the current audio sink, and if the pipeline turns
+ * out to be invalid, nothing changes, we just report an error. Otherwise the
+ * playbin is torn down to take the new sink, and the stream that was playing
+ * is started again right away. The preroll
+ * check is skipped while our audio sink is open, as the device might not be
+ * opened twice. Validated sinks are cached by pipeline string, the least
+ * recently used go first, so that switching back and forth between known
+ * pipelines is immediate.
+ *
+ * On crossfading: when the crossfade duration is set, and the playback is
+ * stopped with gv_engine_crossfade_stop(), the pipeline that is playing is
+ * handed over to another engine, the fader, where it keeps playing. Then the
+ * next stream connects and buffers in our own pipeline, silently. Once it
+ * plays, the two streams are crossfaded, and the fader is stopped. Both
+ * pipelines output to their own audio sink, and it's the sound server that
+ * mixes them, hence crossfading is not possible with a custom pipeline.
+ *
+ * On the bus thread: GStreamer messages are not handled on the main loop
+ * directly. Instead, they're drained by a dedicated thread (shared by all the
+ * engines), where consecutive messages are coalesced: tag lists are merged,
+ * and buffering messages are collapsed, so that only the transitions between
+ * 'buffering' and 'done buffering' remain. The resulting batch is then handed
+ * over to the main loop, where it's dispatched to the bus signal handlers.
+ * This way, bursts of messages don't make the main loop hiccup.
+ *
+ * On time-shift: when a time-shift window is set, HTTP streams are played
+ * through a GvTimeshiftSrc, which wraps the real source and keeps what it
+ * receives in a ring buffer (a queue2), sized to hold that many minutes of
+ * a high bitrate stream. We don't rely on playbin's download mode, as it's
+ * only used for media types that are deemed downloadable, not for live
+ * streams. Pausing then means setting the pipeline to PAUSED, while the
+ * source keeps on downloading, and resuming means setting it back to
+ * PLAYING, behind the live edge. Within the window, seeking is possible as
+ * well, and it's served from the ring buffer, without a new connection. We
+ * keep track of how far behind live we are, so that seeks are clamped to
+ * what the ring buffer holds. Pausing and seeking are only possible once the
+ * time-shift source was set up, so streams taken from the standby engine, or
+ * not played over HTTP, can't be paused.
+ *
+ * On recording: when recording is enabled, the compressed stream is handed
+ * over to a GvRecorder, as it comes out of the source. That's upstream of
+ * the time-shift ring buffer, so seeking doesn't record anything twice, and
+ * pausing doesn't stop the recording. ICY metadata is stripped on the way,
+ * and the titles it carries are used to name the files. Nothing is decoded
+ * or re-encoded, and the buffers are not even copied. A new file is started
+ * for each stream played, once its first title or its first data comes in,
+ * and then each time the title changes. The standby engine and the fader
+ * never record.
+ *
+ * On headless engines: an engine can be created without audio output (see
+ * gv_engine_new_headless()), for monitoring or recording stations. Streams
+ * are still decoded, but they go to a fakesink, with no conversion nor
+ * resampling. There's no custom pipeline, nor standby engine, nor fader.
+ *
+ * On metadata-only engines: a headless engine can go one step further, and
+ * not decode the audio at all (see gv_engine_new_metadata_only()). The
+ * decodebin is told to stop as soon as the stream is parsed, and the
+ * compressed audio goes straight to the fakesink. Tags still flow down the
+ * pipeline, so metadata and stream information are updated as usual, for
+ * a fraction of the CPU time.
+ *
+ * On stalls: a server might stop sending data without closing the connection,
+ * and it can take a long while before souphttpsrc gives up. So we keep an eye
+ * on the data coming out of the source, and if nothing came in for a while
+ * (see the stall-timeout property), the stream is stopped and a
+ * GV_ENGINE_ERROR_STALLED error is emitted, so that the caller can reconnect
+ * right away. The watchdog only kicks in once data started to flow, connect
+ * timeouts are left to the HTTP source. Nothing is expected while the stream
+ * is paused.
+ *
+ * On connection hand over: the caller might have opened the connection to
+ * the stream already, to find out what's behind a uri (see
+ * gv_engine_hand_over()). Rather than connecting again, the playbin is given
+ * an appsrc, and the stream is read from a thread of its own and pushed into
+ * it, ICY metadata included, so that a busy main loop doesn't starve the
+ * audio. There's no time-shift source then, hence no time-shift, and the
+ * appsrc queue is what buffers the network.
+ *
+ * On adaptive streams: for HLS and MPEG-DASH, the demuxer picks a variant
+ * from the master playlist according to the bandwidth it measures, and it
+ * tends to start high. The HLS policy (see the hls-policy property) lets it
+ * adapt, or pins it to the lowest or highest variant, or caps the bitrate.
+ * It's applied to the demuxer when it's created, and to the demuxers in use
+ * when it changes. The demuxer tells us when it switches to another variant,
+ * and it ends up in the streaminfo.
+ *
+ * On statistics: the engine measures a few things about the stream being
+ * played (see GvEngineStats). Some values come from pad probes, hence from
+ * the streaming threads, and are protected by a lock. They're gathered
+ * periodically in the main thread, then notified and logged.
  */
 
+#include <string.h>
+#include <time.h>
+
+#include <gio/gio.h>
 #include <glib-object.h>
 #include <glib.h>
 #include <gst/audio/streamvolume.h>
@@ -44,7 +160,9 @@
 #include "core/gv-core-enum-types.h"
 #include "core/gv-core-internal.h"
 #include "core/gv-metadata.h"
+#include "core/gv-recorder.h"
 #include "core/gv-streaminfo.h"
+#include "core/gv-timeshift-src.h"
 
 #include "core/gv-engine.h"
 
@@ -54,8 +172,98 @@
 //#define DEBUG_GST_ELEMENT_SETUP
 //#define DEBUG_GST_BUS_MESSAGE_ELEMENT
 
-/* Whether we prefer to ignore buffering messages while playing */
-#define IGNORE_BUFFERING_MESSAGES
+/* Buffering profiles. The buffer size and duration are set on the playbin,
+ * while the watermarks are set on the queue2 elements. Then a profile says
+ * whether we pause the pipeline when the buffer runs low while playing.
+ * Refer to the comment in on_bus_message_buffering() for more details. */
+
+typedef struct {
+	const gchar *name;
+	gint buffer_size;         // bytes, -1 for default
+	gint64 buffer_duration;   // nanoseconds, -1 for default
+	gdouble low_watermark;
+	gdouble high_watermark;
+	gboolean pause_on_buffering;
+} GvBufferingProfile;
+
+static const GvBufferingProfile buffering_profiles[] = {
+	[GV_ENGINE_BUFFERING_PROFILE_LOW_LATENCY] =
+	{ "low-latency",   64 * 1024,       1 * GST_SECOND,  0.01, 0.50, FALSE },
+	[GV_ENGINE_BUFFERING_PROFILE_BALANCED] =
+	{ "balanced",      -1,              -1,              0.01, 0.99, FALSE },
+	[GV_ENGINE_BUFFERING_PROFILE_FLAKY_NETWORK] =
+	{ "flaky-network", 2 * 1024 * 1024, 10 * GST_SECOND, 0.10, 0.99, TRUE },
+};
+
+#define N_BUFFERING_PROFILES G_N_ELEMENTS(buffering_profiles)
+
+/* How much data the standby engine is allowed to buffer, when a maximum
+ * bitrate is given. Once the buffer is full, the source blocks, and that's
+ * what actually limits the bandwidth used by the standby engine. */
+#define STANDBY_BUFFER_DURATION 4  // seconds
+
+/* How long the playbin is kept in READY after playback was stopped */
+#define RELEASE_DELAY 5  // seconds
+
+/* How often stats are gathered and logged while playing */
+#define STATS_INTERVAL 10  // seconds
+
+/* Crossfade: how often the volumes are updated, and how long we wait for
+ * the next stream to play, before fading out the previous stream anyway */
+#define CROSSFADE_INTERVAL 50  // milliseconds
+#define CROSSFADE_MAX_WAIT 10  // seconds
+
+/* Time-shift: the ring buffer is sized for streams up to this bitrate */
+#define TIMESHIFT_MAX_BITRATE 320  // kbps
+
+/* Playbin flags are not part of the public headers */
+#define GST_PLAY_FLAG_VIDEO        (1 << 0)
+#define GST_PLAY_FLAG_TEXT         (1 << 2)
+#define GST_PLAY_FLAG_SOFT_VOLUME  (1 << 4)
+#define GST_PLAY_FLAG_NATIVE_AUDIO (1 << 5)
+
+/* Bus messages, on their way from the bus thread to the main loop. The queue
+ * belongs to a bus, and follows it if it's swapped to another engine. Then
+ * the generation is bumped each time the bus is flushed, so that messages
+ * that were pulled from the bus before the flush can be told apart. The
+ * flush marker carries the new generation: a flush can drop the marker of
+ * the flush before, so the bus thread can't just count them. */
+
+typedef struct {
+	GMutex lock;
+	GstBus *bus;
+	GstElement *playbin;
+	GSource *watch;          // attached to the bus thread
+	GSource *dispatch;       // attached to the main loop
+	GQueue messages;
+	gint generation;         // bumped in the main thread
+	gint thread_generation;  // copied from the markers, in the bus thread
+	guint n_messages;
+	guint n_coalesced;
+	GvEngine *engine;        // main thread only
+} GvBusQueue;
+
+typedef struct {
+	GstMessage *message;
+	gint generation;
+} GvBusEntry;
+
+#define BUS_FLUSH_MESSAGE "gv-bus-flush"
+
+/* Connection hand over: the stream that was opened by the caller is fed to
+ * an appsrc, chunk by chunk, from a thread of its own. The feed belongs to
+ * the playbin, as it must follow it when playbins are swapped. */
+
+#define FEED_CHUNK_SIZE 4096
+#define FEED_DATA_KEY   "gv-feed"
+
+typedef struct {
+	GstElement *appsrc;
+	GInputStream *stream;
+	GCancellable *cancellable;
+	gint started;       // set from the streaming thread
+	guint64 bytes_fed;  // feed thread only
+} GvEngineFeed;
 
 /*
  * Properties
@@ -63,6 +271,14 @@
 
 #define DEFAULT_VOLUME 100
 #define DEFAULT_MUTE   FALSE
+#define DEFAULT_BUFFERING_PROFILE GV_ENGINE_BUFFERING_PROFILE_BALANCED
+#define DEFAULT_CROSSFADE_DURATION 0
+#define DEFAULT_TIMESHIFT_WINDOW 0
+#define DEFAULT_STALL_TIMEOUT 10
+#define DEFAULT_HLS_POLICY GV_ENGINE_HLS_POLICY_ADAPTIVE
+#define DEFAULT_HLS_MAX_BITRATE 0
+#define MAX_CACHED_AUDIO_SINKS 4
+#define AUDIO_SINK_PREROLL_TIMEOUT 10  // seconds
 
 enum {
 	/* Reserved */
@@ -75,6 +291,21 @@ enum {
 	PROP_MUTE,
 	PROP_PIPELINE_ENABLED,
 	PROP_PIPELINE_STRING,
+	PROP_SWITCH_LATENCY,
+	PROP_BUFFERING_PROFILE,
+	PROP_STATS,
+	PROP_CROSSFADE_DURATION,
+	PROP_TIMESHIFT_WINDOW,
+	PROP_STALL_TIMEOUT,
+	PROP_STALL_COUNT,
+	PROP_PREROLLED,
+	PROP_HLS_POLICY,
+	PROP_HLS_MAX_BITRATE,
+	PROP_RECORDING,
+	PROP_RECORDING_DIRECTORY,
+	/* Set at construct-time */
+	PROP_HEADLESS,
+	PROP_METADATA_ONLY,
 	/* Number of properties */
 	PROP_N
 };
@@ -104,15 +335,32 @@ struct _GvEnginePrivate {
 	/* GStreamer stuff */
 	GstElement *playbin;
 	GstBus *bus;
+	GvBusQueue *bus_queue;
 	/* Playbin state */
 	gboolean buffering;
 	GstState target_state;
+	guint release_timeout_id;
+	/* Latency measurement */
+	gint64 play_time;
+	gint first_buffer_pending;
 	/* Current stream */
 	gchar *uri;
 	gchar *user_agent;
 	gboolean ssl_strict;
+	gchar *stream_buffering_profile;
+	/* Buffering, the active profile is also read from streaming threads */
+	const GvBufferingProfile *active_profile;
+	gboolean underrun;
+	guint underruns[N_BUFFERING_PROFILES];
 	/* Defaults */
 	gchar *default_user_agent;
+	/* Custom audio sinks, by pipeline string, most recently used first */
+	GHashTable *audio_sinks;
+	GQueue *audio_sinks_lru;
+	GCancellable *audio_sink_cancellable;
+	/* Construct-time */
+	gboolean headless;
+	gboolean metadata_only;
 	/* Properties */
 	GvEngineState state;
 	GvStreaminfo *streaminfo;
@@ -121,6 +369,63 @@ struct _GvEnginePrivate {
 	gboolean mute;
 	gboolean pipeline_enabled;
 	gchar *pipeline_string;
+	guint switch_latency;
+	GvEngineBufferingProfile buffering_profile;
+	/* Standby engine */
+	GvEngine *standby;
+	gboolean standby_mode;
+	gboolean prerolled;
+	/* Crossfade */
+	guint crossfade_duration;
+	GvEngine *fader;
+	gdouble fade;
+	gint64 crossfade_wait_time;
+	gint64 crossfade_start_time;
+	guint crossfade_timeout_id;
+	/* Time-shift, the delay is how far behind live we are */
+	guint timeshift_window;
+	gboolean timeshift_active;  // set from the streaming thread
+	gboolean paused;
+	gint64 pause_time;
+	gint64 timeshift_delay;
+	/* Stall watchdog, the time of the last data is protected by the
+	 * stats lock */
+	guint stall_timeout;
+	guint stall_count;
+	guint watchdog_timeout_id;
+	/* HTTP status that came with the last error, if the server answered */
+	guint http_status;
+	gint64 last_data_time;
+	/* Adaptive streams, also read from streaming threads */
+	gint hls_policy;
+	gint hls_max_bitrate;
+	/* Recording, the recorder is protected by the stats lock, and so
+	 * is whether we're still waiting to start a file, and whether the
+	 * stream is ICY, in which case titles are picked from the stream */
+	GvRecorder *recorder;
+	gboolean recording_pending;
+	gboolean recording_icy;
+	gchar *recording_title;
+	gchar *recording_directory;
+	/* Statistics - the lock protects the values written by pad probes
+	 * (including the decoder CPU mark), and the recorder */
+	GvEngineStats stats;
+	GMutex stats_lock;
+	gint64 connect_time;
+	guint64 bytes_received;
+	gint64 decoder_cpu_time;
+	gint64 decoder_cpu_mark;
+	gint64 buffering_start_time;
+	gint64 stats_time;
+	guint64 stats_bytes_received;
+	guint stats_timeout_id;
+	/* Connection hand over, the stream is taken by the source setup
+	 * handler, hence it's protected by the stats lock */
+	gchar *handover_uri;
+	GInputStream *handover_stream;
+	guint handover_icy_metaint;
+	GInputStream *feed_stream;
+	guint feed_icy_metaint;
 };
 
 typedef struct _GvEnginePrivate GvEnginePrivate;
@@ -136,6 +441,32 @@ G_DEFINE_TYPE_WITH_CODE(GvEngine, gv_engine, G_TYPE_OBJECT,
 			G_ADD_PRIVATE(GvEngine)
 			G_IMPLEMENT_INTERFACE(GV_TYPE_ERRORABLE, NULL))
 
+G_DEFINE_BOXED_TYPE(GvEngineStats, gv_engine_stats,
+		    gv_engine_stats_copy, gv_engine_stats_free)
+
+GvEngineStats *
+gv_engine_stats_copy(const GvEngineStats *self)
+{
+	GvEngineStats *copy;
+
+	copy = g_new(GvEngineStats, 1);
+	*copy = *self;
+
+	return copy;
+}
+
+void
+gv_engine_stats_free(GvEngineStats *self)
+{
+	g_free(self);
+}
+
+/*
+ * Errors
+ */
+
+G_DEFINE_QUARK(gv-engine-error-quark, gv_engine_error)
+
 /*
  * GStreamer helpers
  */
@@ -170,6 +501,408 @@ set_gst_state(GstElement *playbin, GstState state)
 		DEBUG("Set playbin state to %s, got %s", state_name, return_name);
 }
 
+/* ICY metadata is interleaved with the audio: every metaint bytes of audio,
+ * one byte gives the length of the metadata block that follows, divided by
+ * 16. We strip it for the recorder, and pick the title on the way. The state
+ * belongs to the stream, hence it's attached to the source pad, and it's
+ * only used from the streaming thread of the source. */
+
+typedef enum {
+	ICY_AUDIO,
+	ICY_LENGTH,
+	ICY_METADATA,
+} GvIcyState;
+
+typedef struct {
+	guint metaint;    /* zero if it's not an ICY stream */
+	GvIcyState state;
+	gsize left;       /* bytes left in the current audio or metadata block */
+	GString *block;   /* metadata block being read */
+	gchar *title;     /* last title seen */
+	GList *held;      /* audio held until we know the first title */
+} GvIcyParser;
+
+static void
+icy_parser_free(GvIcyParser *parser)
+{
+	g_string_free(parser->block, TRUE);
+	g_free(parser->title);
+	g_list_free_full(parser->held, (GDestroyNotify) gst_buffer_unref);
+	g_free(parser);
+}
+
+static GvIcyParser *
+get_icy_parser(GstPad *pad)
+{
+	GvIcyParser *parser;
+	GstCaps *caps;
+	gint metaint = 0;
+
+	parser = g_object_get_data(G_OBJECT(pad), "gv-icy-parser");
+	if (parser != NULL)
+		return parser;
+
+	/* Caps come before the first buffer */
+	caps = gst_pad_get_current_caps(pad);
+	if (caps != NULL && gst_caps_get_size(caps) > 0) {
+		GstStructure *s = gst_caps_get_structure(caps, 0);
+
+		if (gst_structure_has_name(s, "application/x-icy"))
+			gst_structure_get_int(s, "metadata-interval", &metaint);
+	}
+	if (caps != NULL)
+		gst_caps_unref(caps);
+
+	parser = g_new0(GvIcyParser, 1);
+	parser->metaint = MAX(metaint, 0);
+	parser->state = ICY_AUDIO;
+	parser->left = parser->metaint;
+	parser->block = g_string_new(NULL);
+	g_object_set_data_full(G_OBJECT(pad), "gv-icy-parser", parser,
+			       (GDestroyNotify) icy_parser_free);
+
+	return parser;
+}
+
+/* Returns the title of a metadata block, ie. StreamTitle='...'; */
+static gchar *
+icy_parse_title(const gchar *block)
+{
+	const gchar *start, *end;
+	gchar *title;
+
+	start = strstr(block, "StreamTitle='");
+	if (start == NULL)
+		return NULL;
+	start += strlen("StreamTitle='");
+
+	end = strstr(start, "';");
+	if (end == NULL)
+		end = start + strlen(start);
+	if (end == start)
+		return NULL;
+
+	title = g_strndup(start, end - start);
+	if (!g_utf8_validate(title, -1, NULL)) {
+		gchar *valid = g_utf8_make_valid(title, -1);
+		g_free(title);
+		title = valid;
+	}
+
+	return title;
+}
+
+static void
+icy_parser_end_block(GvIcyParser *parser, GvRecorder *recorder, gboolean *pending)
+{
+	gchar *title;
+	gboolean split;
+	GList *item;
+
+	title = icy_parse_title(parser->block->str);
+	g_string_truncate(parser->block, 0);
+
+	/* Streams repeat the title in every block, only a change counts */
+	split = *pending || (title != NULL && g_strcmp0(title, parser->title));
+	if (title != NULL) {
+		g_free(parser->title);
+		parser->title = title;
+	}
+
+	if (recorder == NULL || split == FALSE)
+		return;
+
+	gv_recorder_split(recorder, parser->title);
+	*pending = FALSE;
+
+	for (item = parser->held; item; item = item->next)
+		gv_recorder_write(recorder, item->data);
+	g_list_free_full(g_steal_pointer(&parser->held),
+			 (GDestroyNotify) gst_buffer_unref);
+}
+
+static void
+icy_parser_feed(GvIcyParser *parser, GstBuffer *buffer, GvRecorder *recorder,
+		gboolean *pending)
+{
+	gsize size = gst_buffer_get_size(buffer);
+	gsize offset = 0;
+
+	/* Recording stopped while we were waiting for a title */
+	if (recorder == NULL && parser->held != NULL)
+		g_list_free_full(g_steal_pointer(&parser->held),
+				 (GDestroyNotify) gst_buffer_unref);
+
+	while (offset < size) {
+		GstBuffer *audio;
+		gsize n;
+		guint8 length;
+
+		switch (parser->state) {
+		case ICY_AUDIO:
+			n = MIN(parser->left, size - offset);
+			if (recorder != NULL) {
+				/* No copy, the sub-buffer shares the memory */
+				audio = gst_buffer_copy_region(buffer, GST_BUFFER_COPY_MEMORY,
+							       offset, n);
+				if (*pending == TRUE)
+					parser->held = g_list_append(parser->held, audio);
+				else {
+					gv_recorder_write(recorder, audio);
+					gst_buffer_unref(audio);
+				}
+			}
+			offset += n;
+			parser->left -= n;
+			if (parser->left == 0)
+				parser->state = ICY_LENGTH;
+			break;
+
+		case ICY_LENGTH:
+			gst_buffer_extract(buffer, offset, &length, 1);
+			offset++;
+			parser->left = length * 16;
+			parser->state = ICY_METADATA;
+			if (parser->left > 0)
+				break;
+			/* Fall through */
+
+		case ICY_METADATA:
+			n = MIN(parser->left, size - offset);
+			if (n > 0) {
+				GstMapInfo map;
+
+				if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+					g_string_append_len(parser->block,
+							(const gchar *) map.data + offset, n);
+					gst_buffer_unmap(buffer, &map);
+				}
+			}
+			offset += n;
+			parser->left -= n;
+			if (parser->left == 0) {
+				icy_parser_end_block(parser, recorder, pending);
+				parser->state = ICY_AUDIO;
+				parser->left = parser->metaint;
+			}
+			break;
+		}
+	}
+}
+
+/* Decodebins stop decoding once the stream matches these caps, and
+ * everything matches ANY, so they stop right after the parser */
+static void
+set_decodebin_passthrough(GstElement *element)
+{
+	GstElementFactory *factory;
+	const gchar *name;
+	GstCaps *caps;
+
+	factory = gst_element_get_factory(element);
+	if (factory == NULL)
+		return;
+
+	name = GST_OBJECT_NAME(factory);
+	if (g_strcmp0(name, "uridecodebin3") && g_strcmp0(name, "decodebin3"))
+		return;
+
+	caps = gst_caps_new_any();
+	g_object_set(element, "caps", caps, NULL);
+	gst_caps_unref(caps);
+}
+
+static void
+set_decodebin_passthrough_foreach(const GValue *item, gpointer user_data G_GNUC_UNUSED)
+{
+	set_decodebin_passthrough(g_value_get_object(item));
+}
+
+/* Parse a custom audio sink, and check that it can preroll. This can block
+ * for a while, hence it's not for the main thread. Prerolling opens the audio
+ * device, so it's only done if it's not already open on our side, otherwise
+ * we just check that the sink takes audio in. Returns a full ref. */
+static GstElement *
+make_audio_sink(const gchar *pipeline_string, gboolean preroll, GError **error)
+{
+	GstElement *pipeline;
+	GstElement *source;
+	GstElement *sink;
+	GstStateChangeReturn ret;
+	GError *err = NULL;
+
+	sink = gst_parse_bin_from_description(pipeline_string, TRUE, error);
+	if (sink == NULL)
+		return NULL;
+	gst_object_ref_sink(sink);
+
+	/* Can't test without a source, let's hope for the best */
+	source = gst_element_factory_make("audiotestsrc", NULL);
+	if (source == NULL)
+		return sink;
+	g_object_set(source, "num-buffers", 1, NULL);
+
+	pipeline = gst_pipeline_new(NULL);
+	gst_bin_add_many(GST_BIN(pipeline), source, sink, NULL);
+
+	if (gst_element_link(source, sink) == FALSE) {
+		g_set_error(&err, GST_CORE_ERROR, GST_CORE_ERROR_NEGOTIATION,
+			    "Pipeline has no audio input");
+		goto out;
+	}
+
+	/* Any failure to open will come up on the bus once it's in use */
+	if (preroll == FALSE)
+		goto out;
+
+	gst_element_set_state(pipeline, GST_STATE_PAUSED);
+	ret = gst_element_get_state(pipeline, NULL, NULL,
+				    AUDIO_SINK_PREROLL_TIMEOUT * GST_SECOND);
+
+	if (ret == GST_STATE_CHANGE_FAILURE) {
+		GstBus *bus;
+		GstMessage *msg;
+
+		bus = gst_element_get_bus(pipeline);
+		msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+		if (msg != NULL) {
+			gst_message_parse_error(msg, &err, NULL);
+			gst_message_unref(msg);
+		} else {
+			g_set_error(&err, GST_CORE_ERROR, GST_CORE_ERROR_STATE_CHANGE,
+				    "Pipeline failed to preroll");
+		}
+		gst_object_unref(bus);
+	} else if (ret == GST_STATE_CHANGE_ASYNC) {
+		g_set_error(&err, GST_CORE_ERROR, GST_CORE_ERROR_STATE_CHANGE,
+			    "Pipeline didn't preroll within %u seconds",
+			    AUDIO_SINK_PREROLL_TIMEOUT);
+	}
+
+	gst_element_set_state(pipeline, GST_STATE_NULL);
+
+out:
+	/* We still hold a ref on the sink */
+	gst_bin_remove(GST_BIN(pipeline), sink);
+	gst_object_unref(pipeline);
+
+	if (err != NULL) {
+		g_propagate_error(error, err);
+		gst_object_unref(sink);
+		return NULL;
+	}
+
+	return sink;
+}
+
+static void
+set_queue_watermarks(GstElement *element, const GvBufferingProfile *profile)
+{
+	GstElementFactory *factory;
+
+	factory = gst_element_get_factory(element);
+	if (factory == NULL)
+		return;
+
+	if (g_strcmp0(GST_OBJECT_NAME(factory), "queue2") != 0)
+		return;
+
+	g_object_set(element,
+		     "low-watermark", profile->low_watermark,
+		     "high-watermark", profile->high_watermark,
+		     NULL);
+}
+
+static void
+set_queue_watermarks_foreach(const GValue *item, gpointer user_data)
+{
+	GstElement *element = g_value_get_object(item);
+	const GvBufferingProfile *profile = user_data;
+
+	set_queue_watermarks(element, profile);
+}
+
+/* Size the ring buffer of the time-shift source, the window is in minutes */
+static void
+setup_timeshift_src(GvTimeshiftSrc *src, guint window, const GvBufferingProfile *profile)
+{
+	guint64 ring_buffer_size;
+
+	ring_buffer_size = (guint64) window * 60 * TIMESHIFT_MAX_BITRATE * 1000 / 8;
+	gv_timeshift_src_set_ring_buffer_size(src, ring_buffer_size);
+
+	/* The queue was created before it was part of the playbin, so it
+	 * didn't go through element-setup */
+	set_queue_watermarks(gv_timeshift_src_get_queue(src), profile);
+}
+
+/* Adaptive demuxers come in two flavours. The ones from adaptivedemux2 can
+ * be given a fixed bandwidth (in bits per second), and a range of bitrates
+ * to pick from. The older ones only know about the connection speed (in
+ * kbps), so a cap pins the variant rather than bounding it. Either way, a
+ * bandwidth lower than any variant gets the lowest one. The playbin is also
+ * given the connection speed, as it passes it down to the demuxers it
+ * creates, possibly after we've set them up. */
+static guint
+get_adaptive_connection_speed(GvEngineHlsPolicy policy)
+{
+	switch (policy) {
+	case GV_ENGINE_HLS_POLICY_LOWEST:
+		return 1;
+	case GV_ENGINE_HLS_POLICY_HIGHEST:
+		return G_MAXUINT / 1000;
+	default:
+		return 0;
+	}
+}
+
+static gboolean
+is_adaptive_demux(GstElement *element)
+{
+	GstElementFactory *factory;
+	const gchar *klass;
+
+	factory = gst_element_get_factory(element);
+	if (factory == NULL)
+		return FALSE;
+
+	klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+	if (klass == NULL)
+		return FALSE;
+
+	return strstr(klass, "Demuxer/Adaptive") != NULL;
+}
+
+static void
+set_adaptive_demux_policy(GstElement *element, GvEngineHlsPolicy policy,
+			  guint max_bitrate)
+{
+	GObjectClass *object_class;
+	guint speed;  // kbps, zero to let the demuxer measure it
+	guint cap;    // kbps, zero for no cap
+
+	if (is_adaptive_demux(element) == FALSE)
+		return;
+
+	speed = get_adaptive_connection_speed(policy);
+	cap = policy == GV_ENGINE_HLS_POLICY_CAPPED ? max_bitrate : 0;
+
+	DEBUG("Adaptive demuxer %s: speed %u kbps, cap %u kbps",
+	      GST_ELEMENT_NAME(element), speed, cap);
+
+	object_class = G_OBJECT_GET_CLASS(element);
+	if (g_object_class_find_property(object_class, "connection-bitrate") != NULL)
+		g_object_set(element,
+			     "connection-bitrate", speed * 1000,
+			     "max-bitrate", cap * 1000,
+			     "start-bitrate", cap * 1000,
+			     NULL);
+	else if (g_object_class_find_property(object_class, "connection-speed") != NULL)
+		g_object_set(element,
+			     "connection-speed", speed > 0 ? speed : cap,
+			     NULL);
+}
+
 #if 0
 static GstState
 get_gst_state(GstElement *playbin)
@@ -229,129 +962,406 @@ error_code_as_string(GError *err)
  * Private methods
  */
 
+static void release_playback(GvEngine *self);
+
+static const GvBufferingProfile *
+find_buffering_profile(const gchar *name)
+{
+	guint i;
+
+	for (i = 0; i < N_BUFFERING_PROFILES; i++)
+		if (!g_strcmp0(buffering_profiles[i].name, name))
+			return &buffering_profiles[i];
+
+	return NULL;
+}
+
+static const GvBufferingProfile *
+get_buffering_profile(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	const GvBufferingProfile *profile = NULL;
+
+	/* The profile of the stream, if any, wins over the default one */
+	if (priv->stream_buffering_profile != NULL)
+		profile = find_buffering_profile(priv->stream_buffering_profile);
+
+	if (profile == NULL)
+		profile = &buffering_profiles[priv->buffering_profile];
+
+	return profile;
+}
+
 static void
-gv_engine_reload_pipeline(GvEngine *self)
+apply_buffering_profile(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	const GvBufferingProfile *profile = get_buffering_profile(self);
+	GstIterator *iter;
+
+	DEBUG("Applying buffering profile '%s'", profile->name);
+
+	g_atomic_pointer_set(&priv->active_profile, profile);
+
+	/* Buffer size and duration only apply to elements created from now
+	 * on, while watermarks can be changed on existing queues */
+	g_object_set(priv->playbin,
+		     "connection-speed", (guint64) get_adaptive_connection_speed(priv->hls_policy),
+		     "buffer-size", profile->buffer_size,
+		     "buffer-duration", profile->buffer_duration,
+		     NULL);
+
+	iter = gst_bin_iterate_recurse(GST_BIN(priv->playbin));
+	gst_iterator_foreach(iter, set_queue_watermarks_foreach, (gpointer) profile);
+	gst_iterator_free(iter);
+}
+
+static void
+apply_hls_policy_foreach(const GValue *item, gpointer user_data)
+{
+	GstElement *element = g_value_get_object(item);
+	GvEnginePrivate *priv = user_data;
+
+	set_adaptive_demux_policy(element, priv->hls_policy, priv->hls_max_bitrate);
+}
+
+static void
+apply_hls_policy(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstIterator *iter;
+
+	if (priv->playbin == NULL)
+		return;
+
+	/* The standby engine limits the connection speed on its own */
+	if (priv->standby_mode == FALSE)
+		g_object_set(priv->playbin, "connection-speed",
+			     (guint64) get_adaptive_connection_speed(priv->hls_policy),
+			     NULL);
+
+	/* Demuxers pick it up with the next fragment */
+	iter = gst_bin_iterate_recurse(GST_BIN(priv->playbin));
+	gst_iterator_foreach(iter, apply_hls_policy_foreach, priv);
+	gst_iterator_free(iter);
+}
+
+static void
+set_audio_sink(GvEngine *self, GstElement *new_audio_sink)
 {
 	GvEnginePrivate *priv = self->priv;
 	GstElement *playbin = priv->playbin;
-	gboolean pipeline_enabled = priv->pipeline_enabled;
-	const gchar *pipeline_string = priv->pipeline_string;
 	GstElement *cur_audio_sink = NULL;
-	GstElement *new_audio_sink = NULL;
-
-	g_return_if_fail(playbin != NULL);
 
 	/* Get current audio sink */
 	g_object_get(playbin, "audio-sink", &cur_audio_sink, NULL);
 
 	DEBUG("Current audio sink: %s", cur_audio_sink ? GST_ELEMENT_NAME(cur_audio_sink) : "null (default)");
-
-	/* Create a new audio sink */
-	if (pipeline_enabled == FALSE || pipeline_string == NULL) {
-		new_audio_sink = NULL;
-	} else {
-		GError *err = NULL;
-
-		new_audio_sink = gst_parse_launch(pipeline_string, &err);
-		if (err) {
-			WARNING("Failed to parse pipeline description: %s", err->message);
-			gv_errorable_emit_error(GV_ERRORABLE(self),
-						_("Failed to parse pipeline description"),
-						err->message);
-			g_error_free(err);
-		}
-	}
-
 	DEBUG("New audio sink: %s", new_audio_sink ? GST_ELEMENT_NAME(new_audio_sink) : "null (default)");
 
 	/* True when one of them is NULL */
 	if (cur_audio_sink != new_audio_sink) {
+		gchar *uri = NULL;
+		gchar *user_agent = NULL;
+		gchar *buffering_profile = NULL;
+		gboolean ssl_strict = TRUE;
+
+		/* The playbin only picks up a new audio sink when it's torn
+		 * down, so remember what was playing, to resume it after */
+		if (priv->state != GV_ENGINE_STATE_STOPPED && priv->paused == FALSE &&
+		    priv->uri != NULL) {
+			uri = g_strdup(priv->uri);
+			user_agent = g_strdup(priv->user_agent);
+			buffering_profile = g_strdup(priv->stream_buffering_profile);
+			ssl_strict = priv->ssl_strict;
+		}
+
 		gv_engine_stop(self);
+		release_playback(self);
+
+		/* The standby engine is now using an outdated audio sink */
+		gv_engine_cancel_preroll(self);
 
 		if (new_audio_sink == NULL)
 			INFO("Setting gst audio sink to default");
 		else
-			INFO("Setting gst audio sink from pipeline '%s'", pipeline_string);
+			INFO("Setting gst audio sink from pipeline '%s'", priv->pipeline_string);
 
 		g_object_set(playbin, "audio-sink", new_audio_sink, NULL);
+
+		if (uri != NULL) {
+			INFO("Resuming playback with the new audio sink");
+			gv_engine_play(self, uri, user_agent, ssl_strict, buffering_profile);
+			g_free(buffering_profile);
+			g_free(user_agent);
+			g_free(uri);
+		}
 	}
 
 	if (cur_audio_sink)
 		gst_object_unref(cur_audio_sink);
 }
 
-/*
- * Property accessors
- */
-
-GvEngineState
-gv_engine_get_state(GvEngine *self)
-{
-	return self->priv->state;
-}
-
 static void
-gv_engine_set_state(GvEngine *self, GvEngineState state)
+uncache_audio_sink(GvEngine *self, const gchar *pipeline_string)
 {
 	GvEnginePrivate *priv = self->priv;
+	gpointer key;
 
-	if (priv->state == state)
+	/* The queue doesn't own the keys, drop them from there first */
+	if (!g_hash_table_lookup_extended(priv->audio_sinks, pipeline_string, &key, NULL))
 		return;
 
-	priv->state = state;
-	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PLAYBACK_STATE]);
-}
-
-GvStreaminfo *
-gv_engine_get_streaminfo(GvEngine *self)
-{
-	return self->priv->streaminfo;
+	g_queue_remove(priv->audio_sinks_lru, key);
+	g_hash_table_remove(priv->audio_sinks, key);
 }
 
 static void
-gv_engine_update_streaminfo_from_element_setup(GvEngine *self, GstElement *element)
+cache_audio_sink(GvEngine *self, const gchar *pipeline_string, GstElement *sink)
 {
 	GvEnginePrivate *priv = self->priv;
-	gboolean notify = FALSE;
+	gchar *key;
 
-	if (priv->streaminfo == NULL) {
-		priv->streaminfo = gv_streaminfo_new();
-		notify = TRUE;
-	}
+	/* Replace any stale entry */
+	uncache_audio_sink(self, pipeline_string);
 
-	if (gv_streaminfo_update_from_element_setup(priv->streaminfo, element) == TRUE)
-		notify = TRUE;
+	/* Make room, starting with the least recently used, but keep the
+	 * sink in use */
+	if (g_hash_table_size(priv->audio_sinks) >= MAX_CACHED_AUDIO_SINKS) {
+		GstElement *cur_audio_sink = NULL;
+		GList *link;
 
-	if (notify)
-		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STREAMINFO]);
+		g_object_get(priv->playbin, "audio-sink", &cur_audio_sink, NULL);
+
+		for (link = priv->audio_sinks_lru->tail; link; link = link->prev) {
+			if (g_hash_table_lookup(priv->audio_sinks, link->data) == cur_audio_sink)
+				continue;
+			uncache_audio_sink(self, link->data);
+			break;
+		}
+
+		if (cur_audio_sink)
+			gst_object_unref(cur_audio_sink);
+	}
+
+	key = g_strdup(pipeline_string);
+	g_hash_table_insert(priv->audio_sinks, key, gst_object_ref(sink));
+	g_queue_push_head(priv->audio_sinks_lru, key);
 }
 
-static void
-gv_engine_update_streaminfo_from_tags(GvEngine *self, GstTagList *taglist)
+static GstElement *
+lookup_audio_sink(GvEngine *self, const gchar *pipeline_string)
 {
 	GvEnginePrivate *priv = self->priv;
-	gboolean notify = FALSE;
-
-	if (priv->streaminfo == NULL) {
-		priv->streaminfo = gv_streaminfo_new();
-		notify = TRUE;
+	GstElement *sink;
+	gpointer key;
+
+	if (!g_hash_table_lookup_extended(priv->audio_sinks, pipeline_string,
+					  &key, (gpointer *) &sink))
+		return NULL;
+
+	/* It might still be held by the previous pipeline, in which case
+	 * it can't be re-used, and we'll have to build it again */
+	if (GST_OBJECT_PARENT(sink) != NULL) {
+		uncache_audio_sink(self, pipeline_string);
+		return NULL;
 	}
 
-	if (gv_streaminfo_update_from_gst_taglist(priv->streaminfo, taglist) == TRUE)
-		notify = TRUE;
+	/* Move it to the front */
+	g_queue_remove(priv->audio_sinks_lru, key);
+	g_queue_push_head(priv->audio_sinks_lru, key);
 
-	if (notify)
-		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STREAMINFO]);
+	return sink;
 }
 
+typedef struct {
+	gchar *pipeline_string;
+	gboolean preroll;
+} AudioSinkTaskData;
+
 static void
-gv_engine_update_streaminfo_from_caps(GvEngine *self, GstCaps *caps)
+audio_sink_task_data_free(AudioSinkTaskData *data)
 {
-	GvEnginePrivate *priv = self->priv;
-	gboolean notify = FALSE;
+	g_free(data->pipeline_string);
+	g_free(data);
+}
 
-	if (priv->streaminfo == NULL) {
-		priv->streaminfo = gv_streaminfo_new();
+static void
+make_audio_sink_thread(GTask *task,
+		       gpointer source_object G_GNUC_UNUSED,
+		       gpointer task_data,
+		       GCancellable *cancellable G_GNUC_UNUSED)
+{
+	AudioSinkTaskData *data = task_data;
+	GstElement *sink;
+	GError *err = NULL;
+
+	sink = make_audio_sink(data->pipeline_string, data->preroll, &err);
+	if (sink == NULL)
+		g_task_return_error(task, err);
+	else
+		g_task_return_pointer(task, sink, gst_object_unref);
+}
+
+static void
+on_make_audio_sink_ready(GObject *source_object,
+			 GAsyncResult *result,
+			 gpointer user_data G_GNUC_UNUSED)
+{
+	GvEngine *self = GV_ENGINE(source_object);
+	GvEnginePrivate *priv = self->priv;
+	GTask *task = G_TASK(result);
+	AudioSinkTaskData *data = g_task_get_task_data(task);
+	const gchar *pipeline_string = data->pipeline_string;
+	GstElement *sink;
+	GError *err = NULL;
+
+	sink = g_task_propagate_pointer(task, &err);
+
+	/* Superseded by another pipeline, or engine disposed */
+	if (g_error_matches(err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free(err);
+		return;
+	}
+
+	g_clear_object(&priv->audio_sink_cancellable);
+
+	if (err != NULL) {
+		WARNING("Failed to create pipeline '%s': %s", pipeline_string, err->message);
+		gv_errorable_emit_error(GV_ERRORABLE(self),
+					_("Failed to parse pipeline description"),
+					err->message);
+		g_error_free(err);
+		return;
+	}
+
+	cache_audio_sink(self, pipeline_string, sink);
+	set_audio_sink(self, sink);
+	gst_object_unref(sink);
+}
+
+static void
+gv_engine_reload_pipeline(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	const gchar *pipeline_string = priv->pipeline_string;
+	AudioSinkTaskData *data;
+	GstElement *sink;
+	GTask *task;
+
+	g_return_if_fail(priv->playbin != NULL);
+
+	/* Headless engines keep their fakesink */
+	if (priv->headless == TRUE)
+		return;
+
+	/* Whatever was pending is outdated */
+	if (priv->audio_sink_cancellable != NULL) {
+		g_cancellable_cancel(priv->audio_sink_cancellable);
+		g_clear_object(&priv->audio_sink_cancellable);
+	}
+
+	/* Default audio sink */
+	if (priv->pipeline_enabled == FALSE || pipeline_string == NULL) {
+		set_audio_sink(self, NULL);
+		return;
+	}
+
+	/* Known pipeline */
+	sink = lookup_audio_sink(self, pipeline_string);
+	if (sink != NULL) {
+		DEBUG("Re-using cached pipeline '%s'", pipeline_string);
+		set_audio_sink(self, sink);
+		return;
+	}
+
+	/* New pipeline, it will be swapped in once validated */
+	DEBUG("Validating pipeline '%s'", pipeline_string);
+	priv->audio_sink_cancellable = g_cancellable_new();
+	task = g_task_new(self, priv->audio_sink_cancellable,
+			  on_make_audio_sink_ready, NULL);
+	data = g_new0(AudioSinkTaskData, 1);
+	data->pipeline_string = g_strdup(pipeline_string);
+	/* Our audio sink stays open until the playbin is released, and the
+	 * device might not be opened twice, in which case don't try */
+	data->preroll = GST_STATE(priv->playbin) == GST_STATE_NULL;
+	g_task_set_task_data(task, data, (GDestroyNotify) audio_sink_task_data_free);
+	g_task_run_in_thread(task, make_audio_sink_thread);
+	g_object_unref(task);
+}
+
+/*
+ * Property accessors
+ */
+
+GvEngineState
+gv_engine_get_state(GvEngine *self)
+{
+	return self->priv->state;
+}
+
+static void
+gv_engine_set_state(GvEngine *self, GvEngineState state)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->state == state)
+		return;
+
+	priv->state = state;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PLAYBACK_STATE]);
+}
+
+GvStreaminfo *
+gv_engine_get_streaminfo(GvEngine *self)
+{
+	return self->priv->streaminfo;
+}
+
+static void
+gv_engine_update_streaminfo_from_element_setup(GvEngine *self, GstElement *element)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean notify = FALSE;
+
+	if (priv->streaminfo == NULL) {
+		priv->streaminfo = gv_streaminfo_new();
+		notify = TRUE;
+	}
+
+	if (gv_streaminfo_update_from_element_setup(priv->streaminfo, element) == TRUE)
+		notify = TRUE;
+
+	if (notify)
+		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STREAMINFO]);
+}
+
+static void
+gv_engine_update_streaminfo_from_tags(GvEngine *self, GstTagList *taglist)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean notify = FALSE;
+
+	if (priv->streaminfo == NULL) {
+		priv->streaminfo = gv_streaminfo_new();
+		notify = TRUE;
+	}
+
+	if (gv_streaminfo_update_from_gst_taglist(priv->streaminfo, taglist) == TRUE)
+		notify = TRUE;
+
+	if (notify)
+		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STREAMINFO]);
+}
+
+static void
+gv_engine_update_streaminfo_from_caps(GvEngine *self, GstCaps *caps)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean notify = FALSE;
+
+	if (priv->streaminfo == NULL) {
+		priv->streaminfo = gv_streaminfo_new();
 		notify = TRUE;
 	}
 
@@ -362,6 +1372,27 @@ gv_engine_update_streaminfo_from_caps(GvEngine *self, GstCaps *caps)
 		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STREAMINFO]);
 }
 
+static void
+gv_engine_update_streaminfo_from_variant(GvEngine *self, guint bitrate)
+{
+	GvEnginePrivate *priv = self->priv;
+	gboolean notify = FALSE;
+
+	if (priv->streaminfo == NULL) {
+		priv->streaminfo = gv_streaminfo_new();
+		notify = TRUE;
+	}
+
+	if (gv_streaminfo_update_from_variant(priv->streaminfo, bitrate) == TRUE) {
+		INFO("Playing variant at %u kbps (%u switches)", bitrate / 1000,
+		     gv_streaminfo_get_variant_switches(priv->streaminfo));
+		notify = TRUE;
+	}
+
+	if (notify)
+		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STREAMINFO]);
+}
+
 static void
 gv_engine_unset_streaminfo(GvEngine *self)
 {
@@ -400,8 +1431,29 @@ gv_engine_update_metadata_from_tags(GvEngine *self, GstTagList *taglist)
 	if (gv_metadata_is_empty(priv->metadata))
 		gv_clear_metadata(&priv->metadata);
 
-	if (notify)
-		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_METADATA]);
+	if (notify == FALSE)
+		return;
+
+	/* A new title means a new file for the recorder. ICY streams are
+	 * split as the titles come in the stream, upstream of the time-shift
+	 * ring buffer, as the tags that we get here might come much later. */
+	g_mutex_lock(&priv->stats_lock);
+	if (priv->recorder != NULL && priv->recording_icy == FALSE &&
+	    priv->metadata != NULL) {
+		gchar *title;
+
+		title = gv_metadata_make_title_artist(priv->metadata, FALSE);
+		if (priv->recording_pending || g_strcmp0(title, priv->recording_title)) {
+			gv_recorder_split(priv->recorder, title);
+			priv->recording_pending = FALSE;
+			g_free(priv->recording_title);
+			priv->recording_title = g_steal_pointer(&title);
+		}
+		g_free(title);
+	}
+	g_mutex_unlock(&priv->stats_lock);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_METADATA]);
 }
 
 static void
@@ -436,10 +1488,13 @@ gv_engine_set_volume(GvEngine *self, guint volume)
 
 	priv->volume = volume;
 
-	gst_volume = (gdouble) volume / 100.0;
+	gst_volume = (gdouble) volume / 100.0 * priv->fade;
 	gst_stream_volume_set_volume(GST_STREAM_VOLUME(priv->playbin),
 				     GST_STREAM_VOLUME_FORMAT_CUBIC, gst_volume);
 
+	if (priv->fader != NULL)
+		gv_engine_set_volume(priv->fader, volume);
+
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_VOLUME]);
 }
 
@@ -459,6 +1514,10 @@ gv_engine_set_mute(GvEngine *self, gboolean mute)
 
 	priv->mute = mute;
 	gst_stream_volume_set_mute(GST_STREAM_VOLUME(priv->playbin), mute);
+
+	if (priv->fader != NULL)
+		gv_engine_set_mute(priv->fader, mute);
+
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MUTE]);
 }
 
@@ -508,162 +1567,1543 @@ gv_engine_set_pipeline_string(GvEngine *self, const gchar *pipeline_string)
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PIPELINE_STRING]);
 }
 
-static void
-gv_engine_get_property(GObject *object,
-		       guint property_id,
-		       GValue *value,
-		       GParamSpec *pspec)
+guint
+gv_engine_get_switch_latency(GvEngine *self)
 {
-	GvEngine *self = GV_ENGINE(object);
-
-	TRACE_GET_PROPERTY(object, property_id, value, pspec);
-
-	switch (property_id) {
-	case PROP_PLAYBACK_STATE:
-		g_value_set_enum(value, gv_engine_get_state(self));
-		break;
-	case PROP_STREAMINFO:
-		g_value_set_boxed(value, gv_engine_get_streaminfo(self));
-		break;
-	case PROP_METADATA:
-		g_value_set_boxed(value, gv_engine_get_metadata(self));
-		break;
-	case PROP_VOLUME:
-		g_value_set_uint(value, gv_engine_get_volume(self));
-		break;
-	case PROP_MUTE:
-		g_value_set_boolean(value, gv_engine_get_mute(self));
-		break;
-	case PROP_PIPELINE_ENABLED:
-		g_value_set_boolean(value, gv_engine_get_pipeline_enabled(self));
-		break;
-	case PROP_PIPELINE_STRING:
-		g_value_set_string(value, gv_engine_get_pipeline_string(self));
-		break;
-	default:
-		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
-		break;
-	}
+	return self->priv->switch_latency;
 }
 
 static void
-gv_engine_set_property(GObject *object,
-		       guint property_id,
-		       const GValue *value,
-		       GParamSpec *pspec)
+gv_engine_set_switch_latency(GvEngine *self, guint latency)
 {
-	GvEngine *self = GV_ENGINE(object);
+	GvEnginePrivate *priv = self->priv;
 
-	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+	if (priv->switch_latency == latency)
+		return;
 
-	switch (property_id) {
-	case PROP_VOLUME:
-		gv_engine_set_volume(self, g_value_get_uint(value));
-		break;
-	case PROP_MUTE:
-		gv_engine_set_mute(self, g_value_get_boolean(value));
-		break;
-	case PROP_PIPELINE_ENABLED:
-		gv_engine_set_pipeline_enabled(self, g_value_get_boolean(value));
-		break;
-	case PROP_PIPELINE_STRING:
-		gv_engine_set_pipeline_string(self, g_value_get_string(value));
-		break;
-	default:
-		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
-		break;
-	}
+	priv->switch_latency = latency;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SWITCH_LATENCY]);
 }
 
-/*
- * Private methods
- */
+GvEngineBufferingProfile
+gv_engine_get_buffering_profile(GvEngine *self)
+{
+	return self->priv->buffering_profile;
+}
 
-static void
-_stop_playback(GvEngine *self)
+void
+gv_engine_set_buffering_profile(GvEngine *self, GvEngineBufferingProfile profile)
 {
 	GvEnginePrivate *priv = self->priv;
-	GstElement *playbin = priv->playbin;
 
-	/* To stop the playback, we can set it to either READY or NULL. The
-	 * difference is that when we set it to READY, we'll receive a bunch of
-	 * "state-changed" message, that we can use to update our own state.
-	 * While if we set it to NULL, we won't receive any "state-changed"
-	 * message, therefore we need to update our state manually.
-	 *
-	 * We go for the latter, as it's what has always been done in Goodvibes
-	 * so far, and it's also a sure guarantee that will receive a
-	 * "state-changed=ready" message when we'll want to start the playback
-	 * (since we'll go from NULL to READY).
-	 */
+	g_return_if_fail(profile < N_BUFFERING_PROFILES);
 
-	priv->buffering = FALSE;
-	priv->target_state = GST_STATE_NULL;
-	set_gst_state(playbin, GST_STATE_NULL);
-	gv_engine_set_state(self, GV_ENGINE_STATE_STOPPED);
-}
+	if (priv->buffering_profile == profile)
+		return;
 
-#define stop_playback(self) _stop_playback(self)
+	priv->buffering_profile = profile;
 
-static void
-_start_playback(GvEngine *self, gboolean force_stop)
-{
-	GvEnginePrivate *priv = self->priv;
-	GstElement *playbin = priv->playbin;
+	if (priv->uri != NULL && priv->standby_mode == FALSE)
+		apply_buffering_profile(self);
 
-	/* First, stop the playback, in case it's not stopped already. Then set
-	 * the playbin state to PAUSED, so that it starts buffering data.  When
-	 * buffering reaches 100%, we'll start playing for real. This is
-	 * handled in the callback for buffering messages.
-	 *
-	 * It's also possible that there's no buffering, and this is handled
-	 * in the callback for state-changed messages.
-	 */
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_BUFFERING_PROFILE]);
+}
 
-	if (force_stop == TRUE)
-		stop_playback(self);
-	priv->target_state = GST_STATE_PAUSED;
-	set_gst_state(playbin, GST_STATE_PAUSED);
+const GvEngineStats *
+gv_engine_get_stats(GvEngine *self)
+{
+	return &self->priv->stats;
 }
 
-#define start_playback(self) _start_playback(self, TRUE)
+guint
+gv_engine_get_crossfade_duration(GvEngine *self)
+{
+	return self->priv->crossfade_duration;
+}
 
-static void
-start_playback_for_real(GvEngine *self)
+void
+gv_engine_set_crossfade_duration(GvEngine *self, guint duration)
 {
 	GvEnginePrivate *priv = self->priv;
-	GstElement *playbin = priv->playbin;
 
-	priv->target_state = GST_STATE_PLAYING;
-	set_gst_state(playbin, GST_STATE_PLAYING);
+	if (duration > GV_MAX_CROSSFADE_DURATION)
+		duration = GV_MAX_CROSSFADE_DURATION;
+
+	if (priv->crossfade_duration == duration)
+		return;
+
+	priv->crossfade_duration = duration;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_CROSSFADE_DURATION]);
 }
 
-/*
- * Public methods
- */
+guint
+gv_engine_get_timeshift_window(GvEngine *self)
+{
+	return self->priv->timeshift_window;
+}
 
 void
-gv_engine_stop(GvEngine *self)
+gv_engine_set_timeshift_window(GvEngine *self, guint window)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (window > GV_MAX_TIMESHIFT_WINDOW)
+		window = GV_MAX_TIMESHIFT_WINDOW;
+
+	if (priv->timeshift_window == window)
+		return;
+
+	/* Takes effect with the next stream played */
+	priv->timeshift_window = window;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_TIMESHIFT_WINDOW]);
+}
+
+guint
+gv_engine_get_stall_timeout(GvEngine *self)
+{
+	return self->priv->stall_timeout;
+}
+
+void
+gv_engine_set_stall_timeout(GvEngine *self, guint timeout)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (timeout > GV_MAX_STALL_TIMEOUT)
+		timeout = GV_MAX_STALL_TIMEOUT;
+
+	if (priv->stall_timeout == timeout)
+		return;
+
+	/* Takes effect with the next stream played */
+	priv->stall_timeout = timeout;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STALL_TIMEOUT]);
+}
+
+guint
+gv_engine_get_stall_count(GvEngine *self)
+{
+	return self->priv->stall_count;
+}
+
+guint
+gv_engine_get_http_status(GvEngine *self)
+{
+	return self->priv->http_status;
+}
+
+gboolean
+gv_engine_get_prerolled(GvEngine *self)
+{
+	return self->priv->prerolled;
+}
+
+GvEngineHlsPolicy
+gv_engine_get_hls_policy(GvEngine *self)
+{
+	return g_atomic_int_get(&self->priv->hls_policy);
+}
+
+void
+gv_engine_set_hls_policy(GvEngine *self, GvEngineHlsPolicy policy)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_return_if_fail(policy <= GV_ENGINE_HLS_POLICY_CAPPED);
+
+	if (gv_engine_get_hls_policy(self) == policy)
+		return;
+
+	g_atomic_int_set(&priv->hls_policy, policy);
+	apply_hls_policy(self);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_HLS_POLICY]);
+}
+
+guint
+gv_engine_get_hls_max_bitrate(GvEngine *self)
+{
+	return g_atomic_int_get(&self->priv->hls_max_bitrate);
+}
+
+void
+gv_engine_set_hls_max_bitrate(GvEngine *self, guint max_bitrate)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (max_bitrate > GV_HLS_MAX_BITRATE)
+		max_bitrate = GV_HLS_MAX_BITRATE;
+
+	if (gv_engine_get_hls_max_bitrate(self) == max_bitrate)
+		return;
+
+	g_atomic_int_set(&priv->hls_max_bitrate, max_bitrate);
+	apply_hls_policy(self);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_HLS_MAX_BITRATE]);
+}
+
+gboolean
+gv_engine_get_headless(GvEngine *self)
+{
+	return self->priv->headless;
+}
+
+static void
+gv_engine_set_headless(GvEngine *self, gboolean headless)
+{
+	/* Construct-only property */
+	self->priv->headless = headless;
+}
+
+gboolean
+gv_engine_get_metadata_only(GvEngine *self)
+{
+	return self->priv->metadata_only;
+}
+
+static void
+gv_engine_set_metadata_only(GvEngine *self, gboolean metadata_only)
+{
+	/* Construct-only property */
+	self->priv->metadata_only = metadata_only;
+}
+
+gboolean
+gv_engine_get_recording(GvEngine *self)
+{
+	return self->priv->recorder != NULL;
+}
+
+void
+gv_engine_set_recording(GvEngine *self, gboolean recording)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvRecorder *recorder;
+
+	if (gv_engine_get_recording(self) == recording)
+		return;
+
+	/* The recorder is used from the streaming threads, so it's swapped
+	 * under the lock, while it's created and destroyed outside of it */
+	if (recording == TRUE) {
+		const gchar *directory = priv->recording_directory;
+
+		if (directory == NULL)
+			directory = gv_get_app_user_music_dir();
+
+		INFO("Start recording to '%s'", directory);
+		recorder = gv_recorder_new(directory);
+
+		g_mutex_lock(&priv->stats_lock);
+		priv->recorder = recorder;
+		priv->recording_pending = TRUE;
+		/* If we know the title already, start a file right away,
+		 * otherwise wait for the title or for the data */
+		if (priv->uri != NULL && priv->recording_icy == FALSE &&
+		    priv->metadata != NULL) {
+			priv->recording_title =
+				gv_metadata_make_title_artist(priv->metadata, FALSE);
+			gv_recorder_split(recorder, priv->recording_title);
+			priv->recording_pending = FALSE;
+		}
+		g_mutex_unlock(&priv->stats_lock);
+	} else {
+		INFO("Stop recording");
+
+		g_mutex_lock(&priv->stats_lock);
+		recorder = g_steal_pointer(&priv->recorder);
+		g_mutex_unlock(&priv->stats_lock);
+
+		/* Joins the writer thread, once it wrote what's left */
+		g_object_unref(recorder);
+		g_clear_pointer(&priv->recording_title, g_free);
+	}
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RECORDING]);
+}
+
+const gchar *
+gv_engine_get_recording_directory(GvEngine *self)
+{
+	return self->priv->recording_directory;
+}
+
+void
+gv_engine_set_recording_directory(GvEngine *self, const gchar *directory)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Empty means the default directory. Takes effect the next time
+	 * recording is started. */
+	if (directory && *directory == '\0')
+		directory = NULL;
+
+	if (!g_strcmp0(priv->recording_directory, directory))
+		return;
+
+	g_free(priv->recording_directory);
+	priv->recording_directory = g_strdup(directory);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RECORDING_DIRECTORY]);
+}
+
+gboolean
+gv_engine_get_can_seek(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (g_atomic_int_get(&priv->timeshift_active) == FALSE)
+		return FALSE;
+
+	return priv->state == GV_ENGINE_STATE_PLAYING ||
+	       priv->state == GV_ENGINE_STATE_PAUSED;
+}
+
+gint64
+gv_engine_get_position(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gint64 position;
+
+	/* Position is in microseconds, or -1 if unknown */
+	if (priv->state != GV_ENGINE_STATE_PLAYING &&
+	    priv->state != GV_ENGINE_STATE_PAUSED)
+		return -1;
+
+	if (!gst_element_query_position(priv->playbin, GST_FORMAT_TIME, &position))
+		return -1;
+
+	return position / GST_USECOND;
+}
+
+gint64
+gv_engine_get_data_idle_time(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gint64 last_data_time;
+
+	/* Time since data last came in, or since the stream was started if
+	 * nothing came in yet, in microseconds, or -1 if nothing is playing */
+	if (priv->uri == NULL)
+		return -1;
+
+	g_mutex_lock(&priv->stats_lock);
+	last_data_time = priv->last_data_time;
+	g_mutex_unlock(&priv->stats_lock);
+
+	if (last_data_time == 0)
+		last_data_time = priv->play_time;
+
+	return g_get_monotonic_time() - last_data_time;
+}
+
+guint
+gv_engine_get_underruns(GvEngine *self, GvEngineBufferingProfile profile)
+{
+	g_return_val_if_fail(profile < N_BUFFERING_PROFILES, 0);
+
+	return self->priv->underruns[profile];
+}
+
+static void
+gv_engine_get_property(GObject *object,
+		       guint property_id,
+		       GValue *value,
+		       GParamSpec *pspec)
+{
+	GvEngine *self = GV_ENGINE(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_PLAYBACK_STATE:
+		g_value_set_enum(value, gv_engine_get_state(self));
+		break;
+	case PROP_STREAMINFO:
+		g_value_set_boxed(value, gv_engine_get_streaminfo(self));
+		break;
+	case PROP_METADATA:
+		g_value_set_boxed(value, gv_engine_get_metadata(self));
+		break;
+	case PROP_VOLUME:
+		g_value_set_uint(value, gv_engine_get_volume(self));
+		break;
+	case PROP_MUTE:
+		g_value_set_boolean(value, gv_engine_get_mute(self));
+		break;
+	case PROP_PIPELINE_ENABLED:
+		g_value_set_boolean(value, gv_engine_get_pipeline_enabled(self));
+		break;
+	case PROP_PIPELINE_STRING:
+		g_value_set_string(value, gv_engine_get_pipeline_string(self));
+		break;
+	case PROP_SWITCH_LATENCY:
+		g_value_set_uint(value, gv_engine_get_switch_latency(self));
+		break;
+	case PROP_BUFFERING_PROFILE:
+		g_value_set_enum(value, gv_engine_get_buffering_profile(self));
+		break;
+	case PROP_STATS:
+		g_value_set_boxed(value, gv_engine_get_stats(self));
+		break;
+	case PROP_CROSSFADE_DURATION:
+		g_value_set_uint(value, gv_engine_get_crossfade_duration(self));
+		break;
+	case PROP_TIMESHIFT_WINDOW:
+		g_value_set_uint(value, gv_engine_get_timeshift_window(self));
+		break;
+	case PROP_STALL_TIMEOUT:
+		g_value_set_uint(value, gv_engine_get_stall_timeout(self));
+		break;
+	case PROP_STALL_COUNT:
+		g_value_set_uint(value, gv_engine_get_stall_count(self));
+		break;
+	case PROP_PREROLLED:
+		g_value_set_boolean(value, gv_engine_get_prerolled(self));
+		break;
+	case PROP_HLS_POLICY:
+		g_value_set_enum(value, gv_engine_get_hls_policy(self));
+		break;
+	case PROP_HLS_MAX_BITRATE:
+		g_value_set_uint(value, gv_engine_get_hls_max_bitrate(self));
+		break;
+	case PROP_RECORDING:
+		g_value_set_boolean(value, gv_engine_get_recording(self));
+		break;
+	case PROP_RECORDING_DIRECTORY:
+		g_value_set_string(value, gv_engine_get_recording_directory(self));
+		break;
+	case PROP_HEADLESS:
+		g_value_set_boolean(value, gv_engine_get_headless(self));
+		break;
+	case PROP_METADATA_ONLY:
+		g_value_set_boolean(value, gv_engine_get_metadata_only(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_engine_set_property(GObject *object,
+		       guint property_id,
+		       const GValue *value,
+		       GParamSpec *pspec)
+{
+	GvEngine *self = GV_ENGINE(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_VOLUME:
+		gv_engine_set_volume(self, g_value_get_uint(value));
+		break;
+	case PROP_MUTE:
+		gv_engine_set_mute(self, g_value_get_boolean(value));
+		break;
+	case PROP_PIPELINE_ENABLED:
+		gv_engine_set_pipeline_enabled(self, g_value_get_boolean(value));
+		break;
+	case PROP_PIPELINE_STRING:
+		gv_engine_set_pipeline_string(self, g_value_get_string(value));
+		break;
+	case PROP_BUFFERING_PROFILE:
+		gv_engine_set_buffering_profile(self, g_value_get_enum(value));
+		break;
+	case PROP_CROSSFADE_DURATION:
+		gv_engine_set_crossfade_duration(self, g_value_get_uint(value));
+		break;
+	case PROP_TIMESHIFT_WINDOW:
+		gv_engine_set_timeshift_window(self, g_value_get_uint(value));
+		break;
+	case PROP_STALL_TIMEOUT:
+		gv_engine_set_stall_timeout(self, g_value_get_uint(value));
+		break;
+	case PROP_HLS_POLICY:
+		gv_engine_set_hls_policy(self, g_value_get_enum(value));
+		break;
+	case PROP_HLS_MAX_BITRATE:
+		gv_engine_set_hls_max_bitrate(self, g_value_get_uint(value));
+		break;
+	case PROP_RECORDING:
+		gv_engine_set_recording(self, g_value_get_boolean(value));
+		break;
+	case PROP_RECORDING_DIRECTORY:
+		gv_engine_set_recording_directory(self, g_value_get_string(value));
+		break;
+	case PROP_HEADLESS:
+		gv_engine_set_headless(self, g_value_get_boolean(value));
+		break;
+	case PROP_METADATA_ONLY:
+		gv_engine_set_metadata_only(self, g_value_get_boolean(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Private methods
+ */
+
+static gboolean
+when_timeout_release_playback(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	priv->release_timeout_id = 0;
+
+	DEBUG("Releasing playbin");
+	set_gst_state(priv->playbin, GST_STATE_NULL);
+
+	return G_SOURCE_REMOVE;
+}
+
+static gint64
+get_thread_cpu_time(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+
+	return (gint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static guint
+get_stats_elapsed(GvEngine *self, gint64 time)
+{
+	gint64 elapsed = (time - self->priv->play_time) / 1000;
+
+	/* Zero means 'no data', so round it up */
+	return elapsed > 0 ? (guint) elapsed : 1;
+}
+
+static void
+reset_stats(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_mutex_lock(&priv->stats_lock);
+	priv->connect_time = 0;
+	priv->last_data_time = 0;
+	priv->bytes_received = 0;
+	priv->decoder_cpu_time = 0;
+	priv->decoder_cpu_mark = 0;
+	g_mutex_unlock(&priv->stats_lock);
+
+	g_mutex_lock(&priv->bus_queue->lock);
+	priv->bus_queue->n_messages = 0;
+	priv->bus_queue->n_coalesced = 0;
+	g_mutex_unlock(&priv->bus_queue->lock);
+
+	priv->stats = (GvEngineStats) { 0 };
+	priv->buffering_start_time = 0;
+	priv->stats_time = g_get_monotonic_time();
+	priv->stats_bytes_received = 0;
+}
+
+static void
+update_stats(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEngineStats *stats = &priv->stats;
+	gint64 now = g_get_monotonic_time();
+	gint64 connect_time;
+	gint64 decoder_cpu_time;
+	guint64 bytes_received;
+
+	g_mutex_lock(&priv->stats_lock);
+	connect_time = priv->connect_time;
+	bytes_received = priv->bytes_received;
+	decoder_cpu_time = priv->decoder_cpu_time;
+	g_mutex_unlock(&priv->stats_lock);
+
+	g_mutex_lock(&priv->bus_queue->lock);
+	stats->bus_messages = priv->bus_queue->n_messages;
+	stats->bus_coalesced = priv->bus_queue->n_coalesced;
+	g_mutex_unlock(&priv->bus_queue->lock);
+
+	if (connect_time != 0)
+		stats->connect_time = get_stats_elapsed(self, connect_time);
+	stats->bytes_received = bytes_received;
+	stats->decoder_cpu_time = decoder_cpu_time / 1000000;
+
+	/* Input bitrate is measured since the last update */
+	if (now > priv->stats_time)
+		stats->input_bitrate = (bytes_received - priv->stats_bytes_received)
+			* 8 * 1000 / (now - priv->stats_time);
+	priv->stats_time = now;
+	priv->stats_bytes_received = bytes_received;
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STATS]);
+}
+
+static void
+log_stats(GvEngine *self)
+{
+	GvEngineStats *stats = &self->priv->stats;
+
+	INFO("Stats: connect %u ms, first buffer %u ms, playing %u ms, "
+	     "buffering %u times (%u ms), received %" G_GUINT64_FORMAT " bytes, "
+	     "bitrate %u kbps, decoder cpu %u ms, bus messages %u (%u coalesced), "
+	     "stalls %u",
+	     stats->connect_time, stats->first_buffer_time, stats->playing_time,
+	     stats->buffering_count, stats->buffering_time, stats->bytes_received,
+	     stats->input_bitrate, stats->decoder_cpu_time,
+	     stats->bus_messages, stats->bus_coalesced,
+	     self->priv->stall_count);
+}
+
+static gboolean
+when_timeout_update_stats(GvEngine *self)
+{
+	update_stats(self);
+	log_stats(self);
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+release_playback(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_clear_handle_id(&priv->release_timeout_id, g_source_remove);
+	set_gst_state(priv->playbin, GST_STATE_NULL);
+}
+
+static void
+flush_bus(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstMessage *msg;
+	gint generation;
+
+	/* Drop the messages that are still on the bus. Then some messages
+	 * might have been pulled by the bus thread already, so we bump the
+	 * generation, and post a message to let the bus thread know. */
+	gst_bus_set_flushing(priv->bus, TRUE);
+	gst_bus_set_flushing(priv->bus, FALSE);
+
+	generation = g_atomic_int_add(&priv->bus_queue->generation, 1) + 1;
+	msg = gst_message_new_application(GST_OBJECT(priv->playbin),
+			gst_structure_new(BUS_FLUSH_MESSAGE,
+					  "generation", G_TYPE_INT, generation,
+					  NULL));
+	gst_bus_post(priv->bus, msg);
+}
+
+static void
+_stop_playback(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstElement *playbin = priv->playbin;
+
+	/* To stop the playback, we can set it to either READY or NULL. In
+	 * READY, the source and the decoders are dropped, but the audio sink
+	 * stays open, while in NULL everything is torn down. So we go for
+	 * READY, so that the next playback doesn't have to open the audio
+	 * device again, and we release the playbin later on.
+	 *
+	 * Either way, we update our state manually, and we flush the bus, so
+	 * that we don't process messages that were posted for the stream we
+	 * just stopped. Any state change from now on belongs to the next
+	 * playback.
+	 */
+
+	priv->buffering = FALSE;
+	priv->prerolled = FALSE;
+	priv->underrun = FALSE;
+	priv->paused = FALSE;
+	priv->pause_time = 0;
+	priv->timeshift_delay = 0;
+	priv->target_state = GST_STATE_NULL;
+	g_atomic_int_set(&priv->first_buffer_pending, FALSE);
+
+	if (GST_STATE(playbin) != GST_STATE_NULL) {
+		set_gst_state(playbin, GST_STATE_READY);
+		flush_bus(self);
+	}
+
+	if (GST_STATE(playbin) != GST_STATE_NULL && priv->release_timeout_id == 0)
+		priv->release_timeout_id = g_timeout_add_seconds(RELEASE_DELAY,
+				G_SOURCE_FUNC(when_timeout_release_playback), self);
+
+	gv_engine_set_state(self, GV_ENGINE_STATE_STOPPED);
+}
+
+#define stop_playback(self) _stop_playback(self)
+
+static void
+_start_playback(GvEngine *self, gboolean force_stop)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstElement *playbin = priv->playbin;
+
+	/* First, stop the playback, in case it's not stopped already. Then set
+	 * the playbin state to PAUSED, so that it starts buffering data.  When
+	 * buffering reaches 100%, we'll start playing for real. This is
+	 * handled in the callback for buffering messages.
+	 *
+	 * It's also possible that there's no buffering, and this is handled
+	 * in the callback for state-changed messages.
+	 */
+
+	if (force_stop == TRUE)
+		stop_playback(self);
+	g_clear_handle_id(&priv->release_timeout_id, g_source_remove);
+	g_atomic_int_set(&priv->first_buffer_pending, !priv->standby_mode);
+	priv->target_state = GST_STATE_PAUSED;
+	set_gst_state(playbin, GST_STATE_PAUSED);
+
+	/* When starting from READY, we won't be notified of the state
+	 * READY, so it's up to us to say that we're connecting */
+	gv_engine_set_state(self, GV_ENGINE_STATE_CONNECTING);
+}
+
+#define start_playback(self) _start_playback(self, TRUE)
+
+static void
+start_playback_for_real(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstElement *playbin = priv->playbin;
+
+	/* A standby engine never plays, it stays in PAUSED, waiting to be
+	 * swapped with the main engine */
+	if (priv->standby_mode == TRUE) {
+		if (priv->prerolled == FALSE) {
+			DEBUG("Standby pipeline is pre-rolled: %s", priv->uri);
+			priv->prerolled = TRUE;
+			g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PREROLLED]);
+		}
+		return;
+	}
+
+	/* When paused by the user, the pipeline stays in PAUSED, while the
+	 * source keeps on downloading the stream to the ring buffer */
+	if (priv->paused == TRUE)
+		return;
+
+	priv->target_state = GST_STATE_PLAYING;
+	set_gst_state(playbin, GST_STATE_PLAYING);
+}
+
+static gint64
+get_timeshift_delay(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gint64 delay = priv->timeshift_delay;
+
+	/* While paused, we fall further behind live, up to the point where
+	 * the ring buffer is full */
+	if (priv->paused == TRUE)
+		delay += g_get_monotonic_time() - priv->pause_time;
+
+	return MIN(delay, (gint64) priv->timeshift_window * 60 * G_USEC_PER_SEC);
+}
+
+static void watch_playbin(GvEngine *self);
+static void unwatch_playbin(GvEngine *self);
+
+static void
+swap_playbins(GvEngine *self, GvEngine *other)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEnginePrivate *opriv = other->priv;
+	GstElement *playbin;
+	GstBus *bus;
+	GvBusQueue *bus_queue;
+
+	unwatch_playbin(self);
+	unwatch_playbin(other);
+
+	playbin = priv->playbin;
+	bus = priv->bus;
+	bus_queue = priv->bus_queue;
+	priv->playbin = opriv->playbin;
+	priv->bus = opriv->bus;
+	priv->bus_queue = opriv->bus_queue;
+	opriv->playbin = playbin;
+	opriv->bus = bus;
+	opriv->bus_queue = bus_queue;
+
+	watch_playbin(self);
+	watch_playbin(other);
+}
+
+static void
+apply_volume(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	gst_stream_volume_set_volume(GST_STREAM_VOLUME(priv->playbin),
+				     GST_STREAM_VOLUME_FORMAT_CUBIC,
+				     (gdouble) priv->volume / 100.0 * priv->fade);
+	gst_stream_volume_set_mute(GST_STREAM_VOLUME(priv->playbin), priv->mute);
+}
+
+static void
+stop_crossfade(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->crossfade_timeout_id == 0)
+		return;
+
+	g_clear_handle_id(&priv->crossfade_timeout_id, g_source_remove);
+
+	gv_engine_stop(priv->fader);
+	release_playback(priv->fader);
+
+	priv->fade = 1.0;
+	apply_volume(self);
+}
+
+static gboolean
+when_timeout_crossfade(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEnginePrivate *fpriv = priv->fader->priv;
+	gint64 now = g_get_monotonic_time();
+	gdouble progress;
+
+	/* Wait for the next stream to play, but not forever */
+	if (priv->crossfade_start_time == 0) {
+		if (priv->state != GV_ENGINE_STATE_PLAYING &&
+		    now - priv->crossfade_wait_time < CROSSFADE_MAX_WAIT * G_USEC_PER_SEC)
+			return G_SOURCE_CONTINUE;
+
+		DEBUG("Crossfading over %u ms", priv->crossfade_duration);
+		priv->crossfade_start_time = now;
+	}
+
+	if (priv->crossfade_duration > 0)
+		progress = (gdouble) (now - priv->crossfade_start_time) /
+			(priv->crossfade_duration * 1000);
+	else
+		progress = 1.0;
+	if (progress > 1.0)
+		progress = 1.0;
+
+	priv->fade = progress;
+	apply_volume(self);
+	fpriv->fade = 1.0 - progress;
+	apply_volume(priv->fader);
+
+	if (progress < 1.0)
+		return G_SOURCE_CONTINUE;
+
+	DEBUG("Crossfade complete");
+	priv->crossfade_timeout_id = 0;
+	gv_engine_stop(priv->fader);
+	release_playback(priv->fader);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+start_crossfade(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEnginePrivate *fpriv;
+
+	/* Create the fader on first use, it follows our volume and mute */
+	if (priv->fader == NULL) {
+		priv->fader = gv_engine_new();
+		priv->fader->priv->volume = priv->volume;
+		priv->fader->priv->mute = priv->mute;
+	}
+
+	fpriv = priv->fader->priv;
+
+	/* Abort a crossfade that would still be in progress */
+	stop_crossfade(self);
+
+	/* Hand over our pipeline, it keeps playing in the fader */
+	INFO("Handing over stream to the fader: %s", priv->uri);
+	swap_playbins(self, priv->fader);
+
+	g_free(fpriv->uri);
+	fpriv->uri = g_strdup(priv->uri);
+	fpriv->target_state = GST_STATE_PLAYING;
+	fpriv->fade = priv->fade;
+	gv_engine_set_state(priv->fader, GV_ENGINE_STATE_PLAYING);
+
+	/* The next stream starts silently, until the crossfade begins */
+	priv->fade = 0.0;
+	apply_volume(self);
+
+	priv->crossfade_wait_time = g_get_monotonic_time();
+	priv->crossfade_start_time = 0;
+	priv->crossfade_timeout_id = g_timeout_add(CROSSFADE_INTERVAL,
+			G_SOURCE_FUNC(when_timeout_crossfade), self);
+}
+
+static void
+set_buffering_limits(GstElement *playbin, guint max_bitrate)
+{
+	guint64 connection_speed = 0;
+	gint buffer_size = -1;
+	gint64 buffer_duration = -1;
+
+	/* Bitrate is in kbps, zero means no limit */
+	if (max_bitrate > 0) {
+		connection_speed = max_bitrate;
+		buffer_size = max_bitrate * 1000 / 8 * STANDBY_BUFFER_DURATION;
+		buffer_duration = STANDBY_BUFFER_DURATION * GST_SECOND;
+	}
+
+	g_object_set(playbin,
+		     "connection-speed", connection_speed,
+		     "buffer-size", buffer_size,
+		     "buffer-duration", buffer_duration,
+		     NULL);
+}
+
+static gboolean
+take_standby(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEngine *standby = priv->standby;
+	GvEnginePrivate *spriv;
+	gboolean prerolled;
+
+	if (standby == NULL)
+		return FALSE;
+
+	spriv = standby->priv;
+
+	/* The standby engine must be pre-rolling the exact same stream */
+	if (spriv->target_state != GST_STATE_PAUSED)
+		return FALSE;
+
+	if (g_strcmp0(spriv->uri, priv->uri) ||
+	    g_strcmp0(spriv->user_agent, priv->user_agent) ||
+	    spriv->ssl_strict != priv->ssl_strict)
+		return FALSE;
+
+	INFO("Taking over standby pipeline (%s)", spriv->prerolled ?
+	     "pre-rolled" : "still pre-rolling");
+
+	/* Swap the playbins. Our own playbin was stopped already, we release
+	 * it now, so that the standby engine is left with a pipeline in the
+	 * NULL state. */
+	release_playback(self);
+	swap_playbins(self, standby);
+
+	/* Take over the playbin state. If the standby pipeline is pre-rolled,
+	 * the first buffer reached the audio sink already. */
+	prerolled = spriv->prerolled;
+	g_atomic_int_set(&priv->first_buffer_pending, !prerolled);
+	g_atomic_int_set(&spriv->first_buffer_pending, FALSE);
+	priv->buffering = spriv->buffering;
+	priv->target_state = GST_STATE_PAUSED;
+	spriv->buffering = FALSE;
+	spriv->prerolled = FALSE;
+	spriv->target_state = GST_STATE_NULL;
+
+	g_clear_pointer(&spriv->uri, g_free);
+	g_clear_pointer(&spriv->user_agent, g_free);
+	spriv->ssl_strict = TRUE;
+
+	/* Take over the data received by the standby engine. As for the
+	 * connection, it was established by the time we asked for it. */
+	g_mutex_lock(&spriv->stats_lock);
+	g_mutex_lock(&priv->stats_lock);
+	priv->connect_time = spriv->connect_time ? priv->play_time : 0;
+	priv->bytes_received = spriv->bytes_received;
+	priv->decoder_cpu_time = spriv->decoder_cpu_time;
+	priv->decoder_cpu_mark = spriv->decoder_cpu_mark;
+	spriv->connect_time = 0;
+	spriv->bytes_received = 0;
+	spriv->decoder_cpu_time = 0;
+	spriv->decoder_cpu_mark = 0;
+	g_mutex_unlock(&priv->stats_lock);
+	g_mutex_unlock(&spriv->stats_lock);
+
+	/* Take over what the standby engine learnt about the stream */
+	if (spriv->streaminfo != NULL) {
+		priv->streaminfo = g_steal_pointer(&spriv->streaminfo);
+		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STREAMINFO]);
+	}
+
+	if (spriv->metadata != NULL) {
+		priv->metadata = g_steal_pointer(&spriv->metadata);
+		g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_METADATA]);
+	}
+
+	gv_engine_set_state(standby, GV_ENGINE_STATE_STOPPED);
+
+	/* Lift the standby limits, and apply our own settings */
+	apply_buffering_profile(self);
+	apply_volume(self);
+
+	/* If the pipeline is already pre-rolled, we won't receive any more
+	 * message that would trigger the playback, so we start it now.
+	 * Otherwise we just wait for the pipeline to be ready, as usual. */
+	if (prerolled == TRUE) {
+		guint latency = (g_get_monotonic_time() - priv->play_time) / 1000;
+		INFO("Stop to first buffer: %u ms (standby)", latency);
+		gv_engine_set_switch_latency(self, latency);
+		priv->stats.first_buffer_time = get_stats_elapsed(self, g_get_monotonic_time());
+		start_playback_for_real(self);
+	} else if (priv->buffering == TRUE) {
+		gv_engine_set_state(self, GV_ENGINE_STATE_BUFFERING);
+	} else {
+		gv_engine_set_state(self, GV_ENGINE_STATE_CONNECTING);
+	}
+
+	return TRUE;
+}
+
+/*
+ * Connection hand over
+ */
+
+static void
+feed_clear(GvEngineFeed *feed)
+{
+	DEBUG("Feed done, %" G_GUINT64_FORMAT " bytes fed", feed->bytes_fed);
+
+	g_object_unref(feed->cancellable);
+	g_object_unref(feed->stream);
+	gst_object_unref(feed->appsrc);
+}
+
+static void
+feed_release(GvEngineFeed *feed)
+{
+	g_atomic_rc_box_release_full(feed, (GDestroyNotify) feed_clear);
+}
+
+static void
+feed_stop(GvEngineFeed *feed)
+{
+	/* The feed thread is not joined: a pending read completes with an
+	 * error that is ignored, and a pending push returns as soon as the
+	 * appsrc is flushing. The thread then drops its own reference. */
+	g_cancellable_cancel(feed->cancellable);
+	g_signal_handlers_disconnect_by_data(feed->appsrc, feed);
+	feed_release(feed);
+}
+
+static void
+feed_post_error(GvEngineFeed *feed, GError *err)
+{
+	GstMessage *msg;
+	GError *gst_err;
+
+	gst_err = g_error_new(GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_READ,
+			"Could not read from stream: %s", err->message);
+	msg = gst_message_new_error(GST_OBJECT(feed->appsrc), gst_err, NULL);
+	gst_element_post_message(feed->appsrc, msg);
+	g_error_free(gst_err);
+}
+
+static gpointer
+feed_thread_func(GvEngineFeed *feed)
+{
+	/* WARNING! We're in the feed thread! */
+
+	GstFlowReturn flow = GST_FLOW_OK;
+
+	/* Reads block until data comes in, and pushes block while the appsrc
+	 * queue is full, so it's the pipeline that sets the pace */
+	while (flow == GST_FLOW_OK) {
+		GstBuffer *buffer;
+		GError *err = NULL;
+		GBytes *bytes;
+
+		bytes = g_input_stream_read_bytes(feed->stream, FEED_CHUNK_SIZE,
+				feed->cancellable, &err);
+		if (bytes == NULL) {
+			if (!g_error_matches(err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+				INFO("Failed to read from stream: %s", err->message);
+				feed_post_error(feed, err);
+			}
+			g_error_free(err);
+			break;
+		}
+
+		if (g_cancellable_is_cancelled(feed->cancellable)) {
+			g_bytes_unref(bytes);
+			break;
+		}
+
+		if (g_bytes_get_size(bytes) == 0) {
+			DEBUG("End of stream reached");
+			g_signal_emit_by_name(feed->appsrc, "end-of-stream", &flow);
+			g_bytes_unref(bytes);
+			break;
+		}
+
+		/* The buffer takes ownership of the bytes, no copy involved */
+		feed->bytes_fed += g_bytes_get_size(bytes);
+		buffer = gst_buffer_new_wrapped_bytes(bytes);
+		g_signal_emit_by_name(feed->appsrc, "push-buffer", buffer, &flow);
+		gst_buffer_unref(buffer);
+		g_bytes_unref(bytes);
+	}
+
+	feed_release(feed);
+
+	return NULL;
+}
+
+static void
+on_feed_need_data(GstElement *appsrc G_GNUC_UNUSED,
+		  guint length G_GNUC_UNUSED,
+		  GvEngineFeed *feed)
+{
+	/* WARNING! We're likely in the GStreamer streaming thread! */
+
+	/* The appsrc asks for data once it's started, which is when it
+	 * accepts buffers, so that's when the feed thread is started. From
+	 * then on, it's the thread that keeps the appsrc fed. */
+	if (g_atomic_int_compare_and_exchange(&feed->started, FALSE, TRUE))
+		g_thread_unref(g_thread_new("gv-feed",
+				(GThreadFunc) feed_thread_func,
+				g_atomic_rc_box_acquire(feed)));
+}
+
+static void
+setup_feed(GvEngine *self, GstElement *playbin, GstElement *appsrc)
+{
+	/* WARNING! We're likely in the GStreamer streaming thread! */
+
+	GvEnginePrivate *priv = self->priv;
+	const GvBufferingProfile *profile;
+	GvEngineFeed *feed;
+	GInputStream *stream;
+	guint icy_metaint;
+	GstCaps *caps;
+
+	g_mutex_lock(&priv->stats_lock);
+	stream = g_steal_pointer(&priv->feed_stream);
+	icy_metaint = priv->feed_icy_metaint;
+	g_mutex_unlock(&priv->stats_lock);
+
+	if (stream == NULL) {
+		GError *err;
+
+		WARNING("No stream to feed the appsrc with");
+		err = g_error_new_literal(GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_READ,
+				"No stream to read from");
+		gst_element_post_message(appsrc, gst_message_new_error(
+				GST_OBJECT(appsrc), err, NULL));
+		g_error_free(err);
+		return;
+	}
+
+	DEBUG("Setting up appsrc: icy-metaint=%u", icy_metaint);
+
+	/* ICY metadata is still in the stream, let icydemux take care of it */
+	if (icy_metaint > 0)
+		caps = gst_caps_new_simple("application/x-icy",
+				"metadata-interval", G_TYPE_INT, (gint) icy_metaint,
+				NULL);
+	else
+		caps = NULL;
+
+	/* There's no queue2 in front of an appsrc, so the appsrc queue is
+	 * what buffers the network. Pushes block when it's full. */
+	g_object_set(appsrc,
+		     "format", GST_FORMAT_BYTES,
+		     "stream-type", 0,  // GST_APP_STREAM_TYPE_STREAM
+		     "is-live", FALSE,
+		     "block", TRUE,
+		     "caps", caps,
+		     NULL);
+	profile = g_atomic_pointer_get(&priv->active_profile);
+	if (profile->buffer_size > 0)
+		g_object_set(appsrc, "max-bytes", (guint64) profile->buffer_size, NULL);
+
+	if (caps != NULL)
+		gst_caps_unref(caps);
+
+	feed = g_atomic_rc_box_new0(GvEngineFeed);
+	feed->appsrc = gst_object_ref(appsrc);
+	feed->stream = stream;
+	feed->cancellable = g_cancellable_new();
+
+	g_signal_connect_data(appsrc, "need-data", G_CALLBACK(on_feed_need_data),
+			g_atomic_rc_box_acquire(feed),
+			(GClosureNotify) feed_release, 0);
+
+	/* The playbin owns the feed from now on */
+	g_object_set_data_full(G_OBJECT(playbin), FEED_DATA_KEY, feed,
+			(GDestroyNotify) feed_stop);
+}
+
+static void
+clear_handover(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_clear_pointer(&priv->handover_uri, g_free);
+	g_clear_object(&priv->handover_stream);
+	priv->handover_icy_metaint = 0;
+
+	g_mutex_lock(&priv->stats_lock);
+	g_clear_object(&priv->feed_stream);
+	priv->feed_icy_metaint = 0;
+	g_mutex_unlock(&priv->stats_lock);
+}
+
+/*
+ * Public methods
+ */
+
+void
+gv_engine_cancel_preroll(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->standby == NULL)
+		return;
+
+	if (priv->standby->priv->uri != NULL)
+		DEBUG("Cancelling pre-roll of stream: %s", priv->standby->priv->uri);
+
+	gv_engine_stop(priv->standby);
+}
+
+static GvEngine *
+make_standby(void)
+{
+	GvEngine *standby;
+
+	standby = gv_engine_new();
+	standby->priv->standby_mode = TRUE;
+
+	return standby;
+}
+
+static void
+start_preroll(GvEngine *self, GvEngine *standby, const gchar *uri,
+	      const gchar *user_agent, gboolean ssl_strict, guint max_bitrate)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEnginePrivate *spriv = standby->priv;
+
+	/* The standby engine must output to the same audio sink as us,
+	 * and pick the same variant of adaptive streams */
+	gv_engine_set_pipeline_string(standby, priv->pipeline_string);
+	gv_engine_set_pipeline_enabled(standby, priv->pipeline_enabled);
+	gv_engine_set_hls_policy(standby, priv->hls_policy);
+	gv_engine_set_hls_max_bitrate(standby, priv->hls_max_bitrate);
+
+	/* Ensure pre-roll is stopped */
+	gv_engine_stop(standby);
+
+	/* Save uri and user-agent */
+	spriv->uri = g_strdup(uri);
+	spriv->user_agent = g_strdup(user_agent);
+	spriv->ssl_strict = ssl_strict;
+
+	INFO("Pre-rolling stream: %s", uri);
+
+	/* Start pre-roll, it will stop at PAUSED */
+	g_object_set(spriv->playbin, "uri", uri, NULL);
+	set_buffering_limits(spriv->playbin, max_bitrate);
+	start_playback(standby);
+}
+
+void
+gv_engine_preroll(GvEngine *self, const gchar *uri, const gchar *user_agent,
+		  gboolean ssl_strict, guint max_bitrate)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEnginePrivate *spriv;
+
+	g_return_if_fail(priv->standby_mode == FALSE);
+
+	/* Create the standby engine on first use */
+	if (priv->standby == NULL)
+		priv->standby = make_standby();
+
+	spriv = priv->standby->priv;
+
+	/* Bail out if we're pre-rolling this stream already */
+	if (spriv->target_state == GST_STATE_PAUSED &&
+	    !g_strcmp0(spriv->uri, uri) &&
+	    !g_strcmp0(spriv->user_agent, user_agent) &&
+	    spriv->ssl_strict == ssl_strict)
+		return;
+
+	start_preroll(self, priv->standby, uri, user_agent, ssl_strict, max_bitrate);
+}
+
+/* Pre-roll a stream in a new standby engine, with no buffering limits. It
+ * can be handed back with gv_engine_set_standby(), so that it's taken over
+ * when this stream is played. */
+GvEngine *
+gv_engine_preroll_new(GvEngine *self, const gchar *uri, const gchar *user_agent,
+		      gboolean ssl_strict)
+{
+	GvEnginePrivate *priv = self->priv;
+	GvEngine *standby;
+
+	g_return_val_if_fail(priv->standby_mode == FALSE, NULL);
+
+	standby = make_standby();
+	start_preroll(self, standby, uri, user_agent, ssl_strict, 0);
+
+	return standby;
+}
+
+/* Replace the standby engine, the one that was pre-rolling is dropped */
+void
+gv_engine_set_standby(GvEngine *self, GvEngine *standby)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_return_if_fail(priv->standby_mode == FALSE);
+	g_return_if_fail(standby->priv->standby_mode == TRUE);
+
+	if (priv->standby == standby)
+		return;
+
+	if (priv->standby != NULL) {
+		gv_engine_stop(priv->standby);
+		g_object_unref(priv->standby);
+	}
+
+	priv->standby = g_object_ref(standby);
+}
+
+static gboolean
+when_timeout_watchdog(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	gint64 last_data_time;
+	gint64 now;
+	GError *err;
+
+	/* Nothing is expected to come while paused */
+	if (priv->paused == TRUE)
+		return G_SOURCE_CONTINUE;
+
+	g_mutex_lock(&priv->stats_lock);
+	last_data_time = priv->last_data_time;
+	g_mutex_unlock(&priv->stats_lock);
+
+	/* No data yet, we're still connecting. A slow connect is not a
+	 * stall, the HTTP source has its own timeout for that. */
+	if (last_data_time == 0)
+		return G_SOURCE_CONTINUE;
+
+	now = g_get_monotonic_time();
+	if (now - last_data_time < (gint64) priv->stall_timeout * G_USEC_PER_SEC)
+		return G_SOURCE_CONTINUE;
+
+	priv->watchdog_timeout_id = 0;
+	priv->stall_count++;
+
+	WARNING("Stream stalled, no data for %" G_GINT64_FORMAT " s (%u stalls so far)",
+		(now - last_data_time) / G_USEC_PER_SEC, priv->stall_count);
+
+	/* Stop before emitting, as the handler might want to reconnect */
+	stop_playback(self);
+
+	err = g_error_new(GV_ENGINE_ERROR, GV_ENGINE_ERROR_STALLED,
+			  _("Stream stalled"));
+	g_signal_emit(self, signals[SIGNAL_PLAYBACK_ERROR], 0, err, NULL);
+	g_error_free(err);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STALL_COUNT]);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+stop_engine(GvEngine *self)
 {
 	GvEnginePrivate *priv = self->priv;
 
 	stop_playback(self);
 
+	/* Drop the connection that was handed over, if any */
+	g_object_set_data(G_OBJECT(priv->playbin), FEED_DATA_KEY, NULL);
+	clear_handover(self);
+
+	/* Stop watching */
+	g_clear_handle_id(&priv->watchdog_timeout_id, g_source_remove);
+
+	/* Log the stats of the stream that was playing, one last time */
+	if (priv->stats_timeout_id != 0) {
+		g_clear_handle_id(&priv->stats_timeout_id, g_source_remove);
+		update_stats(self);
+		log_stats(self);
+	}
+
 	gv_engine_unset_streaminfo(self);
 	gv_engine_unset_metadata(self);
 
 	g_clear_pointer(&priv->uri, g_free);
 	g_clear_pointer(&priv->user_agent, g_free);
+	g_clear_pointer(&priv->stream_buffering_profile, g_free);
 	priv->ssl_strict = TRUE;
+	priv->http_status = 0;
+	g_atomic_int_set(&priv->timeshift_active, FALSE);
+
+	/* Close the recording of the stream that was playing, the next one
+	 * starts a file once its first title or its first data comes in */
+	g_mutex_lock(&priv->stats_lock);
+	if (priv->recorder != NULL)
+		gv_recorder_close(priv->recorder);
+	priv->recording_pending = TRUE;
+	priv->recording_icy = FALSE;
+	g_mutex_unlock(&priv->stats_lock);
+	g_clear_pointer(&priv->recording_title, g_free);
+}
+
+void
+gv_engine_stop(GvEngine *self)
+{
+	stop_engine(self);
+	stop_crossfade(self);
+}
+
+void
+gv_engine_crossfade_stop(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Crossfading requires that we're playing, and that the sound server
+	 * mixes the streams, so it's not possible with a custom pipeline */
+	if (priv->crossfade_duration > 0 &&
+	    priv->state == GV_ENGINE_STATE_PLAYING &&
+	    priv->pipeline_enabled == FALSE &&
+	    priv->headless == FALSE &&
+	    priv->standby_mode == FALSE)
+		start_crossfade(self);
+
+	stop_engine(self);
+}
+
+gboolean
+gv_engine_pause(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	/* Pausing a live stream only makes sense if we can resume from where
+	 * we left, ie. if the stream is downloaded to the ring buffer */
+	if (g_atomic_int_get(&priv->timeshift_active) == FALSE)
+		return FALSE;
+
+	if (priv->paused == TRUE)
+		return TRUE;
+
+	if (priv->state != GV_ENGINE_STATE_PLAYING)
+		return FALSE;
+
+	INFO("Pausing stream");
+
+	priv->paused = TRUE;
+	priv->pause_time = g_get_monotonic_time();
+	priv->target_state = GST_STATE_PAUSED;
+	set_gst_state(priv->playbin, GST_STATE_PAUSED);
+	gv_engine_set_state(self, GV_ENGINE_STATE_PAUSED);
+
+	return TRUE;
+}
+
+void
+gv_engine_resume(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	if (priv->paused == FALSE)
+		return;
+
+	priv->timeshift_delay = get_timeshift_delay(self);
+	priv->paused = FALSE;
+	priv->pause_time = 0;
+	priv->buffering = FALSE;
+
+	/* The download might have been held back while paused, give the
+	 * stream a full stall timeout to get going again */
+	g_mutex_lock(&priv->stats_lock);
+	priv->last_data_time = g_get_monotonic_time();
+	g_mutex_unlock(&priv->stats_lock);
+
+	INFO("Resuming stream, %" G_GINT64_FORMAT " s behind live",
+	     priv->timeshift_delay / G_USEC_PER_SEC);
+
+	start_playback_for_real(self);
+}
+
+void
+gv_engine_seek(GvEngine *self, gint64 position)
+{
+	GvEnginePrivate *priv = self->priv;
+	gint64 current;
+	gint64 live;
+	gint64 oldest;
+
+	/* Position is in microseconds, in stream time */
+	if (gv_engine_get_can_seek(self) == FALSE)
+		return;
+
+	current = gv_engine_get_position(self);
+	if (current < 0)
+		return;
+
+	/* We can't go further than the live edge, nor further back than what
+	 * the ring buffer holds */
+	live = current + get_timeshift_delay(self);
+	oldest = MAX(live - (gint64) priv->timeshift_window * 60 * G_USEC_PER_SEC, 0);
+	position = CLAMP(position, oldest, live);
+
+	if (!gst_element_seek_simple(priv->playbin, GST_FORMAT_TIME,
+				     GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT,
+				     position * GST_USECOND)) {
+		WARNING("Failed to seek to %" G_GINT64_FORMAT " ms", position / 1000);
+		return;
+	}
+
+	priv->timeshift_delay = live - position;
+	if (priv->paused == TRUE)
+		priv->pause_time = g_get_monotonic_time();
+
+	DEBUG("Seeked to %" G_GINT64_FORMAT " ms, %" G_GINT64_FORMAT " s behind live",
+	      position / 1000, priv->timeshift_delay / G_USEC_PER_SEC);
 }
 
 void
-gv_engine_play(GvEngine *self, const gchar *uri, const gchar *user_agent, gboolean ssl_strict)
+gv_engine_play(GvEngine *self, const gchar *uri, const gchar *user_agent, gboolean ssl_strict,
+	       const gchar *buffering_profile)
 {
 	GvEnginePrivate *priv = self->priv;
+	GInputStream *handover_stream = NULL;
+	guint handover_icy_metaint = 0;
+	gint64 play_time;
 
-	/* Ensure playback is stopped */
-	gv_engine_stop(self);
+	/* Start measuring latency from now on */
+	play_time = g_get_monotonic_time();
+
+	/* Take the connection that was handed over for this stream, if any */
+	if (!g_strcmp0(priv->handover_uri, uri)) {
+		handover_stream = g_steal_pointer(&priv->handover_stream);
+		handover_icy_metaint = priv->handover_icy_metaint;
+	}
+
+	/* Ensure playback is stopped, but let a crossfade go on */
+	stop_engine(self);
+
+	/* Start gathering stats */
+	priv->play_time = play_time;
+	reset_stats(self);
+	priv->stats_timeout_id = g_timeout_add_seconds(STATS_INTERVAL,
+			G_SOURCE_FUNC(when_timeout_update_stats), self);
+
+	/* Watch for stalls */
+	if (priv->stall_timeout > 0)
+		priv->watchdog_timeout_id = g_timeout_add_seconds(1,
+				G_SOURCE_FUNC(when_timeout_watchdog), self);
 
 	/* Save uri and user-agent */
 	g_assert(priv->uri == NULL);
@@ -673,19 +3113,91 @@ gv_engine_play(GvEngine *self, const gchar *uri, const gchar *user_agent, gboole
 	g_assert(priv->ssl_strict == TRUE);
 	priv->ssl_strict = ssl_strict;
 
+	/* Save buffering profile, if it's a valid one */
+	g_assert(priv->stream_buffering_profile == NULL);
+	if (buffering_profile != NULL) {
+		if (find_buffering_profile(buffering_profile) != NULL)
+			priv->stream_buffering_profile = g_strdup(buffering_profile);
+		else
+			WARNING("Invalid buffering profile '%s', using default",
+				buffering_profile);
+	}
+
 	INFO("Playing stream: %s", uri);
 
-	/* Start playback */
-	g_object_set(priv->playbin, "uri", uri, NULL);
+	/* Maybe the stream is standing by already */
+	if (take_standby(self) == TRUE) {
+		g_clear_object(&handover_stream);
+		return;
+	}
+
+	/* Maybe the connection is open already, in which case it's fed to an
+	 * appsrc. There's no time-shift source then, hence no time-shift. */
+	if (handover_stream != NULL) {
+		INFO("Taking over connection");
+		g_mutex_lock(&priv->stats_lock);
+		priv->feed_stream = handover_stream;
+		priv->feed_icy_metaint = handover_icy_metaint;
+		g_mutex_unlock(&priv->stats_lock);
+		g_object_set(priv->playbin, "uri", "appsrc://", NULL);
+		apply_buffering_profile(self);
+		start_playback(self);
+		return;
+	}
+
+	/* Start playback, through the time-shift source if need be. Whether
+	 * time-shift is active is known once the source is set up. */
+	if (priv->timeshift_window > 0) {
+		gchar *timeshift_uri;
+
+		timeshift_uri = gv_timeshift_src_make_uri(uri);
+		if (timeshift_uri == NULL)
+			INFO("Time-shift is not supported for this stream");
+		g_object_set(priv->playbin, "uri",
+			     timeshift_uri ? timeshift_uri : uri, NULL);
+		g_free(timeshift_uri);
+	} else {
+		g_object_set(priv->playbin, "uri", uri, NULL);
+	}
+	apply_buffering_profile(self);
 	start_playback(self);
 }
 
+void
+gv_engine_hand_over(GvEngine *self, const gchar *uri, GInputStream *stream,
+		    guint icy_metaint)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_return_if_fail(uri != NULL);
+	g_return_if_fail(G_IS_INPUT_STREAM(stream));
+
+	/* Kept until the next call to gv_engine_play() */
+	g_free(priv->handover_uri);
+	priv->handover_uri = g_strdup(uri);
+	g_set_object(&priv->handover_stream, stream);
+	priv->handover_icy_metaint = icy_metaint;
+}
+
 GvEngine *
 gv_engine_new(void)
 {
 	return g_object_new(GV_TYPE_ENGINE, NULL);
 }
 
+GvEngine *
+gv_engine_new_headless(void)
+{
+	return g_object_new(GV_TYPE_ENGINE, "headless", TRUE, NULL);
+}
+
+GvEngine *
+gv_engine_new_metadata_only(void)
+{
+	return g_object_new(GV_TYPE_ENGINE, "headless", TRUE,
+			    "metadata-only", TRUE, NULL);
+}
+
 /*
  * More signal handlers
  */
@@ -735,51 +3247,238 @@ on_source_accept_certificate(GstElement *source,
 					G_TYPE_TLS_CERTIFICATE_FLAGS, tls_errors, NULL));
 		gst_element_post_message(playbin, msg);
 
-		return FALSE;
+		return FALSE;
+	}
+}
+
+/*
+ * GStreamer playbin signal handlers
+ */
+
+static void
+on_stream_notify_caps(GstStream *stream,
+		      GParamSpec *pspec,
+		      GvEngine *self)
+{
+	/* WARNING! We're likely in the GStreamer streaming thread! */
+
+	const gchar *property_name = g_param_spec_get_name(pspec);
+	GstElement *playbin = self->priv->playbin;
+	GstCaps * caps;
+	GstMessage *msg;
+	gchar *caps_str;
+
+	TRACE("%p, %s, %p", stream, property_name, self);
+
+	caps = gst_stream_get_caps(stream);
+	if (caps == NULL)
+		return;
+
+	caps_str = gst_caps_to_string(caps);
+
+	msg = gst_message_new_application(GST_OBJECT(playbin),
+			gst_structure_new("stream-caps-changed", "caps",
+				G_TYPE_STRING, caps_str, NULL));
+	gst_element_post_message(playbin, msg);
+
+	g_free(caps_str);
+	gst_caps_unref(caps);
+}
+
+static GstPadProbeReturn
+on_sink_pad_buffer(GstPad *pad G_GNUC_UNUSED,
+		   GstPadProbeInfo *info G_GNUC_UNUSED,
+		   GstElement *playbin)
+{
+	/* WARNING! We're in the GStreamer streaming thread! */
+
+	GvEngine *self;
+	GstMessage *msg;
+
+	/* The playbin might have been swapped from an engine to another,
+	 * so we can't tie the probe to an engine, we must look it up */
+	self = g_object_get_data(G_OBJECT(playbin), "gv-engine");
+	if (self == NULL)
+		return GST_PAD_PROBE_OK;
+
+	if (!g_atomic_int_compare_and_exchange(&self->priv->first_buffer_pending,
+					       TRUE, FALSE))
+		return GST_PAD_PROBE_OK;
+
+	msg = gst_message_new_application(GST_OBJECT(playbin),
+			gst_structure_new("first-buffer", "time",
+				G_TYPE_INT64, g_get_monotonic_time(), NULL));
+	gst_element_post_message(playbin, msg);
+
+	return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+on_source_pad_buffer(GstPad *pad,
+		     GstPadProbeInfo *info,
+		     GstElement *playbin)
+{
+	/* WARNING! We're in the GStreamer streaming thread! */
+
+	GvEngine *self;
+	GvEnginePrivate *priv;
+	GvIcyParser *parser;
+	GstBuffer *buffer;
+
+	self = g_object_get_data(G_OBJECT(playbin), "gv-engine");
+	if (self == NULL)
+		return GST_PAD_PROBE_OK;
+
+	priv = self->priv;
+	buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	parser = get_icy_parser(pad);
+
+	g_mutex_lock(&priv->stats_lock);
+	priv->last_data_time = g_get_monotonic_time();
+	if (priv->connect_time == 0)
+		priv->connect_time = priv->last_data_time;
+	priv->bytes_received += gst_buffer_get_size(buffer);
+	/* Record here, upstream of the time-shift ring buffer, so that what
+	 * was recorded is not recorded again after a seek, and so that the
+	 * recording goes on while paused. A new file is started with the
+	 * first title, or with the first data if there's no title to wait for. */
+	priv->recording_icy = parser->metaint > 0;
+	if (priv->recording_icy) {
+		icy_parser_feed(parser, buffer, priv->recorder, &priv->recording_pending);
+	} else if (priv->recorder != NULL) {
+		if (priv->recording_pending == TRUE) {
+			gv_recorder_split(priv->recorder, NULL);
+			priv->recording_pending = FALSE;
+		}
+		gv_recorder_write(priv->recorder, buffer);
+	}
+	g_mutex_unlock(&priv->stats_lock);
+
+	return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+on_decoder_sink_pad_buffer(GstPad *pad G_GNUC_UNUSED,
+			   GstPadProbeInfo *info G_GNUC_UNUSED,
+			   GstElement *playbin)
+{
+	/* WARNING! We're in the GStreamer streaming thread! */
+
+	GvEngine *self;
+	GvEnginePrivate *priv;
+	gint64 now;
+
+	self = g_object_get_data(G_OBJECT(playbin), "gv-engine");
+	if (self == NULL)
+		return GST_PAD_PROBE_OK;
+
+	priv = self->priv;
+	now = get_thread_cpu_time();
+
+	g_mutex_lock(&priv->stats_lock);
+	priv->decoder_cpu_mark = now;
+	g_mutex_unlock(&priv->stats_lock);
+
+	return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+on_decoder_src_pad_buffer(GstPad *pad G_GNUC_UNUSED,
+			  GstPadProbeInfo *info G_GNUC_UNUSED,
+			  GstElement *playbin)
+{
+	/* WARNING! We're in the GStreamer streaming thread! */
+
+	GvEngine *self;
+	GvEnginePrivate *priv;
+	gint64 now;
+
+	self = g_object_get_data(G_OBJECT(playbin), "gv-engine");
+	if (self == NULL)
+		return GST_PAD_PROBE_OK;
+
+	/* Audio decoders output buffers from the thread that pushed the input
+	 * buffers, so the CPU time of this thread, since the input buffer came
+	 * in (or since the previous output buffer), is the decoding time. */
+	priv = self->priv;
+	now = get_thread_cpu_time();
+
+	g_mutex_lock(&priv->stats_lock);
+	if (priv->decoder_cpu_mark != 0 && now >= priv->decoder_cpu_mark) {
+		priv->decoder_cpu_time += now - priv->decoder_cpu_mark;
+		priv->decoder_cpu_mark = now;
 	}
-}
+	g_mutex_unlock(&priv->stats_lock);
 
-/*
- * GStreamer playbin signal handlers
- */
+	return GST_PAD_PROBE_OK;
+}
 
 static void
-on_stream_notify_caps(GstStream *stream,
-		      GParamSpec *pspec,
-		      GvEngine *self)
+add_buffer_probe(GstElement *element, const gchar *pad_name,
+		 GstPadProbeCallback callback, GstElement *playbin)
 {
-	/* WARNING! We're likely in the GStreamer streaming thread! */
-
-	const gchar *property_name = g_param_spec_get_name(pspec);
-	GstElement *playbin = self->priv->playbin;
-	GstCaps * caps;
-	GstMessage *msg;
-	gchar *caps_str;
+	GstPad *pad;
 
-	TRACE("%p, %s, %p", stream, property_name, self);
-
-	caps = gst_stream_get_caps(stream);
-	if (caps == NULL)
+	pad = gst_element_get_static_pad(element, pad_name);
+	if (pad == NULL)
 		return;
 
-	caps_str = gst_caps_to_string(caps);
+	gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, callback, playbin, NULL);
+	gst_object_unref(pad);
+}
 
-	msg = gst_message_new_application(GST_OBJECT(playbin),
-			gst_structure_new("stream-caps-changed", "caps",
-				G_TYPE_STRING, caps_str, NULL));
-	gst_element_post_message(playbin, msg);
+static void
+add_sink_buffer_probe(GstElement *element, GstElement *playbin)
+{
+	GstIterator *iter;
+	GValue item = G_VALUE_INIT;
+	gboolean done = FALSE;
+
+	if (!GST_IS_BIN(element)) {
+		/* A sink might show up more than once, probe it only once */
+		if (g_object_get_data(G_OBJECT(element), "gv-sink-probed") != NULL)
+			return;
+		g_object_set_data(G_OBJECT(element), "gv-sink-probed", GINT_TO_POINTER(1));
+		add_buffer_probe(element, "sink",
+				 (GstPadProbeCallback) on_sink_pad_buffer, playbin);
+		return;
+	}
 
-	g_free(caps_str);
-	gst_caps_unref(caps);
+	/* A sink bin (ie. a custom pipeline) comes with its children already
+	 * inside, we won't be told about them, so we must look for the sinks */
+	iter = gst_bin_iterate_recurse(GST_BIN(element));
+	while (!done) {
+		GstElement *child;
+
+		switch (gst_iterator_next(iter, &item)) {
+		case GST_ITERATOR_OK:
+			child = g_value_get_object(&item);
+			if (GST_OBJECT_FLAG_IS_SET(child, GST_ELEMENT_FLAG_SINK) &&
+			    !GST_IS_BIN(child))
+				add_sink_buffer_probe(child, playbin);
+			g_value_reset(&item);
+			break;
+		case GST_ITERATOR_RESYNC:
+			gst_iterator_resync(iter);
+			break;
+		default:
+			done = TRUE;
+			break;
+		}
+	}
+	g_value_unset(&item);
+	gst_iterator_free(iter);
 }
 
 static void
-on_playbin_element_setup(GstElement *playbin G_GNUC_UNUSED,
+on_playbin_element_setup(GstElement *playbin,
 			 GstElement *element,
 			 GvEngine *self)
 {
 	/* WARNING! We're likely in the GStreamer streaming thread! */
 
+	GstElementFactory *factory;
+
 #ifdef DEBUG_GST_ELEMENT_SETUP
 	gchar *element_name;
 	element_name = gst_element_get_name(element);
@@ -787,11 +3486,38 @@ on_playbin_element_setup(GstElement *playbin G_GNUC_UNUSED,
 	g_free(element_name);
 #endif
 
+	/* Set watermarks on the queues, according to the buffering profile */
+	set_queue_watermarks(element, g_atomic_pointer_get(&self->priv->active_profile));
+
+	/* Pick the variant of adaptive streams, according to the policy */
+	set_adaptive_demux_policy(element,
+				  g_atomic_int_get(&self->priv->hls_policy),
+				  g_atomic_int_get(&self->priv->hls_max_bitrate));
+
+	/* Don't decode anything if we're only after the metadata */
+	if (self->priv->metadata_only == TRUE)
+		set_decodebin_passthrough(element);
+
+	/* Watch buffers reaching the sinks, to measure latency. The probe
+	 * stays as long as the sink lives, as sinks are kept across streams. */
+	if (GST_OBJECT_FLAG_IS_SET(element, GST_ELEMENT_FLAG_SINK))
+		add_sink_buffer_probe(element, playbin);
+
+	/* Measure the CPU time spent decoding */
+	factory = gst_element_get_factory(element);
+	if (factory != NULL &&
+	    gst_element_factory_list_is_type(factory, GST_ELEMENT_FACTORY_TYPE_DECODER)) {
+		add_buffer_probe(element, "sink",
+				 (GstPadProbeCallback) on_decoder_sink_pad_buffer, playbin);
+		add_buffer_probe(element, "src",
+				 (GstPadProbeCallback) on_decoder_src_pad_buffer, playbin);
+	}
+
 	gv_engine_update_streaminfo_from_element_setup(self, element);
 }
 
 static void
-on_playbin_source_setup(GstElement *playbin G_GNUC_UNUSED,
+on_playbin_source_setup(GstElement *playbin,
 			GstElement *source,
 			GvEngine *self)
 {
@@ -803,6 +3529,27 @@ on_playbin_source_setup(GstElement *playbin G_GNUC_UNUSED,
 
 	DEBUG("Source setup: %s", G_OBJECT_TYPE_NAME(source));
 
+	/* The stream goes through the time-shift source, the real source is
+	 * the one within */
+	if (GV_IS_TIMESHIFT_SRC(source)) {
+		GvTimeshiftSrc *timeshift_src = GV_TIMESHIFT_SRC(source);
+
+		setup_timeshift_src(timeshift_src, priv->timeshift_window,
+				    g_atomic_pointer_get(&priv->active_profile));
+		source = gv_timeshift_src_get_source(timeshift_src);
+		g_atomic_int_set(&priv->timeshift_active, TRUE);
+	}
+
+	/* Count the bytes received */
+	add_buffer_probe(source, "src",
+			 (GstPadProbeCallback) on_source_pad_buffer, playbin);
+
+	/* The connection was handed over, there's nothing else to set up */
+	if (!g_strcmp0(G_OBJECT_TYPE_NAME(source), "GstAppSrc")) {
+		setup_feed(self, playbin, source);
+		return;
+	}
+
 	ssl_strict = priv->ssl_strict;
 	user_agent = priv->user_agent;
 	if (user_agent == NULL)
@@ -846,6 +3593,8 @@ on_bus_message_eos(GstBus *bus, GstMessage *message, GvEngine *self)
 static void
 on_bus_message_error(GstBus *bus, GstMessage *message, GvEngine *self)
 {
+	GvEnginePrivate *priv = self->priv;
+	const GstStructure *details = NULL;
 	GError *err;
 	gchar *debug, *err_code;
 
@@ -855,6 +3604,15 @@ on_bus_message_error(GstBus *bus, GstMessage *message, GvEngine *self)
 	gst_message_parse_error(message, &err, &debug);
 	err_code = error_code_as_string(err);
 
+	/* Sources like souphttpsrc attach the HTTP status, if the server
+	 * answered. Below 100, it's a transport error from libsoup. */
+	gst_message_parse_error_details(message, &details);
+	priv->http_status = 0;
+	if (details != NULL &&
+	    gst_structure_get_uint(details, "http-status-code", &priv->http_status) &&
+	    priv->http_status < 100)
+		priv->http_status = 0;
+
 	/* Display */
 	WARNING("message: %s: %s", err_code, err->message);
 	WARNING("debug: %s", debug);
@@ -1063,6 +3821,7 @@ static void
 on_bus_message_buffering(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *self)
 {
 	GvEnginePrivate *priv = self->priv;
+	const GvBufferingProfile *profile = priv->active_profile;
 	static gint prev_percent = 0;
 	gint percent = 0;
 
@@ -1110,6 +3869,10 @@ on_bus_message_buffering(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *s
 	 * So instead of setting the pipeline to PAUSED, we can just ignore the
 	 * buffering messages during playback. Everything still works, and we
 	 * don't interrupt the sound.
+	 *
+	 * Which behavior we pick is now up to the buffering profile in use:
+	 * the flaky-network profile plays by the book and pauses, while the
+	 * others ignore the messages and keep playing.
 	 */
 
 	/* Parse message */
@@ -1121,41 +3884,49 @@ on_bus_message_buffering(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngine *s
 		DEBUG("Buffering (%3u %%)", percent);
 	}
 
-	/* Now let's handle the buffering value */
-#ifdef IGNORE_BUFFERING_MESSAGES
-	if (percent >= 100) {
-		if (priv->target_state == GST_STATE_PAUSED) {
-			DEBUG("Buffering complete, setting pipeline to PLAYING");
-			start_playback_for_real(self);
-		}
-		priv->buffering = FALSE;
-		prev_percent = percent;
-	} else {
-		if (priv->target_state == GST_STATE_PLAYING)
-			DEBUG("Buffering < 100%%, ignore and keep playing");
-		else
-			priv->buffering = TRUE;
+	/* Keep track of buffering episodes */
+	if (percent < 100 && priv->buffering_start_time == 0) {
+		priv->buffering_start_time = g_get_monotonic_time();
+		priv->stats.buffering_count++;
+	} else if (percent >= 100 && priv->buffering_start_time != 0) {
+		priv->stats.buffering_time +=
+			(g_get_monotonic_time() - priv->buffering_start_time) / 1000;
+		priv->buffering_start_time = 0;
 	}
-#else
+
+	/* Count underruns, ie. the buffer draining while we're playing */
+	if (percent < 100 && priv->target_state == GST_STATE_PLAYING &&
+	    priv->underrun == FALSE) {
+		priv->underrun = TRUE;
+		priv->underruns[profile - buffering_profiles]++;
+		INFO("Buffer underrun (profile: %s, count: %u)", profile->name,
+		     priv->underruns[profile - buffering_profiles]);
+	} else if (percent >= 100) {
+		priv->underrun = FALSE;
+	}
+
+	/* Now let's handle the buffering value */
 	if (percent >= 100) {
 		if (priv->target_state == GST_STATE_PAUSED) {
 			DEBUG("Buffering complete, setting pipeline to PLAYING");
 			start_playback_for_real(self);
-		} else if (priv->target_state == GST_STATE_PLAYING) {
+		} else if (priv->target_state == GST_STATE_PLAYING &&
+			   priv->buffering == TRUE) {
 			DEBUG("Done buffering, setting pipeline to PLAYING");
 			set_gst_state(priv->playbin, GST_STATE_PLAYING);
 		}
 		priv->buffering = FALSE;
 		prev_percent = percent;
-	} else {
-		if (priv->target_state == GST_STATE_PLAYING && priv->buffering == FALSE) {
-			/* We were not buffering but PLAYING, PAUSE the pipeline */
-			DEBUG("Buffering < 100%%, setting pipeline to PAUSED");
-			set_gst_state(priv->playbin, GST_STATE_PAUSED);
-		}
+	} else if (priv->target_state != GST_STATE_PLAYING) {
+		priv->buffering = TRUE;
+	} else if (profile->pause_on_buffering == FALSE) {
+		DEBUG("Buffering < 100%%, ignore and keep playing");
+	} else if (priv->buffering == FALSE) {
+		/* We were not buffering but PLAYING, PAUSE the pipeline */
+		DEBUG("Buffering < 100%%, setting pipeline to PAUSED");
+		set_gst_state(priv->playbin, GST_STATE_PAUSED);
 		priv->buffering = TRUE;
 	}
-#endif
 }
 
 static void
@@ -1189,12 +3960,20 @@ on_bus_message_state_changed(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvEngin
 			gv_engine_set_state(self, GV_ENGINE_STATE_STOPPED);
 		break;
 	case GST_STATE_PAUSED:
-		if (priv->buffering == TRUE)
+		if (priv->paused == TRUE)
+			gv_engine_set_state(self, GV_ENGINE_STATE_PAUSED);
+		else if (priv->buffering == TRUE)
 			gv_engine_set_state(self, GV_ENGINE_STATE_BUFFERING);
 		else
 			gv_engine_set_state(self, GV_ENGINE_STATE_CONNECTING);
 		break;
 	case GST_STATE_PLAYING:
+		/* Refresh the stats right away, so that they're up to date for
+		 * whoever is watching the state */
+		if (priv->stats.playing_time == 0) {
+			priv->stats.playing_time = get_stats_elapsed(self, g_get_monotonic_time());
+			update_stats(self);
+		}
 		gv_engine_set_state(self, GV_ENGINE_STATE_PLAYING);
 		break;
 	case GST_STATE_VOID_PENDING:
@@ -1318,6 +4097,17 @@ on_bus_message_application(GstBus *bus G_GNUC_UNUSED, GstMessage *msg,
 			gst_caps_unref(caps);
 		}
 
+	} else if (!g_strcmp0(msg_name, "first-buffer")) {
+		GvEnginePrivate *priv = self->priv;
+		gint64 time;
+		guint latency;
+
+		gst_structure_get_int64(s, "time", &time);
+		latency = (time - priv->play_time) / 1000;
+		INFO("Stop to first buffer: %u ms", latency);
+		gv_engine_set_switch_latency(self, latency);
+		priv->stats.first_buffer_time = get_stats_elapsed(self, time);
+
 	} else if (!g_strcmp0(msg_name, "certificate-rejected")) {
 		GTlsCertificateFlags tls_errors;
 
@@ -1345,6 +4135,17 @@ on_bus_message_element(GstBus *bus G_GNUC_UNUSED, GstMessage *msg,
 		return;
 
 	struct_name = gst_structure_get_name(s);
+
+	/* Adaptive demuxers post statistics for each fragment, and the
+	 * bitrate of the variant when they switch to another one */
+	if (!g_strcmp0(struct_name, "adaptive-streaming-statistics")) {
+		gint bitrate = 0;
+
+		if (gst_structure_get_int(s, "bitrate", &bitrate) && bitrate > 0)
+			gv_engine_update_streaminfo_from_variant(self, bitrate);
+		return;
+	}
+
 	if (g_strcmp0(struct_name, "http-headers") != 0)
 		return;
 
@@ -1361,6 +4162,309 @@ on_bus_message_element(GstBus *bus G_GNUC_UNUSED, GstMessage *msg,
 	g_signal_emit(self, signals[SIGNAL_REDIRECTED], 0, uri);
 }
 
+/*
+ * Bus thread
+ */
+
+static GMainContext *bus_context;
+
+static gpointer
+bus_thread_func(gpointer data G_GNUC_UNUSED)
+{
+	GMainLoop *loop;
+
+	g_main_context_push_thread_default(bus_context);
+	loop = g_main_loop_new(bus_context, FALSE);
+	g_main_loop_run(loop);
+
+	/* Never reached */
+	g_main_loop_unref(loop);
+	g_main_context_pop_thread_default(bus_context);
+
+	return NULL;
+}
+
+static GMainContext *
+get_bus_context(void)
+{
+	static gsize initialized = 0;
+
+	if (g_once_init_enter(&initialized)) {
+		bus_context = g_main_context_new();
+		g_thread_unref(g_thread_new("gv-bus", bus_thread_func, NULL));
+		g_once_init_leave(&initialized, 1);
+	}
+
+	return bus_context;
+}
+
+static void
+bus_entry_free(GvBusEntry *entry)
+{
+	gst_message_unref(entry->message);
+	g_free(entry);
+}
+
+static void
+bus_queue_clear(GvBusQueue *queue)
+{
+	g_queue_clear_full(&queue->messages, (GDestroyNotify) bus_entry_free);
+	g_mutex_clear(&queue->lock);
+}
+
+static void
+bus_queue_release(GvBusQueue *queue)
+{
+	g_atomic_rc_box_release_full(queue, (GDestroyNotify) bus_queue_clear);
+}
+
+static void
+handle_bus_message(GvEngine *self, GstMessage *msg)
+{
+	GstBus *bus = self->priv->bus;
+
+	switch (GST_MESSAGE_TYPE(msg)) {
+	case GST_MESSAGE_EOS:
+		on_bus_message_eos(bus, msg, self);
+		break;
+	case GST_MESSAGE_ERROR:
+		on_bus_message_error(bus, msg, self);
+		break;
+	case GST_MESSAGE_WARNING:
+		on_bus_message_warning(bus, msg, self);
+		break;
+	case GST_MESSAGE_INFO:
+		on_bus_message_info(bus, msg, self);
+		break;
+	case GST_MESSAGE_TAG:
+		on_bus_message_tag(bus, msg, self);
+		break;
+	case GST_MESSAGE_BUFFERING:
+		on_bus_message_buffering(bus, msg, self);
+		break;
+	case GST_MESSAGE_STATE_CHANGED:
+		on_bus_message_state_changed(bus, msg, self);
+		break;
+	case GST_MESSAGE_STREAM_COLLECTION:
+		on_bus_message_stream_collection(bus, msg, self);
+		break;
+	case GST_MESSAGE_APPLICATION:
+		on_bus_message_application(bus, msg, self);
+		break;
+	case GST_MESSAGE_ELEMENT:
+		on_bus_message_element(bus, msg, self);
+		break;
+	default:
+		break;
+	}
+}
+
+static gboolean
+when_idle_dispatch_bus_messages(GvBusQueue *queue)
+{
+	GQueue messages = G_QUEUE_INIT;
+	GvBusEntry *entry;
+
+	g_mutex_lock(&queue->lock);
+	messages = queue->messages;
+	g_queue_init(&queue->messages);
+	g_clear_pointer(&queue->dispatch, g_source_unref);
+	g_mutex_unlock(&queue->lock);
+
+	/* The engine and the generation are checked for each message, as
+	 * handling a message might stop the playback, or swap the bus */
+	while ((entry = g_queue_pop_head(&messages)) != NULL) {
+		GvEngine *engine = queue->engine;
+
+		if (engine != NULL &&
+		    entry->generation == g_atomic_int_get(&queue->generation))
+			handle_bus_message(engine, entry->message);
+
+		bus_entry_free(entry);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+coalesce_bus_message(GvBusEntry *last, GstMessage *msg)
+{
+	/* WARNING! We're in the bus thread! */
+
+	if (GST_MESSAGE_TYPE(last->message) != GST_MESSAGE_TYPE(msg))
+		return FALSE;
+
+	if (GST_MESSAGE_SRC(last->message) != GST_MESSAGE_SRC(msg))
+		return FALSE;
+
+	switch (GST_MESSAGE_TYPE(msg)) {
+	case GST_MESSAGE_TAG: {
+		GstTagList *last_tags = NULL;
+		GstTagList *tags = NULL;
+		GstTagList *merged;
+
+		/* Merge tag lists, the most recent values win */
+		gst_message_parse_tag(last->message, &last_tags);
+		gst_message_parse_tag(msg, &tags);
+		merged = gst_tag_list_merge(last_tags, tags, GST_TAG_MERGE_REPLACE);
+		gst_tag_list_unref(last_tags);
+		gst_tag_list_unref(tags);
+
+		gst_message_unref(last->message);
+		last->message = gst_message_new_tag(GST_MESSAGE_SRC(msg), merged);
+		return TRUE;
+	}
+	case GST_MESSAGE_BUFFERING: {
+		gint last_percent = 0;
+		gint percent = 0;
+
+		/* Only keep the transitions between buffering and done */
+		gst_message_parse_buffering(last->message, &last_percent);
+		gst_message_parse_buffering(msg, &percent);
+		if ((last_percent >= 100) != (percent >= 100))
+			return FALSE;
+
+		gst_message_unref(last->message);
+		last->message = gst_message_ref(msg);
+		return TRUE;
+	}
+	default:
+		return FALSE;
+	}
+}
+
+static gboolean
+on_bus_thread_message(GstBus *bus G_GNUC_UNUSED, GstMessage *msg, GvBusQueue *queue)
+{
+	/* WARNING! We're in the bus thread! */
+
+	GvBusEntry *last;
+
+	g_mutex_lock(&queue->lock);
+
+	/* The bus was flushed, the messages that follow are for real */
+	if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_APPLICATION &&
+	    gst_message_has_name(msg, BUS_FLUSH_MESSAGE)) {
+		const GstStructure *s = gst_message_get_structure(msg);
+
+		gst_structure_get_int(s, "generation", &queue->thread_generation);
+		goto out;
+	}
+
+	queue->n_messages++;
+
+	/* State changes of the elements within the playbin are of no use */
+	if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STATE_CHANGED &&
+	    GST_MESSAGE_SRC(msg) != GST_OBJECT_CAST(queue->playbin)) {
+		queue->n_coalesced++;
+		goto out;
+	}
+
+	/* Coalesce with the previous message, if possible */
+	last = g_queue_peek_tail(&queue->messages);
+	if (last != NULL && last->generation == queue->thread_generation &&
+	    coalesce_bus_message(last, msg) == TRUE) {
+		queue->n_coalesced++;
+	} else {
+		GvBusEntry *entry;
+
+		entry = g_new(GvBusEntry, 1);
+		entry->message = gst_message_ref(msg);
+		entry->generation = queue->thread_generation;
+		g_queue_push_tail(&queue->messages, entry);
+	}
+
+	/* Hand over to the main loop */
+	if (queue->dispatch == NULL) {
+		queue->dispatch = g_idle_source_new();
+		g_source_set_priority(queue->dispatch, G_PRIORITY_DEFAULT);
+		g_source_set_callback(queue->dispatch,
+				G_SOURCE_FUNC(when_idle_dispatch_bus_messages),
+				g_atomic_rc_box_acquire(queue),
+				(GDestroyNotify) bus_queue_release);
+		g_source_attach(queue->dispatch, NULL);
+	}
+
+out:
+	g_mutex_unlock(&queue->lock);
+
+	return G_SOURCE_CONTINUE;
+}
+
+static GvBusQueue *
+bus_queue_new(GstBus *bus, GstElement *playbin)
+{
+	GvBusQueue *queue;
+
+	queue = g_atomic_rc_box_new0(GvBusQueue);
+	g_mutex_init(&queue->lock);
+	g_queue_init(&queue->messages);
+	queue->bus = bus;
+	queue->playbin = playbin;
+
+	queue->watch = gst_bus_create_watch(bus);
+	g_source_set_callback(queue->watch,
+			G_SOURCE_FUNC(on_bus_thread_message),
+			g_atomic_rc_box_acquire(queue),
+			(GDestroyNotify) bus_queue_release);
+	g_source_attach(queue->watch, get_bus_context());
+
+	return queue;
+}
+
+static void
+bus_queue_free(GvBusQueue *queue)
+{
+	queue->engine = NULL;
+
+	g_source_destroy(queue->watch);
+	g_source_unref(queue->watch);
+
+	g_mutex_lock(&queue->lock);
+	if (queue->dispatch != NULL) {
+		g_source_destroy(queue->dispatch);
+		g_clear_pointer(&queue->dispatch, g_source_unref);
+	}
+	g_mutex_unlock(&queue->lock);
+
+	bus_queue_release(queue);
+}
+
+/*
+ * Playbin and bus signal handlers setup
+ */
+
+static void
+watch_playbin(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+	GstElement *playbin = priv->playbin;
+	GstBus *bus = priv->bus;
+
+	/* Let the probes know which engine the playbin belongs to */
+	g_object_set_data(G_OBJECT(playbin), "gv-engine", self);
+
+	/* Connect playbin signal handlers */
+	g_signal_connect_object(playbin, "element-setup",
+				G_CALLBACK(on_playbin_element_setup), self, 0);
+	g_signal_connect_object(playbin, "source-setup",
+				G_CALLBACK(on_playbin_source_setup), self, 0);
+
+	/* Let the bus queue know where to dispatch messages */
+	g_assert(priv->bus_queue->bus == bus);
+	priv->bus_queue->engine = self;
+}
+
+static void
+unwatch_playbin(GvEngine *self)
+{
+	GvEnginePrivate *priv = self->priv;
+
+	g_object_set_data(G_OBJECT(priv->playbin), "gv-engine", NULL);
+	g_signal_handlers_disconnect_by_data(priv->playbin, self);
+	priv->bus_queue->engine = NULL;
+}
+
 /*
  * GObject methods
  */
@@ -1386,25 +4490,49 @@ gv_engine_finalize(GObject *object)
 
 	TRACE("%p", object);
 
+	/* Unref the standby engine and the fader */
+	g_clear_object(&priv->standby);
+	g_clear_handle_id(&priv->crossfade_timeout_id, g_source_remove);
+	g_clear_object(&priv->fader);
+
+	/* Remove pending operations */
+	g_clear_handle_id(&priv->release_timeout_id, g_source_remove);
+	g_clear_handle_id(&priv->stats_timeout_id, g_source_remove);
+	g_clear_handle_id(&priv->watchdog_timeout_id, g_source_remove);
+
 	/* Stop playback, the hard way */
+	g_object_set_data(G_OBJECT(priv->playbin), "gv-engine", NULL);
 	gst_element_set_state(priv->playbin, GST_STATE_NULL);
 
 	/* Unref the bus */
-	gst_bus_remove_signal_watch(priv->bus);
+	bus_queue_free(priv->bus_queue);
 	gst_object_unref(priv->bus);
 
 	/* Unref the playbin */
 	gst_object_unref(priv->playbin);
 
+	/* Stop recording */
+	g_clear_object(&priv->recorder);
+	g_free(priv->recording_title);
+	g_free(priv->recording_directory);
+
 	/* Unref metadata */
 	gv_clear_streaminfo(&priv->streaminfo);
 	gv_clear_metadata(&priv->metadata);
 
+	/* Drop the custom audio sinks */
+	g_clear_object(&priv->audio_sink_cancellable);
+	g_queue_free(priv->audio_sinks_lru);
+	g_hash_table_unref(priv->audio_sinks);
+
 	/* Free resources */
 	g_free(priv->pipeline_string);
 	g_free(priv->uri);
 	g_free(priv->user_agent);
+	g_free(priv->stream_buffering_profile);
 	g_free(priv->default_user_agent);
+	clear_handover(self);
+	g_mutex_clear(&priv->stats_lock);
 
 	/* Chain up */
 	G_OBJECT_CHAINUP_FINALIZE(gv_engine, object);
@@ -1428,10 +4556,20 @@ gv_engine_constructed(GObject *object)
 	priv->mute = DEFAULT_MUTE;
 	priv->pipeline_enabled = FALSE;
 	priv->pipeline_string = NULL;
+	priv->buffering_profile = DEFAULT_BUFFERING_PROFILE;
+	priv->crossfade_duration = DEFAULT_CROSSFADE_DURATION;
+	priv->timeshift_window = DEFAULT_TIMESHIFT_WINDOW;
+	priv->stall_timeout = DEFAULT_STALL_TIMEOUT;
+	priv->fade = 1.0;
+	priv->active_profile = &buffering_profiles[DEFAULT_BUFFERING_PROFILE];
 
 	/* Check that GStreamer is initialized */
 	g_assert(gst_is_initialized());
 
+	/* Make the time-shift source known to playbin, registering it again
+	 * is harmless */
+	gv_timeshift_src_register();
+
 	/* Make the playbin - returns floating ref */
 	playbin = gst_element_factory_make("playbin3", "playbin");
 	g_assert(playbin != NULL);
@@ -1442,41 +4580,43 @@ gv_engine_constructed(GObject *object)
 	g_assert(fakesink != NULL);
 	g_object_set(playbin, "video-sink", fakesink, NULL);
 
-	/* Connect playbin signal handlers */
-	g_signal_connect_object(playbin, "element-setup",
-				G_CALLBACK(on_playbin_element_setup), self, 0);
-	g_signal_connect_object(playbin, "source-setup",
-				G_CALLBACK(on_playbin_source_setup), self, 0);
+	/* Headless engines discard the audio as soon as it's decoded */
+	if (priv->headless == TRUE) {
+		guint flags;
+
+		fakesink = gst_element_factory_make("fakesink", "audiosink");
+		g_assert(fakesink != NULL);
+		g_object_set(playbin, "audio-sink", fakesink, NULL);
+
+		g_object_get(playbin, "flags", &flags, NULL);
+		flags &= ~(GST_PLAY_FLAG_VIDEO | GST_PLAY_FLAG_TEXT | GST_PLAY_FLAG_SOFT_VOLUME);
+		flags |= GST_PLAY_FLAG_NATIVE_AUDIO;
+		g_object_set(playbin, "flags", flags, NULL);
+	}
+
+	/* Metadata-only engines don't decode. The decodebins might have been
+	 * created along with the playbin, before element-setup is connected,
+	 * so we look for them right now as well. */
+	if (priv->metadata_only == TRUE) {
+		GstIterator *iter;
+
+		g_assert(priv->headless == TRUE);
+
+		iter = gst_bin_iterate_recurse(GST_BIN(playbin));
+		gst_iterator_foreach(iter, set_decodebin_passthrough_foreach, NULL);
+		gst_iterator_free(iter);
+	}
 
 	/* Get a reference to the message bus - returns full ref */
 	bus = gst_element_get_bus(playbin);
 	g_assert(bus != NULL);
 	priv->bus = bus;
 
-	/* Add a bus signal watch (so that 'message' signals are emitted) */
-	gst_bus_add_signal_watch(bus);
-
-	/* Connect bus signal handlers */
-	g_signal_connect_object(bus, "message::eos",
-				G_CALLBACK(on_bus_message_eos), self, 0);
-	g_signal_connect_object(bus, "message::error",
-				G_CALLBACK(on_bus_message_error), self, 0);
-	g_signal_connect_object(bus, "message::warning",
-				G_CALLBACK(on_bus_message_warning), self, 0);
-	g_signal_connect_object(bus, "message::info",
-				G_CALLBACK(on_bus_message_info), self, 0);
-	g_signal_connect_object(bus, "message::tag",
-				G_CALLBACK(on_bus_message_tag), self, 0);
-	g_signal_connect_object(bus, "message::buffering",
-				G_CALLBACK(on_bus_message_buffering), self, 0);
-	g_signal_connect_object(bus, "message::state-changed",
-				G_CALLBACK(on_bus_message_state_changed), self, 0);
-	g_signal_connect_object(bus, "message::stream-collection",
-				G_CALLBACK(on_bus_message_stream_collection), self, 0);
-	g_signal_connect_object(bus, "message::application",
-				G_CALLBACK(on_bus_message_application), self, 0);
-	g_signal_connect_object(bus, "message::element",
-				G_CALLBACK(on_bus_message_element), self, 0);
+	/* Watch the bus, from the bus thread */
+	priv->bus_queue = bus_queue_new(bus, playbin);
+
+	/* Connect playbin and bus signal handlers */
+	watch_playbin(self);
 
 	/* Chain up */
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_engine, object);
@@ -1489,6 +4629,17 @@ gv_engine_init(GvEngine *self)
 
 	/* Initialize private pointer */
 	self->priv = gv_engine_get_instance_private(self);
+
+	/* Initialize the stats lock */
+	g_mutex_init(&self->priv->stats_lock);
+
+	/* Initialize the audio sink cache */
+	self->priv->audio_sinks = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, (GDestroyNotify) gst_object_unref);
+	self->priv->audio_sinks_lru = g_queue_new();
+
+	/* Recording starts with the first title or data of a stream */
+	self->priv->recording_pending = TRUE;
 }
 
 static void
@@ -1541,6 +4692,89 @@ gv_engine_class_init(GvEngineClass *class)
 		g_param_spec_string("pipeline-string", "Custom pipeline string", NULL, NULL,
 				    GV_PARAM_READWRITE);
 
+	properties[PROP_SWITCH_LATENCY] =
+		g_param_spec_uint("switch-latency", "Stop to first buffer latency",
+				  "In milliseconds, measured for the last stream played",
+				  0, G_MAXUINT, 0,
+				  GV_PARAM_READABLE);
+
+	properties[PROP_BUFFERING_PROFILE] =
+		g_param_spec_enum("buffering-profile", "Default buffering profile", NULL,
+				  GV_TYPE_ENGINE_BUFFERING_PROFILE,
+				  DEFAULT_BUFFERING_PROFILE,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_STATS] =
+		g_param_spec_boxed("stats", "Statistics", NULL,
+				   GV_TYPE_ENGINE_STATS,
+				   GV_PARAM_READABLE);
+
+	properties[PROP_CROSSFADE_DURATION] =
+		g_param_spec_uint("crossfade-duration", "Crossfade duration",
+				  "In milliseconds, zero to disable crossfading",
+				  0, GV_MAX_CROSSFADE_DURATION, DEFAULT_CROSSFADE_DURATION,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_TIMESHIFT_WINDOW] =
+		g_param_spec_uint("timeshift-window", "Time-shift window",
+				  "In minutes, zero to disable time-shift",
+				  0, GV_MAX_TIMESHIFT_WINDOW, DEFAULT_TIMESHIFT_WINDOW,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_STALL_TIMEOUT] =
+		g_param_spec_uint("stall-timeout", "Stall timeout",
+				  "In seconds without data, zero to disable the watchdog",
+				  0, GV_MAX_STALL_TIMEOUT, DEFAULT_STALL_TIMEOUT,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_STALL_COUNT] =
+		g_param_spec_uint("stall-count", "Stall count",
+				  "How many times a stream stalled",
+				  0, G_MAXUINT, 0,
+				  GV_PARAM_READABLE);
+
+	properties[PROP_PREROLLED] =
+		g_param_spec_boolean("prerolled", "Pre-rolled",
+				     "Whether a standby engine is pre-rolled",
+				     FALSE,
+				     GV_PARAM_READABLE);
+
+	properties[PROP_HLS_POLICY] =
+		g_param_spec_enum("hls-policy", "HLS policy",
+				  "How the variant of adaptive streams is picked",
+				  GV_TYPE_ENGINE_HLS_POLICY,
+				  DEFAULT_HLS_POLICY,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_HLS_MAX_BITRATE] =
+		g_param_spec_uint("hls-max-bitrate", "HLS maximum bitrate",
+				  "In kbps, for the capped policy, zero for no cap",
+				  0, GV_HLS_MAX_BITRATE, DEFAULT_HLS_MAX_BITRATE,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_RECORDING] =
+		g_param_spec_boolean("recording", "Recording", NULL,
+				     FALSE,
+				     GV_PARAM_READWRITE);
+
+	properties[PROP_RECORDING_DIRECTORY] =
+		g_param_spec_string("recording-directory", "Recording directory",
+				    "Where recordings are saved, NULL for the default", NULL,
+				    GV_PARAM_READWRITE);
+
+	properties[PROP_HEADLESS] =
+		g_param_spec_boolean("headless", "Headless",
+				     "Discard the audio rather than playing it",
+				     FALSE,
+				     GV_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_METADATA_ONLY] =
+		g_param_spec_boolean("metadata-only", "Metadata only",
+				     "Discard the audio without decoding it, "
+				     "only the metadata is wanted",
+				     FALSE,
+				     GV_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
 	g_object_class_install_properties(object_class, PROP_N, properties);
 
 	/* Signals */
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <gio/gio.h>
 #include <glib.h>
 #include <glib-object.h>
 
@@ -32,20 +33,84 @@
 
 G_DECLARE_FINAL_TYPE(GvEngine, gv_engine, GV, ENGINE, GObject)
 
+/* Errors */
+
+#define GV_ENGINE_ERROR (gv_engine_error_quark())
+GQuark gv_engine_error_quark(void);
+
+typedef enum {
+	GV_ENGINE_ERROR_STALLED,
+} GvEngineError;
+
 /* Data types */
 
 typedef enum {
 	GV_ENGINE_STATE_STOPPED = 0,
 	GV_ENGINE_STATE_CONNECTING,
 	GV_ENGINE_STATE_BUFFERING,
-	GV_ENGINE_STATE_PLAYING
+	GV_ENGINE_STATE_PLAYING,
+	GV_ENGINE_STATE_PAUSED
 } GvEngineState;
 
+typedef enum {
+	GV_ENGINE_BUFFERING_PROFILE_LOW_LATENCY = 0,
+	GV_ENGINE_BUFFERING_PROFILE_BALANCED,
+	GV_ENGINE_BUFFERING_PROFILE_FLAKY_NETWORK,
+} GvEngineBufferingProfile;
+
+typedef enum {
+	GV_ENGINE_HLS_POLICY_ADAPTIVE = 0,
+	GV_ENGINE_HLS_POLICY_LOWEST,
+	GV_ENGINE_HLS_POLICY_HIGHEST,
+	GV_ENGINE_HLS_POLICY_CAPPED,
+} GvEngineHlsPolicy;
+
+/* Statistics of the current stream, times are in milliseconds, and are
+ * measured from the moment gv_engine_play() was called. Zero means that
+ * there's no data (yet). */
+
+#define GV_TYPE_ENGINE_STATS gv_engine_stats_get_type()
+
+GType gv_engine_stats_get_type(void) G_GNUC_CONST;
+
+typedef struct _GvEngineStats GvEngineStats;
+
+struct _GvEngineStats {
+	guint   connect_time;      // first bytes received
+	guint   first_buffer_time; // first decoded buffer reaching the sink
+	guint   playing_time;      // pipeline reaching PLAYING
+	guint   buffering_count;
+	guint   buffering_time;
+	guint64 bytes_received;
+	guint   input_bitrate;     // kbps
+	guint   decoder_cpu_time;
+	guint   bus_messages;
+	guint   bus_coalesced;     // merged or dropped before reaching the main loop
+};
+
+GvEngineStats *gv_engine_stats_copy(const GvEngineStats *self);
+void           gv_engine_stats_free(GvEngineStats *self);
+
 /* Methods */
 
 GvEngine *gv_engine_new (void);
-void      gv_engine_play(GvEngine *self, const gchar *uri, const gchar *user_agent, gboolean ssl_strict);
+GvEngine *gv_engine_new_headless(void);
+GvEngine *gv_engine_new_metadata_only(void);
+void      gv_engine_play(GvEngine *self, const gchar *uri, const gchar *user_agent, gboolean ssl_strict,
+                         const gchar *buffering_profile);
+void      gv_engine_hand_over(GvEngine *self, const gchar *uri, GInputStream *stream,
+                              guint icy_metaint);
 void      gv_engine_stop(GvEngine *self);
+void      gv_engine_crossfade_stop(GvEngine *self);
+void      gv_engine_preroll(GvEngine *self, const gchar *uri, const gchar *user_agent,
+                            gboolean ssl_strict, guint max_bitrate);
+void      gv_engine_cancel_preroll(GvEngine *self);
+GvEngine *gv_engine_preroll_new(GvEngine *self, const gchar *uri, const gchar *user_agent,
+                                gboolean ssl_strict);
+void      gv_engine_set_standby(GvEngine *self, GvEngine *standby);
+gboolean  gv_engine_pause(GvEngine *self);
+void      gv_engine_resume(GvEngine *self);
+void      gv_engine_seek(GvEngine *self, gint64 position);
 
 /* Property accessors */
 
@@ -60,3 +125,30 @@ gboolean       gv_engine_get_pipeline_enabled(GvEngine *self);
 void           gv_engine_set_pipeline_enabled(GvEngine *self, gboolean enabled);
 const gchar   *gv_engine_get_pipeline_string (GvEngine *self);
 void           gv_engine_set_pipeline_string (GvEngine *self, const gchar *pipeline);
+guint          gv_engine_get_switch_latency  (GvEngine *self);
+GvEngineBufferingProfile gv_engine_get_buffering_profile(GvEngine *self);
+void           gv_engine_set_buffering_profile(GvEngine *self, GvEngineBufferingProfile profile);
+guint          gv_engine_get_underruns       (GvEngine *self, GvEngineBufferingProfile profile);
+GvEngineHlsPolicy gv_engine_get_hls_policy   (GvEngine *self);
+void           gv_engine_set_hls_policy      (GvEngine *self, GvEngineHlsPolicy policy);
+guint          gv_engine_get_hls_max_bitrate (GvEngine *self);
+void           gv_engine_set_hls_max_bitrate (GvEngine *self, guint max_bitrate);
+const GvEngineStats *gv_engine_get_stats     (GvEngine *self);
+guint          gv_engine_get_crossfade_duration(GvEngine *self);
+void           gv_engine_set_crossfade_duration(GvEngine *self, guint duration);
+guint          gv_engine_get_timeshift_window(GvEngine *self);
+void           gv_engine_set_timeshift_window(GvEngine *self, guint window);
+guint          gv_engine_get_stall_timeout   (GvEngine *self);
+void           gv_engine_set_stall_timeout   (GvEngine *self, guint timeout);
+guint          gv_engine_get_stall_count     (GvEngine *self);
+guint          gv_engine_get_http_status     (GvEngine *self);
+gboolean       gv_engine_get_prerolled       (GvEngine *self);
+gboolean       gv_engine_get_headless        (GvEngine *self);
+gboolean       gv_engine_get_metadata_only   (GvEngine *self);
+gboolean       gv_engine_get_recording       (GvEngine *self);
+void           gv_engine_set_recording       (GvEngine *self, gboolean recording);
+const gchar   *gv_engine_get_recording_directory(GvEngine *self);
+void           gv_engine_set_recording_directory(GvEngine *self, const gchar *directory);
+gboolean       gv_engine_get_can_seek        (GvEngine *self);
+gint64         gv_engine_get_position        (GvEngine *self);
+gint64         gv_engine_get_data_idle_time  (GvEngine *self);
@@ -0,0 +1,853 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The HTTP pool hands out long-lived soup sessions, so that playlist
+ * downloads, retries and probes to the same server reuse the connections
+ * that are already open, rather than paying for DNS, TCP and TLS every time.
+ *
+ * Sessions are keyed by user agent and by TLS strictness. The user agent
+ * is a session property in libsoup, and so is the TLS policy: insecure
+ * sessions accept bad certificates for every request they send, strict
+ * sessions leave it to libsoup, which rejects them. Keeping them apart
+ * ensures that a connection for which a bad certificate was accepted is
+ * never handed over to a request that wouldn't accept it.
+ *
+ * libsoup doesn't cache DNS lookups. It has no per-session resolver either,
+ * it always goes through the default GResolver, so that's where the caching
+ * resolver has to be installed. However it only caches the hosts that pool
+ * sessions talk to, any other lookup goes straight to the resolver it
+ * wraps, as if it wasn't there.
+ */
+
+#include <glib-object.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "base/glib-object-additions.h"
+#include "base/gv-base.h"
+
+#include "core/gv-http-pool.h"
+
+/* Connections are cheap to keep, it's opening them that costs. Streams
+ * that are handed over keep their connection for as long as they play,
+ * and the monitor plays hundreds of them, often from the same servers. */
+#define MAX_CONNS          1024
+#define MAX_CONNS_PER_HOST 256
+#define IDLE_TIMEOUT       60  // seconds
+
+/* We don't get the TTL of the records from GResolver, so we pick one */
+#define DNS_CACHE_TTL         60  // seconds
+#define DNS_CACHE_MAX_ENTRIES 64
+
+/*
+ * DNS cache
+ */
+
+#define GV_TYPE_CACHING_RESOLVER gv_caching_resolver_get_type()
+
+G_DECLARE_FINAL_TYPE(GvCachingResolver, gv_caching_resolver, GV, CACHING_RESOLVER, GResolver)
+
+struct _GvCachingResolver {
+	/* Parent instance structure */
+	GResolver parent_instance;
+	/* Resolver that does the actual work */
+	GResolver *inner;
+	/* Cache, and the hosts it's for, protected by the lock */
+	GMutex lock;
+	GHashTable *cache;
+	GHashTable *hosts;
+	guint n_hits;
+	guint n_misses;
+};
+
+G_DEFINE_TYPE(GvCachingResolver, gv_caching_resolver, G_TYPE_RESOLVER)
+
+typedef struct {
+	GList *addresses;
+	gint64 expiry;
+} GvDnsEntry;
+
+static void
+dns_entry_free(GvDnsEntry *entry)
+{
+	g_resolver_free_addresses(entry->addresses);
+	g_free(entry);
+}
+
+static gchar *
+make_dns_key(const gchar *hostname, GResolverNameLookupFlags flags)
+{
+	return g_strdup_printf("%d %s", flags, hostname);
+}
+
+static GList *
+dns_cache_lookup(GvCachingResolver *self, const gchar *key)
+{
+	GvDnsEntry *entry;
+	GList *addresses = NULL;
+
+	g_mutex_lock(&self->lock);
+	entry = g_hash_table_lookup(self->cache, key);
+	if (entry != NULL && entry->expiry < g_get_monotonic_time()) {
+		g_hash_table_remove(self->cache, key);
+		entry = NULL;
+	}
+	if (entry != NULL) {
+		addresses = g_list_copy_deep(entry->addresses,
+				(GCopyFunc) g_object_ref, NULL);
+		self->n_hits++;
+	} else {
+		self->n_misses++;
+	}
+	g_mutex_unlock(&self->lock);
+
+	return addresses;
+}
+
+static void
+dns_cache_insert(GvCachingResolver *self, const gchar *key, GList *addresses)
+{
+	GvDnsEntry *entry;
+
+	entry = g_new0(GvDnsEntry, 1);
+	entry->addresses = g_list_copy_deep(addresses, (GCopyFunc) g_object_ref, NULL);
+	entry->expiry = g_get_monotonic_time() + DNS_CACHE_TTL * G_USEC_PER_SEC;
+
+	g_mutex_lock(&self->lock);
+	/* No need for anything clever, the cache is only there to
+	 * smooth out bursts of lookups */
+	if (g_hash_table_size(self->cache) >= DNS_CACHE_MAX_ENTRIES)
+		g_hash_table_remove_all(self->cache);
+	g_hash_table_replace(self->cache, g_strdup(key), entry);
+	g_mutex_unlock(&self->lock);
+}
+
+static gboolean
+is_cached_host(GvCachingResolver *self, const gchar *hostname)
+{
+	gboolean cached;
+
+	g_mutex_lock(&self->lock);
+	cached = g_hash_table_contains(self->hosts, hostname);
+	g_mutex_unlock(&self->lock);
+
+	return cached;
+}
+
+/* Hosts are added right before a request is sent, so it's fine to forget
+ * about them all at once, as for the cache */
+static void
+gv_caching_resolver_add_host(GvCachingResolver *self, const gchar *hostname)
+{
+	if (hostname == NULL)
+		return;
+
+	g_mutex_lock(&self->lock);
+	if (g_hash_table_size(self->hosts) >= DNS_CACHE_MAX_ENTRIES)
+		g_hash_table_remove_all(self->hosts);
+	g_hash_table_add(self->hosts, g_strdup(hostname));
+	g_mutex_unlock(&self->lock);
+}
+
+static void
+gv_caching_resolver_flush(GvCachingResolver *self)
+{
+	g_mutex_lock(&self->lock);
+	g_hash_table_remove_all(self->cache);
+	g_mutex_unlock(&self->lock);
+}
+
+static guint
+gv_caching_resolver_get_n_hits(GvCachingResolver *self)
+{
+	guint n_hits;
+
+	g_mutex_lock(&self->lock);
+	n_hits = self->n_hits;
+	g_mutex_unlock(&self->lock);
+
+	return n_hits;
+}
+
+static guint
+gv_caching_resolver_get_n_misses(GvCachingResolver *self)
+{
+	guint n_misses;
+
+	g_mutex_lock(&self->lock);
+	n_misses = self->n_misses;
+	g_mutex_unlock(&self->lock);
+
+	return n_misses;
+}
+
+static GList *
+gv_caching_resolver_lookup_by_name_with_flags(GResolver *resolver,
+					      const gchar *hostname,
+					      GResolverNameLookupFlags flags,
+					      GCancellable *cancellable,
+					      GError **error)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+	GList *addresses;
+	gchar *key;
+
+	if (!is_cached_host(self, hostname))
+		return g_resolver_lookup_by_name_with_flags(self->inner,
+				hostname, flags, cancellable, error);
+
+	key = make_dns_key(hostname, flags);
+
+	addresses = dns_cache_lookup(self, key);
+	if (addresses == NULL) {
+		addresses = g_resolver_lookup_by_name_with_flags(self->inner,
+				hostname, flags, cancellable, error);
+		if (addresses != NULL)
+			dns_cache_insert(self, key, addresses);
+	}
+
+	g_free(key);
+
+	return addresses;
+}
+
+static GList *
+gv_caching_resolver_lookup_by_name(GResolver *resolver,
+				   const gchar *hostname,
+				   GCancellable *cancellable,
+				   GError **error)
+{
+	return gv_caching_resolver_lookup_by_name_with_flags(resolver, hostname,
+			G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT, cancellable, error);
+}
+
+static void
+lookup_by_name_callback(GResolver *inner, GAsyncResult *result, GTask *task)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(g_task_get_source_object(task));
+	const gchar *key = g_task_get_task_data(task);
+	GList *addresses;
+	GError *err = NULL;
+
+	addresses = g_resolver_lookup_by_name_with_flags_finish(inner, result, &err);
+	if (addresses == NULL) {
+		g_task_return_error(task, err);
+	} else {
+		/* No key means that it's not for the cache */
+		if (key != NULL)
+			dns_cache_insert(self, key, addresses);
+		g_task_return_pointer(task, addresses,
+				(GDestroyNotify) g_resolver_free_addresses);
+	}
+
+	g_object_unref(task);
+}
+
+static void
+gv_caching_resolver_lookup_by_name_with_flags_async(GResolver *resolver,
+						    const gchar *hostname,
+						    GResolverNameLookupFlags flags,
+						    GCancellable *cancellable,
+						    GAsyncReadyCallback callback,
+						    gpointer user_data)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+	GList *addresses;
+	GTask *task;
+	gchar *key;
+
+	task = g_task_new(resolver, cancellable, callback, user_data);
+
+	if (!is_cached_host(self, hostname)) {
+		g_resolver_lookup_by_name_with_flags_async(self->inner, hostname,
+				flags, cancellable,
+				(GAsyncReadyCallback) lookup_by_name_callback, task);
+		return;
+	}
+
+	key = make_dns_key(hostname, flags);
+
+	addresses = dns_cache_lookup(self, key);
+	if (addresses != NULL) {
+		g_task_return_pointer(task, addresses,
+				(GDestroyNotify) g_resolver_free_addresses);
+		g_object_unref(task);
+		g_free(key);
+		return;
+	}
+
+	g_task_set_task_data(task, key, g_free);
+	g_resolver_lookup_by_name_with_flags_async(self->inner, hostname, flags,
+			cancellable, (GAsyncReadyCallback) lookup_by_name_callback, task);
+}
+
+static GList *
+gv_caching_resolver_lookup_by_name_with_flags_finish(GResolver *resolver,
+						     GAsyncResult *result,
+						     GError **error)
+{
+	g_return_val_if_fail(g_task_is_valid(result, resolver), NULL);
+
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+gv_caching_resolver_lookup_by_name_async(GResolver *resolver,
+					 const gchar *hostname,
+					 GCancellable *cancellable,
+					 GAsyncReadyCallback callback,
+					 gpointer user_data)
+{
+	gv_caching_resolver_lookup_by_name_with_flags_async(resolver, hostname,
+			G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT, cancellable,
+			callback, user_data);
+}
+
+static GList *
+gv_caching_resolver_lookup_by_name_finish(GResolver *resolver,
+					  GAsyncResult *result,
+					  GError **error)
+{
+	return gv_caching_resolver_lookup_by_name_with_flags_finish(resolver,
+			result, error);
+}
+
+/* Everything else goes straight to the inner resolver. The results of the
+ * async methods below belong to the inner resolver, hence the finish
+ * methods are called on it. */
+
+static gchar *
+gv_caching_resolver_lookup_by_address(GResolver *resolver,
+				      GInetAddress *address,
+				      GCancellable *cancellable,
+				      GError **error)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	return g_resolver_lookup_by_address(self->inner, address, cancellable, error);
+}
+
+static void
+gv_caching_resolver_lookup_by_address_async(GResolver *resolver,
+					    GInetAddress *address,
+					    GCancellable *cancellable,
+					    GAsyncReadyCallback callback,
+					    gpointer user_data)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	g_resolver_lookup_by_address_async(self->inner, address, cancellable,
+			callback, user_data);
+}
+
+static gchar *
+gv_caching_resolver_lookup_by_address_finish(GResolver *resolver,
+					     GAsyncResult *result,
+					     GError **error)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	return g_resolver_lookup_by_address_finish(self->inner, result, error);
+}
+
+static GList *
+gv_caching_resolver_lookup_service(GResolver *resolver,
+				   const gchar *rrname,
+				   GCancellable *cancellable,
+				   GError **error)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	return G_RESOLVER_GET_CLASS(self->inner)->lookup_service(self->inner,
+			rrname, cancellable, error);
+}
+
+static void
+gv_caching_resolver_lookup_service_async(GResolver *resolver,
+					 const gchar *rrname,
+					 GCancellable *cancellable,
+					 GAsyncReadyCallback callback,
+					 gpointer user_data)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	G_RESOLVER_GET_CLASS(self->inner)->lookup_service_async(self->inner,
+			rrname, cancellable, callback, user_data);
+}
+
+static GList *
+gv_caching_resolver_lookup_service_finish(GResolver *resolver,
+					  GAsyncResult *result,
+					  GError **error)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	return G_RESOLVER_GET_CLASS(self->inner)->lookup_service_finish(self->inner,
+			result, error);
+}
+
+static GList *
+gv_caching_resolver_lookup_records(GResolver *resolver,
+				   const gchar *rrname,
+				   GResolverRecordType record_type,
+				   GCancellable *cancellable,
+				   GError **error)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	return g_resolver_lookup_records(self->inner, rrname, record_type,
+			cancellable, error);
+}
+
+static void
+gv_caching_resolver_lookup_records_async(GResolver *resolver,
+					 const gchar *rrname,
+					 GResolverRecordType record_type,
+					 GCancellable *cancellable,
+					 GAsyncReadyCallback callback,
+					 gpointer user_data)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	g_resolver_lookup_records_async(self->inner, rrname, record_type,
+			cancellable, callback, user_data);
+}
+
+static GList *
+gv_caching_resolver_lookup_records_finish(GResolver *resolver,
+					  GAsyncResult *result,
+					  GError **error)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	return g_resolver_lookup_records_finish(self->inner, result, error);
+}
+
+/* The system configuration changed (eg. /etc/resolv.conf), the addresses
+ * in cache might not be valid anymore */
+static void
+gv_caching_resolver_reload(GResolver *resolver)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(resolver);
+
+	DEBUG("Resolver reloaded, flushing DNS cache");
+	gv_caching_resolver_flush(self);
+}
+
+static void
+on_inner_reload(GResolver *inner G_GNUC_UNUSED, GvCachingResolver *self)
+{
+	g_signal_emit_by_name(self, "reload");
+}
+
+static GvCachingResolver *
+gv_caching_resolver_new(GResolver *inner)
+{
+	GvCachingResolver *self;
+
+	self = g_object_new(GV_TYPE_CACHING_RESOLVER, NULL);
+	self->inner = g_object_ref(inner);
+	g_signal_connect_object(inner, "reload",
+			G_CALLBACK(on_inner_reload), self, 0);
+
+	return self;
+}
+
+static void
+gv_caching_resolver_finalize(GObject *object)
+{
+	GvCachingResolver *self = GV_CACHING_RESOLVER(object);
+
+	g_hash_table_unref(self->hosts);
+	g_hash_table_unref(self->cache);
+	g_mutex_clear(&self->lock);
+	g_clear_object(&self->inner);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_caching_resolver, object);
+}
+
+static void
+gv_caching_resolver_init(GvCachingResolver *self)
+{
+	g_mutex_init(&self->lock);
+	self->cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, (GDestroyNotify) dns_entry_free);
+	self->hosts = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, NULL);
+}
+
+static void
+gv_caching_resolver_class_init(GvCachingResolverClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+	GResolverClass *resolver_class = G_RESOLVER_CLASS(class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_caching_resolver_finalize;
+
+	/* Override GResolver methods */
+	resolver_class->reload = gv_caching_resolver_reload;
+	resolver_class->lookup_by_name = gv_caching_resolver_lookup_by_name;
+	resolver_class->lookup_by_name_async = gv_caching_resolver_lookup_by_name_async;
+	resolver_class->lookup_by_name_finish = gv_caching_resolver_lookup_by_name_finish;
+	resolver_class->lookup_by_name_with_flags = gv_caching_resolver_lookup_by_name_with_flags;
+	resolver_class->lookup_by_name_with_flags_async = gv_caching_resolver_lookup_by_name_with_flags_async;
+	resolver_class->lookup_by_name_with_flags_finish = gv_caching_resolver_lookup_by_name_with_flags_finish;
+	resolver_class->lookup_by_address = gv_caching_resolver_lookup_by_address;
+	resolver_class->lookup_by_address_async = gv_caching_resolver_lookup_by_address_async;
+	resolver_class->lookup_by_address_finish = gv_caching_resolver_lookup_by_address_finish;
+	resolver_class->lookup_service = gv_caching_resolver_lookup_service;
+	resolver_class->lookup_service_async = gv_caching_resolver_lookup_service_async;
+	resolver_class->lookup_service_finish = gv_caching_resolver_lookup_service_finish;
+	resolver_class->lookup_records = gv_caching_resolver_lookup_records;
+	resolver_class->lookup_records_async = gv_caching_resolver_lookup_records_async;
+	resolver_class->lookup_records_finish = gv_caching_resolver_lookup_records_finish;
+}
+
+/*
+ * GObject definitions
+ */
+
+struct _GvHttpPoolPrivate {
+	/* Sessions, keyed by user agent and TLS strictness */
+	GHashTable *sessions;
+	/* DNS cache */
+	GResolver *previous_resolver;
+	GvCachingResolver *resolver;
+	/* Network */
+	GNetworkMonitor *network_monitor;
+	/* Counters */
+	guint n_requests;
+	guint n_connections;
+	guint n_reused;
+};
+
+typedef struct _GvHttpPoolPrivate GvHttpPoolPrivate;
+
+struct _GvHttpPool {
+	/* Parent instance structure */
+	GObject parent_instance;
+	/* Private data */
+	GvHttpPoolPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GvHttpPool, gv_http_pool, G_TYPE_OBJECT)
+
+/*
+ * Connections, so that we can tell new ones from reused ones. libsoup
+ * doesn't expose them, so we learn about them when they're established,
+ * and forget about them when their stream goes away.
+ */
+
+typedef struct {
+	GHashTable *connections;
+	guint64 id;
+} GvConnectionWatch;
+
+static void
+on_connection_finalized(GvConnectionWatch *watch,
+			GObject *where_the_object_was G_GNUC_UNUSED)
+{
+	g_hash_table_remove(watch->connections, &watch->id);
+	g_hash_table_unref(watch->connections);
+	g_free(watch);
+}
+
+static void
+watch_connection(GHashTable *connections, guint64 id, GIOStream *stream)
+{
+	GvConnectionWatch *watch;
+	gint64 *key;
+
+	/* Not used by any request yet */
+	key = g_new(gint64, 1);
+	*key = id;
+	g_hash_table_insert(connections, key, GINT_TO_POINTER(FALSE));
+
+	watch = g_new0(GvConnectionWatch, 1);
+	watch->connections = g_hash_table_ref(connections);
+	watch->id = id;
+	g_object_weak_ref(G_OBJECT(stream), (GWeakNotify) on_connection_finalized, watch);
+}
+
+/*
+ * Signal handlers
+ */
+
+static gboolean
+on_insecure_message_accept_certificate(SoupMessage *msg G_GNUC_UNUSED,
+				       GTlsCertificate *tls_certificate G_GNUC_UNUSED,
+				       GTlsCertificateFlags tls_errors G_GNUC_UNUSED,
+				       gpointer user_data G_GNUC_UNUSED)
+{
+	return TRUE;
+}
+
+static void
+on_message_network_event(SoupMessage *msg,
+			 GSocketClientEvent event,
+			 GIOStream *connection,
+			 SoupSession *session)
+{
+	GHashTable *connections;
+	guint64 id;
+
+	if (event != G_SOCKET_CLIENT_COMPLETE || connection == NULL)
+		return;
+
+	id = soup_message_get_connection_id(msg);
+	if (id == 0)
+		return;
+
+	connections = g_object_get_data(G_OBJECT(session), "gv-connections");
+	watch_connection(connections, id, connection);
+}
+
+static void
+on_session_request_queued(SoupSession *session, SoupMessage *msg, GvHttpPool *self)
+{
+	GvHttpPoolPrivate *priv = self->priv;
+	gboolean ssl_strict;
+
+	/* Lookups for this host go through the DNS cache */
+	gv_caching_resolver_add_host(priv->resolver,
+			g_uri_get_host(soup_message_get_uri(msg)));
+
+	/* Apply the TLS policy of the session */
+	ssl_strict = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(session), "gv-ssl-strict"));
+	if (ssl_strict == FALSE)
+		g_signal_connect(msg, "accept-certificate",
+				G_CALLBACK(on_insecure_message_accept_certificate), NULL);
+
+	/* Learn about the connection, if ever a new one is made */
+	g_signal_connect(msg, "network-event",
+			G_CALLBACK(on_message_network_event), session);
+}
+
+static void
+on_session_request_unqueued(SoupSession *session, SoupMessage *msg, GvHttpPool *self)
+{
+	GvHttpPoolPrivate *priv = self->priv;
+	GHashTable *connections;
+	guint64 id;
+	gint64 *key;
+
+	/* Zero means that no connection was ever made, eg. DNS failure */
+	id = soup_message_get_connection_id(msg);
+	if (id == 0)
+		return;
+
+	priv->n_requests++;
+
+	connections = g_object_get_data(G_OBJECT(session), "gv-connections");
+	if (g_hash_table_lookup(connections, &id) != NULL) {
+		priv->n_reused++;
+		DEBUG("Reused connection %" G_GUINT64_FORMAT, id);
+	} else {
+		/* Only connections that we watch go in the table, as they
+		 * must be removed when they close */
+		if (g_hash_table_contains(connections, &id)) {
+			key = g_new(gint64, 1);
+			*key = id;
+			g_hash_table_insert(connections, key, GINT_TO_POINTER(TRUE));
+		}
+		priv->n_connections++;
+		DEBUG("New connection %" G_GUINT64_FORMAT, id);
+	}
+}
+
+static void
+on_network_changed(GNetworkMonitor *monitor G_GNUC_UNUSED,
+		   gboolean available G_GNUC_UNUSED,
+		   GvHttpPool *self)
+{
+	/* Addresses might not be valid anymore on the new network */
+	gv_caching_resolver_flush(self->priv->resolver);
+}
+
+/*
+ * Property accessors
+ */
+
+guint
+gv_http_pool_get_n_sessions(GvHttpPool *self)
+{
+	return g_hash_table_size(self->priv->sessions);
+}
+
+guint
+gv_http_pool_get_n_requests(GvHttpPool *self)
+{
+	return self->priv->n_requests;
+}
+
+guint
+gv_http_pool_get_n_connections(GvHttpPool *self)
+{
+	return self->priv->n_connections;
+}
+
+guint
+gv_http_pool_get_n_reused(GvHttpPool *self)
+{
+	return self->priv->n_reused;
+}
+
+guint
+gv_http_pool_get_n_dns_hits(GvHttpPool *self)
+{
+	return gv_caching_resolver_get_n_hits(self->priv->resolver);
+}
+
+guint
+gv_http_pool_get_n_dns_misses(GvHttpPool *self)
+{
+	return gv_caching_resolver_get_n_misses(self->priv->resolver);
+}
+
+/*
+ * Public methods
+ */
+
+SoupSession *
+gv_http_pool_get_session(GvHttpPool *self, const gchar *user_agent, gboolean ssl_strict)
+{
+	GvHttpPoolPrivate *priv = self->priv;
+	SoupSession *session;
+	GHashTable *connections;
+	gchar *key;
+
+	key = g_strdup_printf("%s %s", ssl_strict ? "strict" : "insecure", user_agent);
+
+	session = g_hash_table_lookup(priv->sessions, key);
+	if (session != NULL) {
+		g_free(key);
+		return session;
+	}
+
+	DEBUG("Creating session for: %s", key);
+	session = soup_session_new_with_options("user-agent", user_agent,
+			"max-conns", MAX_CONNS,
+			"max-conns-per-host", MAX_CONNS_PER_HOST,
+			"idle-timeout", IDLE_TIMEOUT,
+			NULL);
+
+	g_object_set_data(G_OBJECT(session), "gv-ssl-strict", GINT_TO_POINTER(ssl_strict));
+	connections = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, NULL);
+	g_object_set_data_full(G_OBJECT(session), "gv-connections",
+			connections, (GDestroyNotify) g_hash_table_unref);
+	g_signal_connect_object(session, "request-queued",
+			G_CALLBACK(on_session_request_queued), self, 0);
+	g_signal_connect_object(session, "request-unqueued",
+			G_CALLBACK(on_session_request_unqueued), self, 0);
+
+	g_hash_table_insert(priv->sessions, key, session);
+
+	return session;
+}
+
+GvHttpPool *
+gv_http_pool_new(void)
+{
+	return g_object_new(GV_TYPE_HTTP_POOL, NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_http_pool_finalize(GObject *object)
+{
+	GvHttpPool *self = GV_HTTP_POOL(object);
+	GvHttpPoolPrivate *priv = self->priv;
+	GResolver *resolver;
+
+	TRACE("%p", object);
+
+	DEBUG("HTTP pool: %u requests, %u connections, %u reused, "
+	      "%u DNS cache hits, %u misses",
+	      priv->n_requests, priv->n_connections, priv->n_reused,
+	      gv_caching_resolver_get_n_hits(priv->resolver),
+	      gv_caching_resolver_get_n_misses(priv->resolver));
+
+	/* Put back the resolver we replaced */
+	resolver = g_resolver_get_default();
+	if (resolver == G_RESOLVER(priv->resolver))
+		g_resolver_set_default(priv->previous_resolver);
+	g_object_unref(resolver);
+
+	g_clear_object(&priv->network_monitor);
+	g_hash_table_unref(priv->sessions);
+	g_clear_object(&priv->resolver);
+	g_clear_object(&priv->previous_resolver);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_http_pool, object);
+}
+
+static void
+gv_http_pool_constructed(GObject *object)
+{
+	GvHttpPool *self = GV_HTTP_POOL(object);
+	GvHttpPoolPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Install the DNS cache */
+	priv->previous_resolver = g_resolver_get_default();
+	priv->resolver = gv_caching_resolver_new(priv->previous_resolver);
+	g_resolver_set_default(G_RESOLVER(priv->resolver));
+
+	/* Watch the network */
+	priv->network_monitor = g_object_ref(g_network_monitor_get_default());
+	g_signal_connect_object(priv->network_monitor, "network-changed",
+			G_CALLBACK(on_network_changed), self, 0);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_http_pool, object);
+}
+
+static void
+gv_http_pool_init(GvHttpPool *self)
+{
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_http_pool_get_instance_private(self);
+
+	self->priv->sessions = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, g_object_unref);
+}
+
+static void
+gv_http_pool_class_init(GvHttpPoolClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_http_pool_finalize;
+	object_class->constructed = gv_http_pool_constructed;
+}
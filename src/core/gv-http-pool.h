@@ -0,0 +1,46 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include <libsoup/soup.h>
+
+/* GObject declarations */
+
+#define GV_TYPE_HTTP_POOL gv_http_pool_get_type()
+
+G_DECLARE_FINAL_TYPE(GvHttpPool, gv_http_pool, GV, HTTP_POOL, GObject)
+
+/* Methods */
+
+GvHttpPool  *gv_http_pool_new        (void);
+SoupSession *gv_http_pool_get_session(GvHttpPool *self,
+				      const gchar *user_agent,
+				      gboolean ssl_strict);
+
+/* Property accessors */
+
+guint gv_http_pool_get_n_sessions   (GvHttpPool *self);
+guint gv_http_pool_get_n_requests   (GvHttpPool *self);
+guint gv_http_pool_get_n_connections(GvHttpPool *self);
+guint gv_http_pool_get_n_reused     (GvHttpPool *self);
+guint gv_http_pool_get_n_dns_hits   (GvHttpPool *self);
+guint gv_http_pool_get_n_dns_misses (GvHttpPool *self);
@@ -0,0 +1,514 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The monitor runs one headless engine per station, so that many stations
+ * can be followed at once: metadata, playback state, errors, and optionally
+ * recording. Nothing goes to the sound card.
+ *
+ * Headless engines still decode the streams, unless the monitor is created
+ * with metadata-only set. In this case the decodebins stop as soon as the
+ * streams are parsed, and the compressed audio goes straight to a fakesink.
+ * Tags still flow, so metadata and stream information are updated, and
+ * recording works the same, as the recorder never needed decoded audio.
+ *
+ * The slots connect to the streams through the core HTTP pool, so they
+ * share its sessions, connections and DNS cache, and the connections are
+ * handed over to the engines. Beyond that, engines share what GStreamer
+ * already shares between pipelines (the default task pool, the main loop
+ * and the core bus thread), so a stalled or failing station has no effect
+ * on the other ones.
+ */
+
+#include <glib-object.h>
+#include <glib.h>
+
+#include "base/glib-object-additions.h"
+#include "base/gv-base.h"
+#include "core/gv-engine.h"
+#include "core/gv-metadata.h"
+#include "core/gv-playback.h"
+#include "core/gv-station.h"
+#include "core/gv-station-list.h"
+
+#include "core/gv-monitor.h"
+
+/*
+ * Properties
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Construct-only properties */
+	PROP_METADATA_ONLY,
+	/* Properties */
+	PROP_N_SLOTS,
+	PROP_RUNNING,
+	PROP_RECORDING,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * Signals
+ */
+
+enum {
+	SIGNAL_SLOT_CHANGED,
+	/* Number of signals */
+	SIGNAL_N
+};
+
+static guint signals[SIGNAL_N];
+
+/*
+ * Slots
+ */
+
+typedef struct {
+	GvMonitor *monitor;  /* weak */
+	guint index;
+	GvStation *station;
+	GvEngine *engine;
+	GvPlayback *playback;
+} GvMonitorSlot;
+
+static void
+gv_monitor_slot_free(GvMonitorSlot *slot)
+{
+	if (slot == NULL)
+		return;
+
+	g_signal_handlers_disconnect_by_data(slot->playback, slot);
+	gv_playback_stop(slot->playback);
+
+	g_object_unref(slot->playback);
+	g_object_unref(slot->engine);
+	g_object_unref(slot->station);
+	g_free(slot);
+}
+
+/*
+ * GObject definitions
+ */
+
+struct _GvMonitorPrivate {
+	/* Construct-only properties */
+	gboolean metadata_only;
+	/* Properties */
+	gboolean running;
+	gboolean recording;
+	/* Slots */
+	GPtrArray *slots;
+};
+
+typedef struct _GvMonitorPrivate GvMonitorPrivate;
+
+struct _GvMonitor {
+	/* Parent instance structure */
+	GObject parent_instance;
+	/* Private data */
+	GvMonitorPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GvMonitor, gv_monitor, G_TYPE_OBJECT)
+
+/*
+ * Private methods
+ */
+
+static GvMonitorSlot *
+get_slot(GvMonitor *self, guint index)
+{
+	GvMonitorPrivate *priv = self->priv;
+
+	g_return_val_if_fail(index < priv->slots->len, NULL);
+
+	return g_ptr_array_index(priv->slots, index);
+}
+
+/*
+ * Signal handlers
+ */
+
+static void
+on_slot_playback_notify(GvPlayback *playback,
+			GParamSpec *pspec,
+			GvMonitorSlot *slot)
+{
+	GvMonitor *self = slot->monitor;
+	const gchar *property_name = g_param_spec_get_name(pspec);
+	const gchar *station_name = gv_station_get_name_or_uri(slot->station);
+
+	if (!g_strcmp0(property_name, "state")) {
+		GvPlaybackState state = gv_playback_get_state(playback);
+
+		INFO("[%u] %s: %s", slot->index, station_name,
+		     gv_playback_state_to_string(state));
+
+	} else if (!g_strcmp0(property_name, "error")) {
+		GvPlaybackError *error = gv_playback_get_error(playback);
+
+		if (error == NULL)
+			return;
+
+		INFO("[%u] %s: error: %s", slot->index, station_name,
+		     error->details ? error->details : error->message);
+
+	} else if (!g_strcmp0(property_name, "metadata")) {
+		GvMetadata *metadata = gv_playback_get_metadata(playback);
+
+		if (metadata == NULL)
+			return;
+
+		INFO("[%u] %s: %s", slot->index, station_name,
+		     gv_metadata_get_title(metadata));
+
+	} else {
+		return;
+	}
+
+	g_signal_emit(self, signals[SIGNAL_SLOT_CHANGED], 0,
+		      slot->index, property_name);
+}
+
+/*
+ * Property accessors
+ */
+
+guint
+gv_monitor_get_n_slots(GvMonitor *self)
+{
+	return self->priv->slots->len;
+}
+
+GvStation *
+gv_monitor_get_station(GvMonitor *self, guint slot)
+{
+	GvMonitorSlot *s = get_slot(self, slot);
+
+	return s ? s->station : NULL;
+}
+
+GvPlayback *
+gv_monitor_get_playback(GvMonitor *self, guint slot)
+{
+	GvMonitorSlot *s = get_slot(self, slot);
+
+	return s ? s->playback : NULL;
+}
+
+GvEngine *
+gv_monitor_get_engine(GvMonitor *self, guint slot)
+{
+	GvMonitorSlot *s = get_slot(self, slot);
+
+	return s ? s->engine : NULL;
+}
+
+gboolean
+gv_monitor_get_metadata_only(GvMonitor *self)
+{
+	return self->priv->metadata_only;
+}
+
+static void
+gv_monitor_set_metadata_only(GvMonitor *self, gboolean metadata_only)
+{
+	/* Construct-only property */
+	self->priv->metadata_only = metadata_only;
+}
+
+gboolean
+gv_monitor_get_running(GvMonitor *self)
+{
+	return self->priv->running;
+}
+
+static void
+gv_monitor_set_running(GvMonitor *self, gboolean running)
+{
+	GvMonitorPrivate *priv = self->priv;
+
+	if (priv->running == running)
+		return;
+
+	priv->running = running;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RUNNING]);
+}
+
+gboolean
+gv_monitor_get_recording(GvMonitor *self)
+{
+	return self->priv->recording;
+}
+
+void
+gv_monitor_set_recording(GvMonitor *self, gboolean recording)
+{
+	GvMonitorPrivate *priv = self->priv;
+	guint i;
+
+	if (priv->recording == recording)
+		return;
+
+	for (i = 0; i < priv->slots->len; i++) {
+		GvMonitorSlot *slot = g_ptr_array_index(priv->slots, i);
+
+		gv_engine_set_recording(slot->engine, recording);
+	}
+
+	priv->recording = recording;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RECORDING]);
+}
+
+static void
+gv_monitor_get_property(GObject *object,
+			guint property_id,
+			GValue *value,
+			GParamSpec *pspec)
+{
+	GvMonitor *self = GV_MONITOR(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_METADATA_ONLY:
+		g_value_set_boolean(value, gv_monitor_get_metadata_only(self));
+		break;
+	case PROP_N_SLOTS:
+		g_value_set_uint(value, gv_monitor_get_n_slots(self));
+		break;
+	case PROP_RUNNING:
+		g_value_set_boolean(value, gv_monitor_get_running(self));
+		break;
+	case PROP_RECORDING:
+		g_value_set_boolean(value, gv_monitor_get_recording(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_monitor_set_property(GObject *object,
+			guint property_id,
+			const GValue *value,
+			GParamSpec *pspec)
+{
+	GvMonitor *self = GV_MONITOR(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_METADATA_ONLY:
+		gv_monitor_set_metadata_only(self, g_value_get_boolean(value));
+		break;
+	case PROP_RECORDING:
+		gv_monitor_set_recording(self, g_value_get_boolean(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+guint
+gv_monitor_add(GvMonitor *self, GvStation *station)
+{
+	GvMonitorPrivate *priv = self->priv;
+	GvMonitorSlot *slot;
+
+	g_return_val_if_fail(GV_IS_STATION(station), G_MAXUINT);
+
+	slot = g_new0(GvMonitorSlot, 1);
+	slot->monitor = self;
+	slot->index = priv->slots->len;
+	slot->station = g_object_ref_sink(station);
+
+	/* Latency doesn't matter when nobody listens, but memory does,
+	 * and it adds up quickly with many streams */
+	if (priv->metadata_only)
+		slot->engine = gv_engine_new_metadata_only();
+	else
+		slot->engine = gv_engine_new_headless();
+	gv_engine_set_buffering_profile(slot->engine,
+			GV_ENGINE_BUFFERING_PROFILE_LOW_LATENCY);
+	gv_engine_set_recording(slot->engine, priv->recording);
+
+	slot->playback = gv_playback_new(slot->engine);
+	gv_playback_set_fetch_streams(slot->playback, TRUE);
+	gv_playback_set_station(slot->playback, station);
+	g_signal_connect(slot->playback, "notify",
+			 G_CALLBACK(on_slot_playback_notify), slot);
+
+	g_ptr_array_add(priv->slots, slot);
+
+	INFO("[%u] Monitoring station: %s", slot->index,
+	     gv_station_get_name_or_uri(station));
+
+	if (priv->running)
+		gv_playback_start(slot->playback);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_N_SLOTS]);
+
+	return slot->index;
+}
+
+void
+gv_monitor_add_station_list(GvMonitor *self, GvStationList *station_list)
+{
+	GvStationListIter *iter;
+	GvStation *station;
+
+	iter = gv_station_list_iter_new(station_list);
+	while (gv_station_list_iter_loop(iter, &station))
+		gv_monitor_add(self, station);
+	gv_station_list_iter_free(iter);
+}
+
+void
+gv_monitor_start(GvMonitor *self)
+{
+	GvMonitorPrivate *priv = self->priv;
+	guint i;
+
+	INFO("Starting monitor (%u stations) ...", priv->slots->len);
+
+	for (i = 0; i < priv->slots->len; i++) {
+		GvMonitorSlot *slot = g_ptr_array_index(priv->slots, i);
+
+		gv_playback_start(slot->playback);
+	}
+
+	gv_monitor_set_running(self, TRUE);
+}
+
+void
+gv_monitor_stop(GvMonitor *self)
+{
+	GvMonitorPrivate *priv = self->priv;
+	guint i;
+
+	INFO("Stopping monitor ...");
+
+	for (i = 0; i < priv->slots->len; i++) {
+		GvMonitorSlot *slot = g_ptr_array_index(priv->slots, i);
+
+		gv_playback_stop(slot->playback);
+	}
+
+	gv_monitor_set_running(self, FALSE);
+}
+
+GvMonitor *
+gv_monitor_new(gboolean metadata_only)
+{
+	return g_object_new(GV_TYPE_MONITOR, "metadata-only", metadata_only, NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_monitor_finalize(GObject *object)
+{
+	GvMonitor *self = GV_MONITOR(object);
+	GvMonitorPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Free the slots, stopping the engines along the way */
+	g_ptr_array_unref(priv->slots);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_monitor, object);
+}
+
+static void
+gv_monitor_init(GvMonitor *self)
+{
+	GvMonitorPrivate *priv;
+
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_monitor_get_instance_private(self);
+
+	/* Initialize properties */
+	priv = self->priv;
+	priv->slots = g_ptr_array_new_with_free_func
+		((GDestroyNotify) gv_monitor_slot_free);
+}
+
+static void
+gv_monitor_class_init(GvMonitorClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_monitor_finalize;
+
+	/* Properties */
+	object_class->get_property = gv_monitor_get_property;
+	object_class->set_property = gv_monitor_set_property;
+
+	/* Construct-only properties */
+	properties[PROP_METADATA_ONLY] =
+		g_param_spec_boolean("metadata-only", "Metadata only",
+				     "Don't decode the streams, only follow the metadata",
+				     FALSE,
+				     GV_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+	/* Properties */
+	properties[PROP_N_SLOTS] =
+		g_param_spec_uint("n-slots", "Number of slots", NULL,
+				  0, G_MAXUINT, 0,
+				  GV_PARAM_READABLE);
+
+	properties[PROP_RUNNING] =
+		g_param_spec_boolean("running", "Running", NULL,
+				     FALSE,
+				     GV_PARAM_READABLE);
+
+	properties[PROP_RECORDING] =
+		g_param_spec_boolean("recording", "Recording", NULL,
+				     FALSE,
+				     GV_PARAM_READWRITE);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+
+	/* Signals */
+	signals[SIGNAL_SLOT_CHANGED] =
+		g_signal_new("slot-changed", G_OBJECT_CLASS_TYPE(class),
+			     G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
+			     G_TYPE_NONE, 2, G_TYPE_UINT, G_TYPE_STRING);
+}
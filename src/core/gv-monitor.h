@@ -0,0 +1,53 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "core/gv-engine.h"
+#include "core/gv-playback.h"
+#include "core/gv-station.h"
+#include "core/gv-station-list.h"
+
+/* GObject declarations */
+
+#define GV_TYPE_MONITOR gv_monitor_get_type()
+
+G_DECLARE_FINAL_TYPE(GvMonitor, gv_monitor, GV, MONITOR, GObject)
+
+/* Methods */
+
+GvMonitor *gv_monitor_new  (gboolean metadata_only);
+guint      gv_monitor_add  (GvMonitor *self, GvStation *station);
+void       gv_monitor_add_station_list(GvMonitor *self, GvStationList *station_list);
+void       gv_monitor_start(GvMonitor *self);
+void       gv_monitor_stop (GvMonitor *self);
+
+/* Property accessors */
+
+gboolean    gv_monitor_get_metadata_only(GvMonitor *self);
+guint       gv_monitor_get_n_slots  (GvMonitor *self);
+GvStation  *gv_monitor_get_station  (GvMonitor *self, guint slot);
+GvPlayback *gv_monitor_get_playback (GvMonitor *self, guint slot);
+GvEngine   *gv_monitor_get_engine   (GvMonitor *self, guint slot);
+gboolean    gv_monitor_get_running  (GvMonitor *self);
+gboolean    gv_monitor_get_recording(GvMonitor *self);
+void        gv_monitor_set_recording(GvMonitor *self, gboolean recording);
@@ -18,22 +18,39 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <gio/gio.h>
 #include <glib-object.h>
 #include <glib.h>
+#include <gst/gst.h>
+#include <libsoup/soup.h>
 
 #include "base/glib-object-additions.h"
 #include "base/gv-base.h"
 #include "core/gv-core-enum-types.h"
+#include "core/gv-core-internal.h"
 #include "core/gv-engine.h"
 #include "core/gv-metadata.h"
 #include "core/gv-playlist.h"
 #include "core/gv-station.h"
 #include "core/gv-streaminfo.h"
 #include "core/playlist-utils.h"
+#include "core/retry-utils.h"
 
 #include "core/gv-playback.h"
 
-#define RETRY_MAX_DELAY 60  // seconds
+/* A stream that played that long before failing starts the retry cycle
+ * from scratch */
+#define RETRY_RESET_DELAY 30  // seconds
+
+/* When the network changes, wait a bit for things to settle, then restart
+ * the connection if no data came in for a while */
+#define NETWORK_CHANGE_DELAY 1000  // milliseconds
+#define NETWORK_IDLE_THRESHOLD 500  // milliseconds
+
+/* When a playlist lists several streams, this many of them race, and each
+ * new contender starts that long after the previous one */
+#define RACE_MAX_CONTENDERS 3
+#define RACE_STAGGER_DELAY 250  // milliseconds
 
 /*
  * Properties
@@ -49,6 +66,7 @@ enum {
 	PROP_STREAMINFO,
 	/* Properties */
 	PROP_ERROR,
+	PROP_RETRY,
 	PROP_STATE,
 	PROP_STATION,
 	PROP_PLAYLIST,
@@ -89,15 +107,37 @@ struct _GvPlaybackPrivate {
 	gboolean playback_on;
 	guint retry_count;
 	guint retry_timeout_id;
+	GSourceFunc retry_func;
+	gboolean retry_suspended;
+	gint64 playing_since;
+	GvPlaybackRetry *retry;
+	/* Network */
+	GNetworkMonitor *network_monitor;
+	gboolean network_available;
+	guint network_timeout_id;
+	/* Pending start of the stream */
+	guint play_idle_id;
 	/* Playlist, if any */
 	GCancellable *cancellable;
 	GvPlaylist *playlist;
 	gchar *playlist_uri;
 	gchar *playlist_redirection_uri;
+	gboolean playlist_sniffing;
 	/* Stream */
 	gchar *stream_uri;
 	gchar *stream_redirection_uri;
+	gboolean stream_known_redirect;
+	gboolean stream_handed_over;
 	gboolean stream_tls_error;
+	/* Connect to streams through the HTTP pool */
+	gboolean fetch_streams;
+	GCancellable *stream_cancellable;
+	/* Streams from the playlist that were not tried yet */
+	GSList *candidates;
+	/* Race between candidates */
+	GPtrArray *contenders;
+	guint n_contenders_running;
+	guint race_timeout_id;
 };
 
 typedef struct _GvPlaybackPrivate GvPlaybackPrivate;
@@ -152,6 +192,34 @@ gv_playback_error_new(const gchar *message, const gchar *details)
 	return self;
 }
 
+/*
+ * Playback retry
+ */
+
+G_DEFINE_BOXED_TYPE(GvPlaybackRetry, gv_playback_retry,
+		    gv_playback_retry_copy, gv_playback_retry_free)
+
+void
+gv_playback_retry_free(GvPlaybackRetry *self)
+{
+	g_return_if_fail(self != NULL);
+
+	g_free(self);
+}
+
+GvPlaybackRetry *
+gv_playback_retry_copy(GvPlaybackRetry *self)
+{
+	GvPlaybackRetry *copy;
+
+	g_return_val_if_fail(self != NULL, NULL);
+
+	copy = g_new(GvPlaybackRetry, 1);
+	*copy = *self;
+
+	return copy;
+}
+
 /*
  * Playback state
  */
@@ -180,6 +248,9 @@ gv_playback_state_to_string(GvPlaybackState state)
 	case GV_PLAYBACK_STATE_WAITING_RETRY:
 		str = _("Retrying soon…");
 		break;
+	case GV_PLAYBACK_STATE_PAUSED:
+		str = _("Paused");
+		break;
 	default:
 		WARNING("Unhandled state: %d", state);
 		str = _("Stopped");
@@ -194,7 +265,7 @@ gv_playback_state_to_string(GvPlaybackState state)
  */
 
 static void start_playback(GvPlayback *self);
-static void stop_playback(GvPlayback *self);
+static void stop_playback(GvPlayback *self, gboolean crossfade);
 
 static gboolean
 when_timeout_retry(gpointer data)
@@ -210,6 +281,90 @@ when_timeout_retry(gpointer data)
 	return G_SOURCE_REMOVE;
 }
 
+/*
+ * Station history
+ */
+
+static const gchar *
+get_last_stream(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (gv_core_station_history == NULL || priv->playlist_uri == NULL)
+		return NULL;
+
+	return gv_station_history_get_stream(gv_core_station_history, priv->playlist_uri);
+}
+
+static void
+set_last_stream(GvPlayback *self, const gchar *stream_uri)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (gv_core_station_history == NULL || priv->playlist_uri == NULL)
+		return;
+
+	gv_station_history_set_stream(gv_core_station_history, priv->playlist_uri, stream_uri);
+}
+
+static void
+record_stream_failure(const gchar *stream_uri)
+{
+	if (gv_core_station_history == NULL || stream_uri == NULL)
+		return;
+
+	gv_station_history_record_failure(gv_core_station_history, stream_uri);
+}
+
+/* The stream is to blame if the server answered, or if what it sent
+ * couldn't be played. Errors that come before that, like the network
+ * being down or the name not resolving, say nothing about the stream. */
+static gboolean
+is_stream_at_fault(GvPlayback *self, GvEngine *engine, const GError *error)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (priv->network_available == FALSE)
+		return FALSE;
+
+	if (error == NULL || error->domain == GST_STREAM_ERROR)
+		return TRUE;
+
+	return gv_engine_get_http_status(engine) != 0;
+}
+
+static gboolean
+is_stream_failing(const gchar *stream_uri)
+{
+	if (gv_core_station_history == NULL)
+		return FALSE;
+
+	return gv_station_history_is_failing(gv_core_station_history, stream_uri);
+}
+
+/* Order the streams of the playlist by how they did in the past, with the
+ * one that worked last time first, and without those that keep failing */
+static GSList *
+order_candidates(GvPlayback *self, GSList *candidates)
+{
+	const gchar *last_stream;
+	GSList *item;
+
+	if (gv_core_station_history == NULL)
+		return candidates;
+
+	candidates = gv_station_history_order(gv_core_station_history, candidates);
+
+	last_stream = get_last_stream(self);
+	item = g_slist_find_custom(candidates, last_stream, (GCompareFunc) g_strcmp0);
+	if (item != NULL && item != candidates) {
+		candidates = g_slist_remove_link(candidates, item);
+		candidates = g_slist_concat(item, candidates);
+	}
+
+	return candidates;
+}
+
 /*
  * Signal handlers & callbacks
  */
@@ -222,7 +377,14 @@ static void gv_playback_set_state(GvPlayback *self, GvPlaybackState value);
 static void gv_playback_set_stream_uri(GvPlayback *self, const gchar *uri);
 static void gv_playback_set_stream_redirection_uri(GvPlayback *self, const gchar *uri);
 static void play_stream(GvPlayback *self, const gchar *uri);
-static void schedule_retry(GvPlayback *self);
+static void schedule_retry(GvPlayback *self, const GvRetryPolicy *policy);
+static void start_race(GvPlayback *self);
+static void start_early_race(GvPlayback *self, const gchar *uri);
+static void join_race(GvPlayback *self);
+static gboolean is_contending(GvPlayback *self, const gchar *uri);
+static void stop_race(GvPlayback *self);
+static gboolean fail_over(GvPlayback *self);
+static gboolean when_idle_play(GvPlayback *self);
 static void reset_playlist(GvPlayback *self);
 static void reset_retry(GvPlayback *self);
 
@@ -241,6 +403,26 @@ on_engine_bad_certificate(GvEngine *engine, GTlsCertificateFlags tls_errors, GvP
 
 }
 
+/* If we went straight to a known redirect and it never played, it might
+ * not be valid anymore, try again with the original uri */
+static gboolean
+fall_back_from_known_redirect(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (priv->stream_known_redirect == FALSE || priv->playing_since != 0)
+		return FALSE;
+
+	INFO("Known redirect failed, falling back to: %s", priv->stream_uri);
+	gv_redirect_cache_forget(gv_core_redirect_cache, priv->stream_uri);
+	priv->stream_known_redirect = FALSE;
+	gv_playback_set_stream_redirection_uri(self, NULL);
+	g_clear_handle_id(&priv->play_idle_id, g_source_remove);
+	priv->play_idle_id = g_idle_add(G_SOURCE_FUNC(when_idle_play), self);
+
+	return TRUE;
+}
+
 static void
 on_engine_end_of_stream(GvEngine *engine, GvPlayback *self)
 {
@@ -250,8 +432,15 @@ on_engine_end_of_stream(GvEngine *engine, GvPlayback *self)
 
 	gv_playback_set_error(self, _("End of stream"), NULL);
 
-	if (priv->playback_on == TRUE)
-		schedule_retry(self);
+	if (priv->playback_on == FALSE)
+		return;
+
+	/* A redirect that ends before playing is as dead as one that fails */
+	if (fall_back_from_known_redirect(self) == TRUE)
+		return;
+
+	if (fail_over(self) == FALSE)
+		schedule_retry(self, gv_get_eos_retry_policy());
 }
 
 static void
@@ -293,12 +482,33 @@ on_engine_notify(GvEngine *engine, GParamSpec *pspec, GvPlayback *self)
 		case GV_ENGINE_STATE_PLAYING:
 			playback_state = GV_PLAYBACK_STATE_PLAYING;
 			break;
+		case GV_ENGINE_STATE_PAUSED:
+			playback_state = GV_PLAYBACK_STATE_PAUSED;
+			break;
 		default:
 			ERROR("Unhandled engine state: %d", engine_state);
 			/* Program execution stops here */
 			break;
 		}
 
+		/* Remember since when we've been playing, where we were
+		 * redirected to, and how long it took, now that we know that
+		 * it works */
+		if (engine_state == GV_ENGINE_STATE_PLAYING && priv->playing_since == 0) {
+			priv->playing_since = g_get_monotonic_time();
+			if (gv_core_redirect_cache != NULL && priv->stream_redirection_uri != NULL)
+				gv_redirect_cache_learn(gv_core_redirect_cache, priv->stream_uri,
+						priv->stream_redirection_uri);
+			if (gv_core_station_history != NULL && priv->stream_uri != NULL) {
+				const GvEngineStats *stats = gv_engine_get_stats(engine);
+
+				gv_station_history_record_success(gv_core_station_history,
+						priv->stream_uri, stats->connect_time,
+						stats->first_buffer_time);
+				set_last_stream(self, priv->stream_uri);
+			}
+		}
+
 		/* Set state */
 		gv_playback_set_state(self, playback_state);
 	}
@@ -309,6 +519,7 @@ on_engine_playback_error(GvEngine *engine, GError *error, const gchar *debug,
 		GvPlayback *self)
 {
 	GvPlaybackPrivate *priv = self->priv;
+	const GvRetryPolicy *policy;
 
 	TRACE("%p, %p, %s, %p", engine, error, debug, self);
 
@@ -318,8 +529,23 @@ on_engine_playback_error(GvEngine *engine, GError *error, const gchar *debug,
 	if (priv->stream_tls_error == TRUE)
 		return;
 
-	if (priv->playback_on == TRUE)
-		schedule_retry(self);
+	if (priv->playback_on == FALSE)
+		return;
+
+	if (fall_back_from_known_redirect(self) == TRUE)
+		return;
+
+	/* A stream that never played counts as a failure, if it's to blame */
+	if (priv->playing_since == 0 && is_stream_at_fault(self, engine, error))
+		record_stream_failure(priv->stream_uri);
+
+	/* Policies that reconnect to the same stream come first, otherwise
+	 * we try the other streams of the playlist, if any, first */
+	policy = gv_find_retry_policy(error);
+	if (policy->reconnect == FALSE && fail_over(self) == TRUE)
+		return;
+
+	schedule_retry(self, policy);
 }
 
 static void
@@ -377,6 +603,37 @@ on_playlist_restarted(GvPlaylist *playlist, const gchar *uri, GvPlayback *self)
 	gv_playback_set_playlist_redirection_uri(self, uri);
 }
 
+static void
+on_playlist_stream_found(GvPlaylist *playlist, const gchar *uri, GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	const gchar *last_stream;
+
+	TRACE("%p, %s, %p", playlist, uri, self);
+
+	if (priv->stream_uri != NULL || priv->contenders->len > 0)
+		return;
+
+	/* If a stream worked last time, it goes first. Either it's this
+	 * one and we can start right away, or we wait for it. */
+	last_stream = get_last_stream(self);
+	if (last_stream != NULL) {
+		if (g_strcmp0(uri, last_stream) != 0)
+			return;
+
+		INFO("Playing last stream while the playlist downloads: %s", uri);
+		play_stream(self, uri);
+		return;
+	}
+
+	/* Wait for the whole playlist if this one keeps failing */
+	if (is_stream_failing(uri))
+		return;
+
+	/* No need to wait for the rest of the playlist to start the race */
+	start_early_race(self, uri);
+}
+
 static void
 playlist_downloaded_callback(GvPlaylist *playlist, GAsyncResult *result, GvPlayback *self)
 {
@@ -384,6 +641,7 @@ playlist_downloaded_callback(GvPlaylist *playlist, GAsyncResult *result, GvPlayb
 	GError *err = NULL;
 	const gchar *station_uri;
 	const gchar *stream_uri;
+	GSList *item;
 
 	gv_playlist_download_finish(playlist, result, &err);
 
@@ -407,9 +665,61 @@ playlist_downloaded_callback(GvPlaylist *playlist, GAsyncResult *result, GvPlayb
 	/* Check for errors we can handle */
 	if (g_error_matches(err, GV_PLAYLIST_ERROR, GV_PLAYLIST_ERROR_EXTENSION) ||
 	    g_error_matches(err, GV_PLAYLIST_ERROR, GV_PLAYLIST_ERROR_CONTENT_TYPE)) {
-		/* It's not a playlist, let's assume it's a stream */
+		GInputStream *stream;
+		gchar *redirection_uri;
+		guint icy_metaint;
+
+		/* It's not a playlist, let's assume it's a stream. If the
+		 * connection is still open, the engine takes it over. */
+		stream = gv_playlist_steal_audio_stream(playlist, &icy_metaint);
+		redirection_uri = g_strdup(priv->playlist_redirection_uri);
 		reset_playlist(self);
+		if (stream != NULL) {
+			gv_engine_hand_over(priv->engine, station_uri, stream, icy_metaint);
+			priv->stream_handed_over = TRUE;
+			g_object_unref(stream);
+		}
 		play_stream(self, station_uri);
+		if (stream != NULL)
+			gv_playback_set_stream_redirection_uri(self, redirection_uri);
+		g_free(redirection_uri);
+		goto out;
+	}
+
+	/* We were only having a look, let the engine deal with the stream */
+	if (err != NULL && priv->playlist_sniffing == TRUE && priv->stream_uri == NULL &&
+	    priv->contenders->len == 0) {
+		INFO("Failed to sniff stream: %s", err->message);
+		reset_playlist(self);
+		play_stream(self, station_uri);
+		goto out;
+	}
+
+	/* The first stream is racing or playing already, what's left of the
+	 * playlist joins the race or is there for fail-over, it's no big deal
+	 * if it's broken */
+	if (priv->stream_uri != NULL || priv->contenders->len > 0) {
+		gboolean racing = priv->contenders->len > 0;
+
+		if (err != NULL || gv_playlist_parse(playlist, &err) == FALSE) {
+			INFO("Failed to get the rest of the playlist: %s", err->message);
+			if (racing)
+				join_race(self);
+			goto out;
+		}
+
+		for (item = gv_playlist_get_stream_uris(playlist); item; item = item->next) {
+			if (!g_strcmp0(item->data, priv->stream_uri) ||
+			    g_slist_find_custom(priv->candidates, item->data,
+						(GCompareFunc) g_strcmp0) != NULL ||
+			    is_contending(self, item->data))
+				continue;
+			priv->candidates = g_slist_prepend(priv->candidates, g_strdup(item->data));
+		}
+		priv->candidates = g_slist_reverse(priv->candidates);
+		priv->candidates = order_candidates(self, priv->candidates);
+		if (racing)
+			join_race(self);
 		goto out;
 	}
 
@@ -442,8 +752,20 @@ playlist_downloaded_callback(GvPlaylist *playlist, GAsyncResult *result, GvPlayb
 		goto out;
 	}
 
-	/* At this point, we know the uri of the stream to play */
-	play_stream(self, stream_uri);
+	/* A single stream, just play it */
+	if (gv_playlist_get_stream_uris(playlist)->next == NULL) {
+		play_stream(self, stream_uri);
+		goto out;
+	}
+
+	/* Several streams, the best ones go first, then the streams race,
+	 * and the other ones are kept for fail-over */
+	for (item = gv_playlist_get_stream_uris(playlist); item; item = item->next)
+		priv->candidates = g_slist_prepend(priv->candidates, g_strdup(item->data));
+	priv->candidates = g_slist_reverse(priv->candidates);
+	priv->candidates = order_candidates(self, priv->candidates);
+
+	start_race(self);
 
 out:
 	g_clear_error(&err);
@@ -501,6 +823,27 @@ gv_playback_get_streaminfo(GvPlayback *self)
  * Property accessors
  */
 
+GvPlaybackRetry *
+gv_playback_get_retry(GvPlayback *self)
+{
+	return self->priv->retry;
+}
+
+static void
+gv_playback_set_retry(GvPlayback *self, GvPlaybackRetry *retry)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (priv->retry == NULL && retry == NULL)
+		return;
+
+	g_clear_pointer(&priv->retry, gv_playback_retry_free);
+	if (retry != NULL)
+		priv->retry = gv_playback_retry_copy(retry);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RETRY]);
+}
+
 GvPlaybackError *
 gv_playback_get_error(GvPlayback *self)
 {
@@ -558,7 +901,8 @@ gv_playback_set_station(GvPlayback *self, GvStation *station)
 	if (station == priv->station)
 		return;
 
-	stop_playback(self);
+	/* Crossfade if we're about to play another station */
+	stop_playback(self, priv->playback_on && station != NULL);
 	reset_retry(self);
 
 	g_clear_object(&priv->station);
@@ -699,6 +1043,9 @@ gv_playback_get_property(GObject *object, guint property_id, GValue *value, GPar
 		g_value_set_boxed(value, gv_playback_get_streaminfo(self));
 		break;
 	/* Properties */
+	case PROP_RETRY:
+		g_value_set_boxed(value, gv_playback_get_retry(self));
+		break;
 	case PROP_ERROR:
 		g_value_set_object(value, gv_playback_get_error(self));
 		break;
@@ -754,30 +1101,179 @@ gv_playback_set_property(GObject *object, guint property_id, const GValue *value
  */
 
 static gboolean
-when_idle_play(GvPlayback *self)
+is_http_uri(const gchar *uri)
+{
+	const gchar *scheme;
+
+	scheme = g_uri_peek_scheme(uri);
+	return !g_strcmp0(scheme, "http") || !g_strcmp0(scheme, "https");
+}
+
+static void
+start_engine(GvPlayback *self, const gchar *uri)
 {
 	GvPlaybackPrivate *priv = self->priv;
-	GvEngine *engine = priv->engine;
 	GvStation *station = priv->station;
+
+	gv_engine_play(priv->engine, uri,
+		       gv_station_get_user_agent(station),
+		       gv_station_get_insecure(station) ? FALSE : TRUE,
+		       gv_station_get_buffering_profile(station));
+}
+
+static void
+stream_fetched_callback(SoupSession *session, GAsyncResult *result, GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	GInputStream *stream;
+	SoupMessage *msg;
+	GError *err = NULL;
+	const gchar *uri;
+
+	stream = soup_session_send_finish(session, result, &err);
+
+	/* Check if we've been cancelled */
+	if (g_error_matches(err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		DEBUG("%s", err->message);
+		goto out;
+	}
+
+	g_clear_object(&priv->stream_cancellable);
+
+	msg = soup_session_get_async_result_message(session, result);
+	uri = g_object_get_data(G_OBJECT(msg), "gv-stream-uri");
+
+	/* If anything went wrong, let the engine connect by itself, it
+	 * reports errors in detail */
+	if (stream == NULL) {
+		INFO("Failed to fetch stream: %s", err->message);
+	} else if (SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)) == FALSE) {
+		INFO("Failed to fetch stream: HTTP status: %u", soup_message_get_status(msg));
+	} else {
+		SoupMessageHeaders *headers = soup_message_get_response_headers(msg);
+		const gchar *content_type;
+		const gchar *icy_metaint;
+		gchar *final_uri;
+
+		/* HLS, GStreamer must get it from the uri */
+		content_type = soup_message_headers_get_content_type(headers, NULL);
+		if (content_type != NULL && g_str_has_suffix(content_type, "mpegurl"))
+			goto play;
+
+		icy_metaint = soup_message_headers_get_one(headers, "icy-metaint");
+		gv_engine_hand_over(priv->engine, uri, stream,
+				icy_metaint ? g_ascii_strtoull(icy_metaint, NULL, 10) : 0);
+
+		final_uri = g_uri_to_string(soup_message_get_uri(msg));
+		if (g_strcmp0(final_uri, uri) != 0)
+			gv_playback_set_stream_redirection_uri(self, final_uri);
+		g_free(final_uri);
+	}
+
+play:
+	start_engine(self, uri);
+
+out:
+	g_clear_object(&stream);
+	g_clear_error(&err);
+	g_object_unref(self);
+}
+
+/* Connect to the stream through the HTTP pool, and hand the connection
+ * over to the engine, rather than letting GStreamer open its own */
+static void
+fetch_stream(GvPlayback *self, const gchar *uri, const gchar *user_agent,
+	     gboolean ssl_strict)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	SoupSession *session;
+	SoupMessage *msg;
+
+	msg = soup_message_new(SOUP_METHOD_GET, uri);
+	if (msg == NULL) {
+		start_engine(self, uri);
+		return;
+	}
+
+	DEBUG("Fetching stream: %s", uri);
+
+	soup_message_headers_append(soup_message_get_request_headers(msg),
+			"Icy-MetaData", "1");
+	g_object_set_data_full(G_OBJECT(msg), "gv-stream-uri", g_strdup(uri), g_free);
+
+	g_assert(priv->stream_cancellable == NULL);
+	priv->stream_cancellable = g_cancellable_new();
+	gv_playback_set_state(self, GV_PLAYBACK_STATE_CONNECTING);
+
+	session = gv_http_pool_get_session(gv_core_http_pool, user_agent, ssl_strict);
+	soup_session_send_async(session, msg, G_PRIORITY_DEFAULT, priv->stream_cancellable,
+			(GAsyncReadyCallback) stream_fetched_callback, g_object_ref(self));
+	g_object_unref(msg);
+}
+
+static void
+connect_stream(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	GvStation *station = priv->station;
+	const gchar *uri;
 	const gchar *user_agent;
 	gboolean ssl_strict;
+	gboolean handed_over;
+
+	/* Whatever was scheduled, it's happening now */
+	g_clear_handle_id(&priv->play_idle_id, g_source_remove);
 
 	if (priv->stream_uri == NULL) {
 		DEBUG("No stream uri");
-		goto out;
+		return;
 	}
 
 	if (priv->station == NULL) {
 		DEBUG("No station");
-		goto out;
+		return;
 	}
 
 	user_agent = gv_station_get_user_agent(station);
 	ssl_strict = gv_station_get_insecure(station) ? FALSE : TRUE;
 
-	gv_engine_play(engine, priv->stream_uri, user_agent, ssl_strict);
+	/* Skip the redirections if we know where they lead, unless the
+	 * connection was handed over, in which case they're behind us */
+	uri = priv->stream_uri;
+	priv->stream_known_redirect = FALSE;
+	handed_over = priv->stream_handed_over;
+	if (priv->stream_handed_over == TRUE) {
+		priv->stream_handed_over = FALSE;
+	} else if (gv_core_redirect_cache != NULL) {
+		const gchar *target;
+
+		target = gv_redirect_cache_lookup(gv_core_redirect_cache, uri);
+		if (target != NULL) {
+			INFO("Going straight to known redirect: %s", target);
+			gv_playback_set_stream_redirection_uri(self, target);
+			priv->stream_known_redirect = TRUE;
+			uri = target;
+		}
+	}
+
+	/* Share the connections of the HTTP pool, if asked to */
+	if (handed_over == FALSE && priv->fetch_streams == TRUE &&
+	    gv_core_http_pool != NULL && is_http_uri(uri)) {
+		fetch_stream(self, uri, user_agent, ssl_strict);
+		return;
+	}
+
+	start_engine(self, uri);
+}
+
+static gboolean
+when_idle_play(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	priv->play_idle_id = 0;
+	connect_stream(self);
 
-out:
 	return G_SOURCE_REMOVE;
 }
 
@@ -786,9 +1282,17 @@ reset_stream(GvPlayback *self)
 {
 	GvPlaybackPrivate *priv = self->priv;
 
+	if (priv->stream_cancellable != NULL)
+		g_cancellable_cancel(priv->stream_cancellable);
+	g_clear_object(&priv->stream_cancellable);
+
 	gv_playback_set_stream_uri(self, NULL);
 	gv_playback_set_stream_redirection_uri(self, NULL);
 
+	g_clear_handle_id(&priv->play_idle_id, g_source_remove);
+
+	priv->stream_known_redirect = FALSE;
+	priv->stream_handed_over = FALSE;
 	priv->stream_tls_error = FALSE;
 }
 
@@ -802,7 +1306,331 @@ play_stream(GvPlayback *self, const gchar *uri)
 
 	g_assert(priv->stream_redirection_uri == NULL);
 
-	g_idle_add(G_SOURCE_FUNC(when_idle_play), self);
+	g_clear_handle_id(&priv->play_idle_id, g_source_remove);
+	priv->play_idle_id = g_idle_add(G_SOURCE_FUNC(when_idle_play), self);
+}
+
+/*
+ * Stream race
+ *
+ * When a playlist lists several streams, the first few of them are
+ * pre-rolled in standby engines, a short while apart, and the first one that
+ * pre-rolls (ie. delivers decoded audio) wins. The others are stopped, and
+ * the winner is handed over to our engine, which takes over its pipeline
+ * rather than connecting again. Streams that were not tried, or didn't fail,
+ * are kept as candidates, so that if the winner fails later on, we fail over
+ * to them before starting the retry cycle.
+ *
+ * When the stream that worked last time is not known, the race starts with
+ * the first stream found, while the rest of the playlist downloads. The
+ * other streams join once the playlist is complete.
+ */
+
+static void launch_contender(GvPlayback *self);
+
+static gboolean
+when_idle_release_contenders(GPtrArray *contenders)
+{
+	guint i;
+
+	for (i = 0; i < contenders->len; i++)
+		gv_engine_stop(contenders->pdata[i]);
+
+	g_ptr_array_unref(contenders);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+stop_race(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	guint i;
+
+	g_clear_handle_id(&priv->race_timeout_id, g_source_remove);
+
+	if (priv->contenders->len == 0)
+		return;
+
+	for (i = 0; i < priv->contenders->len; i++)
+		g_signal_handlers_disconnect_by_data(priv->contenders->pdata[i], self);
+
+	/* We might be within a signal handler of one of the contenders,
+	 * so they're stopped and released from an idle callback */
+	g_idle_add(G_SOURCE_FUNC(when_idle_release_contenders), priv->contenders);
+	priv->contenders = g_ptr_array_new_with_free_func(g_object_unref);
+	priv->n_contenders_running = 0;
+}
+
+static void
+reset_candidates(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	stop_race(self);
+	g_slist_free_full(priv->candidates, g_free);
+	priv->candidates = NULL;
+}
+
+static gboolean
+is_contending(GvPlayback *self, const gchar *uri)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	guint i;
+
+	for (i = 0; i < priv->contenders->len; i++) {
+		GObject *contender = priv->contenders->pdata[i];
+
+		if (!g_strcmp0(g_object_get_data(contender, "gv-stream-uri"), uri))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+lose_race(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	/* Everyone failed */
+	stop_race(self);
+	gv_playback_set_error(self, _("Failed to connect to any stream"), NULL);
+	if (priv->playback_on == TRUE)
+		schedule_retry(self, gv_find_retry_policy(NULL));
+}
+
+static void
+contender_failed(GvPlayback *self, GvEngine *contender, const GError *error)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	const gchar *uri;
+
+	uri = g_object_get_data(G_OBJECT(contender), "gv-stream-uri");
+	INFO("Stream dropped out of the race: %s", uri);
+	if (is_stream_at_fault(self, contender, error))
+		record_stream_failure(uri);
+
+	/* Forget about it, it won't be a candidate again */
+	g_signal_handlers_disconnect_by_data(contender, self);
+	priv->n_contenders_running--;
+
+	/* Let the next candidate in, right away */
+	if (priv->candidates != NULL) {
+		launch_contender(self);
+		return;
+	}
+
+	if (priv->n_contenders_running > 0)
+		return;
+
+	/* More streams might come with the rest of the playlist */
+	if (priv->cancellable != NULL)
+		return;
+
+	lose_race(self);
+}
+
+static void
+on_contender_playback_error(GvEngine *contender, GError *error,
+			    const gchar *debug G_GNUC_UNUSED, GvPlayback *self)
+{
+	contender_failed(self, contender, error);
+}
+
+static void
+on_contender_end_of_stream(GvEngine *contender, GvPlayback *self)
+{
+	contender_failed(self, contender, NULL);
+}
+
+static void
+on_contender_notify_prerolled(GvEngine *contender, GParamSpec *pspec G_GNUC_UNUSED,
+			      GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	gchar *winner;
+	GSList *losers = NULL;
+	guint i;
+
+	if (gv_engine_get_prerolled(contender) == FALSE)
+		return;
+
+	winner = g_strdup(g_object_get_data(G_OBJECT(contender), "gv-stream-uri"));
+	INFO("Stream won the race: %s", winner);
+
+	/* Remember the winner for the next time */
+	set_last_stream(self, winner);
+
+	/* Contenders still running go back to the candidates, first */
+	for (i = 0; i < priv->contenders->len; i++) {
+		GvEngine *engine = priv->contenders->pdata[i];
+
+		if (engine == contender || gv_engine_get_state(engine) == GV_ENGINE_STATE_STOPPED)
+			continue;
+
+		losers = g_slist_prepend(losers, g_strdup(g_object_get_data(G_OBJECT(engine),
+						"gv-stream-uri")));
+	}
+	priv->candidates = g_slist_concat(g_slist_reverse(losers), priv->candidates);
+
+	/* Hand the winner over to our engine, its pipeline is taken over
+	 * when the stream is played, and it must outlive the race */
+	g_object_ref(contender);
+	g_signal_handlers_disconnect_by_data(contender, self);
+	g_ptr_array_remove(priv->contenders, contender);
+	priv->n_contenders_running--;
+	gv_engine_set_standby(priv->engine, contender);
+	g_object_unref(contender);
+	stop_race(self);
+
+	/* Play the winner for real. The redirections, if any, are behind us,
+	 * as for a connection that was handed over. */
+	play_stream(self, winner);
+	priv->stream_handed_over = TRUE;
+	g_free(winner);
+}
+
+static void
+launch_contender(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	GvStation *station = priv->station;
+	GvEngine *contender;
+	gchar *uri;
+
+	g_assert(priv->candidates != NULL);
+
+	uri = priv->candidates->data;
+	priv->candidates = g_slist_delete_link(priv->candidates, priv->candidates);
+
+	INFO("Stream joining the race: %s", uri);
+
+	contender = gv_engine_preroll_new(priv->engine, uri,
+			gv_station_get_user_agent(station),
+			gv_station_get_insecure(station) ? FALSE : TRUE);
+	g_object_set_data_full(G_OBJECT(contender), "gv-stream-uri", uri, g_free);
+	g_ptr_array_add(priv->contenders, contender);
+	priv->n_contenders_running++;
+
+	g_signal_connect_object(contender, "notify::prerolled",
+			G_CALLBACK(on_contender_notify_prerolled), self, 0);
+	g_signal_connect_object(contender, "playback-error",
+			G_CALLBACK(on_contender_playback_error), self, 0);
+	g_signal_connect_object(contender, "end-of-stream",
+			G_CALLBACK(on_contender_end_of_stream), self, 0);
+}
+
+static gboolean
+when_timeout_launch_contender(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (priv->candidates == NULL ||
+	    priv->n_contenders_running >= RACE_MAX_CONTENDERS) {
+		priv->race_timeout_id = 0;
+		return G_SOURCE_REMOVE;
+	}
+
+	launch_contender(self);
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+start_race(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	g_assert(priv->candidates != NULL);
+	g_assert(priv->contenders->len == 0);
+
+	/* Only one left, no need to race */
+	if (priv->candidates->next == NULL) {
+		gchar *uri = priv->candidates->data;
+
+		priv->candidates = g_slist_delete_link(priv->candidates, priv->candidates);
+		play_stream(self, uri);
+		g_free(uri);
+		return;
+	}
+
+	INFO("Starting a race between %u streams", g_slist_length(priv->candidates));
+
+	gv_playback_set_state(self, GV_PLAYBACK_STATE_CONNECTING);
+
+	launch_contender(self);
+	priv->race_timeout_id = g_timeout_add(RACE_STAGGER_DELAY,
+			G_SOURCE_FUNC(when_timeout_launch_contender), self);
+}
+
+/* Start the race with the first stream found, the others join later on */
+static void
+start_early_race(GvPlayback *self, const gchar *uri)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	g_assert(priv->candidates == NULL);
+	g_assert(priv->contenders->len == 0);
+
+	INFO("Starting a race while the playlist downloads");
+
+	priv->candidates = g_slist_prepend(NULL, g_strdup(uri));
+	gv_playback_set_state(self, GV_PLAYBACK_STATE_CONNECTING);
+	launch_contender(self);
+}
+
+/* The rest of the playlist came in, let the other streams join the race */
+static void
+join_race(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (priv->candidates == NULL) {
+		if (priv->n_contenders_running == 0)
+			lose_race(self);
+		return;
+	}
+
+	if (priv->n_contenders_running == 0)
+		launch_contender(self);
+
+	if (priv->race_timeout_id == 0)
+		priv->race_timeout_id = g_timeout_add(RACE_STAGGER_DELAY,
+				G_SOURCE_FUNC(when_timeout_launch_contender), self);
+}
+
+static gboolean
+when_idle_start_race(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	priv->race_timeout_id = 0;
+	start_race(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+fail_over(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	if (priv->candidates == NULL)
+		return FALSE;
+
+	INFO("Stream failed, trying the other streams of the playlist");
+
+	/* The stream that worked last time is not that good after all */
+	if (!g_strcmp0(get_last_stream(self), priv->stream_uri))
+		set_last_stream(self, NULL);
+
+	/* Let the engine finish stopping first */
+	reset_stream(self);
+	g_clear_handle_id(&priv->race_timeout_id, g_source_remove);
+	priv->race_timeout_id = g_idle_add(G_SOURCE_FUNC(when_idle_start_race), self);
+
+	return TRUE;
 }
 
 static void
@@ -817,10 +1645,12 @@ reset_playlist(GvPlayback *self)
 	gv_playback_set_playlist(self, NULL);
 	gv_playback_set_playlist_uri(self, NULL);
 	gv_playback_set_playlist_redirection_uri(self, NULL);
+	priv->playlist_sniffing = FALSE;
 }
 
 static void
-download_playlist(GvPlayback *self, const gchar *uri, const gchar *user_agent)
+download_playlist(GvPlayback *self, const gchar *uri, const gchar *user_agent,
+		  gboolean ssl_strict)
 {
 	GvPlaybackPrivate *priv = self->priv;
 	GvPlaylist *playlist;
@@ -842,8 +1672,10 @@ download_playlist(GvPlayback *self, const gchar *uri, const gchar *user_agent)
 			G_CALLBACK(on_playlist_accept_certificate), self, 0);
 	g_signal_connect_object(playlist, "restarted",
 			G_CALLBACK(on_playlist_restarted), self, 0);
+	g_signal_connect_object(playlist, "stream-found",
+			G_CALLBACK(on_playlist_stream_found), self, 0);
 
-	gv_playlist_download_async(playlist, uri, user_agent, priv->cancellable,
+	gv_playlist_download_async(playlist, uri, user_agent, ssl_strict, priv->cancellable,
 			(GAsyncReadyCallback) playlist_downloaded_callback, self);
 }
 
@@ -853,47 +1685,181 @@ reset_retry(GvPlayback *self)
 	GvPlaybackPrivate *priv = self->priv;
 
 	g_clear_handle_id(&priv->retry_timeout_id, g_source_remove);
+	priv->retry_suspended = FALSE;
 	priv->retry_count = 0;
+	priv->playing_since = 0;
+	gv_playback_set_retry(self, NULL);
+}
+
+static gboolean
+when_timeout_reconnect(gpointer data)
+{
+	GvPlayback *self = GV_PLAYBACK(data);
+	GvPlaybackPrivate *priv = self->priv;
+
+	priv->retry_timeout_id = 0;
+
+	if (priv->playback_on == TRUE)
+		connect_stream(self);
+
+	return G_SOURCE_REMOVE;
 }
 
 static void
-schedule_retry(GvPlayback *self)
+schedule_retry(GvPlayback *self, const GvRetryPolicy *policy)
 {
 	GvPlaybackPrivate *priv = self->priv;
+	GvPlaybackRetry retry;
+	gint64 now = g_get_monotonic_time();
 	guint delay;
 
 	/* We retry playback after there's been a failure of some sort.
-	 * We don't know what kind of failure, maybe the network is down,
-	 * or the server is down, and in any case we don't want to retry
-	 * asap. We need to wait a bit, and increase the waiting time for
-	 * each retry.
+	 * The policy tells how long we should wait, depending on what the
+	 * failure was, and when to give up.
 	 */
 
 	/* If a retry is already scheduled, bail out */
-	if (priv->retry_timeout_id != 0)
+	if (priv->retry_timeout_id != 0 || priv->retry_suspended == TRUE)
 		return;
 
+	/* If we played for a while, it's a new failure, not the same one */
+	if (priv->playing_since != 0 &&
+	    now - priv->playing_since >= RETRY_RESET_DELAY * G_USEC_PER_SEC)
+		priv->retry_count = 0;
+	priv->playing_since = 0;
+
 	/* Increase the retry counter */
 	priv->retry_count++;
-	delay = priv->retry_count;
-	if (delay > RETRY_MAX_DELAY)
-		delay = RETRY_MAX_DELAY;
 
-	INFO("Restarting playback in %u seconds", delay);
-	priv->retry_timeout_id = g_timeout_add_seconds(delay, when_timeout_retry, self);
+	retry = (GvPlaybackRetry) {
+		.policy = policy->name,
+		.attempt = priv->retry_count,
+		.max_attempts = policy->max_attempts,
+	};
+
+	/* Give up, for good. The playback is stopped, but the error that
+	 * got us there stays, it was notified already. */
+	if (policy->max_attempts > 0 && priv->retry_count > policy->max_attempts) {
+		GvPlaybackError *error;
+
+		INFO("Giving up after %u attempts (%s)", policy->max_attempts,
+		     policy->name);
+		gv_playback_set_retry(self, &retry);
+		error = g_steal_pointer(&priv->error);
+		priv->playback_on = FALSE;
+		stop_playback(self, FALSE);
+		priv->error = error;
+		return;
+	}
+
+	priv->retry_func = policy->reconnect ? when_timeout_reconnect : when_timeout_retry;
+
+	/* No need to try while the network is down, we'll try again as
+	 * soon as it's back */
+	if (priv->network_available == FALSE) {
+		INFO("Network is unreachable, waiting for it to come back");
+		priv->retry_suspended = TRUE;
+		gv_playback_set_retry(self, &retry);
+		gv_playback_set_state(self, GV_PLAYBACK_STATE_WAITING_RETRY);
+		return;
+	}
+
+	delay = gv_get_retry_delay(policy, priv->retry_count);
+	retry.delay = delay;
+	retry.time = now + (gint64) delay * 1000;
+	gv_playback_set_retry(self, &retry);
+
+	INFO("%s in %u ms (%s, attempt %u)",
+	     policy->reconnect ? "Reconnecting to stream" : "Restarting playback",
+	     delay, policy->name, priv->retry_count);
+	priv->retry_timeout_id = g_timeout_add(delay, priv->retry_func, self);
 
 	gv_playback_set_state(self, GV_PLAYBACK_STATE_WAITING_RETRY);
 }
 
+static gboolean
+when_timeout_network_changed(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+	GvEngineState engine_state;
+	gint64 idle_time;
+
+	priv->network_timeout_id = 0;
+
+	if (priv->playback_on == FALSE)
+		return G_SOURCE_REMOVE;
+
+	/* A retry is pending, no need to wait any longer */
+	if (priv->retry_timeout_id != 0 || priv->retry_suspended == TRUE) {
+		INFO("Network changed, retrying now");
+		g_clear_handle_id(&priv->retry_timeout_id, g_source_remove);
+		priv->retry_suspended = FALSE;
+		priv->retry_timeout_id = g_idle_add(priv->retry_func, self);
+		return G_SOURCE_REMOVE;
+	}
+
+	/* The playlist download (or the first look at the stream) might be
+	 * stuck on the previous route, unless a stream is playing already */
+	if (priv->cancellable != NULL && priv->stream_uri == NULL) {
+		INFO("Network changed, downloading the playlist again");
+		start_playback(self);
+		return G_SOURCE_REMOVE;
+	}
+
+	/* So might be the stream. If data still comes in, it's not. */
+	engine_state = gv_engine_get_state(priv->engine);
+	if (engine_state != GV_ENGINE_STATE_CONNECTING &&
+	    engine_state != GV_ENGINE_STATE_BUFFERING &&
+	    engine_state != GV_ENGINE_STATE_PLAYING)
+		return G_SOURCE_REMOVE;
+
+	idle_time = gv_engine_get_data_idle_time(priv->engine);
+	if (idle_time < NETWORK_IDLE_THRESHOLD * 1000)
+		return G_SOURCE_REMOVE;
+
+	INFO("Network changed, no data for %" G_GINT64_FORMAT " ms, reconnecting",
+	     idle_time / 1000);
+	connect_stream(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_network_changed(GNetworkMonitor *monitor,
+		   gboolean available,
+		   GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	TRACE("%p, %s, %p", monitor, available ? "available" : "unavailable", self);
+
+	if (priv->network_available != available)
+		INFO("Network is %s", available ? "available" : "unreachable");
+
+	priv->network_available = available;
+	g_clear_handle_id(&priv->network_timeout_id, g_source_remove);
+
+	if (available == FALSE)
+		return;
+
+	/* Network changes tend to come in bursts */
+	priv->network_timeout_id = g_timeout_add(NETWORK_CHANGE_DELAY,
+			G_SOURCE_FUNC(when_timeout_network_changed), self);
+}
+
 static void
-stop_playback(GvPlayback *self)
+stop_playback(GvPlayback *self, gboolean crossfade)
 {
 	GvPlaybackPrivate *priv = self->priv;
 
 	/* Stop engine (if ever it was started) */
-	gv_engine_stop(priv->engine);
+	if (crossfade == TRUE)
+		gv_engine_crossfade_stop(priv->engine);
+	else
+		gv_engine_stop(priv->engine);
 
 	/* Reset stream and playlist */
+	reset_candidates(self);
 	reset_stream(self);
 	reset_playlist(self);
 
@@ -913,10 +1879,11 @@ start_playback(GvPlayback *self)
 	GError *err = NULL;
 	const gchar *station_uri;
 	const gchar *user_agent;
+	gboolean ssl_strict;
 	gboolean ret;
 
-	/* Stop playback first */
-	stop_playback(self);
+	/* Stop playback first, crossfade if there's something to play next */
+	stop_playback(self, station != NULL);
 
 	/* Bail out if no station is set */
 	if (station == NULL)
@@ -925,12 +1892,23 @@ start_playback(GvPlayback *self)
 	/* Get station details */
 	station_uri = gv_station_get_uri(station);
 	user_agent = gv_station_get_user_agent(station);
+	ssl_strict = gv_station_get_insecure(station) ? FALSE : TRUE;
 
 	INFO("Station uri: %s", station_uri);
 
 	/* Try to guess whether it's a playlist or an audio stream */
 	ret = gv_playlist_format_from_uri(station_uri, &format, &err);
-	if (ret == FALSE) {
+	if (ret == FALSE && is_http_uri(station_uri)) {
+		/* Can't tell from the uri */
+		INFO("Can't get playlist format from uri: %s", err->message);
+		g_clear_error(&err);
+
+		/* One request tells, and if it's an audio stream, the
+		 * connection is handed over to the engine */
+		download_playlist(self, station_uri, user_agent, ssl_strict);
+		priv->playlist_sniffing = TRUE;
+		gv_playback_set_state(self, GV_PLAYBACK_STATE_CONNECTING);
+	} else if (ret == FALSE) {
 		/* Not a playlist */
 		INFO("Can't get playlist format from uri: %s", err->message);
 		g_clear_error(&err);
@@ -945,7 +1923,7 @@ start_playback(GvPlayback *self)
 				gv_playlist_format_to_string(format));
 
 		/* Download it */
-		download_playlist(self, station_uri, user_agent);
+		download_playlist(self, station_uri, user_agent, ssl_strict);
 		gv_playback_set_state(self, GV_PLAYBACK_STATE_DOWNLOADING_PLAYLIST);
 	}
 }
@@ -965,12 +1943,33 @@ gv_playback_stop(GvPlayback *self)
 	priv->playback_on = FALSE;
 
 	/* Stop playback */
-	stop_playback(self);
+	stop_playback(self, FALSE);
 
 	/* Reset retry */
 	reset_retry(self);
 }
 
+gboolean
+gv_playback_pause(GvPlayback *self)
+{
+	GvPlaybackPrivate *priv = self->priv;
+
+	/* Only possible if the engine can resume the stream later on,
+	 * otherwise it's up to the caller to stop the playback */
+	if (gv_engine_pause(priv->engine) == FALSE)
+		return FALSE;
+
+	INFO("Pausing playback ...");
+
+	/* Remember what we're doing */
+	priv->playback_on = FALSE;
+
+	/* Reset retry */
+	reset_retry(self);
+
+	return TRUE;
+}
+
 void
 gv_playback_start(GvPlayback *self)
 {
@@ -983,13 +1982,33 @@ gv_playback_start(GvPlayback *self)
 		return;
 	}
 
+	/* Start the retry cycle from scratch, if we gave up before */
+	if (priv->playback_on == FALSE)
+		reset_retry(self);
+
 	/* Remember what we're doing */
 	priv->playback_on = TRUE;
 
+	/* Resume the stream if it was paused. Changing station stops the
+	 * engine, so a paused engine is still playing our station. */
+	if (gv_engine_get_state(priv->engine) == GV_ENGINE_STATE_PAUSED) {
+		gv_engine_resume(priv->engine);
+		return;
+	}
+
 	/* Start playback */
 	start_playback(self);
 }
 
+/* By default GStreamer opens its own connections to the streams. With
+ * this set, connections go through the HTTP pool, and are handed over
+ * to the engine. Takes effect with the next stream played. */
+void
+gv_playback_set_fetch_streams(GvPlayback *self, gboolean fetch)
+{
+	self->priv->fetch_streams = fetch;
+}
+
 GvPlayback *
 gv_playback_new(GvEngine *engine)
 {
@@ -1011,6 +2030,7 @@ gv_playback_finalize(GObject *object)
 	/* Free the stream details */
 	g_free(priv->stream_uri);
 	g_free(priv->stream_redirection_uri);
+	g_clear_object(&priv->stream_cancellable);
 
 	/* Cancel playlist download */
 	if (priv->cancellable)
@@ -1024,10 +2044,21 @@ gv_playback_finalize(GObject *object)
 
 	/* Remove pending operations */
 	g_clear_handle_id(&priv->retry_timeout_id, g_source_remove);
+	g_clear_handle_id(&priv->network_timeout_id, g_source_remove);
+	g_clear_handle_id(&priv->play_idle_id, g_source_remove);
 
-	/* Free the playback error */
+	/* Stop watching the network */
+	g_clear_object(&priv->network_monitor);
+
+	/* Stop the race, if any */
+	reset_candidates(self);
+	g_ptr_array_unref(priv->contenders);
+
+	/* Free the playback error and retry */
 	if (priv->error)
 		gv_playback_error_free(priv->error);
+	if (priv->retry)
+		gv_playback_retry_free(priv->retry);
 
 	/* Unref the current station */
 	if (priv->station)
@@ -1051,6 +2082,12 @@ gv_playback_constructed(GObject *object)
 	/* Ensure construct-only properties have been set */
 	g_assert(priv->engine != NULL);
 
+	/* Watch the network */
+	priv->network_monitor = g_object_ref(g_network_monitor_get_default());
+	priv->network_available = g_network_monitor_get_network_available(priv->network_monitor);
+	g_signal_connect_object(priv->network_monitor, "network-changed",
+			G_CALLBACK(on_network_changed), self, 0);
+
 	/* Chain up */
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_playback, object);
 }
@@ -1062,6 +2099,9 @@ gv_playback_init(GvPlayback *self)
 
 	/* Initialize private pointer */
 	self->priv = gv_playback_get_instance_private(self);
+
+	/* Initialize the stream race */
+	self->priv->contenders = g_ptr_array_new_with_free_func(g_object_unref);
 }
 
 static void
@@ -1102,6 +2142,11 @@ gv_playback_class_init(GvPlaybackClass *class)
 				   GV_TYPE_PLAYBACK_ERROR,
 				   GV_PARAM_READABLE);
 
+	properties[PROP_RETRY] =
+		g_param_spec_boxed("retry", "Retry", NULL,
+				   GV_TYPE_PLAYBACK_RETRY,
+				   GV_PARAM_READABLE);
+
 	properties[PROP_STATE] =
 		g_param_spec_enum("state", "State", NULL,
 				  GV_TYPE_PLAYBACK_STATE,
@@ -43,6 +43,7 @@ typedef enum {
 	GV_PLAYBACK_STATE_BUFFERING,
 	GV_PLAYBACK_STATE_PLAYING,
 	GV_PLAYBACK_STATE_WAITING_RETRY,
+	GV_PLAYBACK_STATE_PAUSED,
 } GvPlaybackState;
 
 const gchar *gv_playback_state_to_string(GvPlaybackState);
@@ -64,11 +65,32 @@ GvPlaybackError *gv_playback_error_new (const gchar *message, const gchar *detai
 GvPlaybackError *gv_playback_error_copy(GvPlaybackError *self);
 void             gv_playback_error_free(GvPlaybackError *self);
 
+/* Playback retry */
+
+#define GV_TYPE_PLAYBACK_RETRY gv_playback_retry_get_type()
+
+GType gv_playback_retry_get_type(void) G_GNUC_CONST;
+
+typedef struct _GvPlaybackRetry GvPlaybackRetry;
+
+struct _GvPlaybackRetry {
+	const gchar *policy;  /* name of the retry policy */
+	guint attempt;
+	guint max_attempts;   /* zero if there's no limit */
+	guint delay;          /* milliseconds, zero if we gave up */
+	gint64 time;          /* monotonic time of the attempt, zero if we gave up */
+};
+
+GvPlaybackRetry *gv_playback_retry_copy(GvPlaybackRetry *self);
+void             gv_playback_retry_free(GvPlaybackRetry *self);
+
 /* Methods */
 
 GvPlayback *gv_playback_new  (GvEngine *engine);
 void        gv_playback_start(GvPlayback *self);
 void        gv_playback_stop (GvPlayback *self);
+gboolean    gv_playback_pause(GvPlayback *self);
+void        gv_playback_set_fetch_streams(GvPlayback *self, gboolean fetch);
 
 /* Property accessors */
 
@@ -76,6 +98,7 @@ GvStation       *gv_playback_get_station        (GvPlayback *self);
 void             gv_playback_set_station        (GvPlayback *self, GvStation *station);
 GvPlaybackState  gv_playback_get_state          (GvPlayback *self);
 GvPlaybackError *gv_playback_get_error          (GvPlayback *self);
+GvPlaybackRetry *gv_playback_get_retry          (GvPlayback *self);
 GvMetadata      *gv_playback_get_metadata       (GvPlayback *self);
 GvStreaminfo    *gv_playback_get_streaminfo     (GvPlayback *self);
 GvPlaylist      *gv_playback_get_playlist       (GvPlayback *self);
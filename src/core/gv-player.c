@@ -26,9 +26,11 @@
 #include "base/glib-object-additions.h"
 #include "base/gv-base.h"
 #include "core/gv-core-enum-types.h"
+#include "core/gv-core.h"
 #include "core/gv-core-internal.h"
 #include "core/gv-engine.h"
 #include "core/gv-playback.h"
+#include "core/gv-playlist.h"
 #include "core/gv-station-list.h"
 #include "core/gv-station.h"
 
@@ -43,6 +45,12 @@
 #define DEFAULT_REPEAT	 FALSE
 #define DEFAULT_SHUFFLE	 FALSE
 #define DEFAULT_AUTOPLAY FALSE
+#define DEFAULT_STANDBY_ENABLED FALSE
+#define DEFAULT_STANDBY_MAX_BITRATE 128 // kbps
+
+/* Delay between the moment the current station starts playing, and the
+ * moment we start pre-rolling the next station */
+#define STANDBY_DELAY 2 // seconds
 
 enum {
 	/* Reserved */
@@ -56,11 +64,22 @@ enum {
 	PROP_MUTE,
 	PROP_PIPELINE_ENABLED,
 	PROP_PIPELINE_STRING,
+	PROP_BUFFERING_PROFILE,
+	PROP_STATS,
+	PROP_CROSSFADE_DURATION,
+	PROP_TIMESHIFT_WINDOW,
+	PROP_STALL_TIMEOUT,
+	PROP_HLS_POLICY,
+	PROP_HLS_MAX_BITRATE,
+	PROP_RECORDING,
+	PROP_RECORDING_DIRECTORY,
 	/* Properties */
 	PROP_PLAYING,
 	PROP_REPEAT,
 	PROP_SHUFFLE,
 	PROP_AUTOPLAY,
+	PROP_STANDBY_ENABLED,
+	PROP_STANDBY_MAX_BITRATE,
 	PROP_STATION,
 	PROP_STATION_URI,
 	PROP_PREV_STATION,
@@ -85,7 +104,11 @@ struct _GvPlayerPrivate {
 	gboolean repeat;
 	gboolean shuffle;
 	gboolean autoplay;
+	gboolean standby_enabled;
+	guint standby_max_bitrate;
 	GvStation *station;
+	/* Standby */
+	guint standby_timeout_id;
 };
 
 typedef struct _GvPlayerPrivate GvPlayerPrivate;
@@ -104,10 +127,143 @@ G_DEFINE_TYPE_WITH_CODE(GvPlayer, gv_player, G_TYPE_OBJECT,
 			G_IMPLEMENT_INTERFACE(GV_TYPE_CONFIGURABLE,
 					      gv_player_configurable_interface_init))
 
+/*
+ * Standby engine
+ */
+
+static void
+preroll_next_station(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+	GvPlaylistFormat format;
+	GvStation *station;
+	const gchar *uri;
+	const gchar *user_agent;
+	gboolean ssl_strict;
+
+	station = gv_player_get_next_station(self);
+	if (station == NULL || station == priv->station) {
+		gv_engine_cancel_preroll(priv->engine);
+		return;
+	}
+
+	/* Only audio streams are pre-rolled. For playlists, we would need to
+	 * download the playlist first, which is what GvPlayback does. */
+	uri = gv_station_get_uri(station);
+	if (gv_playlist_format_from_uri(uri, &format, NULL) == TRUE) {
+		DEBUG("Next station is a playlist, not pre-rolling: %s", uri);
+		gv_engine_cancel_preroll(priv->engine);
+		return;
+	}
+
+	user_agent = gv_station_get_user_agent(station);
+	ssl_strict = gv_station_get_insecure(station) ? FALSE : TRUE;
+
+	gv_engine_preroll(priv->engine, uri, user_agent, ssl_strict,
+			  priv->standby_max_bitrate);
+}
+
+static gboolean
+when_timeout_preroll(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	priv->standby_timeout_id = 0;
+
+	if (priv->playing == TRUE)
+		preroll_next_station(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+cancel_standby(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	g_clear_handle_id(&priv->standby_timeout_id, g_source_remove);
+	gv_engine_cancel_preroll(priv->engine);
+}
+
+static void
+schedule_standby(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	g_clear_handle_id(&priv->standby_timeout_id, g_source_remove);
+
+	if (priv->standby_enabled == FALSE)
+		return;
+
+	if (priv->playing == FALSE)
+		return;
+
+	if (gv_playback_get_state(priv->playback) != GV_PLAYBACK_STATE_PLAYING)
+		return;
+
+	priv->standby_timeout_id = g_timeout_add_seconds(STANDBY_DELAY,
+			G_SOURCE_FUNC(when_timeout_preroll), self);
+}
+
+static void
+reschedule_standby(GvPlayer *self)
+{
+	/* The next station might have changed, so whatever is standing by
+	 * is not relevant anymore */
+	cancel_standby(self);
+	schedule_standby(self);
+}
+
 /*
  * Signal handlers
  */
 
+static void gv_player_set_playing(GvPlayer *self, gboolean playing);
+
+static void
+on_playback_notify(GvPlayback *playback, GParamSpec *pspec, GvPlayer *self)
+{
+	const gchar *property_name = g_param_spec_get_name(pspec);
+
+	TRACE("%p, %s, %p", playback, property_name, self);
+
+	/* We don't cancel the standby engine when the playback stops, as
+	 * it's exactly when we switch to the next station, and it's the
+	 * moment where we need the standby engine to be ready. */
+	if (!g_strcmp0(property_name, "state")) {
+		GvPlaybackState state = gv_playback_get_state(playback);
+
+		if (state == GV_PLAYBACK_STATE_PLAYING)
+			schedule_standby(self);
+
+		/* The playback stops by itself when it gives up retrying */
+		if (state == GV_PLAYBACK_STATE_STOPPED) {
+			GvPlaybackRetry *retry = gv_playback_get_retry(playback);
+
+			if (retry != NULL && retry->max_attempts > 0 &&
+			    retry->attempt > retry->max_attempts)
+				gv_player_set_playing(self, FALSE);
+		}
+	}
+}
+
+static void
+on_station_list_changed(GvStationList *station_list, GvPlayer *self)
+{
+	TRACE("%p, %p", station_list, self);
+
+	reschedule_standby(self);
+}
+
+static void
+on_station_list_station_changed(GvStationList *station_list, GvStation *station,
+				GvPlayer *self)
+{
+	TRACE("%p, %p, %p", station_list, station, self);
+
+	reschedule_standby(self);
+}
+
 typedef struct {
 	const gchar *name;
 	guint        id;
@@ -118,6 +274,15 @@ static const PropertyMapping engine_mappings[] = {
 	{ "mute", PROP_MUTE },
 	{ "pipeline-enabled", PROP_PIPELINE_ENABLED },
 	{ "pipeline-string", PROP_PIPELINE_STRING },
+	{ "buffering-profile", PROP_BUFFERING_PROFILE },
+	{ "stats", PROP_STATS },
+	{ "crossfade-duration", PROP_CROSSFADE_DURATION },
+	{ "timeshift-window", PROP_TIMESHIFT_WINDOW },
+	{ "stall-timeout", PROP_STALL_TIMEOUT },
+	{ "hls-policy", PROP_HLS_POLICY },
+	{ "hls-max-bitrate", PROP_HLS_MAX_BITRATE },
+	{ "recording", PROP_RECORDING },
+	{ "recording-directory", PROP_RECORDING_DIRECTORY },
 	{ NULL, 0 },
 };
 
@@ -164,6 +329,9 @@ gv_player_set_playback(GvPlayer *self, GvPlayback *playback)
 	g_assert(priv->playback == NULL);
 	g_assert(playback != NULL);
 	priv->playback = g_object_ref(playback);
+
+	/* Some signal handlers */
+	g_signal_connect_object(playback, "notify", G_CALLBACK(on_playback_notify), self, 0);
 }
 
 static void
@@ -175,6 +343,20 @@ gv_player_set_station_list(GvPlayer *self, GvStationList *station_list)
 	g_assert(priv->station_list == NULL);
 	g_assert(station_list != NULL);
 	priv->station_list = g_object_ref(station_list);
+
+	/* Some signal handlers */
+	g_signal_connect_object(station_list, "loaded",
+				G_CALLBACK(on_station_list_changed), self, 0);
+	g_signal_connect_object(station_list, "emptied",
+				G_CALLBACK(on_station_list_changed), self, 0);
+	g_signal_connect_object(station_list, "station-added",
+				G_CALLBACK(on_station_list_station_changed), self, 0);
+	g_signal_connect_object(station_list, "station-removed",
+				G_CALLBACK(on_station_list_station_changed), self, 0);
+	g_signal_connect_object(station_list, "station-modified",
+				G_CALLBACK(on_station_list_station_changed), self, 0);
+	g_signal_connect_object(station_list, "station-moved",
+				G_CALLBACK(on_station_list_station_changed), self, 0);
 }
 
 /*
@@ -279,6 +461,166 @@ gv_player_set_pipeline_string(GvPlayer *self, const gchar *pipeline_string)
 	gv_engine_set_pipeline_string(engine, pipeline_string);
 }
 
+GvEngineBufferingProfile
+gv_player_get_buffering_profile(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_buffering_profile(engine);
+}
+
+void
+gv_player_set_buffering_profile(GvPlayer *self, GvEngineBufferingProfile profile)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_buffering_profile(engine, profile);
+}
+
+const GvEngineStats *
+gv_player_get_stats(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_stats(engine);
+}
+
+guint
+gv_player_get_crossfade_duration(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_crossfade_duration(engine);
+}
+
+void
+gv_player_set_crossfade_duration(GvPlayer *self, guint duration)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_crossfade_duration(engine, duration);
+}
+
+guint
+gv_player_get_timeshift_window(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_timeshift_window(engine);
+}
+
+void
+gv_player_set_timeshift_window(GvPlayer *self, guint window)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_timeshift_window(engine, window);
+}
+
+guint
+gv_player_get_stall_timeout(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_stall_timeout(engine);
+}
+
+void
+gv_player_set_stall_timeout(GvPlayer *self, guint timeout)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_stall_timeout(engine, timeout);
+}
+
+GvEngineHlsPolicy
+gv_player_get_hls_policy(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_hls_policy(engine);
+}
+
+void
+gv_player_set_hls_policy(GvPlayer *self, GvEngineHlsPolicy policy)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_hls_policy(engine, policy);
+}
+
+guint
+gv_player_get_hls_max_bitrate(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_hls_max_bitrate(engine);
+}
+
+void
+gv_player_set_hls_max_bitrate(GvPlayer *self, guint max_bitrate)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_hls_max_bitrate(engine, max_bitrate);
+}
+
+gboolean
+gv_player_get_recording(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_recording(engine);
+}
+
+void
+gv_player_set_recording(GvPlayer *self, gboolean recording)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_recording(engine, recording);
+}
+
+const gchar *
+gv_player_get_recording_directory(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_recording_directory(engine);
+}
+
+void
+gv_player_set_recording_directory(GvPlayer *self, const gchar *directory)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_set_recording_directory(engine, directory);
+}
+
+gboolean
+gv_player_get_can_seek(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_can_seek(engine);
+}
+
+gint64
+gv_player_get_position(GvPlayer *self)
+{
+	GvEngine *engine = self->priv->engine;
+
+	return gv_engine_get_position(engine);
+}
+
+void
+gv_player_set_position(GvPlayer *self, gint64 position)
+{
+	GvEngine *engine = self->priv->engine;
+
+	gv_engine_seek(engine, position);
+}
+
 /*
  * Property accessors - player properties
  */
@@ -316,6 +658,7 @@ gv_player_set_repeat(GvPlayer *self, gboolean repeat)
 		return;
 
 	priv->repeat = repeat;
+	reschedule_standby(self);
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_REPEAT]);
 }
 
@@ -334,6 +677,7 @@ gv_player_set_shuffle(GvPlayer *self, gboolean shuffle)
 		return;
 
 	priv->shuffle = shuffle;
+	reschedule_standby(self);
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SHUFFLE]);
 }
 
@@ -355,28 +699,104 @@ gv_player_set_autoplay(GvPlayer *self, gboolean autoplay)
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_AUTOPLAY]);
 }
 
+gboolean
+gv_player_get_standby_enabled(GvPlayer *self)
+{
+	return self->priv->standby_enabled;
+}
+
+void
+gv_player_set_standby_enabled(GvPlayer *self, gboolean enabled)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	if (priv->standby_enabled == enabled)
+		return;
+
+	priv->standby_enabled = enabled;
+	reschedule_standby(self);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STANDBY_ENABLED]);
+}
+
+guint
+gv_player_get_standby_max_bitrate(GvPlayer *self)
+{
+	return self->priv->standby_max_bitrate;
+}
+
+void
+gv_player_set_standby_max_bitrate(GvPlayer *self, guint max_bitrate)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	if (max_bitrate > GV_STANDBY_MAX_BITRATE)
+		max_bitrate = GV_STANDBY_MAX_BITRATE;
+
+	if (priv->standby_max_bitrate == max_bitrate)
+		return;
+
+	priv->standby_max_bitrate = max_bitrate;
+	reschedule_standby(self);
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STANDBY_MAX_BITRATE]);
+}
+
 GvStation *
 gv_player_get_station(GvPlayer *self)
 {
 	return self->priv->station;
 }
 
-GvStation *
-gv_player_get_prev_station(GvPlayer *self)
+static GvStation *
+get_sibling_station(GvPlayer *self, GvStation *station, gboolean forward)
 {
 	GvPlayerPrivate *priv = self->priv;
 
-	return gv_station_list_prev(priv->station_list, priv->station,
-				    priv->repeat, priv->shuffle);
+	if (forward)
+		return gv_station_list_next(priv->station_list, station,
+					    priv->repeat, priv->shuffle);
+	else
+		return gv_station_list_prev(priv->station_list, station,
+					    priv->repeat, priv->shuffle);
 }
 
-GvStation *
-gv_player_get_next_station(GvPlayer *self)
+static GvStation *
+get_live_sibling_station(GvPlayer *self, gboolean forward)
 {
 	GvPlayerPrivate *priv = self->priv;
+	GvStation *first, *station;
+	guint n;
+
+	first = get_sibling_station(self, priv->station, forward);
+	if (gv_core_prober == NULL)
+		return first;
+
+	/* Skip the stations that the prober found dead, so that we don't go
+	 * through a retry cycle for nothing. If they're all dead, too bad. */
+	station = first;
+	n = gv_station_list_length(priv->station_list);
+	while (station != NULL && n-- > 0) {
+		if (gv_prober_is_dead(gv_core_prober, station) == FALSE)
+			return station;
+
+		DEBUG("Skipping dead station: %s", gv_station_get_name_or_uri(station));
+		station = get_sibling_station(self, station, forward);
+		if (station == first || station == priv->station)
+			break;
+	}
 
-	return gv_station_list_next(priv->station_list, priv->station,
-				    priv->repeat, priv->shuffle);
+	return first;
+}
+
+GvStation *
+gv_player_get_prev_station(GvPlayer *self)
+{
+	return get_live_sibling_station(self, FALSE);
+}
+
+GvStation *
+gv_player_get_next_station(GvPlayer *self)
+{
+	return get_live_sibling_station(self, TRUE);
 }
 
 static const gchar *
@@ -496,6 +916,33 @@ gv_player_get_property(GObject *object,
 	case PROP_PIPELINE_STRING:
 		g_value_set_string(value, gv_player_get_pipeline_string(self));
 		break;
+	case PROP_BUFFERING_PROFILE:
+		g_value_set_enum(value, gv_player_get_buffering_profile(self));
+		break;
+	case PROP_STATS:
+		g_value_set_boxed(value, gv_player_get_stats(self));
+		break;
+	case PROP_CROSSFADE_DURATION:
+		g_value_set_uint(value, gv_player_get_crossfade_duration(self));
+		break;
+	case PROP_TIMESHIFT_WINDOW:
+		g_value_set_uint(value, gv_player_get_timeshift_window(self));
+		break;
+	case PROP_STALL_TIMEOUT:
+		g_value_set_uint(value, gv_player_get_stall_timeout(self));
+		break;
+	case PROP_HLS_POLICY:
+		g_value_set_enum(value, gv_player_get_hls_policy(self));
+		break;
+	case PROP_HLS_MAX_BITRATE:
+		g_value_set_uint(value, gv_player_get_hls_max_bitrate(self));
+		break;
+	case PROP_RECORDING:
+		g_value_set_boolean(value, gv_player_get_recording(self));
+		break;
+	case PROP_RECORDING_DIRECTORY:
+		g_value_set_string(value, gv_player_get_recording_directory(self));
+		break;
 	case PROP_PLAYING:
 		g_value_set_boolean(value, gv_player_get_playing(self));
 		break;
@@ -508,6 +955,12 @@ gv_player_get_property(GObject *object,
 	case PROP_AUTOPLAY:
 		g_value_set_boolean(value, gv_player_get_autoplay(self));
 		break;
+	case PROP_STANDBY_ENABLED:
+		g_value_set_boolean(value, gv_player_get_standby_enabled(self));
+		break;
+	case PROP_STANDBY_MAX_BITRATE:
+		g_value_set_uint(value, gv_player_get_standby_max_bitrate(self));
+		break;
 	case PROP_STATION:
 		g_value_set_object(value, gv_player_get_station(self));
 		break;
@@ -558,6 +1011,30 @@ gv_player_set_property(GObject *object,
 	case PROP_PIPELINE_STRING:
 		gv_player_set_pipeline_string(self, g_value_get_string(value));
 		break;
+	case PROP_BUFFERING_PROFILE:
+		gv_player_set_buffering_profile(self, g_value_get_enum(value));
+		break;
+	case PROP_CROSSFADE_DURATION:
+		gv_player_set_crossfade_duration(self, g_value_get_uint(value));
+		break;
+	case PROP_TIMESHIFT_WINDOW:
+		gv_player_set_timeshift_window(self, g_value_get_uint(value));
+		break;
+	case PROP_STALL_TIMEOUT:
+		gv_player_set_stall_timeout(self, g_value_get_uint(value));
+		break;
+	case PROP_HLS_POLICY:
+		gv_player_set_hls_policy(self, g_value_get_enum(value));
+		break;
+	case PROP_HLS_MAX_BITRATE:
+		gv_player_set_hls_max_bitrate(self, g_value_get_uint(value));
+		break;
+	case PROP_RECORDING:
+		gv_player_set_recording(self, g_value_get_boolean(value));
+		break;
+	case PROP_RECORDING_DIRECTORY:
+		gv_player_set_recording_directory(self, g_value_get_string(value));
+		break;
 	case PROP_REPEAT:
 		gv_player_set_repeat(self, g_value_get_boolean(value));
 		break;
@@ -567,6 +1044,12 @@ gv_player_set_property(GObject *object,
 	case PROP_AUTOPLAY:
 		gv_player_set_autoplay(self, g_value_get_boolean(value));
 		break;
+	case PROP_STANDBY_ENABLED:
+		gv_player_set_standby_enabled(self, g_value_get_boolean(value));
+		break;
+	case PROP_STANDBY_MAX_BITRATE:
+		gv_player_set_standby_max_bitrate(self, g_value_get_uint(value));
+		break;
 	case PROP_STATION:
 		gv_player_set_station(self, g_value_get_object(value));
 		break;
@@ -589,9 +1072,26 @@ gv_player_stop(GvPlayer *self)
 	GvPlayerPrivate *priv = self->priv;
 
 	gv_player_set_playing(self, FALSE);
+	cancel_standby(self);
 	gv_playback_stop(priv->playback);
 }
 
+void
+gv_player_pause(GvPlayer *self)
+{
+	GvPlayerPrivate *priv = self->priv;
+
+	/* Live streams can only be paused if time-shift is enabled,
+	 * otherwise pausing is just stopping */
+	if (gv_playback_pause(priv->playback) == FALSE) {
+		gv_player_stop(self);
+		return;
+	}
+
+	gv_player_set_playing(self, FALSE);
+	cancel_standby(self);
+}
+
 void
 gv_player_play(GvPlayer *self)
 {
@@ -630,6 +1130,20 @@ gv_player_next(GvPlayer *self)
 	return TRUE;
 }
 
+void
+gv_player_seek(GvPlayer *self, gint64 offset)
+{
+	GvEngine *engine = self->priv->engine;
+	gint64 position;
+
+	/* Offset is in microseconds, negative to go back in time */
+	position = gv_engine_get_position(engine);
+	if (position < 0)
+		return;
+
+	gv_engine_seek(engine, position + offset);
+}
+
 gboolean
 gv_player_prev(GvPlayer *self)
 {
@@ -651,7 +1165,7 @@ gv_player_toggle(GvPlayer *self)
 	GvPlayerPrivate *priv = self->priv;
 
 	if (priv->playing == TRUE)
-		gv_player_stop(self);
+		gv_player_pause(self);
 	else
 		gv_player_play(self);
 }
@@ -721,6 +1235,20 @@ gv_player_configure(GvConfigurable *configurable)
 			self, "pipeline-enabled", G_SETTINGS_BIND_DEFAULT);
 	g_settings_bind(gv_core_settings, "pipeline-string",
 			self, "pipeline-string", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "buffering-profile",
+			self, "buffering-profile", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "crossfade-duration",
+			self, "crossfade-duration", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "timeshift-window",
+			self, "timeshift-window", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "stall-timeout",
+			self, "stall-timeout", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "hls-policy",
+			self, "hls-policy", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "hls-max-bitrate",
+			self, "hls-max-bitrate", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "recording-directory",
+			self, "recording-directory", G_SETTINGS_BIND_DEFAULT);
 	g_settings_bind(gv_core_settings, "volume",
 			self, "volume", G_SETTINGS_BIND_DEFAULT);
 	g_settings_bind(gv_core_settings, "mute",
@@ -731,6 +1259,10 @@ gv_player_configure(GvConfigurable *configurable)
 			self, "shuffle", G_SETTINGS_BIND_DEFAULT);
 	g_settings_bind(gv_core_settings, "autoplay",
 			self, "autoplay", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "standby-enabled",
+			self, "standby-enabled", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "standby-max-bitrate",
+			self, "standby-max-bitrate", G_SETTINGS_BIND_DEFAULT);
 	g_settings_bind(gv_core_settings, "station-uri",
 			self, "station-uri", G_SETTINGS_BIND_DEFAULT);
 }
@@ -753,6 +1285,9 @@ gv_player_finalize(GObject *object)
 
 	TRACE("%p", object);
 
+	/* Remove pending operations */
+	g_clear_handle_id(&priv->standby_timeout_id, g_source_remove);
+
 	/* Unref the current station */
 	if (priv->station)
 		g_object_unref(priv->station);
@@ -787,6 +1322,8 @@ gv_player_constructed(GObject *object)
 	priv->repeat = DEFAULT_REPEAT;
 	priv->shuffle = DEFAULT_SHUFFLE;
 	priv->autoplay = DEFAULT_AUTOPLAY;
+	priv->standby_enabled = DEFAULT_STANDBY_ENABLED;
+	priv->standby_max_bitrate = DEFAULT_STANDBY_MAX_BITRATE;
 	priv->station = NULL;
 
 	/* Chain up */
@@ -854,6 +1391,57 @@ gv_player_class_init(GvPlayerClass *class)
 				    NULL,
 				    GV_PARAM_READWRITE);
 
+	properties[PROP_BUFFERING_PROFILE] =
+		g_param_spec_enum("buffering-profile", "Default buffering profile", NULL,
+				  GV_TYPE_ENGINE_BUFFERING_PROFILE,
+				  GV_ENGINE_BUFFERING_PROFILE_BALANCED,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_STATS] =
+		g_param_spec_boxed("stats", "Statistics", NULL,
+				   GV_TYPE_ENGINE_STATS,
+				   GV_PARAM_READABLE);
+
+	properties[PROP_CROSSFADE_DURATION] =
+		g_param_spec_uint("crossfade-duration", "Crossfade duration",
+				  "In milliseconds, zero to disable crossfading",
+				  0, GV_MAX_CROSSFADE_DURATION, 0,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_TIMESHIFT_WINDOW] =
+		g_param_spec_uint("timeshift-window", "Time-shift window",
+				  "In minutes, zero to disable time-shift",
+				  0, GV_MAX_TIMESHIFT_WINDOW, 0,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_STALL_TIMEOUT] =
+		g_param_spec_uint("stall-timeout", "Stall timeout",
+				  "In seconds without data, zero to disable the watchdog",
+				  0, GV_MAX_STALL_TIMEOUT, 10,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_HLS_POLICY] =
+		g_param_spec_enum("hls-policy", "HLS policy",
+				  "How the variant of adaptive streams is picked",
+				  GV_TYPE_ENGINE_HLS_POLICY,
+				  GV_ENGINE_HLS_POLICY_ADAPTIVE,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_HLS_MAX_BITRATE] =
+		g_param_spec_uint("hls-max-bitrate", "HLS maximum bitrate",
+				  "In kbps, for the capped policy, zero for no cap",
+				  0, GV_HLS_MAX_BITRATE, 0,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_RECORDING] =
+		g_param_spec_boolean("recording", "Recording", NULL,
+				     FALSE,
+				     GV_PARAM_READWRITE);
+
+	properties[PROP_RECORDING_DIRECTORY] =
+		g_param_spec_string("recording-directory", "Recording directory", NULL, NULL,
+				    GV_PARAM_READWRITE);
+
 	/* Player properties */
 	properties[PROP_PLAYING] =
 		g_param_spec_boolean("playing", "Playing", NULL,
@@ -875,6 +1463,17 @@ gv_player_class_init(GvPlayerClass *class)
 				     DEFAULT_AUTOPLAY,
 				     GV_PARAM_READWRITE);
 
+	properties[PROP_STANDBY_ENABLED] =
+		g_param_spec_boolean("standby-enabled", "Pre-roll the next station", NULL,
+				     DEFAULT_STANDBY_ENABLED,
+				     GV_PARAM_READWRITE);
+
+	properties[PROP_STANDBY_MAX_BITRATE] =
+		g_param_spec_uint("standby-max-bitrate", "Maximum bitrate for pre-roll",
+				  "In kbps, zero means no limit",
+				  0, GV_STANDBY_MAX_BITRATE, DEFAULT_STANDBY_MAX_BITRATE,
+				  GV_PARAM_READWRITE);
+
 	properties[PROP_STATION] =
 		g_param_spec_object("station", "Current station", NULL,
 				    GV_TYPE_STATION,
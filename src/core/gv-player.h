@@ -41,9 +41,11 @@ void      gv_player_go    (GvPlayer *self, const gchar *string_to_play);
 
 void      gv_player_play  (GvPlayer *self);
 void      gv_player_stop  (GvPlayer *self);
+void      gv_player_pause (GvPlayer *self);
 void      gv_player_toggle(GvPlayer *self);
 gboolean  gv_player_prev  (GvPlayer *self);
 gboolean  gv_player_next  (GvPlayer *self);
+void      gv_player_seek  (GvPlayer *self, gint64 offset);
 
 /* Property accessors */
 
@@ -62,6 +64,10 @@ gboolean     gv_player_get_shuffle     (GvPlayer *self);
 void         gv_player_set_shuffle     (GvPlayer *self, gboolean shuffle);
 gboolean     gv_player_get_autoplay    (GvPlayer *self);
 void         gv_player_set_autoplay    (GvPlayer *self, gboolean autoplay);
+gboolean     gv_player_get_standby_enabled    (GvPlayer *self);
+void         gv_player_set_standby_enabled    (GvPlayer *self, gboolean enabled);
+guint        gv_player_get_standby_max_bitrate(GvPlayer *self);
+void         gv_player_set_standby_max_bitrate(GvPlayer *self, guint max_bitrate);
 guint        gv_player_get_volume      (GvPlayer *self);
 void         gv_player_set_volume      (GvPlayer *self, guint volume);
 void         gv_player_lower_volume    (GvPlayer *self);
@@ -73,3 +79,23 @@ gboolean     gv_player_get_pipeline_enabled(GvPlayer *self);
 void         gv_player_set_pipeline_enabled(GvPlayer *self, gboolean enabled);
 const gchar *gv_player_get_pipeline_string (GvPlayer *self);
 void         gv_player_set_pipeline_string (GvPlayer *self, const gchar *pipeline);
+GvEngineBufferingProfile gv_player_get_buffering_profile(GvPlayer *self);
+void         gv_player_set_buffering_profile(GvPlayer *self, GvEngineBufferingProfile profile);
+const GvEngineStats *gv_player_get_stats(GvPlayer *self);
+guint        gv_player_get_crossfade_duration(GvPlayer *self);
+void         gv_player_set_crossfade_duration(GvPlayer *self, guint duration);
+guint        gv_player_get_timeshift_window(GvPlayer *self);
+void         gv_player_set_timeshift_window(GvPlayer *self, guint window);
+guint        gv_player_get_stall_timeout(GvPlayer *self);
+void         gv_player_set_stall_timeout(GvPlayer *self, guint timeout);
+GvEngineHlsPolicy gv_player_get_hls_policy(GvPlayer *self);
+void         gv_player_set_hls_policy  (GvPlayer *self, GvEngineHlsPolicy policy);
+guint        gv_player_get_hls_max_bitrate(GvPlayer *self);
+void         gv_player_set_hls_max_bitrate(GvPlayer *self, guint max_bitrate);
+gboolean     gv_player_get_recording   (GvPlayer *self);
+void         gv_player_set_recording   (GvPlayer *self, gboolean recording);
+const gchar *gv_player_get_recording_directory(GvPlayer *self);
+void         gv_player_set_recording_directory(GvPlayer *self, const gchar *directory);
+gboolean     gv_player_get_can_seek    (GvPlayer *self);
+gint64       gv_player_get_position    (GvPlayer *self);
+void         gv_player_set_position    (GvPlayer *self, gint64 position);
@@ -26,12 +26,16 @@
 #include "base/gv-base.h"
 #include "core/gv-core-enum-types.h"
 #include "core/gv-core-internal.h"
+#include "core/playlist-cache.h"
 #include "core/playlist-utils.h"
 
 #include "core/gv-playlist.h"
 
 #define PLAYLIST_MAX_SIZE (1024 * 128) // 128 kB
 
+/* How much we peek at to tell a playlist from an audio stream */
+#define SNIFF_SIZE 1024
+
 /*
  * Signals
  */
@@ -39,6 +43,7 @@
 enum {
 	SIGNAL_ACCEPT_CERTIFICATE,
 	SIGNAL_RESTARTED,
+	SIGNAL_STREAM_FOUND,
 	/* Number of signals */
 	SIGNAL_N
 };
@@ -53,9 +58,35 @@ struct _GvPlaylistPrivate {
 	gchar *uri;
 	gchar *buffer;
 	gsize  buffer_size;
+	gsize  bytes_read;
 	GSList *streams;
+	/* Parser, from the uri extension or from the content */
+	GvPlaylistParser parser;
+	/* Parser fed while downloading, to find the first stream early */
+	GvIncrementalParser *incremental;
+	gboolean stream_found;
+	/* Audio stream, if that's what the uri turned out to be */
+	GInputStream *audio_stream;
+	guint icy_metaint;
+	/* To be stored in the cache, if it was downloaded */
+	gboolean cacheable;
+	gchar *redirection_uri;
+	gchar *etag;
+	gchar *last_modified;
 };
 
+/* Revalidation of a cached playlist, it runs in the background and
+ * outlives the playlist object that started it */
+typedef struct {
+	gchar *uri;
+	gchar *redirection_uri;
+	gboolean ssl_strict;
+	SoupMessage *msg;
+	GInputStream *input_stream;
+	gchar *buffer;
+	gsize buffer_size;
+} GvRevalidation;
+
 typedef struct _GvPlaylistPrivate GvPlaylistPrivate;
 
 struct _GvPlaylist {
@@ -67,10 +98,31 @@ struct _GvPlaylist {
 
 G_DEFINE_TYPE_WITH_PRIVATE(GvPlaylist, gv_playlist, G_TYPE_OBJECT)
 
+/* Without a pool (ie. the core was not initialized), downloads share this
+ * session, rather than creating one each time. Playlist objects are used
+ * once, so it can't live on the instance. */
+static SoupSession *fallback_session;
+
 /*
  * Helpers
  */
 
+static SoupSession *
+get_session(const gchar *user_agent, gboolean ssl_strict)
+{
+	if (gv_core_http_pool != NULL)
+		return gv_http_pool_get_session(gv_core_http_pool, user_agent, ssl_strict);
+
+	if (fallback_session != NULL &&
+	    g_strcmp0(soup_session_get_user_agent(fallback_session), user_agent) != 0)
+		g_clear_object(&fallback_session);
+
+	if (fallback_session == NULL)
+		fallback_session = soup_session_new_with_options("user-agent", user_agent, NULL);
+
+	return fallback_session;
+}
+
 static gboolean
 content_type_is_likely_audio(const gchar *content_type)
 {
@@ -121,6 +173,15 @@ content_type_is_likely_audio(const gchar *content_type)
 	return FALSE;
 }
 
+static gboolean
+content_type_is_manifest(const gchar *content_type)
+{
+	/* Adaptive streams are described by a manifest, that GStreamer must
+	 * download itself, as it needs the uri to resolve the segments */
+	return !g_strcmp0(content_type, "application/dash+xml") ||
+		!g_strcmp0(content_type, "application/vnd.apple.mpegurl");
+}
+
 static GvPlaylistFormat
 get_format(const gchar *extension)
 {
@@ -167,28 +228,34 @@ get_parser(GvPlaylistFormat format)
 	return parser;
 }
 
-static gboolean
-parse_playlist(const gchar *uri, const gchar *text, gsize text_len, GSList **out, GError **error)
+static GvPlaylistParser
+get_parser_from_uri(const gchar *uri)
 {
 	GvPlaylistFormat format;
-	GvPlaylistParser parser;
+
+	gv_playlist_format_from_uri(uri, &format, NULL);
+
+	return get_parser(format);
+}
+
+static gboolean
+parse_playlist(GvPlaylistParser parser, const gchar *text, gsize text_len, GSList **out, GError **error)
+{
 	GSList *streams, *item;
-	gboolean ret;
 
 	g_return_val_if_fail(out != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	*out = NULL;
 
-	ret = gv_playlist_format_from_uri(uri, &format, error);
-	if (ret == FALSE)
-		return FALSE;
-
-	parser = get_parser(format);
+	/* No hint from the uri, go by the content */
+	if (parser == NULL)
+		parser = gv_sniff_playlist_parser(text, text_len);
 	if (parser == NULL) {
-		ERROR("No parser for playlist format: %s",
-				gv_playlist_format_to_string(format));
-		/* Program execution stops here */
+		g_set_error(error, GV_PLAYLIST_ERROR,
+				GV_PLAYLIST_ERROR_CONTENT,
+				"Unknown playlist format");
+		return FALSE;
 	}
 
 	streams = parser(text, text_len);
@@ -208,6 +275,17 @@ parse_playlist(const gchar *uri, const gchar *text, gsize text_len, GSList **out
 	return TRUE;
 }
 
+static void
+revalidation_free(GvRevalidation *reval)
+{
+	g_free(reval->uri);
+	g_free(reval->redirection_uri);
+	g_clear_object(&reval->msg);
+	g_clear_object(&reval->input_stream);
+	g_free(reval->buffer);
+	g_free(reval);
+}
+
 /*
  * Signal handlers
  */
@@ -240,18 +318,56 @@ on_soup_message_restarted(SoupMessage *msg, gpointer user_data)
 {
 	GTask *task = G_TASK(user_data);
 	GvPlaylist *self = GV_PLAYLIST(g_task_get_source_object(task));
+	GvPlaylistPrivate *priv = self->priv;
 	GUri *msg_uri = soup_message_get_uri(msg);
 	gchar *uri;
 
 	uri = g_uri_to_string(msg_uri);
 	g_signal_emit(self, signals[SIGNAL_RESTARTED], 0, uri);
-	g_free(uri);
+
+	/* Remember where we ended up, for the cache */
+	g_free(priv->redirection_uri);
+	priv->redirection_uri = uri;
+}
+
+static gboolean
+on_revalidation_accept_certificate(SoupMessage *msg G_GNUC_UNUSED,
+				   GTlsCertificate *tls_certificate G_GNUC_UNUSED,
+				   GTlsCertificateFlags tls_errors G_GNUC_UNUSED,
+				   GvRevalidation *reval)
+{
+	/* Nobody to ask in the background, apply the station setting */
+	return reval->ssl_strict ? FALSE : TRUE;
+}
+
+static void
+on_revalidation_restarted(SoupMessage *msg, GvRevalidation *reval)
+{
+	GUri *msg_uri = soup_message_get_uri(msg);
+
+	g_free(reval->redirection_uri);
+	reval->redirection_uri = g_uri_to_string(msg_uri);
 }
 
 /*
  * Private methods
  */
 
+static void input_stream_read_callback(GObject *source, GAsyncResult *result,
+				       gpointer user_data);
+
+static void
+read_playlist_chunk(GTask *task, GInputStream *input_stream)
+{
+	GvPlaylist *self = GV_PLAYLIST(g_task_get_source_object(task));
+	GvPlaylistPrivate *priv = self->priv;
+
+	g_input_stream_read_async(input_stream, priv->buffer + priv->bytes_read,
+			priv->buffer_size - priv->bytes_read,
+			G_PRIORITY_DEFAULT, g_task_get_cancellable(task),
+			input_stream_read_callback, task);
+}
+
 static void
 input_stream_read_callback(GObject *source, GAsyncResult *result, gpointer user_data)
 {
@@ -260,21 +376,40 @@ input_stream_read_callback(GObject *source, GAsyncResult *result, gpointer user_
 	GvPlaylistPrivate *priv = self->priv;
 	GInputStream* input_stream = G_INPUT_STREAM(source);
 	GError *err = NULL;
+	gssize n_read;
 	gsize bytes_read;
-	gboolean ret;
+	guint n_streams;
 
 	TRACE("%p, %p, %p", source, result, user_data);
 
-	ret = g_input_stream_read_all_finish(input_stream, result, &bytes_read, &err);
-	if (ret == FALSE) {
+	n_read = g_input_stream_read_finish(input_stream, result, &err);
+	if (n_read < 0) {
 		g_task_return_error(task, err);
 		goto out;
 	}
 
-	DEBUG("Read %" G_GSIZE_FORMAT " bytes from http input", bytes_read);
+	/* Look for streams in what just came in, and let the user know about
+	 * the first one, no need to wait for the rest of the playlist */
+	if (n_read > 0) {
+		n_streams = gv_incremental_parser_feed(priv->incremental,
+				priv->buffer + priv->bytes_read, n_read);
+		priv->bytes_read += n_read;
+	} else {
+		n_streams = gv_incremental_parser_end(priv->incremental);
+	}
+
+	if (n_streams > 0 && priv->stream_found == FALSE) {
+		const gchar *uri;
+
+		uri = gv_incremental_parser_get_first_stream(priv->incremental);
+		DEBUG("First stream found after %" G_GSIZE_FORMAT " bytes: %s",
+		      priv->bytes_read, uri);
+		priv->stream_found = TRUE;
+		g_signal_emit(self, signals[SIGNAL_STREAM_FOUND], 0, uri);
+	}
 
-	g_assert(bytes_read <= priv->buffer_size);
-	if (bytes_read == priv->buffer_size) {
+	g_assert(priv->bytes_read <= priv->buffer_size);
+	if (priv->bytes_read == priv->buffer_size) {
 		g_task_return_new_error(task, GV_PLAYLIST_ERROR,
 				GV_PLAYLIST_ERROR_TOO_BIG,
 				"Playlist too big (> %u kB)",
@@ -282,10 +417,20 @@ input_stream_read_callback(GObject *source, GAsyncResult *result, gpointer user_
 		goto out;
 	}
 
+	/* Carry on until the end of the playlist */
+	if (n_read > 0) {
+		read_playlist_chunk(task, input_stream);
+		return;
+	}
+
+	bytes_read = priv->bytes_read;
+	DEBUG("Read %" G_GSIZE_FORMAT " bytes from http input", bytes_read);
+
 	/* Realloc and make sure the string is null-terminated */
 	priv->buffer = g_realloc(priv->buffer, bytes_read + 1);
 	priv->buffer[bytes_read] = '\0';
 	priv->buffer_size = bytes_read;
+	priv->cacheable = TRUE;
 
 	g_task_return_boolean(task, TRUE);
 
@@ -294,6 +439,63 @@ out:
 	g_object_unref(task);
 }
 
+static void
+read_playlist(GTask *task, GInputStream *input_stream)
+{
+	GvPlaylist *self = GV_PLAYLIST(g_task_get_source_object(task));
+	GvPlaylistPrivate *priv = self->priv;
+
+	DEBUG("Playlist download in progress...");
+
+	/* Allocate a buffer, the parser looks at data as it comes in */
+	priv->buffer_size = PLAYLIST_MAX_SIZE + 1;
+	priv->buffer = g_new(gchar, priv->buffer_size);
+	priv->bytes_read = 0;
+	priv->incremental = gv_incremental_parser_new(priv->parser);
+
+	read_playlist_chunk(task, input_stream);
+}
+
+static void
+input_stream_filled_callback(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	GTask *task = G_TASK(user_data);
+	GvPlaylist *self = GV_PLAYLIST(g_task_get_source_object(task));
+	GvPlaylistPrivate *priv = self->priv;
+	GBufferedInputStream *buffered = G_BUFFERED_INPUT_STREAM(source);
+	GError *err = NULL;
+	const gchar *data;
+	gsize size;
+
+	TRACE("%p, %p, %p", source, result, user_data);
+
+	if (g_buffered_input_stream_fill_finish(buffered, result, &err) < 0) {
+		g_task_return_error(task, err);
+		goto error;
+	}
+
+	data = g_buffered_input_stream_peek_buffer(buffered, &size);
+	priv->parser = gv_sniff_playlist_parser(data, size);
+	if (priv->parser != NULL) {
+		read_playlist(task, G_INPUT_STREAM(buffered));
+		return;
+	}
+
+	/* Not a playlist, so it's audio. The bytes we peeked at are still
+	 * in the buffered stream, it can be handed over as is. HLS is the
+	 * exception, GStreamer must get it from the uri. */
+	DEBUG("Not a playlist, according to content");
+	if (g_strstr_len(data, size, "#EXT-X-") == NULL)
+		priv->audio_stream = g_object_ref(G_INPUT_STREAM(buffered));
+	g_task_return_new_error(task, GV_PLAYLIST_ERROR,
+			GV_PLAYLIST_ERROR_CONTENT_TYPE,
+			"Content indicates an audio stream");
+
+error:
+	g_object_unref(buffered);
+	g_object_unref(task);
+}
+
 static void
 message_sent_callback(GObject *source, GAsyncResult *result, gpointer user_data)
 {
@@ -307,6 +509,7 @@ message_sent_callback(GObject *source, GAsyncResult *result, gpointer user_data)
 	GInputStream* input_stream;
 	GError *err = NULL;
 	const gchar *content_type;
+	const gchar *icy_metaint;
 
 	TRACE("%p, %p, %p", source, result, user_data);
 
@@ -347,17 +550,29 @@ message_sent_callback(GObject *source, GAsyncResult *result, gpointer user_data)
 
 	/* Check the headers and the content-type */
 	headers = soup_message_get_response_headers(msg);
+	g_free(priv->etag);
+	priv->etag = g_strdup(soup_message_headers_get_one(headers, "ETag"));
+	g_free(priv->last_modified);
+	priv->last_modified = g_strdup(soup_message_headers_get_one(headers, "Last-Modified"));
+	icy_metaint = soup_message_headers_get_one(headers, "icy-metaint");
+	if (icy_metaint != NULL)
+		priv->icy_metaint = g_ascii_strtoull(icy_metaint, NULL, 10);
 	content_type = soup_message_headers_get_content_type(headers, NULL);
 	if (content_type != NULL) {
 		DEBUG("Got Content-Type header: %s", content_type);
 
 		/* The idea here is to check if the content-type is indicative
 		 * of an audio stream.  If that's the case, we abort right now
-		 * with ERROR_CONTENT_TYPE. The uri will then be handed over to
-		 * GStreamer, it will play it if it can.
+		 * with ERROR_CONTENT_TYPE. The input stream is kept, so that
+		 * it can be handed over to GStreamer, rather than opening a
+		 * new connection.
 		 */
 		if (content_type_is_likely_audio(content_type)) {
 			DEBUG("Not a playlist, according to Content-Type");
+			if (content_type_is_manifest(content_type))
+				g_object_unref(input_stream);
+			else
+				priv->audio_stream = input_stream;
 			g_task_return_new_error(task, GV_PLAYLIST_ERROR,
 					GV_PLAYLIST_ERROR_CONTENT_TYPE,
 					"Content-Type indicates an audio stream");
@@ -365,14 +580,20 @@ message_sent_callback(GObject *source, GAsyncResult *result, gpointer user_data)
 		}
 	}
 
-	DEBUG("Playlist download in progress...");
+	/* If the uri didn't tell what it is, peek at the first bytes */
+	if (priv->parser == NULL) {
+		GInputStream *buffered;
+
+		buffered = g_buffered_input_stream_new_sized(input_stream, SNIFF_SIZE);
+		g_object_unref(input_stream);
+		g_buffered_input_stream_fill_async(G_BUFFERED_INPUT_STREAM(buffered),
+				SNIFF_SIZE, G_PRIORITY_DEFAULT,
+				g_task_get_cancellable(task),
+				input_stream_filled_callback, task);
+		return;
+	}
 
-	/* Allocate a buffer and read data */
-	priv->buffer_size = PLAYLIST_MAX_SIZE + 1;
-	priv->buffer = g_new(gchar, priv->buffer_size);
-	g_input_stream_read_all_async(input_stream, priv->buffer, priv->buffer_size,
-			G_PRIORITY_DEFAULT, g_task_get_cancellable(task),
-			input_stream_read_callback, task);
+	read_playlist(task, input_stream);
 
 	return;
 
@@ -380,10 +601,172 @@ error:
 	g_object_unref(task);
 }
 
+static void
+revalidation_read_callback(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	GvRevalidation *reval = user_data;
+	GInputStream *input_stream = G_INPUT_STREAM(source);
+	SoupMessageHeaders *headers;
+	GvPlaylistCacheEntry entry = { 0 };
+	GSList *streams = NULL;
+	GError *err = NULL;
+	gsize bytes_read;
+
+	if (g_input_stream_read_all_finish(input_stream, result, &bytes_read, &err) == FALSE) {
+		DEBUG("Failed to revalidate playlist: %s", err->message);
+		goto out;
+	}
+
+	if (bytes_read == reval->buffer_size) {
+		DEBUG("Failed to revalidate playlist: too big");
+		gv_playlist_cache_remove(reval->uri);
+		goto out;
+	}
+	reval->buffer[bytes_read] = '\0';
+
+	/* Only keep it if it's still a playlist */
+	if (parse_playlist(get_parser_from_uri(reval->uri), reval->buffer, bytes_read,
+			   &streams, &err) == FALSE) {
+		DEBUG("Failed to revalidate playlist: %s", err->message);
+		gv_playlist_cache_remove(reval->uri);
+		goto out;
+	}
+	g_slist_free_full(streams, g_free);
+
+	headers = soup_message_get_response_headers(reval->msg);
+	entry.redirection_uri = reval->redirection_uri;
+	entry.etag = (gchar *) soup_message_headers_get_one(headers, "ETag");
+	entry.last_modified = (gchar *) soup_message_headers_get_one(headers, "Last-Modified");
+	entry.content = reval->buffer;
+	entry.content_size = bytes_read;
+
+	if (gv_playlist_cache_store(reval->uri, &entry, &err) == FALSE) {
+		INFO("Failed to cache playlist: %s", err->message);
+		goto out;
+	}
+
+	DEBUG("Cached playlist updated: %s", reval->uri);
+
+out:
+	g_clear_error(&err);
+	revalidation_free(reval);
+}
+
+static void
+revalidation_sent_callback(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	GvRevalidation *reval = user_data;
+	SoupSession *session = SOUP_SESSION(source);
+	SoupMessageHeaders *headers;
+	const gchar *content_type;
+	SoupStatus status;
+	GError *err = NULL;
+
+	reval->input_stream = soup_session_send_finish(session, result, &err);
+	if (reval->input_stream == NULL) {
+		/* Keep the cached copy, the network might be down */
+		DEBUG("Failed to revalidate playlist: %s", err->message);
+		goto error;
+	}
+
+	status = soup_message_get_status(reval->msg);
+	if (status == SOUP_STATUS_NOT_MODIFIED) {
+		DEBUG("Cached playlist is up to date: %s", reval->uri);
+		goto error;
+	}
+
+	if (SOUP_STATUS_IS_SUCCESSFUL(status) == FALSE) {
+		DEBUG("Failed to revalidate playlist: HTTP status %u", status);
+		if (SOUP_STATUS_IS_CLIENT_ERROR(status))
+			gv_playlist_cache_remove(reval->uri);
+		goto error;
+	}
+
+	/* Don't start reading an audio stream */
+	headers = soup_message_get_response_headers(reval->msg);
+	content_type = soup_message_headers_get_content_type(headers, NULL);
+	if (content_type != NULL && content_type_is_likely_audio(content_type)) {
+		DEBUG("Playlist is now an audio stream: %s", reval->uri);
+		gv_playlist_cache_remove(reval->uri);
+		goto error;
+	}
+
+	reval->buffer_size = PLAYLIST_MAX_SIZE + 1;
+	reval->buffer = g_new(gchar, reval->buffer_size);
+	g_input_stream_read_all_async(reval->input_stream, reval->buffer,
+			reval->buffer_size, G_PRIORITY_LOW, NULL,
+			revalidation_read_callback, reval);
+
+	return;
+
+error:
+	g_clear_error(&err);
+	revalidation_free(reval);
+}
+
+static void
+revalidate_playlist(SoupSession *session, const gchar *uri,
+		    GvPlaylistCacheEntry *entry, gboolean ssl_strict)
+{
+	GvRevalidation *reval;
+	SoupMessageHeaders *headers;
+
+	/* Conditional GET, so that we get a 304 if nothing changed */
+	reval = g_new0(GvRevalidation, 1);
+	reval->uri = g_strdup(uri);
+	reval->redirection_uri = g_strdup(entry->redirection_uri);
+	reval->ssl_strict = ssl_strict;
+	reval->msg = soup_message_new(SOUP_METHOD_GET, uri);
+
+	headers = soup_message_get_request_headers(reval->msg);
+	if (entry->etag != NULL)
+		soup_message_headers_append(headers, "If-None-Match", entry->etag);
+	if (entry->last_modified != NULL)
+		soup_message_headers_append(headers, "If-Modified-Since", entry->last_modified);
+
+	g_signal_connect(reval->msg, "accept-certificate",
+			G_CALLBACK(on_revalidation_accept_certificate), reval);
+	g_signal_connect(reval->msg, "restarted",
+			G_CALLBACK(on_revalidation_restarted), reval);
+
+	soup_session_send_async(session, reval->msg, G_PRIORITY_LOW, NULL,
+			revalidation_sent_callback, reval);
+}
+
+static void
+store_playlist(GvPlaylist *self)
+{
+	GvPlaylistPrivate *priv = self->priv;
+	GvPlaylistCacheEntry entry = { 0 };
+	GError *err = NULL;
+
+	entry.redirection_uri = priv->redirection_uri;
+	entry.etag = priv->etag;
+	entry.last_modified = priv->last_modified;
+	entry.content = priv->buffer;
+	entry.content_size = priv->buffer_size;
+
+	if (gv_playlist_cache_store(priv->uri, &entry, &err) == FALSE) {
+		INFO("Failed to cache playlist: %s", err->message);
+		g_clear_error(&err);
+	}
+}
+
 /*
  * Public methods
  */
 
+GInputStream *
+gv_playlist_steal_audio_stream(GvPlaylist *self, guint *icy_metaint)
+{
+	GvPlaylistPrivate *priv = self->priv;
+
+	if (icy_metaint != NULL)
+		*icy_metaint = priv->icy_metaint;
+
+	return g_steal_pointer(&priv->audio_stream);
+}
+
 GSList *
 gv_playlist_get_stream_uris(GvPlaylist *self)
 {
@@ -411,7 +794,14 @@ gv_playlist_parse(GvPlaylist *self, GError **error)
 	g_assert(priv->buffer != NULL);
 	g_assert(priv->streams == NULL);
 
-	return parse_playlist(priv->uri, priv->buffer, priv->buffer_size, &priv->streams, error);
+	if (parse_playlist(priv->parser, priv->buffer, priv->buffer_size, &priv->streams, error) == FALSE)
+		return FALSE;
+
+	/* It's a good one, keep it for next time */
+	if (priv->cacheable == TRUE)
+		store_playlist(self);
+
+	return TRUE;
 }
 
 gboolean
@@ -428,11 +818,13 @@ void
 gv_playlist_download_async(GvPlaylist *self,
 			   const gchar *uri,
 			   const gchar *user_agent,
+			   gboolean ssl_strict,
 			   GCancellable *cancellable,
 			   GAsyncReadyCallback callback,
 			   gpointer user_data)
 {
 	GvPlaylistPrivate *priv = self->priv;
+	GvPlaylistCacheEntry *entry;
 	GTask *task;
 	SoupSession *session;
 	SoupMessage *msg;
@@ -440,6 +832,7 @@ gv_playlist_download_async(GvPlaylist *self,
 	/* User can call this method only once */
 	g_return_if_fail(priv->uri == NULL);
 	priv->uri = g_strdup(uri);
+	priv->parser = get_parser_from_uri(uri);
 
 	/* If no user-agent was given, fall back to a default */
 	if (user_agent == NULL)
@@ -448,13 +841,34 @@ gv_playlist_download_async(GvPlaylist *self,
 	DEBUG("Downloading playlist: %s", uri);
 	DEBUG("with user-agent: %s", user_agent);
 
-	/* Send the request using libsoup */
-	session = soup_session_new_with_options("user-agent", user_agent, NULL);
+	/* Send the request using libsoup. Sessions come from the pool, so that
+	 * connections are reused across downloads. */
+	session = g_object_ref(get_session(user_agent, ssl_strict));
 
 	task = g_task_new(self, cancellable, callback, user_data);
         g_task_set_task_data(task, session, g_object_unref);
 
+	/* If we have it in cache, use it right away, and check in the
+	 * background whether it changed, for next time */
+	entry = gv_playlist_cache_lookup(uri);
+	if (entry != NULL) {
+		DEBUG("Using cached playlist");
+		priv->buffer = g_steal_pointer(&entry->content);
+		priv->buffer_size = entry->content_size;
+		if (entry->redirection_uri != NULL)
+			g_signal_emit(self, signals[SIGNAL_RESTARTED], 0,
+					entry->redirection_uri);
+		revalidate_playlist(session, uri, entry, ssl_strict);
+		gv_playlist_cache_entry_free(entry);
+		g_task_return_boolean(task, TRUE);
+		g_object_unref(task);
+		return;
+	}
+
+	/* Ask for ICY metadata, in case it turns out to be an audio stream */
 	msg = soup_message_new(SOUP_METHOD_GET, uri);
+	soup_message_headers_append(soup_message_get_request_headers(msg),
+			"Icy-MetaData", "1");
 	g_signal_connect_object(msg, "accept-certificate",
 			G_CALLBACK(on_soup_message_accept_certificate), task, 0);
 	g_signal_connect_object(msg, "restarted",
@@ -484,6 +898,11 @@ gv_playlist_finalize(GObject *object)
 	g_slist_free_full(priv->streams, g_free);
 	g_free(priv->buffer);
 	g_free(priv->uri);
+	g_free(priv->redirection_uri);
+	g_free(priv->etag);
+	g_free(priv->last_modified);
+	g_clear_object(&priv->audio_stream);
+	gv_incremental_parser_free(priv->incremental);
 
 	G_OBJECT_CHAINUP_FINALIZE(gv_playlist, object);
 }
@@ -528,6 +947,11 @@ gv_playlist_class_init(GvPlaylistClass *class)
 		g_signal_new("restarted", G_OBJECT_CLASS_TYPE(class),
 			     G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
 			     G_TYPE_NONE, 1, G_TYPE_STRING);
+
+	signals[SIGNAL_STREAM_FOUND] =
+		g_signal_new("stream-found", G_OBJECT_CLASS_TYPE(class),
+			     G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
+			     G_TYPE_NONE, 1, G_TYPE_STRING);
 }
 
 /*
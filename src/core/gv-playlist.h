@@ -65,6 +65,7 @@ GvPlaylist  *gv_playlist_new             (void);
 void         gv_playlist_download_async  (GvPlaylist *self,
 					  const gchar *uri,
 					  const gchar *user_agent,
+					  gboolean ssl_strict,
 					  GCancellable *cancellable,
 					  GAsyncReadyCallback callback,
 					  gpointer user_data);
@@ -74,3 +75,4 @@ gboolean     gv_playlist_download_finish (GvPlaylist *self,
 gboolean     gv_playlist_parse           (GvPlaylist *self, GError **error);
 const gchar *gv_playlist_get_first_stream(GvPlaylist *self);
 GSList      *gv_playlist_get_stream_uris (GvPlaylist *self);
+GInputStream *gv_playlist_steal_audio_stream(GvPlaylist *self, guint *icy_metaint);
@@ -0,0 +1,1088 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The prober checks every station of the station list in the background,
+ * so that we know which ones are dead before the user clicks on them. A
+ * probe is a short GET request: we wait for the headers, then read the
+ * first few kB of the stream, and give up after a little while. Only a few
+ * probes run at a time, through the shared HTTP pool. It's opt-in, as it
+ * connects to every station now and then: there are no rounds until an
+ * interval is set.
+ *
+ * For each station we record whether it's reachable, how long it took to
+ * get the headers, and the codec and bitrate when the server tells us, or
+ * when we can guess it from the first bytes. For playlists, we only know
+ * if they are reachable, we don't go further.
+ *
+ * A station that fails is tried a second time at the end of the round,
+ * before it's declared dead, as servers do hiccup now and then. Results
+ * are saved to a key file, one group per station, and they're considered
+ * stale after a while.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <gio/gio.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libsoup/soup.h>
+
+#include "base/glib-object-additions.h"
+#include "base/gv-base.h"
+#include "core/gv-core-internal.h"
+#include "core/gv-station-list.h"
+#include "core/gv-station.h"
+
+#include "core/gv-prober.h"
+
+#define DEFAULT_INTERVAL   0      // minutes, disabled
+#define MAX_INTERVAL       1440   // minutes
+#define DEFAULT_MAX_PROBES 4
+#define MAX_MAX_PROBES     16
+#define FIRST_ROUND_DELAY  30     // seconds
+#define PROBE_TIMEOUT      10     // seconds
+#define PROBE_READ_SIZE    4096
+#define PROBE_ATTEMPTS     2
+#define RESULT_TTL         (2 * 3600)   // seconds
+#define RESULT_MAX_AGE     (24 * 3600)  // seconds
+
+/*
+ * Properties
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Construct-only properties */
+	PROP_STATION_LIST,
+	PROP_FILENAME,
+	/* Properties */
+	PROP_INTERVAL,
+	PROP_MAX_PROBES,
+	PROP_RUNNING,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * Signals
+ */
+
+enum {
+	SIGNAL_STATION_PROBED,
+	SIGNAL_FINISHED,
+	/* Number of signals */
+	SIGNAL_N
+};
+
+static guint signals[SIGNAL_N];
+
+/*
+ * Probe result
+ */
+
+G_DEFINE_BOXED_TYPE(GvProbeResult, gv_probe_result,
+		    gv_probe_result_copy, gv_probe_result_free)
+
+void
+gv_probe_result_free(GvProbeResult *self)
+{
+	g_return_if_fail(self != NULL);
+
+	g_free(self->codec);
+	g_free(self->error);
+	g_free(self);
+}
+
+GvProbeResult *
+gv_probe_result_copy(GvProbeResult *self)
+{
+	GvProbeResult *copy;
+
+	g_return_val_if_fail(self != NULL, NULL);
+
+	copy = g_new0(GvProbeResult, 1);
+	copy->timestamp = self->timestamp;
+	copy->reachable = self->reachable;
+	copy->latency = self->latency;
+	copy->codec = g_strdup(self->codec);
+	copy->bitrate = self->bitrate;
+	copy->error = g_strdup(self->error);
+
+	return copy;
+}
+
+/*
+ * GObject definitions
+ */
+
+typedef struct {
+	GvProber *prober;  /* NULL once the prober is stopped */
+	gchar *uri;
+	gchar *user_agent;
+	gboolean ssl_strict;
+	guint attempt;
+	SoupSession *session;
+	SoupMessage *msg;
+	GInputStream *input_stream;
+	GCancellable *cancellable;
+	guint timeout_id;
+	gint64 start;
+	guint latency;
+	gchar *codec;
+	guint bitrate;
+	gchar buffer[PROBE_READ_SIZE];
+} GvProbe;
+
+struct _GvProberPrivate {
+	/* Construct-only properties */
+	GvStationList *station_list;
+	gchar *filename;
+	/* Properties */
+	guint interval;
+	guint max_probes;
+	gboolean running;
+	/* Results, keyed by uri */
+	GHashTable *results;
+	/* Probes waiting for their turn, and probes in flight */
+	GQueue *pending;
+	GList *active;
+	/* Session used when there's no pool */
+	SoupSession *session;
+	/* Next round */
+	guint timeout_id;
+};
+
+typedef struct _GvProberPrivate GvProberPrivate;
+
+struct _GvProber {
+	/* Parent instance structure */
+	GObject parent_instance;
+	/* Private data */
+	GvProberPrivate *priv;
+};
+
+static void gv_prober_configurable_interface_init(GvConfigurableInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(GvProber, gv_prober, G_TYPE_OBJECT,
+			G_ADD_PRIVATE(GvProber)
+			G_IMPLEMENT_INTERFACE(GV_TYPE_CONFIGURABLE,
+					      gv_prober_configurable_interface_init))
+
+/*
+ * Helpers
+ */
+
+static const gchar *
+codec_from_content_type(const gchar *content_type)
+{
+	const struct {
+		const gchar *content_type;
+		const gchar *codec;
+	} codecs[] = {
+		{ "audio/mpeg",      "MP3"  },
+		{ "audio/mp3",       "MP3"  },
+		{ "audio/aac",       "AAC"  },
+		{ "audio/aacp",      "AAC"  },
+		{ "audio/x-aac",     "AAC"  },
+		{ "audio/flac",      "FLAC" },
+		{ "audio/opus",      "Opus" },
+		{ "audio/ogg",       "Ogg"  },
+		{ "application/ogg", "Ogg"  },
+	};
+	guint i;
+
+	if (content_type == NULL)
+		return NULL;
+
+	for (i = 0; i < G_N_ELEMENTS(codecs); i++)
+		if (!g_ascii_strcasecmp(content_type, codecs[i].content_type))
+			return codecs[i].codec;
+
+	return NULL;
+}
+
+static gboolean
+contains_bytes(const gchar *haystack, gsize haystack_len, const gchar *needle)
+{
+	gsize needle_len = strlen(needle);
+	gsize i;
+
+	for (i = 0; i + needle_len <= haystack_len; i++)
+		if (memcmp(haystack + i, needle, needle_len) == 0)
+			return TRUE;
+
+	return FALSE;
+}
+
+static const gchar *
+codec_from_first_bytes(const gchar *buffer, gsize size)
+{
+	const guchar *data = (const guchar *) buffer;
+
+	if (size < 4)
+		return NULL;
+
+	/* Ogg is just a container, the codec is named in the first page */
+	if (memcmp(data, "OggS", 4) == 0) {
+		if (contains_bytes(buffer, size, "OpusHead"))
+			return "Opus";
+		if (contains_bytes(buffer, size, "\x01vorbis"))
+			return "Vorbis";
+		if (contains_bytes(buffer, size, "\x7f" "FLAC"))
+			return "FLAC";
+		return "Ogg";
+	}
+
+	if (memcmp(data, "fLaC", 4) == 0)
+		return "FLAC";
+
+	if (memcmp(data, "ID3", 3) == 0)
+		return "MP3";
+
+	/* Frame sync, ADTS has the layer bits set to zero */
+	if (data[0] == 0xff && (data[1] & 0xf6) == 0xf0)
+		return "AAC";
+	if (data[0] == 0xff && (data[1] & 0xe0) == 0xe0)
+		return "MP3";
+
+	return NULL;
+}
+
+static guint
+bitrate_from_icy_br(const gchar *icy_br)
+{
+	guint64 bitrate;
+
+	/* Some servers send a list, eg. "128,128", the first one will do */
+	if (icy_br == NULL)
+		return 0;
+
+	bitrate = g_ascii_strtoull(icy_br, NULL, 10);
+	if (bitrate > G_MAXUINT)
+		return 0;
+
+	return bitrate;
+}
+
+/*
+ * Probes
+ */
+
+static void gv_prober_probe_done(GvProber *self, GvProbe *probe,
+				 gboolean reachable, const gchar *error);
+
+static void
+probe_free(GvProbe *probe)
+{
+	g_clear_handle_id(&probe->timeout_id, g_source_remove);
+	g_clear_object(&probe->input_stream);
+	g_clear_object(&probe->msg);
+	g_clear_object(&probe->session);
+	g_clear_object(&probe->cancellable);
+	g_free(probe->codec);
+	g_free(probe->user_agent);
+	g_free(probe->uri);
+	g_free(probe);
+}
+
+static GvProbe *
+probe_new(GvProber *self, GvStation *station)
+{
+	GvProbe *probe;
+
+	probe = g_new0(GvProbe, 1);
+	probe->prober = self;
+	probe->uri = g_strdup(gv_station_get_uri(station));
+	probe->user_agent = g_strdup(gv_station_get_user_agent(station));
+	probe->ssl_strict = gv_station_get_insecure(station) ? FALSE : TRUE;
+
+	return probe;
+}
+
+static void
+probe_finish(GvProbe *probe, gboolean reachable, const gchar *error)
+{
+	GvProber *self = probe->prober;
+
+	/* The prober was stopped while we were on our way */
+	if (self == NULL) {
+		probe_free(probe);
+		return;
+	}
+
+	gv_prober_probe_done(self, probe, reachable, error);
+}
+
+static gboolean
+when_idle_invalid_uri(GvProbe *probe)
+{
+	probe->timeout_id = 0;
+	probe_finish(probe, FALSE, "Invalid uri");
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+when_probe_timeout(GvProbe *probe)
+{
+	probe->timeout_id = 0;
+	g_cancellable_cancel(probe->cancellable);
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_probe_accept_certificate(SoupMessage *msg G_GNUC_UNUSED,
+			    GTlsCertificate *tls_certificate G_GNUC_UNUSED,
+			    GTlsCertificateFlags tls_errors G_GNUC_UNUSED,
+			    GvProbe *probe)
+{
+	/* Nobody to ask in the background, apply the station setting */
+	return probe->ssl_strict ? FALSE : TRUE;
+}
+
+static void
+probe_read_callback(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	GvProbe *probe = user_data;
+	GInputStream *input_stream = G_INPUT_STREAM(source);
+	GError *err = NULL;
+	gsize bytes_read = 0;
+	const gchar *codec;
+
+	/* A timeout while reading is fine, as long as something came in */
+	g_input_stream_read_all_finish(input_stream, result, &bytes_read, &err);
+	if (bytes_read == 0) {
+		probe_finish(probe, FALSE, err ? err->message : "No data");
+		g_clear_error(&err);
+		return;
+	}
+	g_clear_error(&err);
+
+	/* Ogg is not a codec, so give the first bytes a chance */
+	if (probe->codec == NULL || !g_strcmp0(probe->codec, "Ogg")) {
+		codec = codec_from_first_bytes(probe->buffer, bytes_read);
+		if (codec != NULL) {
+			g_free(probe->codec);
+			probe->codec = g_strdup(codec);
+		}
+	}
+
+	probe_finish(probe, TRUE, NULL);
+}
+
+static void
+probe_sent_callback(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	GvProbe *probe = user_data;
+	SoupSession *session = SOUP_SESSION(source);
+	SoupMessageHeaders *headers;
+	const gchar *content_type;
+	SoupStatus status;
+	GError *err = NULL;
+	gchar *error;
+
+	probe->input_stream = soup_session_send_finish(session, result, &err);
+	if (probe->input_stream == NULL) {
+		if (g_error_matches(err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			probe_finish(probe, FALSE, "Timed out");
+		else
+			probe_finish(probe, FALSE, err->message);
+		g_clear_error(&err);
+		return;
+	}
+
+	probe->latency = (g_get_monotonic_time() - probe->start) / 1000;
+
+	status = soup_message_get_status(probe->msg);
+	if (SOUP_STATUS_IS_SUCCESSFUL(status) == FALSE) {
+		error = g_strdup_printf("HTTP status %u", status);
+		probe_finish(probe, FALSE, error);
+		g_free(error);
+		return;
+	}
+
+	headers = soup_message_get_response_headers(probe->msg);
+	content_type = soup_message_headers_get_content_type(headers, NULL);
+	probe->codec = g_strdup(codec_from_content_type(content_type));
+	probe->bitrate = bitrate_from_icy_br(soup_message_headers_get_one(headers, "icy-br"));
+
+	g_input_stream_read_all_async(probe->input_stream, probe->buffer,
+			sizeof probe->buffer, G_PRIORITY_LOW, probe->cancellable,
+			probe_read_callback, probe);
+}
+
+static SoupSession *
+get_session(GvProber *self, const gchar *user_agent, gboolean ssl_strict)
+{
+	GvProberPrivate *priv = self->priv;
+
+	if (gv_core_http_pool != NULL)
+		return gv_http_pool_get_session(gv_core_http_pool, user_agent, ssl_strict);
+
+	/* Without a pool (ie. the core was not initialized), keep our own */
+	if (priv->session != NULL &&
+	    g_strcmp0(soup_session_get_user_agent(priv->session), user_agent) != 0)
+		g_clear_object(&priv->session);
+
+	if (priv->session == NULL)
+		priv->session = soup_session_new_with_options("user-agent", user_agent, NULL);
+
+	return priv->session;
+}
+
+static void
+probe_start(GvProbe *probe)
+{
+	const gchar *user_agent = probe->user_agent;
+
+	if (user_agent == NULL)
+		user_agent = gv_core_user_agent;
+
+	probe->session = g_object_ref(get_session(probe->prober, user_agent,
+						  probe->ssl_strict));
+
+	/* Don't finish right away, we're called from the run queue, and it
+	 * would recurse for every invalid uri in a row */
+	probe->msg = soup_message_new(SOUP_METHOD_GET, probe->uri);
+	if (probe->msg == NULL) {
+		probe->timeout_id = g_idle_add((GSourceFunc) when_idle_invalid_uri, probe);
+		return;
+	}
+
+	g_signal_connect(probe->msg, "accept-certificate",
+			G_CALLBACK(on_probe_accept_certificate), probe);
+
+	probe->cancellable = g_cancellable_new();
+	probe->timeout_id = g_timeout_add_seconds(PROBE_TIMEOUT,
+			(GSourceFunc) when_probe_timeout, probe);
+	probe->start = g_get_monotonic_time();
+
+	soup_session_send_async(probe->session, probe->msg, G_PRIORITY_LOW,
+			probe->cancellable, probe_sent_callback, probe);
+}
+
+/*
+ * Private methods
+ */
+
+static void
+gv_prober_load(GvProber *self)
+{
+	GvProberPrivate *priv = self->priv;
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	gchar **groups;
+	gint64 now;
+	guint i;
+
+	keyfile = g_key_file_new();
+	if (g_key_file_load_from_file(keyfile, priv->filename, G_KEY_FILE_NONE, &err) == FALSE) {
+		if (!g_error_matches(err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			INFO("Failed to load probe results: %s", err->message);
+		g_clear_error(&err);
+		g_key_file_unref(keyfile);
+		return;
+	}
+
+	now = g_get_real_time();
+	groups = g_key_file_get_groups(keyfile, NULL);
+	for (i = 0; groups[i] != NULL; i++) {
+		GvProbeResult *res;
+		gchar *uri;
+		gint64 timestamp;
+
+		uri = g_key_file_get_string(keyfile, groups[i], "Uri", NULL);
+		timestamp = g_key_file_get_int64(keyfile, groups[i], "Timestamp", NULL);
+
+		if (uri == NULL || timestamp < now - (gint64) RESULT_MAX_AGE * G_USEC_PER_SEC) {
+			g_free(uri);
+			continue;
+		}
+
+		res = g_new0(GvProbeResult, 1);
+		res->timestamp = timestamp;
+		res->reachable = g_key_file_get_boolean(keyfile, groups[i], "Reachable", NULL);
+		res->latency = g_key_file_get_integer(keyfile, groups[i], "Latency", NULL);
+		res->codec = g_key_file_get_string(keyfile, groups[i], "Codec", NULL);
+		res->bitrate = g_key_file_get_integer(keyfile, groups[i], "Bitrate", NULL);
+		res->error = g_key_file_get_string(keyfile, groups[i], "Error", NULL);
+		g_hash_table_replace(priv->results, uri, res);
+	}
+
+	DEBUG("Loaded %u probe results", g_hash_table_size(priv->results));
+
+	g_strfreev(groups);
+	g_key_file_unref(keyfile);
+}
+
+static void
+gv_prober_save(GvProber *self)
+{
+	GvProberPrivate *priv = self->priv;
+	GHashTableIter iter;
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	gpointer key, value;
+	gchar *dirname;
+	guint n = 0;
+
+	dirname = g_path_get_dirname(priv->filename);
+	if (g_mkdir_with_parents(dirname, S_IRWXU) != 0) {
+		INFO("Failed to create directory '%s': %s", dirname, g_strerror(errno));
+		g_free(dirname);
+		return;
+	}
+	g_free(dirname);
+
+	keyfile = g_key_file_new();
+	g_hash_table_iter_init(&iter, priv->results);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		GvProbeResult *res = value;
+		gchar *group;
+
+		group = g_strdup_printf("Probe %u", n++);
+		g_key_file_set_string(keyfile, group, "Uri", key);
+		g_key_file_set_int64(keyfile, group, "Timestamp", res->timestamp);
+		g_key_file_set_boolean(keyfile, group, "Reachable", res->reachable);
+		g_key_file_set_integer(keyfile, group, "Latency", res->latency);
+		if (res->codec != NULL)
+			g_key_file_set_string(keyfile, group, "Codec", res->codec);
+		if (res->bitrate != 0)
+			g_key_file_set_integer(keyfile, group, "Bitrate", res->bitrate);
+		if (res->error != NULL)
+			g_key_file_set_string(keyfile, group, "Error", res->error);
+		g_free(group);
+	}
+
+	if (g_key_file_save_to_file(keyfile, priv->filename, &err) == FALSE) {
+		INFO("Failed to save probe results: %s", err->message);
+		g_clear_error(&err);
+	}
+
+	g_key_file_unref(keyfile);
+}
+
+static gboolean
+when_timeout_start_round(GvProber *self)
+{
+	GvProberPrivate *priv = self->priv;
+
+	priv->timeout_id = 0;
+	gv_prober_start(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gv_prober_schedule_round(GvProber *self, guint delay)
+{
+	GvProberPrivate *priv = self->priv;
+
+	g_clear_handle_id(&priv->timeout_id, g_source_remove);
+
+	if (priv->interval == 0)
+		return;
+
+	priv->timeout_id = g_timeout_add_seconds(delay,
+			(GSourceFunc) when_timeout_start_round, self);
+}
+
+static void
+gv_prober_set_running(GvProber *self, gboolean running)
+{
+	GvProberPrivate *priv = self->priv;
+
+	if (priv->running == running)
+		return;
+
+	priv->running = running;
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RUNNING]);
+}
+
+static void
+gv_prober_cancel_probes(GvProber *self)
+{
+	GvProberPrivate *priv = self->priv;
+	GList *item;
+
+	g_clear_handle_id(&priv->timeout_id, g_source_remove);
+	g_queue_clear_full(priv->pending, (GDestroyNotify) probe_free);
+
+	/* Probes in flight are orphaned, they free themselves when they return */
+	for (item = priv->active; item; item = item->next) {
+		GvProbe *probe = item->data;
+
+		probe->prober = NULL;
+		g_cancellable_cancel(probe->cancellable);
+	}
+	g_clear_pointer(&priv->active, g_list_free);
+}
+
+static void
+gv_prober_run_queue(GvProber *self)
+{
+	GvProberPrivate *priv = self->priv;
+
+	while (g_list_length(priv->active) < priv->max_probes &&
+	       !g_queue_is_empty(priv->pending)) {
+		GvProbe *probe = g_queue_pop_head(priv->pending);
+
+		priv->active = g_list_prepend(priv->active, probe);
+		probe_start(probe);
+	}
+
+	if (priv->active != NULL || priv->running == FALSE)
+		return;
+
+	/* Round is over */
+	DEBUG("Probing done, %u results", g_hash_table_size(priv->results));
+	gv_prober_save(self);
+	gv_prober_set_running(self, FALSE);
+	g_signal_emit(self, signals[SIGNAL_FINISHED], 0);
+	gv_prober_schedule_round(self, priv->interval * 60);
+}
+
+static void
+gv_prober_probe_done(GvProber *self, GvProbe *probe, gboolean reachable, const gchar *error)
+{
+	GvProberPrivate *priv = self->priv;
+	GvProbeResult *res;
+
+	priv->active = g_list_remove(priv->active, probe);
+
+	/* Give it another chance at the end of the round */
+	if (reachable == FALSE && ++probe->attempt < PROBE_ATTEMPTS) {
+		DEBUG("Probe failed, will retry: %s: %s", probe->uri, error);
+		g_clear_handle_id(&probe->timeout_id, g_source_remove);
+		g_clear_object(&probe->input_stream);
+		g_clear_object(&probe->msg);
+		g_clear_object(&probe->session);
+		g_clear_object(&probe->cancellable);
+		g_clear_pointer(&probe->codec, g_free);
+		g_queue_push_tail(priv->pending, probe);
+		gv_prober_run_queue(self);
+		return;
+	}
+
+	res = g_new0(GvProbeResult, 1);
+	res->timestamp = g_get_real_time();
+	res->reachable = reachable;
+	res->latency = probe->latency;
+	res->codec = g_steal_pointer(&probe->codec);
+	res->bitrate = probe->bitrate;
+	res->error = g_strdup(error);
+
+	if (reachable)
+		DEBUG("Probed %s: %u ms, %s, %u kbps", probe->uri, res->latency,
+		      res->codec ? res->codec : "unknown codec", res->bitrate);
+	else
+		INFO("Station unreachable: %s: %s", probe->uri, error);
+
+	g_hash_table_replace(priv->results, g_strdup(probe->uri), res);
+	g_signal_emit(self, signals[SIGNAL_STATION_PROBED], 0, probe->uri);
+
+	probe_free(probe);
+	gv_prober_run_queue(self);
+}
+
+/*
+ * Property accessors
+ */
+
+static void
+gv_prober_set_station_list(GvProber *self, GvStationList *station_list)
+{
+	GvProberPrivate *priv = self->priv;
+
+	/* Construct-only property */
+	g_assert(priv->station_list == NULL);
+	g_assert(station_list != NULL);
+	priv->station_list = g_object_ref(station_list);
+}
+
+const gchar *
+gv_prober_get_filename(GvProber *self)
+{
+	return self->priv->filename;
+}
+
+static void
+gv_prober_set_filename(GvProber *self, const gchar *filename)
+{
+	GvProberPrivate *priv = self->priv;
+
+	/* Construct-only property */
+	g_assert(priv->filename == NULL);
+	priv->filename = g_strdup(filename);
+}
+
+guint
+gv_prober_get_interval(GvProber *self)
+{
+	return self->priv->interval;
+}
+
+void
+gv_prober_set_interval(GvProber *self, guint interval)
+{
+	GvProberPrivate *priv = self->priv;
+
+	if (interval > MAX_INTERVAL)
+		interval = MAX_INTERVAL;
+
+	if (priv->interval == interval)
+		return;
+
+	priv->interval = interval;
+
+	/* The next round is scheduled at the end of the current one */
+	if (priv->running == FALSE)
+		gv_prober_schedule_round(self, interval * 60);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_INTERVAL]);
+}
+
+guint
+gv_prober_get_max_probes(GvProber *self)
+{
+	return self->priv->max_probes;
+}
+
+void
+gv_prober_set_max_probes(GvProber *self, guint max_probes)
+{
+	GvProberPrivate *priv = self->priv;
+
+	max_probes = CLAMP(max_probes, 1, MAX_MAX_PROBES);
+
+	if (priv->max_probes == max_probes)
+		return;
+
+	priv->max_probes = max_probes;
+
+	/* More room, maybe */
+	gv_prober_run_queue(self);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_PROBES]);
+}
+
+gboolean
+gv_prober_get_running(GvProber *self)
+{
+	return self->priv->running;
+}
+
+static void
+gv_prober_get_property(GObject *object,
+		       guint property_id,
+		       GValue *value,
+		       GParamSpec *pspec)
+{
+	GvProber *self = GV_PROBER(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_FILENAME:
+		g_value_set_string(value, gv_prober_get_filename(self));
+		break;
+	case PROP_INTERVAL:
+		g_value_set_uint(value, gv_prober_get_interval(self));
+		break;
+	case PROP_MAX_PROBES:
+		g_value_set_uint(value, gv_prober_get_max_probes(self));
+		break;
+	case PROP_RUNNING:
+		g_value_set_boolean(value, gv_prober_get_running(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_prober_set_property(GObject *object,
+		       guint property_id,
+		       const GValue *value,
+		       GParamSpec *pspec)
+{
+	GvProber *self = GV_PROBER(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_STATION_LIST:
+		gv_prober_set_station_list(self, g_value_get_object(value));
+		break;
+	case PROP_FILENAME:
+		gv_prober_set_filename(self, g_value_get_string(value));
+		break;
+	case PROP_INTERVAL:
+		gv_prober_set_interval(self, g_value_get_uint(value));
+		break;
+	case PROP_MAX_PROBES:
+		gv_prober_set_max_probes(self, g_value_get_uint(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+GvProbeResult *
+gv_prober_lookup(GvProber *self, const gchar *uri)
+{
+	g_return_val_if_fail(uri != NULL, NULL);
+
+	return g_hash_table_lookup(self->priv->results, uri);
+}
+
+gboolean
+gv_prober_is_dead(GvProber *self, GvStation *station)
+{
+	GvProbeResult *res;
+	const gchar *uri;
+
+	uri = gv_station_get_uri(station);
+	if (uri == NULL)
+		return FALSE;
+
+	res = gv_prober_lookup(self, uri);
+	if (res == NULL || res->reachable == TRUE)
+		return FALSE;
+
+	/* Don't hold a grudge for too long */
+	return res->timestamp > g_get_real_time() - (gint64) RESULT_TTL * G_USEC_PER_SEC;
+}
+
+void
+gv_prober_stop(GvProber *self)
+{
+	gv_prober_cancel_probes(self);
+	gv_prober_set_running(self, FALSE);
+}
+
+void
+gv_prober_start(GvProber *self)
+{
+	GvProberPrivate *priv = self->priv;
+	GvStationListIter *iter;
+	GvStation *station;
+	GHashTable *uris;
+	GHashTableIter hiter;
+	gpointer key;
+
+	if (priv->running == TRUE)
+		return;
+
+	g_clear_handle_id(&priv->timeout_id, g_source_remove);
+
+	/* No point in declaring everything dead while offline */
+	if (!g_network_monitor_get_network_available(g_network_monitor_get_default())) {
+		DEBUG("Network unavailable, not probing");
+		gv_prober_schedule_round(self, priv->interval * 60);
+		return;
+	}
+
+	/* Snapshot the station list, it might change while we probe */
+	uris = g_hash_table_new(g_str_hash, g_str_equal);
+	iter = gv_station_list_iter_new(priv->station_list);
+	while (gv_station_list_iter_loop(iter, &station)) {
+		const gchar *uri = gv_station_get_uri(station);
+
+		if (uri == NULL || !g_hash_table_add(uris, (gpointer) uri))
+			continue;
+
+		g_queue_push_tail(priv->pending, probe_new(self, station));
+	}
+	gv_station_list_iter_free(iter);
+
+	/* Forget about stations that are gone */
+	g_hash_table_iter_init(&hiter, priv->results);
+	while (g_hash_table_iter_next(&hiter, &key, NULL))
+		if (!g_hash_table_contains(uris, key))
+			g_hash_table_iter_remove(&hiter);
+	g_hash_table_unref(uris);
+
+	DEBUG("Probing %u stations", g_queue_get_length(priv->pending));
+
+	gv_prober_set_running(self, TRUE);
+	gv_prober_run_queue(self);
+}
+
+GvProber *
+gv_prober_new(GvStationList *station_list, const gchar *filename)
+{
+	return g_object_new(GV_TYPE_PROBER,
+			    "station-list", station_list,
+			    "filename", filename,
+			    NULL);
+}
+
+/*
+ * GvConfigurable interface
+ */
+
+static void
+gv_prober_configure(GvConfigurable *configurable)
+{
+	GvProber *self = GV_PROBER(configurable);
+
+	TRACE("%p", self);
+
+	g_assert(gv_core_settings);
+	g_settings_bind(gv_core_settings, "probe-interval",
+			self, "interval", G_SETTINGS_BIND_DEFAULT);
+	g_settings_bind(gv_core_settings, "probe-max-concurrent",
+			self, "max-probes", G_SETTINGS_BIND_DEFAULT);
+
+	/* Don't compete with the startup, but don't wait a full interval either */
+	gv_prober_schedule_round(self, FIRST_ROUND_DELAY);
+}
+
+static void
+gv_prober_configurable_interface_init(GvConfigurableInterface *iface)
+{
+	iface->configure = gv_prober_configure;
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_prober_finalize(GObject *object)
+{
+	GvProber *self = GV_PROBER(object);
+	GvProberPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	gv_prober_cancel_probes(self);
+	g_queue_free(priv->pending);
+	g_hash_table_unref(priv->results);
+	g_object_unref(priv->station_list);
+	g_clear_object(&priv->session);
+	g_free(priv->filename);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_prober, object);
+}
+
+static void
+gv_prober_constructed(GObject *object)
+{
+	GvProber *self = GV_PROBER(object);
+	GvProberPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	g_assert(priv->station_list != NULL);
+	g_assert(priv->filename != NULL);
+
+	gv_prober_load(self);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_prober, object);
+}
+
+static void
+gv_prober_init(GvProber *self)
+{
+	GvProberPrivate *priv;
+
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_prober_get_instance_private(self);
+	priv = self->priv;
+
+	priv->interval = DEFAULT_INTERVAL;
+	priv->max_probes = DEFAULT_MAX_PROBES;
+	priv->pending = g_queue_new();
+	priv->results = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, (GDestroyNotify) gv_probe_result_free);
+}
+
+static void
+gv_prober_class_init(GvProberClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_prober_finalize;
+	object_class->constructed = gv_prober_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_prober_get_property;
+	object_class->set_property = gv_prober_set_property;
+
+	properties[PROP_STATION_LIST] =
+		g_param_spec_object("station-list", "Station list", NULL,
+				    GV_TYPE_STATION_LIST,
+				    GV_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_FILENAME] =
+		g_param_spec_string("filename", "Filename", NULL, NULL,
+				    GV_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+	properties[PROP_INTERVAL] =
+		g_param_spec_uint("interval", "Interval",
+				  "Minutes between two rounds of probes, 0 to disable",
+				  0, MAX_INTERVAL, DEFAULT_INTERVAL,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_MAX_PROBES] =
+		g_param_spec_uint("max-probes", "Max probes",
+				  "How many probes run at the same time",
+				  1, MAX_MAX_PROBES, DEFAULT_MAX_PROBES,
+				  GV_PARAM_READWRITE);
+
+	properties[PROP_RUNNING] =
+		g_param_spec_boolean("running", "Running", NULL, FALSE,
+				     GV_PARAM_READABLE);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+
+	/* Signals */
+	signals[SIGNAL_STATION_PROBED] =
+		g_signal_new("station-probed", G_OBJECT_CLASS_TYPE(class),
+			     G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
+			     G_TYPE_NONE, 1, G_TYPE_STRING);
+
+	signals[SIGNAL_FINISHED] =
+		g_signal_new("finished", G_OBJECT_CLASS_TYPE(class),
+			     G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
+			     G_TYPE_NONE, 0);
+}
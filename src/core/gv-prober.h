@@ -0,0 +1,69 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "core/gv-station.h"
+#include "core/gv-station-list.h"
+
+/* GObject declarations */
+
+#define GV_TYPE_PROBER gv_prober_get_type()
+
+G_DECLARE_FINAL_TYPE(GvProber, gv_prober, GV, PROBER, GObject)
+
+/* Data types */
+
+#define GV_TYPE_PROBE_RESULT gv_probe_result_get_type()
+
+GType gv_probe_result_get_type(void) G_GNUC_CONST;
+
+typedef struct _GvProbeResult GvProbeResult;
+
+struct _GvProbeResult {
+	gint64 timestamp;  /* wall-clock time, in microseconds */
+	gboolean reachable;
+	guint latency;     /* time to get the headers, in ms */
+	gchar *codec;      /* NULL if unknown */
+	guint bitrate;     /* in kbps, 0 if unknown */
+	gchar *error;      /* NULL if reachable */
+};
+
+GvProbeResult *gv_probe_result_copy(GvProbeResult *self);
+void           gv_probe_result_free(GvProbeResult *self);
+
+/* Methods */
+
+GvProber      *gv_prober_new    (GvStationList *station_list, const gchar *filename);
+void           gv_prober_start  (GvProber *self);
+void           gv_prober_stop   (GvProber *self);
+GvProbeResult *gv_prober_lookup (GvProber *self, const gchar *uri);
+gboolean       gv_prober_is_dead(GvProber *self, GvStation *station);
+
+/* Property accessors */
+
+const gchar *gv_prober_get_filename   (GvProber *self);
+guint        gv_prober_get_interval   (GvProber *self);
+void         gv_prober_set_interval   (GvProber *self, guint interval);
+guint        gv_prober_get_max_probes (GvProber *self);
+void         gv_prober_set_max_probes (GvProber *self, guint max_probes);
+gboolean     gv_prober_get_running    (GvProber *self);
@@ -0,0 +1,557 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The recorder writes the compressed stream to disk, as it's received, with
+ * no decoding or re-encoding involved. Buffers are handed over to a writer
+ * thread, so that a slow disk never blocks the streaming thread. If the
+ * writer thread falls too far behind, data is dropped rather than queued
+ * forever. Each call to gv_recorder_split() starts a new file, named after
+ * the title given, and the extension is guessed from the first bytes of the
+ * stream.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <gio/gio.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <gst/gst.h>
+
+#include "base/glib-object-additions.h"
+#include "base/gv-base.h"
+#include "core/gv-core-internal.h"
+
+#include "core/gv-recorder.h"
+
+/* How much data can be waiting for the writer thread before we drop it.
+ * At usual radio bitrates, that's a few minutes of audio. */
+#define MAX_PENDING_SIZE (8 * 1024 * 1024)
+
+/* Size of the write buffer */
+#define WRITE_BUFFER_SIZE (64 * 1024)
+
+/* Titles can be long, file names can't */
+#define MAX_TITLE_LENGTH 128
+
+typedef enum {
+	RECORDER_OP_WRITE,
+	RECORDER_OP_SPLIT,
+	RECORDER_OP_CLOSE,
+	RECORDER_OP_QUIT,
+} GvRecorderOp;
+
+typedef struct {
+	GvRecorderOp op;
+	GstBuffer *buffer;
+	gchar *name;
+} GvRecorderCommand;
+
+/*
+ * Properties
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Properties */
+	PROP_DIRECTORY,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * GObject definitions
+ */
+
+struct _GvRecorderPrivate {
+	/* Writer thread */
+	GThread *thread;
+	GAsyncQueue *queue;
+	/* Writer thread only */
+	GOutputStream *stream;
+	gchar *next_name;
+	const gchar *extension;
+	/* Accounting, protected by the lock */
+	GMutex lock;
+	gsize pending_size;
+	gboolean dropping;
+	guint64 bytes_written;
+	guint64 bytes_dropped;
+	/* Properties */
+	gchar *directory;
+};
+
+typedef struct _GvRecorderPrivate GvRecorderPrivate;
+
+struct _GvRecorder {
+	/* Parent instance structure */
+	GObject parent_instance;
+	/* Private data */
+	GvRecorderPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GvRecorder, gv_recorder, G_TYPE_OBJECT)
+
+/*
+ * Helpers
+ */
+
+static void
+command_free(GvRecorderCommand *cmd)
+{
+	if (cmd->buffer)
+		gst_buffer_unref(cmd->buffer);
+	g_free(cmd->name);
+	g_free(cmd);
+}
+
+static void
+push_command(GvRecorder *self, GvRecorderOp op, GstBuffer *buffer, gchar *name)
+{
+	GvRecorderCommand *cmd;
+
+	cmd = g_new0(GvRecorderCommand, 1);
+	cmd->op = op;
+	cmd->buffer = buffer;
+	cmd->name = name;
+
+	g_async_queue_push(self->priv->queue, cmd);
+}
+
+static const gchar *
+sniff_extension(GstBuffer *buffer)
+{
+	guint8 data[4];
+
+	if (gst_buffer_extract(buffer, 0, data, sizeof data) < sizeof data)
+		return "bin";
+
+	if (!memcmp(data, "OggS", 4))
+		return "ogg";
+	if (!memcmp(data, "fLaC", 4))
+		return "flac";
+	if (!memcmp(data, "ID3", 3))
+		return "mp3";
+
+	/* ADTS sync word is 12 bits with layer 0, MPEG audio is 11 bits */
+	if (data[0] == 0xff && (data[1] & 0xf6) == 0xf0)
+		return "aac";
+	if (data[0] == 0xff && (data[1] & 0xe0) == 0xe0)
+		return "mp3";
+
+	return "bin";
+}
+
+static gchar *
+make_file_name(const gchar *title)
+{
+	GDateTime *now;
+	gchar *timestamp;
+	gchar *name;
+
+	now = g_date_time_new_now_local();
+	timestamp = g_date_time_format(now, "%Y-%m-%d %H.%M.%S");
+	g_date_time_unref(now);
+
+	if (title == NULL || *title == '\0') {
+		name = g_steal_pointer(&timestamp);
+	} else {
+		gchar *short_title;
+
+		short_title = g_utf8_substring(title, 0, MAX_TITLE_LENGTH);
+		g_strdelimit(short_title, "/\\:*?\"<>|", '_');
+		name = g_strdup_printf("%s - %s", timestamp, short_title);
+		g_free(short_title);
+	}
+
+	g_free(timestamp);
+
+	return name;
+}
+
+/*
+ * Writer thread
+ */
+
+static void
+close_file(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	GError *err = NULL;
+
+	if (priv->stream == NULL)
+		return;
+
+	if (!g_output_stream_close(priv->stream, NULL, &err)) {
+		WARNING("Failed to close recording: %s", err->message);
+		g_clear_error(&err);
+	}
+
+	g_clear_object(&priv->stream);
+}
+
+static void
+open_file(GvRecorder *self, GstBuffer *buffer)
+{
+	GvRecorderPrivate *priv = self->priv;
+	GFileOutputStream *file_stream = NULL;
+	GError *err = NULL;
+	gchar *path = NULL;
+	guint i;
+
+	/* The extension is guessed once per stream, as later files are likely
+	 * to start in the middle of a frame */
+	if (priv->extension == NULL)
+		priv->extension = sniff_extension(buffer);
+
+	if (g_mkdir_with_parents(priv->directory, 0755) != 0) {
+		WARNING("Failed to create directory '%s': %s", priv->directory,
+			g_strerror(errno));
+		goto out;
+	}
+
+	/* Never overwrite an existing file */
+	for (i = 1; i <= 10 && file_stream == NULL; i++) {
+		GFile *file;
+		gchar *filename;
+
+		if (i == 1)
+			filename = g_strdup_printf("%s.%s", priv->next_name, priv->extension);
+		else
+			filename = g_strdup_printf("%s (%u).%s", priv->next_name, i,
+						   priv->extension);
+
+		g_free(path);
+		path = g_build_filename(priv->directory, filename, NULL);
+		g_free(filename);
+
+		g_clear_error(&err);
+		file = g_file_new_for_path(path);
+		file_stream = g_file_create(file, G_FILE_CREATE_NONE, NULL, &err);
+		g_object_unref(file);
+
+		if (err && !g_error_matches(err, G_IO_ERROR, G_IO_ERROR_EXISTS))
+			break;
+	}
+
+	if (file_stream == NULL) {
+		WARNING("Failed to create recording '%s': %s", path, err->message);
+		g_clear_error(&err);
+		goto out;
+	}
+
+	INFO("Recording to '%s'", path);
+	priv->stream = g_buffered_output_stream_new_sized(G_OUTPUT_STREAM(file_stream),
+							  WRITE_BUFFER_SIZE);
+	g_object_unref(file_stream);
+
+out:
+	/* Whether it worked or not, wait for the next split */
+	g_clear_pointer(&priv->next_name, g_free);
+	g_free(path);
+}
+
+static void
+write_buffer(GvRecorder *self, GstBuffer *buffer)
+{
+	GvRecorderPrivate *priv = self->priv;
+	gsize size = gst_buffer_get_size(buffer);
+	GstMapInfo map;
+
+	if (priv->stream == NULL && priv->next_name != NULL)
+		open_file(self, buffer);
+
+	if (priv->stream != NULL && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+		GError *err = NULL;
+
+		if (g_output_stream_write_all(priv->stream, map.data, map.size,
+					      NULL, NULL, &err)) {
+			g_mutex_lock(&priv->lock);
+			priv->bytes_written += map.size;
+			g_mutex_unlock(&priv->lock);
+		} else {
+			WARNING("Failed to write recording: %s", err->message);
+			g_clear_error(&err);
+			close_file(self);
+		}
+
+		gst_buffer_unmap(buffer, &map);
+	}
+
+	g_mutex_lock(&priv->lock);
+	priv->pending_size -= size;
+	g_mutex_unlock(&priv->lock);
+}
+
+static gpointer
+writer_thread_func(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	gboolean quit = FALSE;
+
+	while (quit == FALSE) {
+		GvRecorderCommand *cmd;
+
+		cmd = g_async_queue_pop(priv->queue);
+
+		switch (cmd->op) {
+		case RECORDER_OP_WRITE:
+			write_buffer(self, cmd->buffer);
+			break;
+		case RECORDER_OP_SPLIT:
+			close_file(self);
+			g_free(priv->next_name);
+			priv->next_name = g_steal_pointer(&cmd->name);
+			break;
+		case RECORDER_OP_CLOSE:
+			close_file(self);
+			g_clear_pointer(&priv->next_name, g_free);
+			priv->extension = NULL;
+			break;
+		case RECORDER_OP_QUIT:
+			close_file(self);
+			quit = TRUE;
+			break;
+		}
+
+		command_free(cmd);
+	}
+
+	return NULL;
+}
+
+/*
+ * Property accessors
+ */
+
+const gchar *
+gv_recorder_get_directory(GvRecorder *self)
+{
+	return self->priv->directory;
+}
+
+static void
+gv_recorder_set_directory(GvRecorder *self, const gchar *directory)
+{
+	GvRecorderPrivate *priv = self->priv;
+
+	/* Construct-only property */
+	g_assert(priv->directory == NULL);
+	priv->directory = g_strdup(directory);
+}
+
+guint64
+gv_recorder_get_bytes_written(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	guint64 bytes;
+
+	g_mutex_lock(&priv->lock);
+	bytes = priv->bytes_written;
+	g_mutex_unlock(&priv->lock);
+
+	return bytes;
+}
+
+guint64
+gv_recorder_get_bytes_dropped(GvRecorder *self)
+{
+	GvRecorderPrivate *priv = self->priv;
+	guint64 bytes;
+
+	g_mutex_lock(&priv->lock);
+	bytes = priv->bytes_dropped;
+	g_mutex_unlock(&priv->lock);
+
+	return bytes;
+}
+
+static void
+gv_recorder_get_property(GObject *object,
+			 guint property_id,
+			 GValue *value,
+			 GParamSpec *pspec)
+{
+	GvRecorder *self = GV_RECORDER(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_DIRECTORY:
+		g_value_set_string(value, gv_recorder_get_directory(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_recorder_set_property(GObject *object,
+			 guint property_id,
+			 const GValue *value,
+			 GParamSpec *pspec)
+{
+	GvRecorder *self = GV_RECORDER(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_DIRECTORY:
+		gv_recorder_set_directory(self, g_value_get_string(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+void
+gv_recorder_split(GvRecorder *self, const gchar *title)
+{
+	/* The data that is received from now on goes to a new file */
+	push_command(self, RECORDER_OP_SPLIT, NULL, make_file_name(title));
+}
+
+void
+gv_recorder_close(GvRecorder *self)
+{
+	/* Close the current file, and discard the data until the next split */
+	push_command(self, RECORDER_OP_CLOSE, NULL, NULL);
+}
+
+void
+gv_recorder_write(GvRecorder *self, GstBuffer *buffer)
+{
+	/* WARNING! We're likely in the GStreamer streaming thread! */
+
+	GvRecorderPrivate *priv = self->priv;
+	gsize size = gst_buffer_get_size(buffer);
+	gboolean drop;
+	gboolean warn;
+
+	g_mutex_lock(&priv->lock);
+	drop = priv->pending_size + size > MAX_PENDING_SIZE;
+	warn = drop && !priv->dropping;
+	priv->dropping = drop;
+	if (drop)
+		priv->bytes_dropped += size;
+	else
+		priv->pending_size += size;
+	g_mutex_unlock(&priv->lock);
+
+	if (warn)
+		WARNING("Disk can't keep up, dropping recorded data");
+
+	if (drop)
+		return;
+
+	/* No copy here, the buffer is only referenced */
+	push_command(self, RECORDER_OP_WRITE, gst_buffer_ref(buffer), NULL);
+}
+
+GvRecorder *
+gv_recorder_new(const gchar *directory)
+{
+	return g_object_new(GV_TYPE_RECORDER, "directory", directory, NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_recorder_finalize(GObject *object)
+{
+	GvRecorder *self = GV_RECORDER(object);
+	GvRecorderPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Let the writer thread flush what's left */
+	push_command(self, RECORDER_OP_QUIT, NULL, NULL);
+	g_thread_join(priv->thread);
+
+	g_async_queue_unref(priv->queue);
+	g_free(priv->next_name);
+	g_mutex_clear(&priv->lock);
+	g_free(priv->directory);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_recorder, object);
+}
+
+static void
+gv_recorder_constructed(GObject *object)
+{
+	GvRecorder *self = GV_RECORDER(object);
+	GvRecorderPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	g_assert(priv->directory != NULL);
+
+	priv->queue = g_async_queue_new_full((GDestroyNotify) command_free);
+	priv->thread = g_thread_new("gv-recorder", (GThreadFunc) writer_thread_func, self);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_recorder, object);
+}
+
+static void
+gv_recorder_init(GvRecorder *self)
+{
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_recorder_get_instance_private(self);
+
+	g_mutex_init(&self->priv->lock);
+}
+
+static void
+gv_recorder_class_init(GvRecorderClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_recorder_finalize;
+	object_class->constructed = gv_recorder_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_recorder_get_property;
+	object_class->set_property = gv_recorder_set_property;
+
+	properties[PROP_DIRECTORY] =
+		g_param_spec_string("directory", "Directory", NULL, NULL,
+				    GV_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+}
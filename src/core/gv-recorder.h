@@ -0,0 +1,43 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2015-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include <gst/gst.h>
+
+/* GObject declarations */
+
+#define GV_TYPE_RECORDER gv_recorder_get_type()
+
+G_DECLARE_FINAL_TYPE(GvRecorder, gv_recorder, GV, RECORDER, GObject)
+
+/* Methods */
+
+GvRecorder *gv_recorder_new  (const gchar *directory);
+void        gv_recorder_split(GvRecorder *self, const gchar *title);
+void        gv_recorder_close(GvRecorder *self);
+void        gv_recorder_write(GvRecorder *self, GstBuffer *buffer);
+
+/* Property accessors */
+
+const gchar *gv_recorder_get_directory    (GvRecorder *self);
+guint64      gv_recorder_get_bytes_written(GvRecorder *self);
+guint64      gv_recorder_get_bytes_dropped(GvRecorder *self);
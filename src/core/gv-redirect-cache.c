@@ -0,0 +1,439 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The redirect cache remembers where a uri ended up after following the
+ * redirections, so that next time we can go straight there. Entries expire
+ * after a while, as redirections are not meant to last forever. It's up to
+ * the user to forget an entry if the target doesn't work anymore, and to
+ * fall back to the original uri.
+ *
+ * The cache is saved to a key file, one group per entry, a few seconds
+ * after it changes so that bursts of changes go in a single write.
+ */
+
+#include <errno.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "base/glib-object-additions.h"
+#include "base/gv-base.h"
+
+#include "core/gv-redirect-cache.h"
+
+#define REDIRECT_TTL (24 * 3600)  // seconds
+#define MAX_ENTRIES  256
+#define SAVE_DELAY   5  // seconds
+
+/*
+ * Properties
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Properties */
+	PROP_FILENAME,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * GObject definitions
+ */
+
+typedef struct {
+	gchar *target;
+	gint64 expiry;  // wall-clock time, in microseconds
+} GvRedirect;
+
+struct _GvRedirectCachePrivate {
+	/* Properties */
+	gchar *filename;
+	/* Entries, keyed by uri */
+	GHashTable *entries;
+	/* Pending save */
+	guint save_timeout_id;
+	/* Counters */
+	guint n_hits;
+	guint n_misses;
+};
+
+typedef struct _GvRedirectCachePrivate GvRedirectCachePrivate;
+
+struct _GvRedirectCache {
+	/* Parent instance structure */
+	GObject parent_instance;
+	/* Private data */
+	GvRedirectCachePrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GvRedirectCache, gv_redirect_cache, G_TYPE_OBJECT)
+
+/*
+ * Helpers
+ */
+
+static void
+redirect_free(GvRedirect *redirect)
+{
+	g_free(redirect->target);
+	g_free(redirect);
+}
+
+/*
+ * Private methods
+ */
+
+static void
+gv_redirect_cache_load(GvRedirectCache *self)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	gchar **groups;
+	gint64 now;
+	guint i;
+
+	keyfile = g_key_file_new();
+	if (g_key_file_load_from_file(keyfile, priv->filename, G_KEY_FILE_NONE, &err) == FALSE) {
+		if (!g_error_matches(err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			INFO("Failed to load redirect cache: %s", err->message);
+		g_clear_error(&err);
+		g_key_file_unref(keyfile);
+		return;
+	}
+
+	now = g_get_real_time();
+	groups = g_key_file_get_groups(keyfile, NULL);
+	for (i = 0; groups[i] != NULL; i++) {
+		GvRedirect *redirect;
+		gchar *uri, *target;
+		gint64 expiry;
+
+		uri = g_key_file_get_string(keyfile, groups[i], "Uri", NULL);
+		target = g_key_file_get_string(keyfile, groups[i], "Target", NULL);
+		expiry = g_key_file_get_int64(keyfile, groups[i], "Expiry", NULL);
+
+		if (uri == NULL || target == NULL || expiry < now) {
+			g_free(uri);
+			g_free(target);
+			continue;
+		}
+
+		redirect = g_new0(GvRedirect, 1);
+		redirect->target = target;
+		redirect->expiry = expiry;
+		g_hash_table_replace(priv->entries, uri, redirect);
+	}
+
+	DEBUG("Loaded %u redirects from cache", g_hash_table_size(priv->entries));
+
+	g_strfreev(groups);
+	g_key_file_unref(keyfile);
+}
+
+static void
+gv_redirect_cache_save(GvRedirectCache *self)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+	GHashTableIter iter;
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	gpointer key, value;
+	gchar *dirname;
+	guint n = 0;
+
+	g_clear_handle_id(&priv->save_timeout_id, g_source_remove);
+
+	dirname = g_path_get_dirname(priv->filename);
+	if (g_mkdir_with_parents(dirname, S_IRWXU) != 0) {
+		INFO("Failed to create directory '%s': %s", dirname, g_strerror(errno));
+		g_free(dirname);
+		return;
+	}
+	g_free(dirname);
+
+	keyfile = g_key_file_new();
+	g_hash_table_iter_init(&iter, priv->entries);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		GvRedirect *redirect = value;
+		gchar *group;
+
+		group = g_strdup_printf("Redirect %u", n++);
+		g_key_file_set_string(keyfile, group, "Uri", key);
+		g_key_file_set_string(keyfile, group, "Target", redirect->target);
+		g_key_file_set_int64(keyfile, group, "Expiry", redirect->expiry);
+		g_free(group);
+	}
+
+	if (g_key_file_save_to_file(keyfile, priv->filename, &err) == FALSE) {
+		INFO("Failed to save redirect cache: %s", err->message);
+		g_clear_error(&err);
+	}
+
+	g_key_file_unref(keyfile);
+}
+
+static gboolean
+when_timeout_save(GvRedirectCache *self)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+
+	priv->save_timeout_id = 0;
+	gv_redirect_cache_save(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gv_redirect_cache_save_delayed(GvRedirectCache *self)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+
+	/* Whatever comes next goes in the same save */
+	if (priv->save_timeout_id != 0)
+		return;
+
+	priv->save_timeout_id = g_timeout_add_seconds(SAVE_DELAY,
+			(GSourceFunc) when_timeout_save, self);
+}
+
+/*
+ * Property accessors
+ */
+
+const gchar *
+gv_redirect_cache_get_filename(GvRedirectCache *self)
+{
+	return self->priv->filename;
+}
+
+static void
+gv_redirect_cache_set_filename(GvRedirectCache *self, const gchar *filename)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+
+	/* Construct-only property */
+	g_assert(priv->filename == NULL);
+	priv->filename = g_strdup(filename);
+}
+
+guint
+gv_redirect_cache_get_n_hits(GvRedirectCache *self)
+{
+	return self->priv->n_hits;
+}
+
+guint
+gv_redirect_cache_get_n_misses(GvRedirectCache *self)
+{
+	return self->priv->n_misses;
+}
+
+static void
+gv_redirect_cache_get_property(GObject *object,
+			       guint property_id,
+			       GValue *value,
+			       GParamSpec *pspec)
+{
+	GvRedirectCache *self = GV_REDIRECT_CACHE(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_FILENAME:
+		g_value_set_string(value, gv_redirect_cache_get_filename(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_redirect_cache_set_property(GObject *object,
+			       guint property_id,
+			       const GValue *value,
+			       GParamSpec *pspec)
+{
+	GvRedirectCache *self = GV_REDIRECT_CACHE(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_FILENAME:
+		gv_redirect_cache_set_filename(self, g_value_get_string(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+const gchar *
+gv_redirect_cache_lookup(GvRedirectCache *self, const gchar *uri)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+	GvRedirect *redirect;
+
+	redirect = g_hash_table_lookup(priv->entries, uri);
+	if (redirect != NULL && redirect->expiry < g_get_real_time()) {
+		DEBUG("Redirect expired: %s", uri);
+		g_hash_table_remove(priv->entries, uri);
+		redirect = NULL;
+	}
+
+	if (redirect == NULL) {
+		priv->n_misses++;
+		return NULL;
+	}
+
+	priv->n_hits++;
+	return redirect->target;
+}
+
+void
+gv_redirect_cache_learn(GvRedirectCache *self, const gchar *uri, const gchar *target)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+	GvRedirect *redirect;
+
+	g_return_if_fail(uri != NULL);
+	g_return_if_fail(target != NULL);
+
+	if (!g_strcmp0(uri, target))
+		return;
+
+	/* No need for anything clever, stations don't come and go that often */
+	if (g_hash_table_size(priv->entries) >= MAX_ENTRIES &&
+	    !g_hash_table_contains(priv->entries, uri))
+		g_hash_table_remove_all(priv->entries);
+
+	DEBUG("Learned redirect: %s -> %s", uri, target);
+
+	redirect = g_new0(GvRedirect, 1);
+	redirect->target = g_strdup(target);
+	redirect->expiry = g_get_real_time() + (gint64) REDIRECT_TTL * G_USEC_PER_SEC;
+	g_hash_table_replace(priv->entries, g_strdup(uri), redirect);
+
+	gv_redirect_cache_save_delayed(self);
+}
+
+void
+gv_redirect_cache_forget(GvRedirectCache *self, const gchar *uri)
+{
+	GvRedirectCachePrivate *priv = self->priv;
+
+	if (g_hash_table_remove(priv->entries, uri) == FALSE)
+		return;
+
+	DEBUG("Forgot redirect: %s", uri);
+
+	gv_redirect_cache_save_delayed(self);
+}
+
+GvRedirectCache *
+gv_redirect_cache_new(const gchar *filename)
+{
+	return g_object_new(GV_TYPE_REDIRECT_CACHE, "filename", filename, NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_redirect_cache_finalize(GObject *object)
+{
+	GvRedirectCache *self = GV_REDIRECT_CACHE(object);
+	GvRedirectCachePrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	DEBUG("Redirect cache: %u hits, %u misses", priv->n_hits, priv->n_misses);
+
+	/* Run any pending save operation */
+	if (priv->save_timeout_id != 0)
+		gv_redirect_cache_save(self);
+
+	g_hash_table_unref(priv->entries);
+	g_free(priv->filename);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_redirect_cache, object);
+}
+
+static void
+gv_redirect_cache_constructed(GObject *object)
+{
+	GvRedirectCache *self = GV_REDIRECT_CACHE(object);
+	GvRedirectCachePrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	g_assert(priv->filename != NULL);
+
+	gv_redirect_cache_load(self);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_redirect_cache, object);
+}
+
+static void
+gv_redirect_cache_init(GvRedirectCache *self)
+{
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_redirect_cache_get_instance_private(self);
+
+	self->priv->entries = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, (GDestroyNotify) redirect_free);
+}
+
+static void
+gv_redirect_cache_class_init(GvRedirectCacheClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_redirect_cache_finalize;
+	object_class->constructed = gv_redirect_cache_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_redirect_cache_get_property;
+	object_class->set_property = gv_redirect_cache_set_property;
+
+	properties[PROP_FILENAME] =
+		g_param_spec_string("filename", "Filename", NULL, NULL,
+				    GV_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+}
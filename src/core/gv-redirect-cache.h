@@ -0,0 +1,43 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+/* GObject declarations */
+
+#define GV_TYPE_REDIRECT_CACHE gv_redirect_cache_get_type()
+
+G_DECLARE_FINAL_TYPE(GvRedirectCache, gv_redirect_cache, GV, REDIRECT_CACHE, GObject)
+
+/* Methods */
+
+GvRedirectCache *gv_redirect_cache_new   (const gchar *filename);
+const gchar     *gv_redirect_cache_lookup(GvRedirectCache *self, const gchar *uri);
+void             gv_redirect_cache_learn (GvRedirectCache *self, const gchar *uri,
+					  const gchar *target);
+void             gv_redirect_cache_forget(GvRedirectCache *self, const gchar *uri);
+
+/* Property accessors */
+
+const gchar *gv_redirect_cache_get_filename(GvRedirectCache *self);
+guint        gv_redirect_cache_get_n_hits  (GvRedirectCache *self);
+guint        gv_redirect_cache_get_n_misses(GvRedirectCache *self);
@@ -0,0 +1,629 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The station history remembers how the streams behaved the last few times
+ * they were played: how long it took to connect and to get the first audio,
+ * and whether they failed. For playlists, it also remembers which stream
+ * worked last. With that, we can try the streams of a playlist in order of
+ * observed performance, and leave aside the ones that keep failing.
+ *
+ * The history is saved to a key file next to the station list, one group
+ * per uri. Changes come in bursts when a station starts playing, so saves
+ * are delayed and coalesced.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <glib-object.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "base/glib-object-additions.h"
+#include "base/gv-base.h"
+
+#include "core/gv-station-history.h"
+
+#define HISTORY_LENGTH   8
+#define CHRONIC_FAILURES 3
+#define FAILING_TTL      (6 * 3600)        // seconds
+#define ENTRY_MAX_AGE    (30 * 24 * 3600)  // seconds
+#define MAX_ENTRIES      512
+#define SAVE_DELAY       5                 // seconds
+
+/* Scores of the streams we know nothing useful about */
+#define SCORE_UNKNOWN    (G_MAXUINT - 1)
+#define SCORE_NEVER_UP   G_MAXUINT
+
+/*
+ * Properties
+ */
+
+enum {
+	/* Reserved */
+	PROP_0,
+	/* Properties */
+	PROP_FILENAME,
+	/* Number of properties */
+	PROP_N
+};
+
+static GParamSpec *properties[PROP_N];
+
+/*
+ * GObject definitions
+ */
+
+typedef struct {
+	/* Most recent first, in milliseconds */
+	guint connect_times[HISTORY_LENGTH];
+	guint first_audio_times[HISTORY_LENGTH];
+	guint n_samples;
+	/* Failures in a row */
+	guint n_failures;
+	/* Wall-clock times, in microseconds */
+	gint64 last_failure;
+	gint64 last_used;
+	/* For playlists, the stream that worked last */
+	gchar *stream;
+} GvHistoryEntry;
+
+struct _GvStationHistoryPrivate {
+	/* Properties */
+	gchar *filename;
+	/* Entries, keyed by uri */
+	GHashTable *entries;
+	/* Pending save */
+	guint save_timeout_id;
+};
+
+typedef struct _GvStationHistoryPrivate GvStationHistoryPrivate;
+
+struct _GvStationHistory {
+	/* Parent instance structure */
+	GObject parent_instance;
+	/* Private data */
+	GvStationHistoryPrivate *priv;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GvStationHistory, gv_station_history, G_TYPE_OBJECT)
+
+/*
+ * Helpers
+ */
+
+static void
+entry_free(GvHistoryEntry *entry)
+{
+	g_free(entry->stream);
+	g_free(entry);
+}
+
+static void
+entry_add_sample(GvHistoryEntry *entry, guint connect_time, guint first_audio_time)
+{
+	gsize n = HISTORY_LENGTH - 1;
+
+	memmove(entry->connect_times + 1, entry->connect_times,
+		n * sizeof entry->connect_times[0]);
+	memmove(entry->first_audio_times + 1, entry->first_audio_times,
+		n * sizeof entry->first_audio_times[0]);
+
+	entry->connect_times[0] = connect_time;
+	entry->first_audio_times[0] = first_audio_time;
+	if (entry->n_samples < HISTORY_LENGTH)
+		entry->n_samples++;
+}
+
+static guint
+entry_get_score(GvHistoryEntry *entry)
+{
+	guint64 sum = 0;
+	guint64 score;
+	guint i;
+
+	if (entry == NULL)
+		return SCORE_UNKNOWN;
+
+	if (entry->n_samples == 0)
+		return entry->n_failures > 0 ? SCORE_NEVER_UP : SCORE_UNKNOWN;
+
+	/* Time to first audio is what the user waits for, the connect time
+	 * is only there for when the first audio was not measured */
+	for (i = 0; i < entry->n_samples; i++)
+		sum += entry->first_audio_times[i] ?
+			entry->first_audio_times[i] : entry->connect_times[i];
+
+	/* Recent failures weigh in */
+	score = sum / entry->n_samples * (1 + entry->n_failures);
+
+	return MIN(score, SCORE_UNKNOWN - 1);
+}
+
+static void
+set_integer_list(GKeyFile *keyfile, const gchar *group, const gchar *key,
+		 const guint *values, guint n_values)
+{
+	gint list[HISTORY_LENGTH];
+	guint i;
+
+	for (i = 0; i < n_values; i++)
+		list[i] = MIN(values[i], G_MAXINT);
+
+	g_key_file_set_integer_list(keyfile, group, key, list, n_values);
+}
+
+static guint
+get_integer_list(GKeyFile *keyfile, const gchar *group, const gchar *key,
+		 guint *values)
+{
+	gint *list;
+	gsize n_list = 0;
+	guint i, n = 0;
+
+	list = g_key_file_get_integer_list(keyfile, group, key, &n_list, NULL);
+	for (i = 0; i < n_list && n < HISTORY_LENGTH; i++)
+		if (list[i] >= 0)
+			values[n++] = list[i];
+	g_free(list);
+
+	return n;
+}
+
+/*
+ * Private methods
+ */
+
+static void
+gv_station_history_load(GvStationHistory *self)
+{
+	GvStationHistoryPrivate *priv = self->priv;
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	gchar **groups;
+	gint64 now;
+	guint i;
+
+	keyfile = g_key_file_new();
+	if (g_key_file_load_from_file(keyfile, priv->filename, G_KEY_FILE_NONE, &err) == FALSE) {
+		if (!g_error_matches(err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			INFO("Failed to load station history: %s", err->message);
+		g_clear_error(&err);
+		g_key_file_unref(keyfile);
+		return;
+	}
+
+	now = g_get_real_time();
+	groups = g_key_file_get_groups(keyfile, NULL);
+	for (i = 0; groups[i] != NULL; i++) {
+		GvHistoryEntry *entry;
+		gchar *uri;
+		gint64 last_used;
+		guint n_connect, n_first_audio;
+
+		uri = g_key_file_get_string(keyfile, groups[i], "Uri", NULL);
+		last_used = g_key_file_get_int64(keyfile, groups[i], "LastUsed", NULL);
+
+		if (uri == NULL || last_used < now - (gint64) ENTRY_MAX_AGE * G_USEC_PER_SEC) {
+			g_free(uri);
+			continue;
+		}
+
+		entry = g_new0(GvHistoryEntry, 1);
+		entry->last_used = last_used;
+		entry->last_failure = g_key_file_get_int64(keyfile, groups[i], "LastFailure", NULL);
+		entry->n_failures = MAX(g_key_file_get_integer(keyfile, groups[i], "Failures", NULL), 0);
+		entry->stream = g_key_file_get_string(keyfile, groups[i], "Stream", NULL);
+
+		n_connect = get_integer_list(keyfile, groups[i], "ConnectTimes",
+					     entry->connect_times);
+		n_first_audio = get_integer_list(keyfile, groups[i], "FirstAudioTimes",
+						 entry->first_audio_times);
+		entry->n_samples = MIN(n_connect, n_first_audio);
+
+		g_hash_table_replace(priv->entries, uri, entry);
+	}
+
+	DEBUG("Loaded history of %u uris", g_hash_table_size(priv->entries));
+
+	g_strfreev(groups);
+	g_key_file_unref(keyfile);
+}
+
+static gboolean
+when_timeout_save(GvStationHistory *self)
+{
+	GvStationHistoryPrivate *priv = self->priv;
+
+	priv->save_timeout_id = 0;
+	gv_station_history_save(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gv_station_history_save_delayed(GvStationHistory *self)
+{
+	GvStationHistoryPrivate *priv = self->priv;
+
+	/* Whatever comes next goes in the same save */
+	if (priv->save_timeout_id != 0)
+		return;
+
+	priv->save_timeout_id = g_timeout_add_seconds(SAVE_DELAY,
+			(GSourceFunc) when_timeout_save, self);
+}
+
+static GvHistoryEntry *
+gv_station_history_get_entry(GvStationHistory *self, const gchar *uri)
+{
+	GvStationHistoryPrivate *priv = self->priv;
+	GvHistoryEntry *entry;
+
+	entry = g_hash_table_lookup(priv->entries, uri);
+	if (entry != NULL)
+		return entry;
+
+	/* Make room by dropping the entry that was not used for the longest */
+	if (g_hash_table_size(priv->entries) >= MAX_ENTRIES) {
+		GHashTableIter iter;
+		gpointer key, value;
+		const gchar *oldest_uri = NULL;
+		gint64 oldest = G_MAXINT64;
+
+		g_hash_table_iter_init(&iter, priv->entries);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			GvHistoryEntry *e = value;
+
+			if (e->last_used < oldest) {
+				oldest = e->last_used;
+				oldest_uri = key;
+			}
+		}
+
+		g_hash_table_remove(priv->entries, oldest_uri);
+	}
+
+	entry = g_new0(GvHistoryEntry, 1);
+	g_hash_table_insert(priv->entries, g_strdup(uri), entry);
+
+	return entry;
+}
+
+static gint
+compare_uris(const gchar *a, const gchar *b, GvStationHistory *self)
+{
+	GvStationHistoryPrivate *priv = self->priv;
+	guint score_a, score_b;
+
+	score_a = entry_get_score(g_hash_table_lookup(priv->entries, a));
+	score_b = entry_get_score(g_hash_table_lookup(priv->entries, b));
+
+	return score_a < score_b ? -1 : score_a > score_b ? 1 : 0;
+}
+
+/*
+ * Property accessors
+ */
+
+const gchar *
+gv_station_history_get_filename(GvStationHistory *self)
+{
+	return self->priv->filename;
+}
+
+static void
+gv_station_history_set_filename(GvStationHistory *self, const gchar *filename)
+{
+	GvStationHistoryPrivate *priv = self->priv;
+
+	/* Construct-only property */
+	g_assert(priv->filename == NULL);
+	priv->filename = g_strdup(filename);
+}
+
+static void
+gv_station_history_get_property(GObject *object,
+				guint property_id,
+				GValue *value,
+				GParamSpec *pspec)
+{
+	GvStationHistory *self = GV_STATION_HISTORY(object);
+
+	TRACE_GET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_FILENAME:
+		g_value_set_string(value, gv_station_history_get_filename(self));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+static void
+gv_station_history_set_property(GObject *object,
+				guint property_id,
+				const GValue *value,
+				GParamSpec *pspec)
+{
+	GvStationHistory *self = GV_STATION_HISTORY(object);
+
+	TRACE_SET_PROPERTY(object, property_id, value, pspec);
+
+	switch (property_id) {
+	case PROP_FILENAME:
+		gv_station_history_set_filename(self, g_value_get_string(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+		break;
+	}
+}
+
+/*
+ * Public methods
+ */
+
+void
+gv_station_history_save(GvStationHistory *self)
+{
+	GvStationHistoryPrivate *priv = self->priv;
+	GHashTableIter iter;
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	gpointer key, value;
+	gchar *dirname;
+	guint n = 0;
+
+	g_clear_handle_id(&priv->save_timeout_id, g_source_remove);
+
+	dirname = g_path_get_dirname(priv->filename);
+	if (g_mkdir_with_parents(dirname, S_IRWXU) != 0) {
+		INFO("Failed to create directory '%s': %s", dirname, g_strerror(errno));
+		g_free(dirname);
+		return;
+	}
+	g_free(dirname);
+
+	keyfile = g_key_file_new();
+	g_hash_table_iter_init(&iter, priv->entries);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		GvHistoryEntry *entry = value;
+		gchar *group;
+
+		group = g_strdup_printf("Uri %u", n++);
+		g_key_file_set_string(keyfile, group, "Uri", key);
+		g_key_file_set_int64(keyfile, group, "LastUsed", entry->last_used);
+		if (entry->n_samples > 0) {
+			set_integer_list(keyfile, group, "ConnectTimes",
+					 entry->connect_times, entry->n_samples);
+			set_integer_list(keyfile, group, "FirstAudioTimes",
+					 entry->first_audio_times, entry->n_samples);
+		}
+		if (entry->n_failures > 0) {
+			g_key_file_set_integer(keyfile, group, "Failures", entry->n_failures);
+			g_key_file_set_int64(keyfile, group, "LastFailure", entry->last_failure);
+		}
+		if (entry->stream != NULL)
+			g_key_file_set_string(keyfile, group, "Stream", entry->stream);
+		g_free(group);
+	}
+
+	if (g_key_file_save_to_file(keyfile, priv->filename, &err) == FALSE) {
+		INFO("Failed to save station history: %s", err->message);
+		g_clear_error(&err);
+	}
+
+	g_key_file_unref(keyfile);
+}
+
+void
+gv_station_history_record_success(GvStationHistory *self, const gchar *uri,
+				  guint connect_time, guint first_audio_time)
+{
+	GvHistoryEntry *entry;
+
+	g_return_if_fail(uri != NULL);
+
+	DEBUG("Stream played: %s (connect %u ms, first audio %u ms)",
+	      uri, connect_time, first_audio_time);
+
+	entry = gv_station_history_get_entry(self, uri);
+	entry_add_sample(entry, connect_time, first_audio_time);
+	entry->n_failures = 0;
+	entry->last_used = g_get_real_time();
+
+	gv_station_history_save_delayed(self);
+}
+
+void
+gv_station_history_record_failure(GvStationHistory *self, const gchar *uri)
+{
+	GvHistoryEntry *entry;
+
+	g_return_if_fail(uri != NULL);
+
+	entry = gv_station_history_get_entry(self, uri);
+	entry->n_failures++;
+	entry->last_failure = g_get_real_time();
+	entry->last_used = entry->last_failure;
+
+	DEBUG("Stream failed: %s (%u in a row)", uri, entry->n_failures);
+
+	gv_station_history_save_delayed(self);
+}
+
+gboolean
+gv_station_history_is_failing(GvStationHistory *self, const gchar *uri)
+{
+	GvHistoryEntry *entry;
+
+	entry = g_hash_table_lookup(self->priv->entries, uri);
+	if (entry == NULL || entry->n_failures < CHRONIC_FAILURES)
+		return FALSE;
+
+	/* Give it another chance after a while */
+	return entry->last_failure > g_get_real_time() - (gint64) FAILING_TTL * G_USEC_PER_SEC;
+}
+
+/* Takes a list of uris (strings), and returns it reordered, best first.
+ * Uris that keep failing are removed from the list (and freed), unless
+ * they're all failing, in which case there's no point in leaving them out.
+ * Uris we know nothing about keep their relative order, after the ones that
+ * worked. */
+GSList *
+gv_station_history_order(GvStationHistory *self, GSList *uris)
+{
+	GSList *item, *next, *failing = NULL;
+
+	for (item = uris; item; item = next) {
+		next = item->next;
+		if (gv_station_history_is_failing(self, item->data) == FALSE)
+			continue;
+
+		DEBUG("Leaving aside failing stream: %s", (const gchar *) item->data);
+		uris = g_slist_remove_link(uris, item);
+		failing = g_slist_concat(failing, item);
+	}
+
+	if (uris == NULL)
+		uris = g_steal_pointer(&failing);
+	else
+		g_slist_free_full(failing, g_free);
+
+	/* GSList sort is stable */
+	return g_slist_sort_with_data(uris, (GCompareDataFunc) compare_uris, self);
+}
+
+const gchar *
+gv_station_history_get_stream(GvStationHistory *self, const gchar *playlist_uri)
+{
+	GvHistoryEntry *entry;
+
+	g_return_val_if_fail(playlist_uri != NULL, NULL);
+
+	entry = g_hash_table_lookup(self->priv->entries, playlist_uri);
+
+	return entry ? entry->stream : NULL;
+}
+
+void
+gv_station_history_set_stream(GvStationHistory *self, const gchar *playlist_uri,
+			      const gchar *stream_uri)
+{
+	GvHistoryEntry *entry;
+
+	g_return_if_fail(playlist_uri != NULL);
+
+	entry = g_hash_table_lookup(self->priv->entries, playlist_uri);
+	if (entry == NULL && stream_uri == NULL)
+		return;
+	if (entry != NULL && !g_strcmp0(entry->stream, stream_uri))
+		return;
+
+	entry = gv_station_history_get_entry(self, playlist_uri);
+	g_free(entry->stream);
+	entry->stream = g_strdup(stream_uri);
+	entry->last_used = g_get_real_time();
+
+	gv_station_history_save_delayed(self);
+}
+
+GvStationHistory *
+gv_station_history_new(const gchar *filename)
+{
+	return g_object_new(GV_TYPE_STATION_HISTORY, "filename", filename, NULL);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_station_history_finalize(GObject *object)
+{
+	GvStationHistory *self = GV_STATION_HISTORY(object);
+	GvStationHistoryPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	/* Run any pending save operation */
+	if (priv->save_timeout_id != 0)
+		gv_station_history_save(self);
+
+	g_hash_table_unref(priv->entries);
+	g_free(priv->filename);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_station_history, object);
+}
+
+static void
+gv_station_history_constructed(GObject *object)
+{
+	GvStationHistory *self = GV_STATION_HISTORY(object);
+	GvStationHistoryPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	g_assert(priv->filename != NULL);
+
+	gv_station_history_load(self);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_CONSTRUCTED(gv_station_history, object);
+}
+
+static void
+gv_station_history_init(GvStationHistory *self)
+{
+	TRACE("%p", self);
+
+	/* Initialize private pointer */
+	self->priv = gv_station_history_get_instance_private(self);
+
+	self->priv->entries = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, (GDestroyNotify) entry_free);
+}
+
+static void
+gv_station_history_class_init(GvStationHistoryClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+	TRACE("%p", class);
+
+	/* Override GObject methods */
+	object_class->finalize = gv_station_history_finalize;
+	object_class->constructed = gv_station_history_constructed;
+
+	/* Properties */
+	object_class->get_property = gv_station_history_get_property;
+	object_class->set_property = gv_station_history_set_property;
+
+	properties[PROP_FILENAME] =
+		g_param_spec_string("filename", "Filename", NULL, NULL,
+				    GV_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+	g_object_class_install_properties(object_class, PROP_N, properties);
+}
@@ -0,0 +1,49 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+/* GObject declarations */
+
+#define GV_TYPE_STATION_HISTORY gv_station_history_get_type()
+
+G_DECLARE_FINAL_TYPE(GvStationHistory, gv_station_history, GV, STATION_HISTORY, GObject)
+
+/* Methods */
+
+GvStationHistory *gv_station_history_new(const gchar *filename);
+
+void         gv_station_history_record_success(GvStationHistory *self, const gchar *uri,
+					       guint connect_time, guint first_audio_time);
+void         gv_station_history_record_failure(GvStationHistory *self, const gchar *uri);
+gboolean     gv_station_history_is_failing    (GvStationHistory *self, const gchar *uri);
+GSList      *gv_station_history_order         (GvStationHistory *self, GSList *uris);
+
+const gchar *gv_station_history_get_stream(GvStationHistory *self, const gchar *playlist_uri);
+void         gv_station_history_set_stream(GvStationHistory *self, const gchar *playlist_uri,
+					   const gchar *stream_uri);
+
+void         gv_station_history_save(GvStationHistory *self);
+
+/* Property accessors */
+
+const gchar *gv_station_history_get_filename(GvStationHistory *self);
@@ -29,9 +29,6 @@
 
 #include "core/gv-station-list.h"
 
-// WISHED Try with a huge number of stations to see how it behaves.
-//        It might be slow. The implementation never tried to be fast.
-
 /*
  * More defines...
  */
@@ -78,6 +75,30 @@ static guint signals[SIGNAL_N];
  * GObject definitions
  */
 
+/* Each station in the list has an entry, that knows its position in the
+ * array, and the keys it was indexed with. We need to keep the keys around,
+ * as by the time a station notifies a change of name or uri, the old value
+ * is gone already.
+ */
+
+typedef struct {
+	guint position;
+	gchar *name;
+	gchar *uri;
+} GvStationListEntry;
+
+/* Names and uris are not guaranteed to be unique. Duplicates are refused
+ * on insertion, but nothing prevents a station from being renamed. So an
+ * index keeps the first station that claimed a key, and counts the others,
+ * so that it knows when to look for a new owner if the first one goes away.
+ */
+
+typedef struct {
+	GHashTable *stations;  // key -> station
+	gsize key_offset;      // offset of the key in an entry
+	guint n_shadowed;      // number of stations hidden behind another
+} GvStationIndex;
+
 struct _GvStationListPrivate {
 	gchar *default_stations;
 	/* Paths */
@@ -88,12 +109,18 @@ struct _GvStationListPrivate {
 	guint save_timeout_id;
 	/* Set to true during object finalization */
 	gboolean finalization;
-	/* Ordered list of stations */
-	GList *stations;
-	/* Shuffled list of stations, automatically created
-	 * and destroyed when needed.
+	/* Ordered array of stations */
+	GPtrArray *stations;
+	/* Indexes, to find stations without walking the array */
+	GHashTable *entries;
+	GHashTable *by_uid;
+	GvStationIndex by_name;
+	GvStationIndex by_uri;
+	/* Shuffled array of stations, and position of each station
+	 * within. Automatically created and destroyed when needed.
 	 */
-	GList *shuffled;
+	GPtrArray *shuffled;
+	GHashTable *shuffled_positions;
 };
 
 typedef struct _GvStationListPrivate GvStationListPrivate;
@@ -119,6 +146,14 @@ copy_func_object_ref(gconstpointer src, gpointer data G_GNUC_UNUSED)
 	return g_object_ref((gpointer) src);
 }
 
+static void
+entry_free(GvStationListEntry *entry)
+{
+	g_free(entry->name);
+	g_free(entry->uri);
+	g_free(entry);
+}
+
 /*
  * Paths helpers
  */
@@ -171,6 +206,7 @@ struct _GvMarkupParsing {
 	gchar *uri;
 	gchar *insecure;
 	gchar *user_agent;
+	gchar *buffering_profile;
 };
 
 typedef struct _GvMarkupParsing GvMarkupParsing;
@@ -223,6 +259,8 @@ markup_on_end_element(GMarkupParseContext *context G_GNUC_UNUSED,
 		gv_station_set_insecure(station, TRUE);
 	if (parsing->user_agent)
 		gv_station_set_user_agent(station, parsing->user_agent);
+	if (parsing->buffering_profile)
+		gv_station_set_buffering_profile(station, parsing->buffering_profile);
 
 	/* We must take ownership right now */
 	g_object_ref_sink(station);
@@ -236,6 +274,7 @@ cleanup:
 	g_clear_pointer(&parsing->uri, g_free);
 	g_clear_pointer(&parsing->insecure, g_free);
 	g_clear_pointer(&parsing->user_agent, g_free);
+	g_clear_pointer(&parsing->buffering_profile, g_free);
 }
 
 static void
@@ -258,6 +297,7 @@ markup_on_start_element(GMarkupParseContext *context G_GNUC_UNUSED,
 		g_assert(parsing->uri == NULL);
 		g_assert(parsing->insecure == NULL);
 		g_assert(parsing->user_agent == NULL);
+		g_assert(parsing->buffering_profile == NULL);
 		return;
 	}
 
@@ -289,6 +329,13 @@ markup_on_start_element(GMarkupParseContext *context G_GNUC_UNUSED,
 		return;
 	}
 
+	/* Buffering profile property */
+	if (!g_strcmp0(element_name, "buffering-profile")) {
+		g_assert(parsing->buffering_profile == NULL);
+		parsing->cur = &parsing->buffering_profile;
+		return;
+	}
+
 	WARNING("Unexpected element: '%s'", element_name);
 }
 
@@ -304,6 +351,7 @@ markup_on_error(GMarkupParseContext *context G_GNUC_UNUSED,
 	g_clear_pointer(&parsing->uri, g_free);
 	g_clear_pointer(&parsing->insecure, g_free);
 	g_clear_pointer(&parsing->user_agent, g_free);
+	g_clear_pointer(&parsing->buffering_profile, g_free);
 }
 
 static gboolean
@@ -323,6 +371,7 @@ parse_markup(const gchar *text, GList **list, GError **err)
 		NULL,
 		NULL,
 		NULL,
+		NULL,
 		NULL
 	};
 	gboolean ret;
@@ -362,6 +411,7 @@ print_markup_station(GvStation *station)
 	const gchar *uri = gv_station_get_uri(station);
 	const gchar *insecure = gv_station_get_insecure(station) ? "true" : NULL;
 	const gchar *user_agent = gv_station_get_user_agent(station);
+	const gchar *buffering_profile = gv_station_get_buffering_profile(station);
 	GString *string;
 
 	/* A station is supposed to have an uri */
@@ -385,6 +435,9 @@ print_markup_station(GvStation *station)
 	if (user_agent)
 		g_string_append_markup_tag_escaped(string, "user-agent", user_agent);
 
+	if (buffering_profile)
+		g_string_append_markup_tag_escaped(string, "buffering-profile", buffering_profile);
+
 	g_string_append(string, "  </Station>\n");
 
 	/* Return */
@@ -392,10 +445,10 @@ print_markup_station(GvStation *station)
 }
 
 static gboolean
-print_markup(GList *list, gchar **markup, gsize *length, GError **err)
+print_markup(GPtrArray *stations, gchar **markup, gsize *length, GError **err)
 {
-	GList *item;
 	GString *string;
+	guint i;
 
 	g_return_val_if_fail(markup != NULL, FALSE);
 	g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
@@ -403,8 +456,8 @@ print_markup(GList *list, gchar **markup, gsize *length, GError **err)
 	string = g_string_new(NULL);
 	g_string_append(string, "<Stations>\n");
 
-	for (item = list; item; item = item->next) {
-		GvStation *station = GV_STATION(item->data);
+	for (i = 0; i < stations->len; i++) {
+		GvStation *station = g_ptr_array_index(stations, i);
 		gchar *text;
 
 		text = print_markup_station(station);
@@ -460,13 +513,13 @@ end:
 }
 
 static gboolean
-save_station_list_to_string(GList *list, gchar **text, gsize *length, GError **err)
+save_station_list_to_string(GPtrArray *stations, gchar **text, gsize *length, GError **err)
 {
-	return print_markup(list, text, length, err);
+	return print_markup(stations, text, length, err);
 }
 
 static gboolean
-save_station_list_to_file(GList *list, const gchar *path, GError **err)
+save_station_list_to_file(GPtrArray *stations, const gchar *path, GError **err)
 {
 	gboolean ret;
 	gsize length = 0;
@@ -481,7 +534,7 @@ save_station_list_to_file(GList *list, const gchar *path, GError **err)
 		return TRUE;
 
 	/* Prepare text to write */
-	ret = save_station_list_to_string(list, &text, &length, err);
+	ret = save_station_list_to_string(stations, &text, &length, err);
 	if (ret == FALSE) {
 		g_assert(err == NULL || *err != NULL);
 		goto end;
@@ -515,18 +568,19 @@ end:
  */
 
 struct _GvStationListIter {
-	GList *head, *item;
+	GPtrArray *stations;
+	guint index;
 };
 
 GvStationListIter *
 gv_station_list_iter_new(GvStationList *self)
 {
-	GList *list = self->priv->stations;
+	GPtrArray *stations = self->priv->stations;
 	GvStationListIter *iter;
 
 	iter = g_new0(GvStationListIter, 1);
-	iter->head = g_list_copy_deep(list, copy_func_object_ref, NULL);
-	iter->item = iter->head;
+	iter->stations = g_ptr_array_copy(stations, copy_func_object_ref, NULL);
+	g_ptr_array_set_free_func(iter->stations, g_object_unref);
 
 	return iter;
 }
@@ -536,7 +590,7 @@ gv_station_list_iter_free(GvStationListIter *iter)
 {
 	g_return_if_fail(iter != NULL);
 
-	g_list_free_full(iter->head, g_object_unref);
+	g_ptr_array_unref(iter->stations);
 	g_free(iter);
 }
 
@@ -548,96 +602,284 @@ gv_station_list_iter_loop(GvStationListIter *iter, GvStation **station)
 
 	*station = NULL;
 
-	if (iter->item == NULL)
+	if (iter->index >= iter->stations->len)
 		return FALSE;
 
-	*station = iter->item->data;
-	iter->item = iter->item->next;
+	*station = g_ptr_array_index(iter->stations, iter->index);
+	iter->index++;
 
 	return TRUE;
 }
 
 /*
- * GList additions
+ * Indexes
  */
 
-static gint
-glist_sortfunc_random(gconstpointer a G_GNUC_UNUSED, gconstpointer b G_GNUC_UNUSED)
+#define ENTRY_KEY(index, entry) G_STRUCT_MEMBER(gchar *, entry, (index)->key_offset)
+
+static void
+station_index_init(GvStationIndex *index, gsize key_offset)
 {
-	return g_random_boolean() ? 1 : -1;
+	index->stations = g_hash_table_new(g_str_hash, g_str_equal);
+	index->key_offset = key_offset;
+	index->n_shadowed = 0;
 }
 
-static GList *
-g_list_shuffle(GList *list)
+static void
+station_index_clear(GvStationIndex *index)
 {
-	/* Shuffle twice. Credits goes to:
-	 * http://www.linuxforums.org/forum/programming-scripting/
-	 * 202125-fastest-way-shuffle-linked-list.html
-	 */
-	list = g_list_sort(list, glist_sortfunc_random);
-	list = g_list_sort(list, glist_sortfunc_random);
-	return list;
+	g_hash_table_remove_all(index->stations);
+	index->n_shadowed = 0;
 }
 
-static GList *
-g_list_copy_deep_shuffle(GList *list, GCopyFunc func, gpointer user_data)
+static void
+station_index_add(GvStationIndex *index, GvStationListEntry *entry, GvStation *station)
 {
-	list = g_list_copy_deep(list, func, user_data);
-	list = g_list_shuffle(list);
-	return list;
+	const gchar *key = ENTRY_KEY(index, entry);
+
+	if (key == NULL)
+		return;
+
+	if (g_hash_table_contains(index->stations, key)) {
+		index->n_shadowed++;
+		return;
+	}
+
+	/* The key belongs to the entry, no need to copy it */
+	g_hash_table_insert(index->stations, (gpointer) key, station);
 }
 
-/*
- * Helpers
- */
+static void
+station_index_remove(GvStationIndex *index, GvStationListEntry *entry, GvStation *station,
+		     GvStationListPrivate *priv)
+{
+	const gchar *key = ENTRY_KEY(index, entry);
+	guint i;
 
-static gint
-are_stations_similar(GvStation *s1, GvStation *s2)
+	if (key == NULL)
+		return;
+
+	/* If the station was hidden behind another, there's not much to do */
+	if (g_hash_table_lookup(index->stations, key) != station) {
+		g_assert(index->n_shadowed > 0);
+		index->n_shadowed--;
+		return;
+	}
+
+	g_hash_table_remove(index->stations, key);
+
+	/* Most of the time, no other station wants this key */
+	if (index->n_shadowed == 0)
+		return;
+
+	/* Otherwise, hand it over to the first one we find */
+	for (i = 0; i < priv->stations->len; i++) {
+		GvStation *other = g_ptr_array_index(priv->stations, i);
+		GvStationListEntry *other_entry;
+		const gchar *other_key;
+
+		if (other == station)
+			continue;
+
+		other_entry = g_hash_table_lookup(priv->entries, other);
+		other_key = ENTRY_KEY(index, other_entry);
+		if (g_strcmp0(key, other_key) != 0)
+			continue;
+
+		g_hash_table_insert(index->stations, (gpointer) other_key, other);
+		index->n_shadowed--;
+		break;
+	}
+}
+
+static void
+gv_station_list_index_station(GvStationList *self, GvStation *station, guint position)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvStationListEntry *entry;
+
+	entry = g_new0(GvStationListEntry, 1);
+	entry->position = position;
+	entry->name = g_strdup(gv_station_get_name(station));
+	entry->uri = g_strdup(gv_station_get_uri(station));
+	g_hash_table_insert(priv->entries, station, entry);
+
+	/* The uid belongs to the station, and never changes */
+	g_hash_table_insert(priv->by_uid, (gpointer) gv_station_get_uid(station), station);
+	station_index_add(&priv->by_name, entry, station);
+	station_index_add(&priv->by_uri, entry, station);
+}
+
+static void
+gv_station_list_unindex_station(GvStationList *self, GvStation *station)
 {
-	if (s1 == s2) {
-		WARNING("Stations %p and %p are the same", s1, s2);
-		return 0;
+	GvStationListPrivate *priv = self->priv;
+	GvStationListEntry *entry;
+
+	entry = g_hash_table_lookup(priv->entries, station);
+	g_return_if_fail(entry != NULL);
+
+	station_index_remove(&priv->by_name, entry, station, priv);
+	station_index_remove(&priv->by_uri, entry, station, priv);
+	g_hash_table_remove(priv->by_uid, gv_station_get_uid(station));
+	g_hash_table_remove(priv->entries, station);
+}
+
+static void
+gv_station_list_reindex_station(GvStationList *self, GvStation *station,
+				GvStationIndex *index, const gchar *key)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvStationListEntry *entry;
+	gchar **entry_key;
+
+	entry = g_hash_table_lookup(priv->entries, station);
+	if (entry == NULL)
+		return;
+
+	entry_key = G_STRUCT_MEMBER_P(entry, index->key_offset);
+	if (!g_strcmp0(*entry_key, key))
+		return;
+
+	station_index_remove(index, entry, station, priv);
+	g_free(*entry_key);
+	*entry_key = g_strdup(key);
+	station_index_add(index, entry, station);
+}
+
+static void
+gv_station_list_update_positions(GvStationList *self, guint from, guint to)
+{
+	GvStationListPrivate *priv = self->priv;
+	guint i;
+
+	for (i = from; i < to; i++) {
+		GvStation *station = g_ptr_array_index(priv->stations, i);
+		GvStationListEntry *entry = g_hash_table_lookup(priv->entries, station);
+
+		entry->position = i;
 	}
+}
+
+static gint
+gv_station_list_index_of(GvStationList *self, GvStation *station)
+{
+	GvStationListPrivate *priv = self->priv;
+	GvStationListEntry *entry;
 
-	if (s1 == NULL || s2 == NULL)
+	if (station == NULL)
 		return -1;
 
-	/* Compare uids */
-	const gchar *s1_uid, *s2_uid;
-	s1_uid = gv_station_get_uid(s1);
-	s2_uid = gv_station_get_uid(s2);
+	entry = g_hash_table_lookup(priv->entries, station);
+
+	return entry ? (gint) entry->position : -1;
+}
 
-	if (!g_strcmp0(s1_uid, s2_uid)) {
-		WARNING("Stations %p and %p have the same uid '%s'", s1, s2, s1_uid);
-		return 0;
+/* Look for a station that is similar enough to the one given, so that it
+ * shouldn't be added to the list. Duplicates are a programming error, we
+ * must warn about that. Identical fields are an user error.
+ */
+static GvStation *
+gv_station_list_find_similar(GvStationList *self, GvStation *station)
+{
+	GvStationListPrivate *priv = self->priv;
+	const gchar *uid, *name, *uri;
+	GvStation *similar;
+
+	if (g_hash_table_contains(priv->entries, station)) {
+		WARNING("Station %p is already part of the list", station);
+		return station;
 	}
 
-	/* Compare names.
-	 * Two stations who don't have name are different.
-	 */
-	const gchar *s1_name, *s2_name;
-	s1_name = gv_station_get_name(s1);
-	s2_name = gv_station_get_name(s2);
+	/* Compare uids */
+	uid = gv_station_get_uid(station);
+	similar = g_hash_table_lookup(priv->by_uid, uid);
+	if (similar) {
+		WARNING("Stations %p and %p have the same uid '%s'", station, similar, uid);
+		return similar;
+	}
 
-	if (s1_name == NULL && s2_name == NULL)
-		return -1;
+	/* Compare names */
+	name = gv_station_get_name(station);
+	if (name) {
+		similar = g_hash_table_lookup(priv->by_name.stations, name);
+		if (similar) {
+			DEBUG("Stations %p and %p have the same name '%s'", station, similar, name);
+			return similar;
+		}
+	}
 
-	if (!g_strcmp0(s1_name, s2_name)) {
-		DEBUG("Stations %p and %p have the same name '%s'", s1, s2, s1_name);
-		return 0;
+	/* Compare uris. Two stations who don't have name are different. */
+	uri = gv_station_get_uri(station);
+	if (uri) {
+		similar = g_hash_table_lookup(priv->by_uri.stations, uri);
+		if (similar && (name || gv_station_get_name(similar))) {
+			DEBUG("Stations %p and %p have the same uri '%s'", station, similar, uri);
+			return similar;
+		}
 	}
 
-	/* Compare uris */
-	const gchar *s1_uri, *s2_uri;
-	s1_uri = gv_station_get_uri(s1);
-	s2_uri = gv_station_get_uri(s2);
+	return NULL;
+}
+
+/*
+ * Shuffling
+ */
 
-	if (!g_strcmp0(s1_uri, s2_uri)) {
-		DEBUG("Stations %p and %p have the same uri '%s'", s1, s2, s1_uri);
-		return 0;
+static void
+gv_station_list_swap_shuffled(GvStationList *self, guint i, guint j)
+{
+	GvStationListPrivate *priv = self->priv;
+	gpointer *pdata = priv->shuffled->pdata;
+	gpointer tmp;
+
+	tmp = pdata[i];
+	pdata[i] = pdata[j];
+	pdata[j] = tmp;
+
+	g_hash_table_insert(priv->shuffled_positions, pdata[i], GUINT_TO_POINTER(i + 1));
+	g_hash_table_insert(priv->shuffled_positions, pdata[j], GUINT_TO_POINTER(j + 1));
+}
+
+static void
+gv_station_list_shuffle(GvStationList *self)
+{
+	GvStationListPrivate *priv = self->priv;
+	guint i;
+
+	/* The shuffled array doesn't hold references, it's destroyed
+	 * as soon as a station is added or removed.
+	 */
+	if (priv->shuffled == NULL) {
+		priv->shuffled = g_ptr_array_copy(priv->stations, NULL, NULL);
+		priv->shuffled_positions = g_hash_table_new(NULL, NULL);
 	}
 
-	return -1;
+	/* Fisher-Yates */
+	for (i = priv->shuffled->len; i > 1; i--)
+		gv_station_list_swap_shuffled(self, i - 1, g_random_int_range(0, i));
+
+	/* The first station might never have been swapped */
+	if (priv->shuffled->len > 0)
+		g_hash_table_insert(priv->shuffled_positions,
+				    g_ptr_array_index(priv->shuffled, 0), GUINT_TO_POINTER(1));
+}
+
+static void
+gv_station_list_clear_shuffled(GvStationList *self)
+{
+	GvStationListPrivate *priv = self->priv;
+
+	g_clear_pointer(&priv->shuffled, g_ptr_array_unref);
+	g_clear_pointer(&priv->shuffled_positions, g_hash_table_unref);
+}
+
+static gint
+gv_station_list_shuffled_index_of(GvStationList *self, GvStation *station)
+{
+	GvStationListPrivate *priv = self->priv;
+
+	return (gint) GPOINTER_TO_UINT(g_hash_table_lookup(priv->shuffled_positions, station)) - 1;
 }
 
 /*
@@ -672,15 +914,25 @@ on_station_notify(GvStation *station,
 		  GParamSpec *pspec,
 		  GvStationList *self)
 {
+	GvStationListPrivate *priv = self->priv;
 	const gchar *property_name = g_param_spec_get_name(pspec);
 
 	TRACE("%s, %s, %p", gv_station_get_uid(station), property_name, self);
 
+	/* Keep the indexes in sync */
+	if (!g_strcmp0(property_name, "name"))
+		gv_station_list_reindex_station(self, station, &priv->by_name,
+						gv_station_get_name(station));
+	else if (!g_strcmp0(property_name, "uri"))
+		gv_station_list_reindex_station(self, station, &priv->by_uri,
+						gv_station_get_uri(station));
+
 	/* We might want to save changes */
 	if (!g_strcmp0(property_name, "uri") ||
 	    !g_strcmp0(property_name, "name") ||
 	    !g_strcmp0(property_name, "insecure") ||
-	    !g_strcmp0(property_name, "user-agent")) {
+	    !g_strcmp0(property_name, "user-agent") ||
+	    !g_strcmp0(property_name, "buffering-profile")) {
 		gv_station_list_save_delayed(self);
 	}
 
@@ -811,19 +1063,23 @@ void
 gv_station_list_empty(GvStationList *self)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *item;
+	guint i;
 
 	/* Iterate on station list and disconnect all signal handlers */
-	for (item = priv->stations; item; item = item->next)
-		g_signal_handlers_disconnect_by_data(item->data, self);
+	for (i = 0; i < priv->stations->len; i++)
+		g_signal_handlers_disconnect_by_data(g_ptr_array_index(priv->stations, i), self);
+
+	/* Destroy the indexes */
+	g_hash_table_remove_all(priv->entries);
+	g_hash_table_remove_all(priv->by_uid);
+	station_index_clear(&priv->by_name);
+	station_index_clear(&priv->by_uri);
 
 	/* Destroy the station list */
-	g_list_free_full(priv->stations, g_object_unref);
-	priv->stations = NULL;
+	g_ptr_array_set_size(priv->stations, 0);
 
 	/* Destroy the shuffled station list */
-	g_list_free_full(priv->shuffled, g_object_unref);
-	priv->shuffled = NULL;
+	gv_station_list_clear_shuffled(self);
 
 	/* Emit a signal */
 	g_signal_emit(self, signals[SIGNAL_EMPTIED], 0);
@@ -836,7 +1092,7 @@ void
 gv_station_list_remove(GvStationList *self, GvStation *station)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *item;
+	gint pos;
 
 	/* Ensure a valid station was given */
 	if (station == NULL) {
@@ -850,8 +1106,8 @@ gv_station_list_remove(GvStationList *self, GvStation *station)
 	/* Check that we own this station at first. If we don't find it
 	 * in our internal list, it's probably a programming error.
 	 */
-	item = g_list_find(priv->stations, station);
-	if (item == NULL) {
+	pos = gv_station_list_index_of(self, station);
+	if (pos == -1) {
 		WARNING("GvStation %p (%s) not found in list",
 			station, gv_station_get_uid(station));
 		return;
@@ -861,22 +1117,19 @@ gv_station_list_remove(GvStationList *self, GvStation *station)
 	g_signal_handlers_disconnect_by_data(station, self);
 
 	/* Remove from list */
-	priv->stations = g_list_remove_link(priv->stations, item);
-	g_list_free(item);
-
-	/* Unown the station */
-	g_object_unref(station);
+	gv_station_list_unindex_station(self, station);
+	g_ptr_array_remove_index(priv->stations, pos);
+	gv_station_list_update_positions(self, pos, priv->stations->len);
 
-	/* Rebuild the shuffled station list */
-	if (priv->shuffled) {
-		g_list_free_full(priv->shuffled, g_object_unref);
-		priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-							  copy_func_object_ref, NULL);
-	}
+	/* Destroy the shuffled station list, it will be re-created if needed */
+	gv_station_list_clear_shuffled(self);
 
 	/* Emit a signal */
 	g_signal_emit(self, signals[SIGNAL_STATION_REMOVED], 0, station);
 
+	/* Unown the station */
+	g_object_unref(station);
+
 	/* Save */
 	gv_station_list_save_delayed(self);
 }
@@ -885,39 +1138,32 @@ void
 gv_station_list_insert(GvStationList *self, GvStation *station, gint pos)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *similar_item;
 
 	g_return_if_fail(station != NULL);
 
 	/* Give info */
 	INFO("Inserting station '%s'", gv_station_get_name_or_uri(station));
 
-	/* Check that the station is not already part of the list.
-	 * Duplicates are a programming error, we must warn about that.
-	 * Identical fields are an user error.
-	 * Warnings and such are encapsulated in the GCompareFunc used
-	 * here, this is messy but temporary (hopefully).
-	 */
-	similar_item = g_list_find_custom(priv->stations, station,
-					  (GCompareFunc) are_stations_similar);
-	if (similar_item)
+	/* Check that the station is not already part of the list */
+	if (gv_station_list_find_similar(self, station))
 		return;
 
 	/* Take ownership of the station */
 	g_object_ref_sink(station);
 
 	/* Add to the list at the right position */
-	priv->stations = g_list_insert(priv->stations, station, pos);
+	if (pos < 0 || (guint) pos > priv->stations->len)
+		pos = priv->stations->len;
+
+	g_ptr_array_insert(priv->stations, pos, station);
+	gv_station_list_index_station(self, station, pos);
+	gv_station_list_update_positions(self, pos + 1, priv->stations->len);
 
 	/* Connect to notify signal */
 	g_signal_connect_object(station, "notify", G_CALLBACK(on_station_notify), self, 0);
 
-	/* Rebuild the shuffled station list */
-	if (priv->shuffled) {
-		g_list_free_full(priv->shuffled, g_object_unref);
-		priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-							  copy_func_object_ref, NULL);
-	}
+	/* Destroy the shuffled station list, it will be re-created if needed */
+	gv_station_list_clear_shuffled(self);
 
 	/* Emit a signal */
 	g_signal_emit(self, signals[SIGNAL_STATION_ADDED], 0, station);
@@ -929,12 +1175,11 @@ gv_station_list_insert(GvStationList *self, GvStation *station, gint pos)
 void
 gv_station_list_insert_before(GvStationList *self, GvStation *station, GvStation *before)
 {
-	GvStationListPrivate *priv = self->priv;
 	gint pos;
 
 	g_return_if_fail(before != NULL);
 
-	pos = g_list_index(priv->stations, before);
+	pos = gv_station_list_index_of(self, before);
 	g_return_if_fail(pos != -1);
 
 	gv_station_list_insert(self, station, pos);
@@ -943,12 +1188,11 @@ gv_station_list_insert_before(GvStationList *self, GvStation *station, GvStation
 void
 gv_station_list_insert_after(GvStationList *self, GvStation *station, GvStation *after)
 {
-	GvStationListPrivate *priv = self->priv;
 	gint pos;
 
 	g_return_if_fail(after != NULL);
 
-	pos = g_list_index(priv->stations, after);
+	pos = gv_station_list_index_of(self, after);
 	g_return_if_fail(pos != -1);
 
 	pos += 1;
@@ -971,18 +1215,27 @@ void
 gv_station_list_move(GvStationList *self, GvStation *station, gint pos)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *item;
+	guint len = priv->stations->len;
+	gint old_pos;
 
 	g_return_if_fail(station != NULL);
 
 	/* Find the station */
-	item = g_list_find(priv->stations, station);
-	g_return_if_fail(item != NULL);
+	old_pos = gv_station_list_index_of(self, station);
+	g_return_if_fail(old_pos != -1);
+
+	/* The position is given as if the station was inserted again,
+	 * before being removed from its current position.
+	 */
+	if (pos < 0 || (guint) pos > len)
+		pos = len;
+	if (pos > old_pos)
+		pos -= 1;
 
 	/* Move it */
-	priv->stations = g_list_insert(priv->stations, station, pos);
-	priv->stations = g_list_remove_link(priv->stations, item);
-	g_list_free(item);
+	g_ptr_array_remove_index(priv->stations, old_pos);
+	g_ptr_array_insert(priv->stations, pos, station);
+	gv_station_list_update_positions(self, MIN(pos, old_pos), MAX(pos, old_pos) + 1);
 
 	/* Emit a signal */
 	g_signal_emit(self, signals[SIGNAL_STATION_MOVED], 0, station);
@@ -994,12 +1247,11 @@ gv_station_list_move(GvStationList *self, GvStation *station, gint pos)
 void
 gv_station_list_move_before(GvStationList *self, GvStation *station, GvStation *before)
 {
-	GvStationListPrivate *priv = self->priv;
 	gint pos;
 
 	g_return_if_fail(before != NULL);
 
-	pos = g_list_index(priv->stations, before);
+	pos = gv_station_list_index_of(self, before);
 	g_return_if_fail(pos != -1);
 
 	gv_station_list_move(self, station, pos);
@@ -1008,12 +1260,11 @@ gv_station_list_move_before(GvStationList *self, GvStation *station, GvStation *
 void
 gv_station_list_move_after(GvStationList *self, GvStation *station, GvStation *after)
 {
-	GvStationListPrivate *priv = self->priv;
 	gint pos;
 
 	g_return_if_fail(after != NULL);
 
-	pos = g_list_index(priv->stations, after);
+	pos = gv_station_list_index_of(self, after);
 	g_return_if_fail(pos != -1);
 
 	pos += 1;
@@ -1037,40 +1288,38 @@ gv_station_list_prev(GvStationList *self, GvStation *station,
 		     gboolean repeat, gboolean shuffle)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *stations, *item;
+	GPtrArray *stations;
+	gint pos;
+
+	/* If the station list is empty, bail out */
+	if (priv->stations->len == 0)
+		return NULL;
 
 	/* Pickup the right station list, create shuffle list if needed */
 	if (shuffle) {
-		if (priv->shuffled == NULL) {
-			priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-								  copy_func_object_ref, NULL);
-		}
+		if (priv->shuffled == NULL)
+			gv_station_list_shuffle(self);
 		stations = priv->shuffled;
 	} else {
-		if (priv->shuffled) {
-			g_list_free_full(priv->shuffled, g_object_unref);
-			priv->shuffled = NULL;
-		}
+		gv_station_list_clear_shuffled(self);
 		stations = priv->stations;
 	}
 
-	/* If the station list is empty, bail out */
-	if (stations == NULL)
-		return NULL;
-
 	/* Return last station for NULL argument */
 	if (station == NULL)
-		return g_list_last(stations)->data;
+		return g_ptr_array_index(stations, stations->len - 1);
 
 	/* Try to find station in station list */
-	item = g_list_find(stations, station);
-	if (item == NULL)
+	if (shuffle)
+		pos = gv_station_list_shuffled_index_of(self, station);
+	else
+		pos = gv_station_list_index_of(self, station);
+	if (pos == -1)
 		return NULL;
 
 	/* Return previous station if any */
-	item = item->prev;
-	if (item)
-		return item->data;
+	if (pos > 0)
+		return g_ptr_array_index(stations, pos - 1);
 
 	/* Without repeat, there's no more station */
 	if (!repeat)
@@ -1078,24 +1327,16 @@ gv_station_list_prev(GvStationList *self, GvStation *station,
 
 	/* With repeat, we may re-shuffle, then return the last station */
 	if (shuffle) {
-		GList *last_item;
-
-		stations = g_list_shuffle(priv->shuffled);
+		gv_station_list_shuffle(self);
 
 		/* In case the last station (that we're about to return) happens to be
 		 * the same as the current station, we do a little a magic trick.
 		 */
-		last_item = g_list_last(stations);
-		if (last_item->data == station) {
-			stations = g_list_remove_link(stations, last_item);
-			stations = g_list_prepend(stations, last_item->data);
-			g_list_free(last_item);
-		}
-
-		priv->shuffled = stations;
+		if (g_ptr_array_index(stations, stations->len - 1) == station)
+			gv_station_list_swap_shuffled(self, 0, stations->len - 1);
 	}
 
-	return g_list_last(stations)->data;
+	return g_ptr_array_index(stations, stations->len - 1);
 }
 
 GvStation *
@@ -1103,40 +1344,38 @@ gv_station_list_next(GvStationList *self, GvStation *station,
 		     gboolean repeat, gboolean shuffle)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *stations, *item;
+	GPtrArray *stations;
+	gint pos;
+
+	/* If the station list is empty, bail out */
+	if (priv->stations->len == 0)
+		return NULL;
 
 	/* Pickup the right station list, create shuffle list if needed */
 	if (shuffle) {
-		if (priv->shuffled == NULL) {
-			priv->shuffled = g_list_copy_deep_shuffle(priv->stations,
-								  copy_func_object_ref, NULL);
-		}
+		if (priv->shuffled == NULL)
+			gv_station_list_shuffle(self);
 		stations = priv->shuffled;
 	} else {
-		if (priv->shuffled) {
-			g_list_free_full(priv->shuffled, g_object_unref);
-			priv->shuffled = NULL;
-		}
+		gv_station_list_clear_shuffled(self);
 		stations = priv->stations;
 	}
 
-	/* If the station list is empty, bail out */
-	if (stations == NULL)
-		return NULL;
-
 	/* Return first station for NULL argument */
 	if (station == NULL)
-		return stations->data;
+		return g_ptr_array_index(stations, 0);
 
 	/* Try to find station in station list */
-	item = g_list_find(stations, station);
-	if (item == NULL)
+	if (shuffle)
+		pos = gv_station_list_shuffled_index_of(self, station);
+	else
+		pos = gv_station_list_index_of(self, station);
+	if (pos == -1)
 		return NULL;
 
 	/* Return next station if any */
-	item = item->next;
-	if (item)
-		return item->data;
+	if ((guint) pos + 1 < stations->len)
+		return g_ptr_array_index(stations, pos + 1);
 
 	/* Without repeat, there's no more station */
 	if (!repeat)
@@ -1144,84 +1383,69 @@ gv_station_list_next(GvStationList *self, GvStation *station,
 
 	/* With repeat, we may re-shuffle, then return the first station */
 	if (shuffle) {
-		GList *first_item;
-
-		stations = g_list_shuffle(priv->shuffled);
+		gv_station_list_shuffle(self);
 
 		/* In case the first station (that we're about to return) happens to be
 		 * the same as the current station, we do a little a magic trick.
 		 */
-		first_item = g_list_first(stations);
-		if (first_item->data == station) {
-			stations = g_list_remove_link(stations, first_item);
-			stations = g_list_append(stations, first_item->data);
-			g_list_free(first_item);
-		}
-
-		priv->shuffled = stations;
+		if (g_ptr_array_index(stations, 0) == station)
+			gv_station_list_swap_shuffled(self, 0, stations->len - 1);
 	}
 
-	return stations->data;
+	return g_ptr_array_index(stations, 0);
 }
 
 GvStation *
 gv_station_list_first(GvStationList *self)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *stations = priv->stations;
+	GPtrArray *stations = priv->stations;
 
-	if (stations == NULL)
+	if (stations->len == 0)
 		return NULL;
 
-	return g_list_first(stations)->data;
+	return g_ptr_array_index(stations, 0);
 }
 
 GvStation *
 gv_station_list_last(GvStationList *self)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *stations = priv->stations;
+	GPtrArray *stations = priv->stations;
 
-	if (stations == NULL)
+	if (stations->len == 0)
 		return NULL;
 
-	return g_list_last(stations)->data;
+	return g_ptr_array_index(stations, stations->len - 1);
 }
 
 GvStation *
 gv_station_list_at(GvStationList *self, guint n)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *stations = priv->stations;
-	GList *item;
+	GPtrArray *stations = priv->stations;
 
-	if (stations == NULL)
+	if (n >= stations->len)
 		return NULL;
 
-	item = g_list_nth(stations, n);
-	if (item == NULL)
-		return NULL;
-
-	return item->data;
+	return g_ptr_array_index(stations, n);
 }
 
 GvStation *
 gv_station_list_find(GvStationList *self, GvStation *station)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *stations = priv->stations;
-	GList *item;
 
-	item = g_list_find(stations, station);
+	if (station == NULL)
+		return NULL;
 
-	return item ? item->data : NULL;
+	return g_hash_table_contains(priv->entries, station) ? station : NULL;
 }
 
 GvStation *
 gv_station_list_find_by_name(GvStationList *self, const gchar *name)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *item;
 
 	/* Ensure station name is valid */
 	if (name == NULL) {
@@ -1233,21 +1457,13 @@ gv_station_list_find_by_name(GvStationList *self, const gchar *name)
 	if (!g_strcmp0(name, ""))
 		return NULL;
 
-	/* Iterate on station list */
-	for (item = priv->stations; item; item = item->next) {
-		GvStation *station = item->data;
-		if (!g_strcmp0(name, gv_station_get_name(station)))
-			return station;
-	}
-
-	return NULL;
+	return g_hash_table_lookup(priv->by_name.stations, name);
 }
 
 GvStation *
 gv_station_list_find_by_uri(GvStationList *self, const gchar *uri)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *item;
 
 	/* Ensure station name is valid */
 	if (uri == NULL) {
@@ -1255,21 +1471,13 @@ gv_station_list_find_by_uri(GvStationList *self, const gchar *uri)
 		return NULL;
 	}
 
-	/* Iterate on station list */
-	for (item = priv->stations; item; item = item->next) {
-		GvStation *station = item->data;
-		if (!g_strcmp0(uri, gv_station_get_uri(station)))
-			return station;
-	}
-
-	return NULL;
+	return g_hash_table_lookup(priv->by_uri.stations, uri);
 }
 
 GvStation *
 gv_station_list_find_by_uid(GvStationList *self, const gchar *uid)
 {
 	GvStationListPrivate *priv = self->priv;
-	GList *item;
 
 	/* Ensure station name is valid */
 	if (uid == NULL) {
@@ -1277,14 +1485,7 @@ gv_station_list_find_by_uid(GvStationList *self, const gchar *uid)
 		return NULL;
 	}
 
-	/* Iterate on station list */
-	for (item = priv->stations; item; item = item->next) {
-		GvStation *station = item->data;
-		if (!g_strcmp0(uid, gv_station_get_uid(station)))
-			return station;
-	}
-
-	return NULL;
+	return g_hash_table_lookup(priv->by_uid, uid);
 }
 
 GvStation *
@@ -1323,12 +1524,13 @@ void
 gv_station_list_load(GvStationList *self)
 {
 	GvStationListPrivate *priv = self->priv;
+	GList *list = NULL;
 	GList *item;
 
 	TRACE("%p", self);
 
 	/* This should be called only once at startup */
-	g_assert(priv->stations == NULL);
+	g_assert(priv->stations->len == 0);
 
 	/* If a single load path is defined, try to load the station list
 	 * from there. It must work. Failing to load from this path is a
@@ -1340,7 +1542,7 @@ gv_station_list_load(GvStationList *self)
 		GError *err = NULL;
 		gboolean ret;
 
-		ret = load_station_list_from_file(path, &priv->stations, &err);
+		ret = load_station_list_from_file(path, &list, &err);
 		if (ret == FALSE) {
 			ERROR("Failed to load station list from '%s': %s",
 			      path, err->message);
@@ -1367,7 +1569,7 @@ gv_station_list_load(GvStationList *self)
 			GError *err = NULL;
 			gboolean ret;
 
-			ret = load_station_list_from_file(path, &priv->stations, &err);
+			ret = load_station_list_from_file(path, &list, &err);
 			if (ret == FALSE) {
 				if (err->code != G_FILE_ERROR_NOENT)
 					WARNING("Failed to load station list from '%s': %s",
@@ -1391,7 +1593,7 @@ gv_station_list_load(GvStationList *self)
 		gboolean ret;
 
 		ret = load_station_list_from_string(priv->default_stations,
-						    &priv->stations, NULL);
+						    &list, NULL);
 
 		if (ret == FALSE) {
 			ERROR("Failed to load station list from hard-coded default");
@@ -1403,15 +1605,20 @@ gv_station_list_load(GvStationList *self)
 	}
 
 finish:
-	/* Dump the number of stations */
-	DEBUG("Station list has %u stations", gv_station_list_length(self));
-
-	/* Register a notify handler for each station */
-	for (item = priv->stations; item; item = item->next) {
+	/* Take ownership of the stations, index them, and register
+	 * a notify handler for each of them.
+	 */
+	for (item = list; item; item = item->next) {
 		GvStation *station = item->data;
 
+		gv_station_list_index_station(self, station, priv->stations->len);
+		g_ptr_array_add(priv->stations, station);
 		g_signal_connect_object(station, "notify", G_CALLBACK(on_station_notify), self, 0);
 	}
+	g_list_free(list);
+
+	/* Dump the number of stations */
+	DEBUG("Station list has %u stations", gv_station_list_length(self));
 
 	/* Emit a signal to indicate that the list has been loaded */
 	g_signal_emit(self, signals[SIGNAL_LOADED], 0);
@@ -1422,7 +1629,7 @@ gv_station_list_length(GvStationList *self)
 {
 	GvStationListPrivate *priv = self->priv;
 
-	return g_list_length(priv->stations);
+	return priv->stations->len;
 }
 
 /* Create a new station list with load paths and save path derived
@@ -1473,7 +1680,7 @@ gv_station_list_finalize(GObject *object)
 {
 	GvStationList *self = GV_STATION_LIST(object);
 	GvStationListPrivate *priv = self->priv;
-	GList *item;
+	guint i;
 
 	TRACE("%p", object);
 
@@ -1484,21 +1691,27 @@ gv_station_list_finalize(GObject *object)
 	if (priv->save_timeout_id > 0)
 		when_timeout_save_station_list(self);
 
-	/* Free shuffled station list */
-	g_list_free_full(priv->shuffled, g_object_unref);
+	/* Free shuffled station list and indexes */
+	gv_station_list_clear_shuffled(self);
+	g_hash_table_unref(priv->by_uri.stations);
+	g_hash_table_unref(priv->by_name.stations);
+	g_hash_table_unref(priv->by_uid);
+	g_hash_table_unref(priv->entries);
 
 	/* Free station list and ensure no memory is leaked. This works only if the
 	 * station list is the last object to hold references to stations. In other
 	 * words, the station list must be the last object finalized.
 	 */
-	for (item = priv->stations; item; item = item->next) {
-		g_object_add_weak_pointer(G_OBJECT(item->data), &(item->data));
-		g_object_unref(item->data);
-		if (item->data != NULL)
+	for (i = 0; i < priv->stations->len; i++) {
+		gpointer *station = &g_ptr_array_index(priv->stations, i);
+
+		g_object_add_weak_pointer(G_OBJECT(*station), station);
+		g_object_unref(*station);
+		if (*station != NULL)
 			WARNING("Station '%s' has not been finalized!",
-				gv_station_get_name_or_uri(GV_STATION(item->data)));
+				gv_station_get_name_or_uri(GV_STATION(*station)));
 	}
-	g_list_free(priv->stations);
+	g_ptr_array_unref(priv->stations);
 
 	/* Free resources */
 	g_free(priv->default_stations);
@@ -1524,10 +1737,19 @@ gv_station_list_constructed(GObject *object)
 static void
 gv_station_list_init(GvStationList *self)
 {
+	GvStationListPrivate *priv;
+
 	TRACE("%p", self);
 
 	/* Initialize private pointer */
-	self->priv = gv_station_list_get_instance_private(self);
+	priv = self->priv = gv_station_list_get_instance_private(self);
+
+	/* Initialize the station list and its indexes */
+	priv->stations = g_ptr_array_new();
+	priv->entries = g_hash_table_new_full(NULL, NULL, NULL, (GDestroyNotify) entry_free);
+	priv->by_uid = g_hash_table_new(g_str_hash, g_str_equal);
+	station_index_init(&priv->by_name, G_STRUCT_OFFSET(GvStationListEntry, name));
+	station_index_init(&priv->by_uri, G_STRUCT_OFFSET(GvStationListEntry, uri));
 }
 
 static void
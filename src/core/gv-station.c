@@ -44,6 +44,7 @@ enum {
 	/* Set by user - customization */
 	PROP_INSECURE,
 	PROP_USER_AGENT,
+	PROP_BUFFERING_PROFILE,
 	/* Number of properties */
 	PROP_N
 };
@@ -67,6 +68,7 @@ struct _GvStationPrivate {
 	/* Set by user - customization */
 	gboolean insecure;
 	gchar *user_agent;
+	gchar *buffering_profile;
 };
 
 typedef struct _GvStationPrivate GvStationPrivate;
@@ -204,6 +206,29 @@ gv_station_set_user_agent(GvStation *self, const gchar *user_agent)
 	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_USER_AGENT]);
 }
 
+const gchar *
+gv_station_get_buffering_profile(GvStation *self)
+{
+	return self->priv->buffering_profile;
+}
+
+void
+gv_station_set_buffering_profile(GvStation *self, const gchar *profile)
+{
+	GvStationPrivate *priv = self->priv;
+
+	if (profile && profile[0] == '\0')
+		profile = NULL;
+
+	if (!g_strcmp0(priv->buffering_profile, profile))
+		return;
+
+	g_free(priv->buffering_profile);
+	priv->buffering_profile = g_strdup(profile);
+
+	g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_BUFFERING_PROFILE]);
+}
+
 static void
 gv_station_get_property(GObject *object,
 			guint property_id,
@@ -230,6 +255,9 @@ gv_station_get_property(GObject *object,
 	case PROP_USER_AGENT:
 		g_value_set_string(value, gv_station_get_user_agent(self));
 		break;
+	case PROP_BUFFERING_PROFILE:
+		g_value_set_string(value, gv_station_get_buffering_profile(self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
 		break;
@@ -259,6 +287,9 @@ gv_station_set_property(GObject *object,
 	case PROP_USER_AGENT:
 		gv_station_set_user_agent(self, g_value_get_string(value));
 		break;
+	case PROP_BUFFERING_PROFILE:
+		gv_station_set_buffering_profile(self, g_value_get_string(value));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
 		break;
@@ -305,6 +336,7 @@ gv_station_finalize(GObject *object)
 
 	TRACE("%p", object);
 
+	g_free(priv->buffering_profile);
 	g_free(priv->user_agent);
 	g_free(priv->name);
 	g_free(priv->uri);
@@ -375,5 +407,11 @@ gv_station_class_init(GvStationClass *class)
 		g_param_spec_string("user-agent", "User agent", NULL, NULL,
 				    GV_PARAM_READWRITE);
 
+	properties[PROP_BUFFERING_PROFILE] =
+		g_param_spec_string("buffering-profile", "Buffering profile",
+				    "Name of the buffering profile, or NULL for the default",
+				    NULL,
+				    GV_PARAM_READWRITE);
+
 	g_object_class_install_properties(object_class, PROP_N, properties);
 }
@@ -45,3 +45,5 @@ gboolean     gv_station_get_insecure        (GvStation *self);
 void         gv_station_set_insecure        (GvStation *self, gboolean insecure);
 const gchar *gv_station_get_user_agent      (GvStation *self);
 void         gv_station_set_user_agent      (GvStation *self, const gchar *user_agent);
+const gchar *gv_station_get_buffering_profile(GvStation *self);
+void         gv_station_set_buffering_profile(GvStation *self, const gchar *profile);
@@ -51,6 +51,11 @@
  * bitrate value is zero in those tags, what do we do? Answer: we update the
  * value to zero in GvStreaminfo, therefore considering zero a valid value,
  * rather than meaning 'no information'. Is it the right thing to do? Maybe.
+ *
+ * For adaptive streams (HLS, MPEG-DASH), the demuxer picks a variant among
+ * those listed in the master playlist, and might switch to another one as
+ * the bandwidth changes. The bitrate of the variant is the one advertised
+ * in the playlist, and we count the switches, to see how stable it is.
  */
 
 #include <glib-object.h>
@@ -74,6 +79,8 @@ struct _GvStreaminfo {
 	gchar *codec;
 	guint sample_rate;
 	GvStreamType stream_type;
+	guint variant_bitrate;
+	guint variant_switches;
 
 	/*< private >*/
 	volatile guint ref_count;
@@ -115,6 +122,18 @@ gv_streaminfo_get_stream_type(GvStreaminfo *self)
 	return self->stream_type;
 }
 
+guint
+gv_streaminfo_get_variant_bitrate(GvStreaminfo *self)
+{
+	return self->variant_bitrate;
+}
+
+guint
+gv_streaminfo_get_variant_switches(GvStreaminfo *self)
+{
+	return self->variant_switches;
+}
+
 gboolean
 gv_streaminfo_update_from_element_setup(GvStreaminfo *self, GstElement *element)
 {
@@ -270,6 +289,23 @@ gv_streaminfo_update_from_gst_taglist(GvStreaminfo *self, GstTagList *taglist)
 	return changed;
 }
 
+gboolean
+gv_streaminfo_update_from_variant(GvStreaminfo *self, guint bitrate)
+{
+	g_return_val_if_fail(self != NULL, FALSE);
+
+	if (bitrate == 0 || bitrate == self->variant_bitrate)
+		return FALSE;
+
+	/* The first variant is not a switch */
+	if (self->variant_bitrate != 0)
+		self->variant_switches++;
+
+	self->variant_bitrate = bitrate;
+
+	return TRUE;
+}
+
 void
 gv_streaminfo_unref(GvStreaminfo *self)
 {
@@ -63,6 +63,8 @@ gboolean gv_streaminfo_update_from_gst_caps     (GvStreaminfo *self,
 		                                 GstCaps *caps);
 gboolean gv_streaminfo_update_from_gst_taglist  (GvStreaminfo *self,
 		                                 GstTagList *taglist);
+gboolean gv_streaminfo_update_from_variant      (GvStreaminfo *self,
+		                                 guint bitrate);
 
 void         gv_streaminfo_get_bitrate        (GvStreaminfo *self,
                                                GvStreamBitrate *bitrate);
@@ -70,3 +72,5 @@ guint        gv_streaminfo_get_channels       (GvStreaminfo *self);
 const gchar *gv_streaminfo_get_codec          (GvStreaminfo *self);
 guint        gv_streaminfo_get_sample_rate    (GvStreaminfo *self);
 GvStreamType gv_streaminfo_get_stream_type    (GvStreaminfo *self);
+guint        gv_streaminfo_get_variant_bitrate (GvStreaminfo *self);
+guint        gv_streaminfo_get_variant_switches(GvStreaminfo *self);
@@ -0,0 +1,271 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The time-shift source is a bin that wraps the source of a stream, and
+ * keeps what it receives in a bounded ring buffer, ie. a queue2 with a
+ * ring-buffer-max-size. Pausing lets the source carry on downloading to the
+ * ring buffer, and seeks within what it holds are served from there, without
+ * touching the network. Large ring buffers are backed by a temporary file.
+ *
+ * It's registered as the handler of 'gvtimeshift+http' and friends, so that
+ * playbin creates it in place of the real source when asked to play such an
+ * URI. The real source is then set up through gv_timeshift_src_get_source().
+ */
+
+#include <string.h>
+
+#include <glib-object.h>
+#include <glib.h>
+#include <gst/gst.h>
+
+#include "base/gv-base.h"
+
+#include "core/gv-timeshift-src.h"
+
+#define URI_PREFIX "gvtimeshift+"
+
+/* Beyond this size, the ring buffer goes to a temporary file */
+#define MAX_MEMORY_SIZE (64 * 1024 * 1024)
+
+static const gchar *const protocols[] = {
+	URI_PREFIX "http",
+	URI_PREFIX "https",
+	NULL
+};
+
+/*
+ * GObject definitions
+ */
+
+struct _GvTimeshiftSrc {
+	/* Parent instance structure */
+	GstBin parent_instance;
+	/* Children */
+	GstElement *source;
+	GstElement *queue;
+	GstPad *ghostpad;
+	gchar *uri;
+};
+
+static void gv_timeshift_src_uri_handler_init(gpointer g_iface, gpointer iface_data);
+
+G_DEFINE_TYPE_WITH_CODE(GvTimeshiftSrc, gv_timeshift_src, GST_TYPE_BIN,
+			G_IMPLEMENT_INTERFACE(GST_TYPE_URI_HANDLER,
+					      gv_timeshift_src_uri_handler_init))
+
+static GstStaticPadTemplate src_template =
+	GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+/*
+ * URI handler
+ */
+
+static GstURIType
+gv_timeshift_src_uri_get_type(GType type G_GNUC_UNUSED)
+{
+	return GST_URI_SRC;
+}
+
+static const gchar *const *
+gv_timeshift_src_uri_get_protocols(GType type G_GNUC_UNUSED)
+{
+	return protocols;
+}
+
+static gchar *
+gv_timeshift_src_uri_get_uri(GstURIHandler *handler)
+{
+	GvTimeshiftSrc *self = GV_TIMESHIFT_SRC(handler);
+	gchar *uri;
+
+	GST_OBJECT_LOCK(self);
+	uri = g_strdup(self->uri);
+	GST_OBJECT_UNLOCK(self);
+
+	return uri;
+}
+
+static gboolean
+gv_timeshift_src_uri_set_uri(GstURIHandler *handler, const gchar *uri, GError **error)
+{
+	GvTimeshiftSrc *self = GV_TIMESHIFT_SRC(handler);
+	GstElement *source;
+
+	if (GST_STATE(self) != GST_STATE_NULL) {
+		g_set_error(error, GST_URI_ERROR, GST_URI_ERROR_BAD_STATE,
+			    "Changing the URI while running is not supported");
+		return FALSE;
+	}
+
+	if (!g_str_has_prefix(uri, URI_PREFIX)) {
+		g_set_error(error, GST_URI_ERROR, GST_URI_ERROR_UNSUPPORTED_PROTOCOL,
+			    "Invalid URI: %s", uri);
+		return FALSE;
+	}
+
+	source = gst_element_make_from_uri(GST_URI_SRC, uri + strlen(URI_PREFIX),
+					   "source", error);
+	if (source == NULL)
+		return FALSE;
+
+	if (self->source != NULL) {
+		gst_element_unlink(self->source, self->queue);
+		gst_bin_remove(GST_BIN(self), self->source);
+	}
+
+	self->source = source;
+	gst_bin_add(GST_BIN(self), source);
+	gst_element_link(source, self->queue);
+
+	GST_OBJECT_LOCK(self);
+	g_free(self->uri);
+	self->uri = g_strdup(uri);
+	GST_OBJECT_UNLOCK(self);
+
+	return TRUE;
+}
+
+static void
+gv_timeshift_src_uri_handler_init(gpointer g_iface, gpointer iface_data G_GNUC_UNUSED)
+{
+	GstURIHandlerInterface *iface = g_iface;
+
+	iface->get_type = gv_timeshift_src_uri_get_type;
+	iface->get_protocols = gv_timeshift_src_uri_get_protocols;
+	iface->get_uri = gv_timeshift_src_uri_get_uri;
+	iface->set_uri = gv_timeshift_src_uri_set_uri;
+}
+
+/*
+ * Public methods
+ */
+
+gboolean
+gv_timeshift_src_register(void)
+{
+	return gst_element_register(NULL, "gvtimeshiftsrc", GST_RANK_PRIMARY,
+				    GV_TYPE_TIMESHIFT_SRC);
+}
+
+/* Returns the URI to play a stream through the time-shift source, or NULL
+ * if it's not supported for this URI */
+gchar *
+gv_timeshift_src_make_uri(const gchar *uri)
+{
+	gchar *protocol;
+	gchar *res = NULL;
+
+	protocol = gst_uri_get_protocol(uri);
+	if (protocol == NULL)
+		return NULL;
+
+	if (!g_strcmp0(protocol, "http") || !g_strcmp0(protocol, "https"))
+		res = g_strconcat(URI_PREFIX, uri, NULL);
+
+	g_free(protocol);
+
+	return res;
+}
+
+GstElement *
+gv_timeshift_src_get_source(GvTimeshiftSrc *self)
+{
+	return self->source;
+}
+
+GstElement *
+gv_timeshift_src_get_queue(GvTimeshiftSrc *self)
+{
+	return self->queue;
+}
+
+/* Must be called before the element leaves the NULL state */
+void
+gv_timeshift_src_set_ring_buffer_size(GvTimeshiftSrc *self, guint64 size)
+{
+	gchar *temp_template = NULL;
+
+	if (size > MAX_MEMORY_SIZE)
+		temp_template = g_build_filename(g_get_tmp_dir(),
+				"goodvibes-timeshift-XXXXXX", NULL);
+
+	g_object_set(self->queue,
+		     "ring-buffer-max-size", size,
+		     "max-size-bytes", (guint) MIN(size, G_MAXUINT),
+		     "temp-template", temp_template,
+		     "temp-remove", TRUE,
+		     NULL);
+
+	g_free(temp_template);
+}
+
+/*
+ * GObject methods
+ */
+
+static void
+gv_timeshift_src_finalize(GObject *object)
+{
+	GvTimeshiftSrc *self = GV_TIMESHIFT_SRC(object);
+
+	g_free(self->uri);
+
+	G_OBJECT_CLASS(gv_timeshift_src_parent_class)->finalize(object);
+}
+
+static void
+gv_timeshift_src_init(GvTimeshiftSrc *self)
+{
+	GstPad *pad;
+
+	/* The queue is only bounded by the ring buffer size */
+	self->queue = gst_element_factory_make("queue2", "ringbuffer");
+	g_assert(self->queue != NULL);
+	g_object_set(self->queue,
+		     "use-buffering", TRUE,
+		     "max-size-buffers", 0,
+		     "max-size-time", (guint64) 0,
+		     NULL);
+	gst_bin_add(GST_BIN(self), self->queue);
+
+	pad = gst_element_get_static_pad(self->queue, "src");
+	self->ghostpad = gst_ghost_pad_new_from_template("src", pad,
+			gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(self), "src"));
+	gst_object_unref(pad);
+	gst_element_add_pad(GST_ELEMENT(self), self->ghostpad);
+
+	GST_OBJECT_FLAG_SET(self, GST_ELEMENT_FLAG_SOURCE);
+}
+
+static void
+gv_timeshift_src_class_init(GvTimeshiftSrcClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(class);
+	GstElementClass *element_class = GST_ELEMENT_CLASS(class);
+
+	object_class->finalize = gv_timeshift_src_finalize;
+
+	gst_element_class_add_static_pad_template(element_class, &src_template);
+	gst_element_class_set_static_metadata(element_class,
+			"Time-shift source", "Source/Network",
+			"Keep the stream received in a ring buffer",
+			"Goodvibes");
+}
@@ -0,0 +1,38 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include <gst/gst.h>
+
+/* GObject declarations */
+
+#define GV_TYPE_TIMESHIFT_SRC gv_timeshift_src_get_type()
+
+G_DECLARE_FINAL_TYPE(GvTimeshiftSrc, gv_timeshift_src, GV, TIMESHIFT_SRC, GstBin)
+
+/* Methods */
+
+gboolean    gv_timeshift_src_register(void);
+gchar      *gv_timeshift_src_make_uri(const gchar *uri);
+GstElement *gv_timeshift_src_get_source(GvTimeshiftSrc *self);
+GstElement *gv_timeshift_src_get_queue(GvTimeshiftSrc *self);
+void        gv_timeshift_src_set_ring_buffer_size(GvTimeshiftSrc *self, guint64 size);
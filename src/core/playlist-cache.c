@@ -0,0 +1,208 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Playlists that were downloaded are kept in the user cache directory,
+ * keyed by uri. Each entry is made of two files: the playlist as it was
+ * received, and a key file with what's needed to revalidate it (ETag,
+ * Last-Modified) and where we were redirected to. The key file is written
+ * last, and an entry without a key file doesn't exist.
+ */
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "base/gv-base.h"
+
+#include "core/playlist-cache.h"
+
+#define CACHE_SUBDIR "playlists"
+#define META_GROUP   "Playlist"
+
+/*
+ * Helpers
+ */
+
+static gchar *
+make_path(const gchar *uri, const gchar *suffix)
+{
+	gchar *checksum;
+	gchar *filename;
+	gchar *path;
+
+	checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, uri, -1);
+	filename = g_strconcat(checksum, suffix, NULL);
+	path = g_build_filename(gv_get_app_user_cache_dir(), CACHE_SUBDIR,
+			filename, NULL);
+
+	g_free(filename);
+	g_free(checksum);
+
+	return path;
+}
+
+static gchar *
+get_meta_string(GKeyFile *keyfile, const gchar *key)
+{
+	gchar *value;
+
+	value = g_key_file_get_string(keyfile, META_GROUP, key, NULL);
+	if (value != NULL && value[0] == '\0')
+		g_clear_pointer(&value, g_free);
+
+	return value;
+}
+
+static void
+set_meta_string(GKeyFile *keyfile, const gchar *key, const gchar *value)
+{
+	if (value != NULL)
+		g_key_file_set_string(keyfile, META_GROUP, key, value);
+}
+
+/*
+ * Public functions
+ */
+
+void
+gv_playlist_cache_entry_free(GvPlaylistCacheEntry *entry)
+{
+	if (entry == NULL)
+		return;
+
+	g_free(entry->redirection_uri);
+	g_free(entry->etag);
+	g_free(entry->last_modified);
+	g_free(entry->content);
+	g_free(entry);
+}
+
+GvPlaylistCacheEntry *
+gv_playlist_cache_lookup(const gchar *uri)
+{
+	GvPlaylistCacheEntry *entry = NULL;
+	GKeyFile *keyfile;
+	GError *err = NULL;
+	gchar *meta_path;
+	gchar *data_path;
+	gchar *cached_uri;
+	gchar *content;
+	gsize content_size;
+
+	meta_path = make_path(uri, ".meta");
+	data_path = make_path(uri, NULL);
+	keyfile = g_key_file_new();
+
+	if (g_key_file_load_from_file(keyfile, meta_path, G_KEY_FILE_NONE, &err) == FALSE) {
+		if (!g_error_matches(err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			DEBUG("Failed to load cached playlist: %s", err->message);
+		goto out;
+	}
+
+	/* Make sure it's the right playlist */
+	cached_uri = get_meta_string(keyfile, "Uri");
+	if (g_strcmp0(cached_uri, uri) != 0) {
+		g_free(cached_uri);
+		goto out;
+	}
+	g_free(cached_uri);
+
+	if (g_file_get_contents(data_path, &content, &content_size, &err) == FALSE) {
+		DEBUG("Failed to load cached playlist: %s", err->message);
+		goto out;
+	}
+
+	entry = g_new0(GvPlaylistCacheEntry, 1);
+	entry->redirection_uri = get_meta_string(keyfile, "RedirectionUri");
+	entry->etag = get_meta_string(keyfile, "ETag");
+	entry->last_modified = get_meta_string(keyfile, "LastModified");
+	entry->content = content;
+	entry->content_size = content_size;
+
+out:
+	g_clear_error(&err);
+	g_key_file_unref(keyfile);
+	g_free(data_path);
+	g_free(meta_path);
+
+	return entry;
+}
+
+gboolean
+gv_playlist_cache_store(const gchar *uri, const GvPlaylistCacheEntry *entry, GError **error)
+{
+	GKeyFile *keyfile = NULL;
+	gchar *meta_path = NULL;
+	gchar *data_path = NULL;
+	gchar *dirname = NULL;
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	dirname = g_build_filename(gv_get_app_user_cache_dir(), CACHE_SUBDIR, NULL);
+	if (g_mkdir_with_parents(dirname, S_IRWXU) != 0) {
+		int errsv = errno;
+		g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errsv),
+			    "Failed to create directory '%s': %s",
+			    dirname, g_strerror(errsv));
+		goto out;
+	}
+
+	/* Write the data first, the entry is valid once the key file exists */
+	meta_path = make_path(uri, ".meta");
+	data_path = make_path(uri, NULL);
+	g_unlink(meta_path);
+
+	if (g_file_set_contents(data_path, entry->content, entry->content_size,
+				error) == FALSE)
+		goto out;
+
+	keyfile = g_key_file_new();
+	set_meta_string(keyfile, "Uri", uri);
+	set_meta_string(keyfile, "RedirectionUri", entry->redirection_uri);
+	set_meta_string(keyfile, "ETag", entry->etag);
+	set_meta_string(keyfile, "LastModified", entry->last_modified);
+
+	ret = g_key_file_save_to_file(keyfile, meta_path, error);
+
+out:
+	if (keyfile)
+		g_key_file_unref(keyfile);
+	g_free(data_path);
+	g_free(meta_path);
+	g_free(dirname);
+
+	return ret;
+}
+
+void
+gv_playlist_cache_remove(const gchar *uri)
+{
+	gchar *path;
+
+	path = make_path(uri, ".meta");
+	g_unlink(path);
+	g_free(path);
+
+	path = make_path(uri, NULL);
+	g_unlink(path);
+	g_free(path);
+}
@@ -0,0 +1,38 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+typedef struct {
+	gchar *redirection_uri;
+	gchar *etag;
+	gchar *last_modified;
+	gchar *content;
+	gsize  content_size;
+} GvPlaylistCacheEntry;
+
+GvPlaylistCacheEntry *gv_playlist_cache_lookup    (const gchar *uri);
+gboolean              gv_playlist_cache_store     (const gchar *uri,
+						   const GvPlaylistCacheEntry *entry,
+						   GError **error);
+void                  gv_playlist_cache_remove    (const gchar *uri);
+void                  gv_playlist_cache_entry_free(GvPlaylistCacheEntry *entry);
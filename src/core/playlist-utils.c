@@ -44,53 +44,477 @@
 #define URL_MAX_LENGTH 4096
 
 /*
- * Helpers
+ * Tokenizer
+ *
+ * Playlists are scanned once, in place. Tokens are views into the text,
+ * nothing is copied until a stream is found, and even then, it's copied
+ * only if we didn't see it before. There's a line scanner for M3U and PLS,
+ * and a markup scanner for ASX and XSPF, which is lenient: it doesn't
+ * validate the document, it only looks for the elements we need.
+ *
+ * Both scanners can be stopped at the end of the text, and resumed once
+ * more text is available, which is what the incremental parser does. They
+ * return how much text was consumed, and what's left must be given again,
+ * with more text appended.
  */
 
+typedef struct {
+	const gchar *str;
+	gsize len;
+} GvToken;
+
+static GvToken
+token_strip(GvToken token)
+{
+	while (token.len > 0 && g_ascii_isspace(token.str[0])) {
+		token.str++;
+		token.len--;
+	}
+
+	while (token.len > 0 && g_ascii_isspace(token.str[token.len - 1]))
+		token.len--;
+
+	return token;
+}
+
 static gboolean
-validate_uri(const gchar *string)
+token_equal_ci(GvToken token, const gchar *str)
 {
-	g_return_val_if_fail(string != NULL, FALSE);
+	gsize len = strlen(str);
 
-	/* Must look like an URI */
-	if (strstr(string, "://") == NULL)
-		return FALSE;
+	return token.len == len && g_ascii_strncasecmp(token.str, str, len) == 0;
+}
+
+static gboolean
+token_has_prefix_ci(GvToken token, const gchar *prefix)
+{
+	gsize len = strlen(prefix);
+
+	return token.len >= len && g_ascii_strncasecmp(token.str, prefix, len) == 0;
+}
+
+static const gchar *
+find_str(const gchar *ptr, const gchar *end, const gchar *str)
+{
+	return g_strstr_len(ptr, end - ptr, str);
+}
 
+static gboolean
+validate_uri(GvToken token)
+{
 	/* Must not be too long */
-	if (strlen(string) > URL_MAX_LENGTH)
+	if (token.len > URL_MAX_LENGTH)
+		return FALSE;
+
+	/* Must not be binary garbage */
+	if (memchr(token.str, '\0', token.len) != NULL)
+		return FALSE;
+
+	/* Must look like an URI */
+	if (g_strstr_len(token.str, token.len, "://") == NULL)
 		return FALSE;
 
 	return TRUE;
 }
 
-static GSList *
-no_duplicate(GSList *input_list)
+/* Lines: the function is called for each line, without the line break.
+ * The last line is only complete if it's the end of the text. */
+
+typedef void (*GvLineFunc)(GvToken line, gpointer user_data);
+
+static gsize
+scan_lines(const gchar *text, gsize text_size, gboolean end,
+	   GvLineFunc func, gpointer user_data)
+{
+	const gchar *ptr = text;
+	const gchar *last = text + text_size;
+	const gchar *eol;
+
+	while (ptr < last) {
+		GvToken line;
+
+		eol = memchr(ptr, '\n', last - ptr);
+		if (eol == NULL && end == FALSE)
+			break;
+		if (eol == NULL)
+			eol = last;
+
+		line.str = ptr;
+		line.len = eol - ptr;
+		func(token_strip(line), user_data);
+
+		ptr = eol < last ? eol + 1 : last;
+	}
+
+	return ptr - text;
+}
+
+/* Markup: the element function is called for each start tag, with the
+ * attributes as a token, and the text function is called with the text that
+ * follows a start tag, if any. Comments, processing instructions, end tags
+ * and declarations are skipped. */
+
+typedef struct {
+	void (*element)(GvToken name, GvToken attributes, gpointer user_data);
+	void (*text)(GvToken element, GvToken text, gpointer user_data);
+} GvMarkupFuncs;
+
+static gboolean
+markup_get_attribute(GvToken attributes, const gchar *name, GvToken *value)
+{
+	const gchar *ptr = attributes.str;
+	const gchar *last = attributes.str + attributes.len;
+
+	while (ptr < last) {
+		GvToken attr_name;
+		const gchar *quote;
+		gchar delim;
+
+		/* Name */
+		while (ptr < last && (g_ascii_isspace(*ptr) || *ptr == '/'))
+			ptr++;
+		attr_name.str = ptr;
+		while (ptr < last && !g_ascii_isspace(*ptr) && *ptr != '=')
+			ptr++;
+		attr_name.len = ptr - attr_name.str;
+
+		/* Equal sign */
+		while (ptr < last && g_ascii_isspace(*ptr))
+			ptr++;
+		if (ptr == last || *ptr != '=')
+			return FALSE;
+		ptr++;
+		while (ptr < last && g_ascii_isspace(*ptr))
+			ptr++;
+
+		/* Quoted value */
+		if (ptr == last || (*ptr != '"' && *ptr != '\''))
+			return FALSE;
+		delim = *ptr++;
+		quote = memchr(ptr, delim, last - ptr);
+		if (quote == NULL)
+			return FALSE;
+
+		if (token_equal_ci(attr_name, name)) {
+			value->str = ptr;
+			value->len = quote - ptr;
+			return TRUE;
+		}
+
+		ptr = quote + 1;
+	}
+
+	return FALSE;
+}
+
+static gsize
+scan_markup(const gchar *text, gsize text_size, gboolean end,
+	    const GvMarkupFuncs *funcs, gpointer user_data)
+{
+	const gchar *ptr = text;
+	const gchar *last = text + text_size;
+
+	while (ptr < last) {
+		const gchar *tag;
+		const gchar *close;
+		GvToken name, attributes, content;
+
+		/* Skip text that doesn't follow a start tag */
+		ptr = memchr(ptr, '<', last - ptr);
+		if (ptr == NULL)
+			return text_size;
+		tag = ptr;
+
+		/* Comments and CDATA sections might contain a '>' */
+		if (last - ptr >= 4 && memcmp(ptr, "<!--", 4) == 0) {
+			close = find_str(ptr + 4, last, "-->");
+			if (close == NULL)
+				goto incomplete;
+			ptr = close + 3;
+			continue;
+		}
+
+		close = memchr(ptr, '>', last - ptr);
+		if (close == NULL)
+			goto incomplete;
+
+		/* End tags, declarations, processing instructions */
+		if (ptr[1] == '/' || ptr[1] == '!' || ptr[1] == '?') {
+			ptr = close + 1;
+			continue;
+		}
+
+		/* Start tag, split name and attributes */
+		name.str = ptr + 1;
+		name.len = 0;
+		while (name.str + name.len < close &&
+		       !g_ascii_isspace(name.str[name.len]) &&
+		       name.str[name.len] != '/')
+			name.len++;
+		attributes.str = name.str + name.len;
+		attributes.len = close - attributes.str;
+		ptr = close + 1;
+
+		/* Self-closing, there's no text */
+		if (close[-1] == '/') {
+			if (funcs->element)
+				funcs->element(name, attributes, user_data);
+			continue;
+		}
+
+		/* Make sure the text is complete before going any further,
+		 * so that we can start again from the tag if it's not */
+		content.str = ptr;
+		while (content.str < last && g_ascii_isspace(*content.str))
+			content.str++;
+		if (last - content.str < 9 && end == FALSE &&
+		    memcmp(content.str, "<![CDATA[", last - content.str) == 0)
+			goto incomplete;
+		if (last - content.str >= 9 && memcmp(content.str, "<![CDATA[", 9) == 0) {
+			close = find_str(content.str + 9, last, "]]>");
+			if (close == NULL)
+				goto incomplete;
+			content.str += 9;
+			content.len = close - content.str;
+			ptr = close + 3;
+		} else {
+			close = memchr(ptr, '<', last - ptr);
+			if (close == NULL && end == FALSE)
+				goto incomplete;
+			if (close == NULL)
+				close = last;
+			content.str = ptr;
+			content.len = close - ptr;
+			ptr = close;
+		}
+
+		if (funcs->element)
+			funcs->element(name, attributes, user_data);
+		if (funcs->text)
+			funcs->text(name, token_strip(content), user_data);
+		continue;
+
+incomplete:
+		if (end == FALSE)
+			return tag - text;
+		return text_size;
+	}
+
+	return ptr - text;
+}
+
+/* Markup escapes, they're rare in uris, but '&amp;' does happen */
+
+static gchar *
+markup_unescape(GvToken token)
 {
-	GSList *out = NULL;
-	GSList *item, *inner;
+	const gchar *ptr = token.str;
+	const gchar *last = token.str + token.len;
+	GString *out;
+
+	out = g_string_sized_new(token.len);
 
-	/* Copy input list, drop duplicates */
-	for (item = input_list; item != NULL; item = item->next) {
-		const gchar *uri = item->data;
-		gboolean found = FALSE;
+	while (ptr < last) {
+		const gchar *semicolon;
+		GvToken entity;
 
-		for (inner = out; inner != NULL; inner = inner->next) {
-			if (g_strcmp0(uri, inner->data) == 0) {
-				found = TRUE;
-				break;
-			}
+		if (*ptr != '&') {
+			g_string_append_c(out, *ptr++);
+			continue;
 		}
 
-		if (found)
+		semicolon = memchr(ptr, ';', last - ptr);
+		if (semicolon == NULL) {
+			g_string_append_c(out, *ptr++);
 			continue;
+		}
+
+		entity.str = ptr + 1;
+		entity.len = semicolon - entity.str;
+
+		if (token_equal_ci(entity, "amp"))
+			g_string_append_c(out, '&');
+		else if (token_equal_ci(entity, "lt"))
+			g_string_append_c(out, '<');
+		else if (token_equal_ci(entity, "gt"))
+			g_string_append_c(out, '>');
+		else if (token_equal_ci(entity, "quot"))
+			g_string_append_c(out, '"');
+		else if (token_equal_ci(entity, "apos"))
+			g_string_append_c(out, '\'');
+		else if (entity.len > 1 && entity.str[0] == '#') {
+			gchar *digits = g_strndup(entity.str + 1, entity.len - 1);
+			gunichar c;
+
+			if (digits[0] == 'x' || digits[0] == 'X')
+				c = g_ascii_strtoull(digits + 1, NULL, 16);
+			else
+				c = g_ascii_strtoull(digits, NULL, 10);
+			g_free(digits);
+
+			if (c > 0 && g_unichar_validate(c))
+				g_string_append_unichar(out, c);
+		} else {
+			/* Unknown entity, keep it as is */
+			g_string_append_len(out, ptr, semicolon + 1 - ptr);
+		}
 
-		out = g_slist_prepend(out, g_strdup(uri));
+		ptr = semicolon + 1;
 	}
 
-	/* Consume input */
-	g_slist_free_full(input_list, g_free);
+	return g_string_free(out, FALSE);
+}
+
+/* Set of uris. The uris are kept in the order they were added, and the hash
+ * table only holds their indexes, so that it can be looked up with a token,
+ * without copying it first. */
+
+typedef struct {
+	GPtrArray *uris;
+	guint *table;  // index + 1, 0 for empty slots
+	guint mask;
+} GvUriSet;
+
+static guint
+hash_token(GvToken token)
+{
+	guint hash = 5381;
+	gsize i;
+
+	for (i = 0; i < token.len; i++)
+		hash = (hash << 5) + hash + (guchar) token.str[i];
+
+	return hash;
+}
+
+static void
+uri_set_init(GvUriSet *set)
+{
+	set->uris = g_ptr_array_new_with_free_func(g_free);
+	set->mask = 15;
+	set->table = g_new0(guint, set->mask + 1);
+}
+
+static void
+uri_set_clear(GvUriSet *set)
+{
+	g_clear_pointer(&set->uris, g_ptr_array_unref);
+	g_clear_pointer(&set->table, g_free);
+}
+
+static guint *
+uri_set_lookup_slot(GvUriSet *set, GvToken token)
+{
+	guint i = hash_token(token) & set->mask;
+
+	/* Linear probing, there's always an empty slot */
+	while (set->table[i] != 0) {
+		const gchar *uri = set->uris->pdata[set->table[i] - 1];
+
+		if (strncmp(uri, token.str, token.len) == 0 && uri[token.len] == '\0')
+			break;
+
+		i = (i + 1) & set->mask;
+	}
+
+	return &set->table[i];
+}
+
+static void
+uri_set_grow(GvUriSet *set)
+{
+	guint i;
+
+	g_free(set->table);
+	set->mask = set->mask * 2 + 1;
+	set->table = g_new0(guint, set->mask + 1);
+
+	for (i = 0; i < set->uris->len; i++) {
+		GvToken token = { set->uris->pdata[i], strlen(set->uris->pdata[i]) };
+
+		*uri_set_lookup_slot(set, token) = i + 1;
+	}
+}
+
+/* Takes ownership of the copy, if one is given */
+static gboolean
+uri_set_add_full(GvUriSet *set, GvToken token, gchar *copy)
+{
+	guint *slot;
+
+	slot = uri_set_lookup_slot(set, token);
+	if (*slot != 0) {
+		g_free(copy);
+		return FALSE;
+	}
+
+	if (copy == NULL)
+		copy = g_strndup(token.str, token.len);
+	g_ptr_array_add(set->uris, copy);
+	*slot = set->uris->len;
+
+	/* Keep the load factor under one half */
+	if (set->uris->len * 2 > set->mask)
+		uri_set_grow(set);
+
+	return TRUE;
+}
+
+static gboolean
+uri_set_add(GvUriSet *set, GvToken token)
+{
+	if (validate_uri(token) == FALSE)
+		return FALSE;
+
+	return uri_set_add_full(set, token, NULL);
+}
+
+static gboolean
+uri_set_add_escaped(GvUriSet *set, GvToken token)
+{
+	gchar *unescaped;
+
+	if (memchr(token.str, '&', token.len) == NULL)
+		return uri_set_add(set, token);
+
+	unescaped = markup_unescape(token);
+	token.str = unescaped;
+	token.len = strlen(unescaped);
+
+	if (validate_uri(token) == FALSE) {
+		g_free(unescaped);
+		return FALSE;
+	}
+
+	return uri_set_add_full(set, token, unescaped);
+}
+
+static GSList *
+uri_set_to_list(GvUriSet *set)
+{
+	GSList *list = NULL;
+	guint i;
+
+	for (i = set->uris->len; i > 0; i--)
+		list = g_slist_prepend(list, g_strdup(set->uris->pdata[i - 1]));
+
+	return list;
+}
+
+/* Consumes the set */
+static GSList *
+uri_set_steal_list(GvUriSet *set)
+{
+	GSList *list = NULL;
+	guint i;
+
+	for (i = set->uris->len; i > 0; i--)
+		list = g_slist_prepend(list, set->uris->pdata[i - 1]);
+
+	g_ptr_array_set_free_func(set->uris, NULL);
+	uri_set_clear(set);
 
-	return g_slist_reverse(out);
+	return list;
 }
 
 /* Parse a M3U playlist, which is a simple text file, each line being a URI.
@@ -105,214 +529,197 @@ no_duplicate(GSList *input_list)
  * Content-Types: audio/x-pn-realaudio
  */
 
-GSList *
-gv_parse_m3u_playlist(const gchar *text, gsize text_size G_GNUC_UNUSED)
+static void
+m3u_parse_line(GvToken line, gpointer user_data)
 {
-	GSList *list = NULL;
-	const gchar *eol;
-	gchar **lines;
-	guint i;
-
-	/* Guess which delimiter is used to separate each lines.
-	 * Traditionnaly, UNIX would only use `\n`, Windows would use `\r\n`.
-	 */
-	if (strstr(text, "\r\n"))
-		eol = "\r\n";
-	else
-		eol = "\n";
+	GvUriSet *uris = user_data;
 
-	/* Split into different lines */
-	lines = g_strsplit(text, eol, -1);
-	if (lines == NULL) {
-		WARNING("Empty m3u playlist");
-		return NULL;
-	}
-
-	/* Iterate on lines */
-	for (i = 0; lines[i] != NULL; i++) {
-		gchar *line = lines[i];
-
-		/* Remove leading & trailing whitespaces */
-		line = g_strstrip(line);
-
-		/* Ignore emtpy lines and comments */
-		if (line[0] == '\0' || line[0] == '#')
-			continue;
+	/* Ignore emtpy lines and comments */
+	if (line.len == 0 || line.str[0] == '#')
+		return;
 
-		/* If it's not a valid URI, discard it */
-		if (validate_uri(line) == FALSE)
-			continue;
+	uri_set_add(uris, line);
+}
 
-		/* Add to stream list */
-		list = g_slist_append(list, g_strdup(line));
-	}
+GSList *
+gv_parse_m3u_playlist(const gchar *text, gsize text_size)
+{
+	GvUriSet uris;
 
-	/* Cleanup */
-	g_strfreev(lines);
+	uri_set_init(&uris);
+	scan_lines(text, text_size, TRUE, m3u_parse_line, &uris);
 
-	return no_duplicate(list);
+	return uri_set_steal_list(&uris);
 }
 
 /* Parse a PLS playlist, which is a "Desktop Entry File" in the Unix world,
  * or an "INI File" in the Windows realm.
  *
  * Examples in the wild showed that it must be treated as case-insensitive,
- * even though the format is supposed to be case-sensitive.
+ * even though the format is supposed to be case-sensitive. Examples also
+ * showed NumberOfEvents instead of NumberOfEntries.
+ *
+ * Only the entries up to the number of entries are taken, in order. If an
+ * entry is given several times, the last one wins, as for a key file.
  *
  * Ref: https://en.wikipedia.org/wiki/PLS_(file_format)
  * Content-Types: audio/x-scpls
  * Extra-Content-Types (seen in the wild): application/pls+xml, audio/scpls
  */
 
-static gchar *
-pls_get_playlist_group_name(GKeyFile *key_file)
-{
-	gchar **groups;
-	gchar **ptr;
-	gchar *ret;
+typedef struct {
+	guint number;
+	guint position;
+	GvToken uri;
+} GvPlsEntry;
+
+typedef struct {
+	gboolean in_group;
+	gint64 n_entries;  // -1 if not found
+	/* Called for each FileN entry of the playlist group */
+	void (*entry)(gpointer pls, guint number, GvToken uri);
+	GArray *entries;
+	/* Incremental parsing */
+	GvUriSet *uris;
+	guint next;  // next entry to report, 0 once out of order
+} GvPlsState;
 
-	if (g_key_file_has_group(key_file, "playlist"))
-		return g_strdup("playlist");
+static gboolean
+parse_uint(GvToken token, guint64 max, guint64 *out)
+{
+	guint64 value = 0;
+	gsize i;
 
-	groups = g_key_file_get_groups(key_file, NULL);
+	if (token.len == 0)
+		return FALSE;
 
-	ret = NULL;
-	for (ptr = groups; *ptr != NULL; ptr++) {
-		if (g_ascii_strcasecmp(*ptr, "playlist") == 0) {
-			ret = g_strdup(*ptr);
-			break;
-		}
+	for (i = 0; i < token.len; i++) {
+		if (!g_ascii_isdigit(token.str[i]))
+			return FALSE;
+		value = value * 10 + (token.str[i] - '0');
+		if (value > max)
+			return FALSE;
 	}
 
-	g_strfreev(groups);
-
-	return ret;
+	*out = value;
+	return TRUE;
 }
 
-static gchar *
-pls_get_number_of_entries_key_name(GKeyFile *key_file, const gchar *group_name)
+static void
+pls_parse_line(GvToken line, gpointer user_data)
 {
-	GError *err = NULL;
-	gchar **keys;
-	gchar **ptr;
-	gchar *ret;
+	GvPlsState *pls = user_data;
+	const gchar *equal;
+	GvToken key, value;
+	guint64 number;
 
-	if (g_key_file_has_key(key_file, group_name, "NumberOfEntries", NULL))
-		return g_strdup("NumberOfEntries");
+	/* Ignore empty lines and comments */
+	if (line.len == 0 || line.str[0] == '#' || line.str[0] == ';')
+		return;
 
-	keys = g_key_file_get_keys(key_file, group_name, NULL, &err);
-	if (err != NULL) {
-		WARNING("Failed to get keys for group %s: %s", group_name, err->message);
-		g_clear_error(&err);
-		return NULL;
+	/* Group header, we're only interested in the playlist group */
+	if (line.str[0] == '[') {
+		pls->in_group = token_equal_ci(line, "[playlist]");
+		return;
 	}
 
-	ret = NULL;
-	for (ptr = keys; *ptr != NULL; ptr ++) {
-		if (g_ascii_strcasecmp(*ptr, "numberofentries") == 0) {
-			ret = g_strdup(*ptr);
-			break;
-		} else if (g_ascii_strcasecmp(*ptr, "numberofevents") == 0) {
-			ret = g_strdup(*ptr);
-			break;
-		}
+	if (pls->in_group == FALSE)
+		return;
+
+	/* Key and value */
+	equal = memchr(line.str, '=', line.len);
+	if (equal == NULL)
+		return;
+
+	key.str = line.str;
+	key.len = equal - line.str;
+	key = token_strip(key);
+	value.str = equal + 1;
+	value.len = line.str + line.len - value.str;
+	value = token_strip(value);
+
+	if (token_equal_ci(key, "numberofentries") ||
+	    token_equal_ci(key, "numberofevents")) {
+		if (parse_uint(value, G_MAXINT, &number))
+			pls->n_entries = number;
+		else
+			WARNING("Invalid number of entries: %.*s",
+				(gint) value.len, value.str);
+		return;
 	}
 
-	g_strfreev(keys);
+	if (token_has_prefix_ci(key, "file")) {
+		key.str += 4;
+		key.len -= 4;
+		if (parse_uint(key, G_MAXUINT, &number))
+			pls->entry(pls, number, value);
+	}
+}
 
-	return ret;
+static void
+pls_collect_entry(gpointer user_data, guint number, GvToken uri)
+{
+	GvPlsState *pls = user_data;
+	GvPlsEntry entry = { number, pls->entries->len, uri };
+
+	g_array_append_val(pls->entries, entry);
 }
 
-static GSList *
-pls_get_streams(GKeyFile *keyfile, const gchar *playlist, guint n_entries)
+static gint
+pls_compare_entries(gconstpointer a, gconstpointer b)
 {
-	GSList *list = NULL;
-	guint i;
+	const GvPlsEntry *ea = a;
+	const GvPlsEntry *eb = b;
 
-	for (i = 0; i < n_entries; i++) {
-		GError *err = NULL;
-		gchar key[8];
-		gchar *str;
+	if (ea->number != eb->number)
+		return ea->number < eb->number ? -1 : 1;
 
-		g_snprintf(key, sizeof key, "File%u", i + 1);
+	return ea->position < eb->position ? -1 : 1;
+}
+
+static void
+pls_add_entries(GvPlsState *pls, GvUriSet *uris)
+{
+	guint i;
 
-		if (!g_key_file_has_key(keyfile, playlist, key, NULL))
-			g_snprintf(key, sizeof key, "file%u", i + 1);
+	if (pls->n_entries < 0) {
+		WARNING("Failed to get the number of entries");
+		return;
+	}
 
-		if (!g_key_file_has_key(keyfile, playlist, key, NULL)) {
-			WARNING("Failed to get key %s: %s", key);
-			continue;
-		}
+	/* Entries in order, the last one wins if there are duplicates */
+	g_array_sort(pls->entries, pls_compare_entries);
+	for (i = 0; i < pls->entries->len; i++) {
+		GvPlsEntry *entry = &g_array_index(pls->entries, GvPlsEntry, i);
 
-		str = g_key_file_get_string(keyfile, playlist, key, &err);
-		if (err != NULL) {
-			WARNING("Failed to get string for key %s: %s", key, err->message);
-			g_clear_error(&err);
+		if (entry->number < 1 || entry->number > pls->n_entries)
 			continue;
-		}
 
-		if (validate_uri(str) == FALSE) {
-			g_free(str);
+		if (i + 1 < pls->entries->len &&
+		    g_array_index(pls->entries, GvPlsEntry, i + 1).number == entry->number)
 			continue;
-		}
 
-		 /* No need for strdup, it's already an allocated string */
-		list = g_slist_append(list, str);
+		uri_set_add(uris, entry->uri);
 	}
-
-	return list;
 }
 
 GSList *
 gv_parse_pls_playlist(const gchar *text, gsize text_size)
 {
-	GKeyFile *keyfile;
-	GError *err = NULL;
-	GSList *list = NULL;
-	gchar *playlist = NULL;
-	gchar *number_of_entries = NULL;
-	gint n_entries;
+	GvPlsState pls = { 0 };
+	GvUriSet uris;
 
-	keyfile = g_key_file_new();
-
-	g_key_file_load_from_data(keyfile, text, text_size, 0, &err);
-	if (err != NULL) {
-		WARNING("Failed to parse pls playlist: %s", err->message);
-		g_clear_error(&err);
-		goto fail;
-	}
-
-	playlist = pls_get_playlist_group_name(keyfile);
-	if (playlist == NULL) {
-		WARNING("Failed to get the playlist group name");
-		goto fail;
-	}
-
-	number_of_entries = pls_get_number_of_entries_key_name(keyfile, playlist);
-	if (number_of_entries == NULL) {
-		WARNING("Failed to get the number of entries key name");
-		goto fail;
-	}
-
-	n_entries = g_key_file_get_integer(keyfile, playlist, number_of_entries, &err);
-	if (err != NULL) {
-		WARNING("Failed to get integer for key %s: %s", number_of_entries, err->message);
-		g_clear_error(&err);
-		goto fail;
-	}
-	if (n_entries < 0) {
-		WARNING("Number of entries is negative: %d", n_entries);
-		goto fail;
-	}
+	uri_set_init(&uris);
+	pls.n_entries = -1;
+	pls.entry = pls_collect_entry;
+	pls.entries = g_array_new(FALSE, FALSE, sizeof(GvPlsEntry));
 
-	list = pls_get_streams(keyfile, playlist, (guint) n_entries);
+	scan_lines(text, text_size, TRUE, pls_parse_line, &pls);
+	pls_add_entries(&pls, &uris);
 
-fail:
-	g_free(number_of_entries);
-	g_free(playlist);
-	g_key_file_free(keyfile);
+	g_array_unref(pls.entries);
 
-	return no_duplicate(list);
+	return uri_set_steal_list(&uris);
 }
 
 /* Parse an ASX (Advanced Stream Redirector) playlist.
@@ -322,139 +729,254 @@ fail:
  */
 
 static void
-asx_parse_element_cb(GMarkupParseContext *context G_GNUC_UNUSED,
-		     const gchar *element_name,
-		     const gchar **attribute_names,
-		     const gchar **attribute_values,
-		     gpointer user_data,
-		     GError **err G_GNUC_UNUSED)
-{
-	GSList **llink = (GSList **) user_data;
-	const gchar *href;
-	guint i;
+asx_element(GvToken name, GvToken attributes, gpointer user_data)
+{
+	GvUriSet *uris = user_data;
+	GvToken href;
 
 	/* We're only interested in the 'ref' element */
-	if (g_ascii_strcasecmp(element_name, "ref"))
+	if (!token_equal_ci(name, "ref"))
 		return;
 
-	/* Get 'href' attribute */
-	href = NULL;
-	for (i = 0; attribute_names[i]; i++) {
-		if (!g_ascii_strcasecmp(attribute_names[i], "href")) {
-			href = attribute_values[i];
-			break;
-		}
-	}
-	if (href == NULL)
+	if (markup_get_attribute(attributes, "href", &href) == FALSE)
 		return;
 
-	/* Make sure it looks valid */
-	if (validate_uri(href) == FALSE)
-		return;
+	uri_set_add_escaped(uris, token_strip(href));
+}
+
+static const GvMarkupFuncs asx_funcs = { asx_element, NULL };
 
-	/* Add to stream list */
-	*llink = g_slist_append(*llink, g_strdup(href));
+GSList *
+gv_parse_asx_playlist(const gchar *text, gsize text_size)
+{
+	GvUriSet uris;
+
+	uri_set_init(&uris);
+	scan_markup(text, text_size, TRUE, &asx_funcs, &uris);
+
+	return uri_set_steal_list(&uris);
 }
 
+/* Parse an XSPF (XML Shareable Playlist Format) playlist.
+ * Ref: https://en.wikipedia.org/wiki/XML_Shareable_Playlist_Format
+ * Content-Types: application/xspf+xml
+ */
+
 static void
-asx_error_cb(GMarkupParseContext *context G_GNUC_UNUSED,
-	     GError *err G_GNUC_UNUSED,
-	     gpointer user_data)
+xspf_text(GvToken element, GvToken text, gpointer user_data)
 {
-	GSList **llink = (GSList **) user_data;
+	GvUriSet *uris = user_data;
+
+	/* We're only interested in the 'location' element */
+	if (!token_equal_ci(element, "location"))
+		return;
 
-	g_slist_free_full(*llink, g_free);
-	*llink = NULL;
+	uri_set_add_escaped(uris, text);
 }
 
+static const GvMarkupFuncs xspf_funcs = { NULL, xspf_text };
+
 GSList *
-gv_parse_asx_playlist(const gchar *text, gsize text_size)
+gv_parse_xspf_playlist(const gchar *text, gsize text_size)
 {
-	GMarkupParseContext *context;
-	GMarkupParser parser = {
-		asx_parse_element_cb,
-		NULL,
-		NULL,
-		NULL,
-		asx_error_cb,
-	};
-	GError *err = NULL;
-	GSList *list = NULL;
-
-	context = g_markup_parse_context_new(&parser, 0, &list, NULL);
+	GvUriSet uris;
 
-	if (!g_markup_parse_context_parse(context, text, text_size, &err)) {
-		WARNING("Failed to parse context: %s", err->message);
-		g_error_free(err);
-	}
+	uri_set_init(&uris);
+	scan_markup(text, text_size, TRUE, &xspf_funcs, &uris);
 
-	g_markup_parse_context_free(context);
-
-	return no_duplicate(list);
+	return uri_set_steal_list(&uris);
 }
 
-/* Parse an XSPF (XML Shareable Playlist Format) playlist.
- * Ref: https://en.wikipedia.org/wiki/XML_Shareable_Playlist_Format
- * Content-Types: application/xspf+xml
+/*
+ * Incremental parsing
+ *
+ * The parsers above need the whole playlist. The incremental parser is fed
+ * chunk by chunk, as the playlist is downloaded, and tells as soon as a
+ * stream is found, so that playback can start before the download is over.
+ * It runs the same scanners, on what's left of the previous chunk plus the
+ * new one. Streams are found in the order they appear in the playlist.
+ *
+ * For PLS, the entries are reported as they come, as long as they come in
+ * order, starting with File1, and after the number of entries. Otherwise we
+ * wait for the end of the playlist, where the streams are sorted out with
+ * the same rules as the full parser. An entry given again after it was
+ * reported can't be taken back though, it's only fixed in the final list.
  */
 
+struct _GvIncrementalParser {
+	GvPlaylistParser parser;
+	GString *pending;
+	GvPlsState pls;
+	GvUriSet uris;
+};
+
 static void
-xspf_text_cb(GMarkupParseContext *context,
-	     const gchar *text,
-	     gsize text_len G_GNUC_UNUSED,
-	     gpointer user_data,
-	     GError **err G_GNUC_UNUSED)
+incremental_pls_entry_clear(GvPlsEntry *entry)
 {
-	GSList **llink = (GSList **) user_data;
-	const gchar *element_name;
+	g_free((gchar *) entry->uri.str);
+}
 
-	element_name = g_markup_parse_context_get_element(context);
+static void
+incremental_pls_entry(gpointer user_data, guint number, GvToken uri)
+{
+	GvPlsState *pls = user_data;
+	GvPlsEntry entry = { number, pls->entries->len, uri };
 
-	/* We're only interested in the 'location' element */
-	if (g_ascii_strcasecmp(element_name, "location"))
+	/* The text goes away with the next chunk, keep a copy */
+	entry.uri.str = g_strndup(uri.str, uri.len);
+	g_array_append_val(pls->entries, entry);
+
+	if (pls->next == 0)
 		return;
 
-	/* Make sure it looks valid */
-	if (validate_uri(text) == FALSE)
+	if (pls->n_entries < 0 || number > pls->n_entries || number != pls->next) {
+		pls->next = 0;
 		return;
+	}
 
-	/* Add to stream list */
-	*llink = g_slist_append(*llink, g_strdup(text));
+	uri_set_add(pls->uris, entry.uri);
+	pls->next++;
 }
 
-static void
-xspf_error_cb(GMarkupParseContext *context G_GNUC_UNUSED,
-	      GError *err G_GNUC_UNUSED,
-	      gpointer user_data)
+static gsize
+incremental_scan(GvIncrementalParser *self, gboolean end)
 {
-	GSList **llink = (GSList **) user_data;
+	const gchar *text = self->pending->str;
+	gsize size = self->pending->len;
+
+	if (self->parser == gv_parse_asx_playlist)
+		return scan_markup(text, size, end, &asx_funcs, &self->uris);
+	else if (self->parser == gv_parse_xspf_playlist)
+		return scan_markup(text, size, end, &xspf_funcs, &self->uris);
+	else if (self->parser == gv_parse_pls_playlist)
+		return scan_lines(text, size, end, pls_parse_line, &self->pls);
+	else
+		return scan_lines(text, size, end, m3u_parse_line, &self->uris);
+}
 
-	g_slist_free_full(*llink, g_free);
-	*llink = NULL;
+GvIncrementalParser *
+gv_incremental_parser_new(GvPlaylistParser parser)
+{
+	GvIncrementalParser *self;
+
+	g_return_val_if_fail(parser != NULL, NULL);
+
+	self = g_new0(GvIncrementalParser, 1);
+	self->parser = parser;
+	self->pending = g_string_new(NULL);
+	uri_set_init(&self->uris);
+	self->pls.n_entries = -1;
+	self->pls.entry = incremental_pls_entry;
+	self->pls.entries = g_array_new(FALSE, FALSE, sizeof(GvPlsEntry));
+	g_array_set_clear_func(self->pls.entries,
+			(GDestroyNotify) incremental_pls_entry_clear);
+	self->pls.uris = &self->uris;
+	self->pls.next = 1;
+
+	return self;
 }
 
-GSList *
-gv_parse_xspf_playlist(const gchar *text, gsize text_size)
+void
+gv_incremental_parser_free(GvIncrementalParser *self)
 {
-	GMarkupParseContext *context;
-	GMarkupParser parser = {
-		NULL,
-		NULL,
-		xspf_text_cb,
-		NULL,
-		xspf_error_cb,
-	};
-	GError *err = NULL;
-	GSList *list = NULL;
+	if (self == NULL)
+		return;
+
+	g_string_free(self->pending, TRUE);
+	g_array_unref(self->pls.entries);
+	uri_set_clear(&self->uris);
+	g_free(self);
+}
+
+/* Returns the number of new streams found in this chunk */
+guint
+gv_incremental_parser_feed(GvIncrementalParser *self, const gchar *data, gsize size)
+{
+	guint n_streams = self->uris.uris->len;
+	gsize consumed;
 
-	context = g_markup_parse_context_new(&parser, 0, &list, NULL);
+	g_string_append_len(self->pending, data, size);
+	consumed = incremental_scan(self, FALSE);
+	g_string_erase(self->pending, 0, consumed);
+
+	return self->uris.uris->len - n_streams;
+}
+
+/* Returns the number of new streams found at the end of the playlist */
+guint
+gv_incremental_parser_end(GvIncrementalParser *self)
+{
+	guint n_streams = self->uris.uris->len;
 
-	if (!g_markup_parse_context_parse(context, text, text_size, &err)) {
-		WARNING("Failed to parse context: %s", err->message);
-		g_error_free(err);
+	incremental_scan(self, TRUE);
+	g_string_truncate(self->pending, 0);
+
+	/* Now that we have all the entries, do as the full parser does */
+	if (self->parser == gv_parse_pls_playlist) {
+		uri_set_clear(&self->uris);
+		uri_set_init(&self->uris);
+		pls_add_entries(&self->pls, &self->uris);
 	}
 
-	g_markup_parse_context_free(context);
+	if (self->uris.uris->len < n_streams)
+		return 0;
+
+	return self->uris.uris->len - n_streams;
+}
+
+const gchar *
+gv_incremental_parser_get_first_stream(GvIncrementalParser *self)
+{
+	if (self->uris.uris->len == 0)
+		return NULL;
+
+	return self->uris.uris->pdata[0];
+}
+
+GSList *
+gv_incremental_parser_get_streams(GvIncrementalParser *self)
+{
+	return uri_set_to_list(&self->uris);
+}
 
-	return no_duplicate(list);
+/*
+ * Sniffing
+ *
+ * Guess the playlist format from the first bytes, when there's nothing else
+ * to go by (no extension, meaningless Content-Type). HLS playlists look
+ * like M3U ones, but they're not ours to parse, so they're not matched.
+ */
+
+#define SNIFF_SIZE 1024
+
+GvPlaylistParser
+gv_sniff_playlist_parser(const gchar *text, gsize text_size)
+{
+	GvPlaylistParser parser = NULL;
+	gchar *head;
+	gchar *ptr;
+
+	head = g_ascii_strdown(text, MIN(text_size, SNIFF_SIZE));
+
+	/* Skip UTF-8 BOM and leading whitespace */
+	ptr = head;
+	if (g_str_has_prefix(ptr, "\xef\xbb\xbf"))
+		ptr += 3;
+	while (g_ascii_isspace(*ptr))
+		ptr++;
+
+	if (g_str_has_prefix(ptr, "[playlist]"))
+		parser = gv_parse_pls_playlist;
+	else if (g_str_has_prefix(ptr, "#extm3u") && strstr(ptr, "#ext-x-") == NULL)
+		parser = gv_parse_m3u_playlist;
+	else if (g_str_has_prefix(ptr, "http://") || g_str_has_prefix(ptr, "https://"))
+		parser = gv_parse_m3u_playlist;
+	else if (ptr[0] == '<' && strstr(ptr, "<asx") != NULL)
+		parser = gv_parse_asx_playlist;
+	else if (ptr[0] == '<' && strstr(ptr, "<playlist") != NULL)
+		parser = gv_parse_xspf_playlist;
+
+	g_free(head);
+
+	return parser;
 }
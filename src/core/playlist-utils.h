@@ -28,3 +28,16 @@ GSList *gv_parse_m3u_playlist (const gchar *text, gsize text_size);
 GSList *gv_parse_pls_playlist (const gchar *text, gsize text_size);
 GSList *gv_parse_asx_playlist (const gchar *text, gsize text_size);
 GSList *gv_parse_xspf_playlist(const gchar *text, gsize text_size);
+
+typedef struct _GvIncrementalParser GvIncrementalParser;
+
+GvIncrementalParser *gv_incremental_parser_new             (GvPlaylistParser parser);
+void                 gv_incremental_parser_free            (GvIncrementalParser *self);
+guint                gv_incremental_parser_feed            (GvIncrementalParser *self,
+							    const gchar *data,
+							    gsize size);
+guint                gv_incremental_parser_end             (GvIncrementalParser *self);
+const gchar         *gv_incremental_parser_get_first_stream(GvIncrementalParser *self);
+GSList              *gv_incremental_parser_get_streams     (GvIncrementalParser *self);
+
+GvPlaylistParser gv_sniff_playlist_parser(const gchar *text, gsize text_size);
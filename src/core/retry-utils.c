@@ -0,0 +1,99 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2023-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The delay doubles with each attempt, from the base delay up to the max
+ * delay, and half of it is random, so that a bunch of players that lost
+ * their stream at the same time don't all come back at the same time. The
+ * first few attempts can be immediate. The first policy that matches the
+ * error is used, the last one matches anything.
+ */
+
+#include <glib.h>
+#include <gst/gst.h>
+
+#include "core/gv-engine.h"
+
+#include "core/retry-utils.h"
+
+static const GvRetryPolicy retry_policies[] = {
+	{ "stall",          gv_engine_error_quark,    GV_ENGINE_ERROR_STALLED,
+	  2, 1000, 30000, 0, TRUE },
+	{ "not-found",      gst_resource_error_quark, GST_RESOURCE_ERROR_NOT_FOUND,
+	  0, 5000, 300000, 10, FALSE },
+	{ "not-authorized", gst_resource_error_quark, GST_RESOURCE_ERROR_NOT_AUTHORIZED,
+	  0, 5000, 60000, 3, FALSE },
+	{ "network",        gst_resource_error_quark, -1,
+	  0, 1000, 60000, 0, FALSE },
+	{ "stream",         gst_stream_error_quark,   -1,
+	  0, 2000, 120000, 10, FALSE },
+	{ "default",        NULL,                     -1,
+	  0, 1000, 60000, 0, FALSE },
+};
+
+static const GvRetryPolicy eos_retry_policy =
+	{ "end-of-stream",  NULL,                     -1,
+	  0, 1000, 30000, 0, FALSE };
+
+const GvRetryPolicy *
+gv_find_retry_policy(const GError *error)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(retry_policies); i++) {
+		const GvRetryPolicy *policy = &retry_policies[i];
+
+		if (error == NULL)
+			continue;
+
+		if (policy->domain != NULL && policy->domain() != error->domain)
+			continue;
+
+		if (policy->code != -1 && policy->code != error->code)
+			continue;
+
+		return policy;
+	}
+
+	return &retry_policies[G_N_ELEMENTS(retry_policies) - 1];
+}
+
+const GvRetryPolicy *
+gv_get_eos_retry_policy(void)
+{
+	return &eos_retry_policy;
+}
+
+guint
+gv_get_retry_delay(const GvRetryPolicy *policy, guint attempt)
+{
+	guint64 delay;
+
+	if (attempt <= policy->immediate)
+		return 0;
+
+	/* Exponential back-off */
+	delay = (guint64) policy->base_delay << MIN(attempt - policy->immediate - 1, 16);
+	if (delay > policy->max_delay)
+		delay = policy->max_delay;
+
+	/* Half of it is jitter */
+	return delay / 2 + g_random_int_range(0, delay / 2 + 1);
+}
@@ -0,0 +1,43 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2023-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+/* Retry policies: how long to wait before retrying, and when to give up,
+ * depending on the error. Some policies reconnect to the same stream,
+ * rather than starting over from the station uri (and possibly downloading
+ * the playlist again). */
+
+typedef struct {
+	const gchar *name;
+	GQuark (*domain)(void);  // NULL matches any domain
+	gint code;               // -1 matches any code
+	guint immediate;         // attempts with no delay
+	guint base_delay;        // milliseconds
+	guint max_delay;         // milliseconds
+	guint max_attempts;      // zero to never give up
+	gboolean reconnect;
+} GvRetryPolicy;
+
+const GvRetryPolicy *gv_find_retry_policy    (const GError *error);
+const GvRetryPolicy *gv_get_eos_retry_policy (void);
+guint                gv_get_retry_delay      (const GvRetryPolicy *policy, guint attempt);
@@ -0,0 +1,107 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <mutest.h>
+
+#include "base/log.h"
+#include "core/gv-core-internal.h"
+#include "core/gv-engine.h"
+
+#define MISSING_URI "file:///nonexistent/goodvibes-test.mp3"
+#define N_ROUNDS    20
+#define TIMEOUT     5  // seconds
+
+static void
+on_playback_error(GvEngine *engine G_GNUC_UNUSED, GError *error G_GNUC_UNUSED,
+		  const gchar *debug G_GNUC_UNUSED, gboolean *errored)
+{
+	*errored = TRUE;
+}
+
+static gboolean
+when_timeout_expire(gboolean *expired)
+{
+	*expired = TRUE;
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+engine_flush_twice(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvEngine *engine;
+	guint i, n_errors = 0;
+
+	engine = gv_engine_new_headless();
+
+	/* Switching stations stops the engine twice in a row, hence two
+	 * flushes of the bus. The error of the next stream must still make
+	 * it to the main loop. */
+	for (i = 0; i < N_ROUNDS; i++) {
+		gboolean errored = FALSE;
+		gboolean expired = FALSE;
+		gulong handler_id;
+		guint timeout_id;
+
+		gv_engine_play(engine, MISSING_URI, NULL, TRUE, NULL);
+		gv_engine_stop(engine);
+		gv_engine_stop(engine);
+
+		handler_id = g_signal_connect(engine, "playback-error",
+				G_CALLBACK(on_playback_error), &errored);
+		timeout_id = g_timeout_add_seconds(TIMEOUT,
+				G_SOURCE_FUNC(when_timeout_expire), &expired);
+
+		gv_engine_play(engine, MISSING_URI, NULL, TRUE, NULL);
+		while (errored == FALSE && expired == FALSE)
+			g_main_context_iteration(NULL, TRUE);
+
+		if (errored == TRUE)
+			n_errors++;
+
+		if (expired == FALSE)
+			g_source_remove(timeout_id);
+		g_signal_handler_disconnect(engine, handler_id);
+		gv_engine_stop(engine);
+	}
+
+	mutest_expect("bus messages are still dispatched after each flush",
+		      mutest_int_value(n_errors),
+		      mutest_to_be, N_ROUNDS,
+		      NULL);
+
+	g_object_unref(engine);
+}
+
+static void
+engine_suite(mutest_suite_t *suite G_GNUC_UNUSED)
+{
+	mutest_it("keeps track of bus flushes", engine_flush_twice);
+}
+
+MUTEST_MAIN(
+	gst_init(NULL, NULL);
+	log_init(NULL, TRUE, NULL);
+	g_setenv("GOODVIBES_IN_TEST_SUITE", "1", TRUE);
+	gv_core_user_agent = "Goodvibes test";
+	mutest_describe("gv-engine", engine_suite);
+)
@@ -0,0 +1,206 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2020-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measure the cost of monitoring many streams at once. The same stream is
+ * opened several times, and we report the CPU time and the memory used per
+ * stream, first with the streams decoded, then in metadata-only mode. This
+ * needs network access and a stream to connect to, so it's skipped unless
+ * GOODVIBES_BENCH_URI is set:
+ *
+ *   GOODVIBES_BENCH_URI=https://... meson test --benchmark -C build
+ *
+ * GOODVIBES_BENCH_SLOTS and GOODVIBES_BENCH_DURATION (in seconds) can be
+ * used to tune the run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+#include "core/gv-core-internal.h"
+#include "core/gv-monitor.h"
+#include "core/gv-station.h"
+
+#define DEFAULT_SLOTS    10
+#define DEFAULT_DURATION 30  // seconds
+#define SKIP_EXIT_CODE   77
+
+static guint
+getenv_uint(const gchar *name, guint default_value)
+{
+	const gchar *str = g_getenv(name);
+	guint64 value;
+
+	if (str == NULL)
+		return default_value;
+
+	if (!g_ascii_string_to_unsigned(str, 10, 1, G_MAXUINT, &value, NULL)) {
+		g_printerr("Invalid value for %s: '%s'\n", name, str);
+		exit(EXIT_FAILURE);
+	}
+
+	return value;
+}
+
+static gdouble
+get_cpu_time(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+		usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static glong
+get_rss_kib(void)
+{
+	glong size = 0, resident = 0;
+	FILE *file;
+
+	file = fopen("/proc/self/statm", "r");
+	if (file == NULL)
+		return 0;
+	if (fscanf(file, "%ld %ld", &size, &resident) != 2)
+		resident = 0;
+	fclose(file);
+
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static guint
+count_playing(GvMonitor *monitor)
+{
+	guint i, n = 0;
+
+	for (i = 0; i < gv_monitor_get_n_slots(monitor); i++) {
+		GvPlayback *playback = gv_monitor_get_playback(monitor, i);
+
+		if (gv_playback_get_state(playback) == GV_PLAYBACK_STATE_PLAYING)
+			n++;
+	}
+
+	return n;
+}
+
+static gboolean
+on_timeout(gpointer user_data)
+{
+	GMainLoop *loop = user_data;
+
+	g_main_loop_quit(loop);
+
+	return G_SOURCE_REMOVE;
+}
+
+typedef struct {
+	guint n_playing;
+	gdouble cpu_percent;
+	glong rss_kib;
+} BenchResult;
+
+static void
+run_bench(const gchar *uri, guint n_slots, guint duration, gboolean metadata_only,
+	  BenchResult *result)
+{
+	GvMonitor *monitor;
+	GMainLoop *loop;
+	gdouble cpu_start, cpu_time, wall_start, wall_time;
+	glong rss_start;
+	guint i;
+
+	loop = g_main_loop_new(NULL, FALSE);
+	monitor = gv_monitor_new(metadata_only);
+	for (i = 0; i < n_slots; i++)
+		gv_monitor_add(monitor, gv_station_new(NULL, uri));
+
+	rss_start = get_rss_kib();
+	cpu_start = get_cpu_time();
+	wall_start = g_get_monotonic_time() / 1e6;
+
+	gv_monitor_start(monitor);
+	g_timeout_add_seconds(duration, on_timeout, loop);
+	g_main_loop_run(loop);
+
+	cpu_time = get_cpu_time() - cpu_start;
+	wall_time = g_get_monotonic_time() / 1e6 - wall_start;
+
+	result->n_playing = count_playing(monitor);
+	result->cpu_percent = 100.0 * cpu_time / wall_time;
+	result->rss_kib = get_rss_kib() - rss_start;
+
+	gv_monitor_stop(monitor);
+	g_object_unref(monitor);
+	g_main_loop_unref(loop);
+}
+
+static void
+print_result(const gchar *mode, guint n_slots, BenchResult *result)
+{
+	g_print("%-14s %3u/%-3u playing, cpu %6.2f %% (%.3f %% per stream), "
+		"memory %6ld KiB (%ld KiB per stream)\n",
+		mode, result->n_playing, n_slots,
+		result->cpu_percent, result->cpu_percent / n_slots,
+		result->rss_kib, result->rss_kib / (glong) n_slots);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const gchar *uri;
+	guint n_slots, duration;
+	BenchResult decoding, metadata_only;
+
+	uri = g_getenv("GOODVIBES_BENCH_URI");
+	if (uri == NULL) {
+		g_print("GOODVIBES_BENCH_URI is not set, skipping\n");
+		return SKIP_EXIT_CODE;
+	}
+
+	n_slots = getenv_uint("GOODVIBES_BENCH_SLOTS", DEFAULT_SLOTS);
+	duration = getenv_uint("GOODVIBES_BENCH_DURATION", DEFAULT_DURATION);
+
+	gst_init(&argc, &argv);
+	gv_core_user_agent = "Goodvibes benchmark";
+	gv_core_http_pool = gv_http_pool_new();
+
+	g_print("%u streams, %u seconds: %s\n", n_slots, duration, uri);
+
+	run_bench(uri, n_slots, duration, FALSE, &decoding);
+	print_result("decoding", n_slots, &decoding);
+
+	run_bench(uri, n_slots, duration, TRUE, &metadata_only);
+	print_result("metadata-only", n_slots, &metadata_only);
+
+	if (decoding.cpu_percent > 0)
+		g_print("metadata-only uses %.1f %% of the CPU time of decoding\n",
+			100.0 * metadata_only.cpu_percent / decoding.cpu_percent);
+
+	if (decoding.n_playing == 0 || metadata_only.n_playing == 0)
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,265 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measure the cost of parsing large playlists, the kind that directories
+ * serve with thousands of entries. A playlist is generated for each format,
+ * with a few duplicates thrown in, and we report the throughput and the
+ * number of allocations per entry, for the batch parser and for the
+ * incremental parser fed with network-sized chunks:
+ *
+ *   meson test --benchmark -C build
+ *
+ * GOODVIBES_BENCH_ENTRIES and GOODVIBES_BENCH_ROUNDS can be used to tune
+ * the run. Allocations are only counted with the GNU C library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include "core/playlist-utils.h"
+
+#define DEFAULT_ENTRIES 5000
+#define DEFAULT_ROUNDS  20
+#define CHUNK_SIZE      4096
+#define DUPLICATE_EVERY 10
+
+/*
+ * Count allocations, by wrapping the allocator of the C library
+ */
+
+static guint64 n_allocs;
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *
+malloc(size_t size)
+{
+	n_allocs++;
+	return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+	n_allocs++;
+	return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+	n_allocs++;
+	return __libc_realloc(ptr, size);
+}
+#endif
+
+/*
+ * Playlist generators
+ */
+
+typedef struct {
+	const gchar *name;
+	GvPlaylistParser parser;
+	const gchar *header;
+	const gchar *entry;
+	const gchar *footer;
+} PlaylistFormat;
+
+static const PlaylistFormat formats[] = {
+	{ "m3u", gv_parse_m3u_playlist,
+	  "#EXTM3U\n",
+	  "#EXTINF:-1,Station %u\nhttp://stream%u.example.com:8000/live\n",
+	  "" },
+	{ "pls", gv_parse_pls_playlist,
+	  "[playlist]\n",
+	  "File%u=http://stream%u.example.com:8000/live\nTitle%u=Station\nLength%u=-1\n",
+	  "NumberOfEntries=%u\nVersion=2\n" },
+	{ "asx", gv_parse_asx_playlist,
+	  "<asx version=\"3.0\">\n",
+	  "  <entry><title>Station %u</title>"
+	  "<ref href=\"http://stream%u.example.com:8000/live?a=1&amp;b=2\"/></entry>\n",
+	  "</asx>\n" },
+	{ "xspf", gv_parse_xspf_playlist,
+	  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	  "<playlist version=\"1\" xmlns=\"http://xspf.org/ns/0/\">\n<trackList>\n",
+	  "  <track><title>Station %u</title>"
+	  "<location>http://stream%u.example.com:8000/live</location></track>\n",
+	  "</trackList>\n</playlist>\n" },
+};
+
+static gchar *
+make_playlist(const PlaylistFormat *format, guint n_entries, gsize *size)
+{
+	GString *str;
+	guint i;
+
+	str = g_string_new(format->header);
+
+	for (i = 1; i <= n_entries; i++) {
+		/* Every now and then, the previous stream shows up again */
+		guint stream = i % DUPLICATE_EVERY == 0 ? i - 1 : i;
+
+		/* Extra arguments are ignored by the formats that don't need them */
+		g_string_append_printf(str, format->entry, i, stream, i, i);
+	}
+
+	g_string_append_printf(str, format->footer, n_entries);
+
+	*size = str->len;
+	return g_string_free(str, FALSE);
+}
+
+/*
+ * Benchmark
+ */
+
+typedef struct {
+	guint n_streams;
+	gdouble seconds;
+	guint64 n_allocs;
+} BenchResult;
+
+static guint
+parse_batch(const PlaylistFormat *format, const gchar *text, gsize size)
+{
+	GSList *streams;
+	guint n_streams;
+
+	streams = format->parser(text, size);
+	n_streams = g_slist_length(streams);
+	g_slist_free_full(streams, g_free);
+
+	return n_streams;
+}
+
+static guint
+parse_incremental(const PlaylistFormat *format, const gchar *text, gsize size)
+{
+	GvIncrementalParser *parser;
+	guint n_streams = 0;
+	gsize offset;
+
+	parser = gv_incremental_parser_new(format->parser);
+	for (offset = 0; offset < size; offset += CHUNK_SIZE)
+		n_streams += gv_incremental_parser_feed(parser, text + offset,
+				MIN(CHUNK_SIZE, size - offset));
+	n_streams += gv_incremental_parser_end(parser);
+	gv_incremental_parser_free(parser);
+
+	return n_streams;
+}
+
+static void
+run_bench(const PlaylistFormat *format, const gchar *text, gsize size,
+	  guint n_rounds, gboolean incremental, BenchResult *result)
+{
+	gint64 start;
+	guint64 allocs_start;
+	guint i;
+
+	allocs_start = n_allocs;
+	start = g_get_monotonic_time();
+
+	for (i = 0; i < n_rounds; i++) {
+		if (incremental)
+			result->n_streams = parse_incremental(format, text, size);
+		else
+			result->n_streams = parse_batch(format, text, size);
+	}
+
+	result->seconds = (g_get_monotonic_time() - start) / 1e6;
+	result->n_allocs = (n_allocs - allocs_start) / n_rounds;
+}
+
+static void
+print_result(const gchar *name, const gchar *mode, guint n_entries, gsize size,
+	     guint n_rounds, BenchResult *result)
+{
+	gdouble seconds = MAX(result->seconds, 1e-6);
+
+	g_print("%-4s %-11s %5u streams, %8.1f MB/s, %10.0f entries/s, "
+		"%7" G_GUINT64_FORMAT " allocs (%.2f per entry)\n",
+		name, mode, result->n_streams,
+		(gdouble) size * n_rounds / seconds / 1e6,
+		(gdouble) n_entries * n_rounds / seconds,
+		result->n_allocs, (gdouble) result->n_allocs / n_entries);
+}
+
+static guint
+getenv_uint(const gchar *name, guint default_value)
+{
+	const gchar *str = g_getenv(name);
+	guint64 value;
+
+	if (str == NULL)
+		return default_value;
+
+	if (!g_ascii_string_to_unsigned(str, 10, 1, G_MAXUINT, &value, NULL)) {
+		g_printerr("Invalid value for %s: '%s'\n", name, str);
+		exit(EXIT_FAILURE);
+	}
+
+	return value;
+}
+
+int
+main(int argc G_GNUC_UNUSED, char *argv[] G_GNUC_UNUSED)
+{
+	guint n_entries, n_rounds, n_unique;
+	gboolean failed = FALSE;
+	guint i;
+
+	n_entries = getenv_uint("GOODVIBES_BENCH_ENTRIES", DEFAULT_ENTRIES);
+	n_rounds = getenv_uint("GOODVIBES_BENCH_ROUNDS", DEFAULT_ROUNDS);
+	n_unique = n_entries - n_entries / DUPLICATE_EVERY;
+
+	g_print("%u entries (%u unique), %u rounds\n", n_entries, n_unique, n_rounds);
+
+	for (i = 0; i < G_N_ELEMENTS(formats); i++) {
+		const PlaylistFormat *format = &formats[i];
+		BenchResult batch = { 0 }, incremental = { 0 };
+		gchar *text;
+		gsize size;
+
+		text = make_playlist(format, n_entries, &size);
+
+		run_bench(format, text, size, n_rounds, FALSE, &batch);
+		print_result(format->name, "batch", n_entries, size, n_rounds, &batch);
+
+		run_bench(format, text, size, n_rounds, TRUE, &incremental);
+		print_result(format->name, "incremental", n_entries, size, n_rounds,
+			     &incremental);
+
+		if (batch.n_streams != n_unique || incremental.n_streams != n_unique) {
+			g_printerr("%s: expected %u streams\n", format->name, n_unique);
+			failed = TRUE;
+		}
+
+		g_free(text);
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
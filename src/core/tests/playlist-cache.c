@@ -0,0 +1,120 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <mutest.h>
+
+#include "base/log.h"
+#include "core/playlist-cache.h"
+#include "core/tests/tmp-utils.h"
+
+#define PLAYLIST_URI "http://example.com/radio.m3u"
+#define PLAYLIST_CONTENT "#EXTM3U\nhttp://example.com/radio.mp3\n"
+
+static void
+playlist_cache_store_lookup(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvPlaylistCacheEntry entry = { 0 };
+	GvPlaylistCacheEntry *cached;
+	GError *err = NULL;
+	gboolean ret;
+
+	/* Nothing in the cache yet */
+	cached = gv_playlist_cache_lookup(PLAYLIST_URI);
+	mutest_expect("nothing is cached at first",
+		      mutest_pointer(cached),
+		      mutest_to_be_null,
+		      NULL);
+
+	entry.redirection_uri = "https://example.com/radio.m3u";
+	entry.etag = "\"abc123\"";
+	entry.content = PLAYLIST_CONTENT;
+	entry.content_size = sizeof PLAYLIST_CONTENT - 1;
+
+	ret = gv_playlist_cache_store(PLAYLIST_URI, &entry, &err);
+	g_assert_no_error(err);
+	mutest_expect("playlist is stored",
+		      mutest_bool_value(ret),
+		      mutest_to_be_true,
+		      NULL);
+
+	/* Everything that was stored comes back */
+	cached = gv_playlist_cache_lookup(PLAYLIST_URI);
+	mutest_expect("playlist is cached",
+		      mutest_pointer(cached),
+		      mutest_not, mutest_to_be_null,
+		      NULL);
+	mutest_expect("content is the same",
+		      mutest_string_value(cached->content),
+		      mutest_to_be, PLAYLIST_CONTENT,
+		      NULL);
+	mutest_expect("content size is the same",
+		      mutest_int_value(cached->content_size),
+		      mutest_to_be, sizeof PLAYLIST_CONTENT - 1,
+		      NULL);
+	mutest_expect("redirection uri is the same",
+		      mutest_string_value(cached->redirection_uri),
+		      mutest_to_be, "https://example.com/radio.m3u",
+		      NULL);
+	mutest_expect("etag is the same",
+		      mutest_string_value(cached->etag),
+		      mutest_to_be, "\"abc123\"",
+		      NULL);
+	mutest_expect("last-modified was not set",
+		      mutest_pointer(cached->last_modified),
+		      mutest_to_be_null,
+		      NULL);
+	gv_playlist_cache_entry_free(cached);
+
+	/* Other uris are not affected */
+	cached = gv_playlist_cache_lookup("http://example.com/other.m3u");
+	mutest_expect("other playlist is not cached",
+		      mutest_pointer(cached),
+		      mutest_to_be_null,
+		      NULL);
+
+	/* And it goes away when removed */
+	gv_playlist_cache_remove(PLAYLIST_URI);
+	cached = gv_playlist_cache_lookup(PLAYLIST_URI);
+	mutest_expect("playlist is not cached anymore",
+		      mutest_pointer(cached),
+		      mutest_to_be_null,
+		      NULL);
+}
+
+static void
+playlist_cache_suite(mutest_suite_t *suite G_GNUC_UNUSED)
+{
+	gchar *tmpdir;
+
+	/* The cache lives in the XDG cache directory */
+	tmpdir = tmp_dir_new();
+	g_assert_true(g_setenv("XDG_CACHE_HOME", tmpdir, TRUE));
+
+	mutest_it("stores and looks up playlists", playlist_cache_store_lookup);
+
+	tmp_dir_free(tmpdir);
+}
+
+MUTEST_MAIN(
+	log_init(NULL, TRUE, NULL);
+	g_setenv("GOODVIBES_IN_TEST_SUITE", "1", TRUE);
+	mutest_describe("playlist-cache", playlist_cache_suite);
+)
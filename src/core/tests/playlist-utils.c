@@ -18,6 +18,8 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <glib.h>
 #include <mutest.h>
 
@@ -139,6 +141,17 @@ playlist_utils_parse_pls(mutest_spec_t *spec G_GNUC_UNUSED)
 		NULL,
 	};
 	run_pls_test("wnyc-fm.pls", wnyc_fm);
+
+	/* Made up: entries out of order, one given twice, one beyond the
+	 * number of entries, and the number of entries comes last
+	 */
+	const gchar *out_of_order[] = {
+		"http://radio.example.com/stream1",
+		"http://radio.example.com/stream2",
+		"http://radio.example.com/stream3",
+		NULL,
+	};
+	run_pls_test("out-of-order.pls", out_of_order);
 }
 
 static void
@@ -228,6 +241,171 @@ playlist_utils_parse_xspf(mutest_spec_t *spec G_GNUC_UNUSED)
 	run_xspf_test("metalon.xspf", metalon);
 }
 
+/* Feed the playlist a few bytes at a time, as if it was downloaded over a
+ * slow connection, and check that we get the same streams as when parsing
+ * the whole thing. Returns how many bytes were fed before the first stream
+ * was found. */
+static gsize
+parse_playlist_incrementally(GvPlaylistParser parser, const gchar *filename,
+			     gboolean *same_streams)
+{
+	GvIncrementalParser *incremental;
+	GSList *expected, *streams, *a, *b;
+	GError *err = NULL;
+	gchar *contents = NULL;
+	gsize length = 0;
+	gsize fed = 0;
+	gsize found = 0;
+	gchar *fn;
+
+	fn = g_build_filename("playlists", filename, NULL);
+	g_file_get_contents(fn, &contents, &length, &err);
+	g_assert_no_error(err);
+	g_free(fn);
+
+	incremental = gv_incremental_parser_new(parser);
+	while (fed < length) {
+		gsize size = MIN(7, length - fed);
+
+		gv_incremental_parser_feed(incremental, contents + fed, size);
+		fed += size;
+		if (found == 0 && gv_incremental_parser_get_first_stream(incremental))
+			found = fed;
+	}
+	gv_incremental_parser_end(incremental);
+	if (found == 0 && gv_incremental_parser_get_first_stream(incremental))
+		found = fed;
+
+	expected = parser(contents, length);
+	streams = gv_incremental_parser_get_streams(incremental);
+	for (a = expected, b = streams; a && b; a = a->next, b = b->next)
+		if (g_strcmp0(a->data, b->data) != 0)
+			break;
+	*same_streams = a == NULL && b == NULL;
+
+	g_slist_free_full(streams, g_free);
+	g_slist_free_full(expected, g_free);
+	gv_incremental_parser_free(incremental);
+	g_free(contents);
+
+	return found;
+}
+
+static void
+playlist_utils_parse_incrementally(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	const struct {
+		GvPlaylistParser parser;
+		const gchar *filename;
+	} playlists[] = {
+		{ gv_parse_m3u_playlist,  "levillage-canalb.m3u" },
+		{ gv_parse_m3u_playlist,  "outpost-acoustic.m3u" },
+		{ gv_parse_m3u_playlist,  "somafm-reggae256.m3u" },
+		{ gv_parse_m3u_playlist,  "radiofabrik.m3u" },
+		{ gv_parse_m3u_playlist,  "nonstopplay-midband.ram" },
+		{ gv_parse_pls_playlist,  "gyusyabu.pls" },
+		{ gv_parse_pls_playlist,  "abc-adelaide.pls" },
+		{ gv_parse_pls_playlist,  "somafm-metal130.pls" },
+		{ gv_parse_pls_playlist,  "wnyc-fm.pls" },
+		{ gv_parse_pls_playlist,  "out-of-order.pls" },
+		{ gv_parse_asx_playlist,  "trancebase.asx" },
+		{ gv_parse_asx_playlist,  "nostalgia.asx" },
+		{ gv_parse_xspf_playlist, "metalon.xspf" },
+	};
+	gboolean same_streams;
+	gchar *contents = NULL;
+	gsize length = 0;
+	gsize found;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(playlists); i++) {
+		found = parse_playlist_incrementally(playlists[i].parser,
+				playlists[i].filename, &same_streams);
+		mutest_expect(playlists[i].filename,
+			      mutest_bool_value(same_streams),
+			      mutest_to_be_true,
+			      NULL);
+		mutest_expect("a stream is found",
+			      mutest_bool_value(found > 0),
+			      mutest_to_be_true,
+			      NULL);
+	}
+
+	/* With several streams, the first one comes way before the end */
+	found = parse_playlist_incrementally(gv_parse_pls_playlist,
+			"somafm-metal130.pls", &same_streams);
+	mutest_expect("first stream is found early",
+		      mutest_bool_value(found > 0 && found < 100),
+		      mutest_to_be_true,
+		      NULL);
+
+	/* Out of order, the streams are sorted out at the end */
+	g_file_get_contents("playlists/out-of-order.pls", &contents, &length, NULL);
+	g_free(contents);
+	found = parse_playlist_incrementally(gv_parse_pls_playlist,
+			"out-of-order.pls", &same_streams);
+	mutest_expect("out of order streams wait for the end",
+		      mutest_bool_value(found == length),
+		      mutest_to_be_true,
+		      NULL);
+}
+
+static gboolean
+sniff_playlist(const gchar *filename, GvPlaylistParser expected)
+{
+	GvPlaylistParser parser;
+	GError *err = NULL;
+	gchar *contents = NULL;
+	gsize length = 0;
+	gchar *fn;
+
+	fn = g_build_filename("playlists", filename, NULL);
+	g_file_get_contents(fn, &contents, &length, &err);
+	g_assert_no_error(err);
+	g_free(fn);
+
+	parser = gv_sniff_playlist_parser(contents, length);
+	g_free(contents);
+
+	return parser == expected;
+}
+
+static void
+playlist_utils_sniff(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	const gchar *hls = "#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:10\n";
+	const gchar *mp3 = "ID3\x04\x00\x00\x00\x00\x00\x00";
+
+	mutest_expect("M3U playlist is detected",
+		      mutest_bool_value(sniff_playlist("somafm-reggae256.m3u", gv_parse_m3u_playlist)),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("M3U playlist without header is detected",
+		      mutest_bool_value(sniff_playlist("nonstopplay-midband.ram", gv_parse_m3u_playlist)),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("PLS playlist is detected",
+		      mutest_bool_value(sniff_playlist("wnyc-fm.pls", gv_parse_pls_playlist)),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("ASX playlist is detected",
+		      mutest_bool_value(sniff_playlist("nostalgia.asx", gv_parse_asx_playlist)),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("XSPF playlist is detected",
+		      mutest_bool_value(sniff_playlist("metalon.xspf", gv_parse_xspf_playlist)),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("HLS playlist is not ours",
+		      mutest_pointer((void *) gv_sniff_playlist_parser(hls, strlen(hls))),
+		      mutest_to_be_null,
+		      NULL);
+	mutest_expect("audio is not a playlist",
+		      mutest_pointer((void *) gv_sniff_playlist_parser(mp3, 10)),
+		      mutest_to_be_null,
+		      NULL);
+}
+
 static void
 playlist_utils_suite(mutest_suite_t *suite G_GNUC_UNUSED)
 {
@@ -235,6 +413,8 @@ playlist_utils_suite(mutest_suite_t *suite G_GNUC_UNUSED)
 	mutest_it("parse PLS playlists", playlist_utils_parse_pls);
 	mutest_it("parse ASX playlists", playlist_utils_parse_asx);
 	mutest_it("parse XSPF playlists", playlist_utils_parse_xspf);
+	mutest_it("parse playlists incrementally", playlist_utils_parse_incrementally);
+	mutest_it("sniff playlist formats", playlist_utils_sniff);
 }
 
 MUTEST_MAIN(
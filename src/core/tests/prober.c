@@ -0,0 +1,364 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <libsoup/soup.h>
+#include <mutest.h>
+
+#include "base/log.h"
+#include "core/gv-core.h"
+#include "core/gv-engine.h"
+#include "core/gv-playback.h"
+#include "core/gv-player.h"
+#include "core/gv-prober.h"
+#include "core/gv-station-list.h"
+#include "core/gv-station.h"
+#include "core/tests/tmp-utils.h"
+
+#define LIVE_URI  "http://example.com/live.mp3"
+#define DEAD_URI  "http://example.com/dead.mp3"
+#define STALE_URI "http://example.com/stale.mp3"
+
+static void
+write_results(const gchar *filename)
+{
+	GKeyFile *keyfile;
+	gint64 now;
+
+	now = g_get_real_time();
+	keyfile = g_key_file_new();
+
+	g_key_file_set_string(keyfile, "Probe 0", "Uri", LIVE_URI);
+	g_key_file_set_int64(keyfile, "Probe 0", "Timestamp", now);
+	g_key_file_set_boolean(keyfile, "Probe 0", "Reachable", TRUE);
+	g_key_file_set_integer(keyfile, "Probe 0", "Latency", 120);
+	g_key_file_set_string(keyfile, "Probe 0", "Codec", "MP3");
+	g_key_file_set_integer(keyfile, "Probe 0", "Bitrate", 128);
+
+	g_key_file_set_string(keyfile, "Probe 1", "Uri", DEAD_URI);
+	g_key_file_set_int64(keyfile, "Probe 1", "Timestamp", now);
+	g_key_file_set_boolean(keyfile, "Probe 1", "Reachable", FALSE);
+	g_key_file_set_string(keyfile, "Probe 1", "Error", "HTTP status 404");
+
+	/* Dead a few hours ago, it had time to come back since */
+	g_key_file_set_string(keyfile, "Probe 2", "Uri", STALE_URI);
+	g_key_file_set_int64(keyfile, "Probe 2", "Timestamp", now - 3 * 3600 * G_USEC_PER_SEC);
+	g_key_file_set_boolean(keyfile, "Probe 2", "Reachable", FALSE);
+
+	g_assert_true(g_key_file_save_to_file(keyfile, filename, NULL));
+	g_key_file_unref(keyfile);
+}
+
+static void
+prober_load_results(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvStationList *sl;
+	GvStation *live, *dead, *stale, *unknown;
+	GvProbeResult *res;
+	GvProber *p;
+	gchar *filename;
+
+	filename = tmp_file_new("probes");
+	write_results(filename);
+
+	sl = gv_station_list_new_from_paths("/dev/null", "/dev/null");
+	gv_station_list_load(sl);
+	live = gv_station_new("Live", LIVE_URI);
+	dead = gv_station_new("Dead", DEAD_URI);
+	stale = gv_station_new("Stale", STALE_URI);
+	unknown = gv_station_new("Unknown", "http://example.com/unknown.mp3");
+	gv_station_list_append(sl, live);
+	gv_station_list_append(sl, dead);
+	gv_station_list_append(sl, stale);
+	gv_station_list_append(sl, unknown);
+
+	p = gv_prober_new(sl, filename);
+
+	res = gv_prober_lookup(p, LIVE_URI);
+	mutest_expect("live station was loaded",
+		      mutest_pointer(res),
+		      mutest_not, mutest_to_be_null,
+		      NULL);
+	mutest_expect("live station is reachable",
+		      mutest_bool_value(res->reachable),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("codec was loaded",
+		      mutest_string_value(res->codec),
+		      mutest_to_be, "MP3",
+		      NULL);
+	mutest_expect("bitrate was loaded",
+		      mutest_int_value(res->bitrate),
+		      mutest_to_be, 128,
+		      NULL);
+
+	res = gv_prober_lookup(p, DEAD_URI);
+	mutest_expect("error was loaded",
+		      mutest_string_value(res->error),
+		      mutest_to_be, "HTTP status 404",
+		      NULL);
+
+	mutest_expect("live station is not dead",
+		      mutest_bool_value(gv_prober_is_dead(p, live)),
+		      mutest_to_be_false,
+		      NULL);
+	mutest_expect("dead station is dead",
+		      mutest_bool_value(gv_prober_is_dead(p, dead)),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("stale result doesn't count",
+		      mutest_bool_value(gv_prober_is_dead(p, stale)),
+		      mutest_to_be_false,
+		      NULL);
+	mutest_expect("unknown station is not dead",
+		      mutest_bool_value(gv_prober_is_dead(p, unknown)),
+		      mutest_to_be_false,
+		      NULL);
+	mutest_expect("nothing runs until asked",
+		      mutest_bool_value(gv_prober_get_running(p)),
+		      mutest_to_be_false,
+		      NULL);
+
+	g_object_unref(p);
+	g_object_unref(sl);
+
+	tmp_file_free(filename);
+}
+
+static void
+prober_skip_dead(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvStationList *sl;
+	GvStation *live, *dead, *stale;
+	GvEngine *engine;
+	GvPlayback *playback;
+	GvPlayer *player;
+	gchar *filename;
+
+	filename = tmp_file_new("probes");
+	write_results(filename);
+
+	sl = gv_station_list_new_from_paths("/dev/null", "/dev/null");
+	gv_station_list_load(sl);
+	live = gv_station_new("Live", LIVE_URI);
+	dead = gv_station_new("Dead", DEAD_URI);
+	stale = gv_station_new("Stale", STALE_URI);
+	gv_station_list_append(sl, live);
+	gv_station_list_append(sl, dead);
+	gv_station_list_append(sl, stale);
+
+	engine = gv_engine_new_headless();
+	playback = gv_playback_new(engine);
+	player = gv_player_new(engine, playback, sl);
+	gv_player_set_station(player, live);
+
+	mutest_expect("without a prober, next station is the dead one",
+		      mutest_bool_value(gv_player_get_next_station(player) == dead),
+		      mutest_to_be_true,
+		      NULL);
+
+	gv_core_prober = gv_prober_new(sl, filename);
+
+	mutest_expect("next station skips the dead one",
+		      mutest_bool_value(gv_player_get_next_station(player) == stale),
+		      mutest_to_be_true,
+		      NULL);
+
+	gv_player_set_station(player, stale);
+	mutest_expect("prev station skips the dead one",
+		      mutest_bool_value(gv_player_get_prev_station(player) == live),
+		      mutest_to_be_true,
+		      NULL);
+
+	g_clear_object(&gv_core_prober);
+	g_object_unref(player);
+	g_object_unref(playback);
+	g_object_unref(engine);
+	g_object_unref(sl);
+
+	tmp_file_free(filename);
+}
+
+/*
+ * A local server that holds every request for a little while, so that
+ * probes overlap, and counts how many are in flight at once.
+ */
+
+#define N_STATIONS 9
+#define MAX_PROBES 3
+
+typedef struct {
+	guint in_flight;
+	guint max_in_flight;
+} ServerStats;
+
+static void
+on_server_message_finished(SoupServerMessage *msg G_GNUC_UNUSED, ServerStats *stats)
+{
+	stats->in_flight--;
+}
+
+static gboolean
+when_server_reply(SoupServerMessage *msg)
+{
+	static const gchar body[] = "ID3 not really an mp3";
+	SoupServer *server;
+
+	server = g_object_get_data(G_OBJECT(msg), "server");
+	soup_server_message_set_status(msg, SOUP_STATUS_OK, NULL);
+	soup_server_message_set_response(msg, "audio/mpeg", SOUP_MEMORY_STATIC,
+					 body, sizeof body - 1);
+#if SOUP_CHECK_VERSION(3, 2, 0)
+	(void) server;
+	soup_server_message_unpause(msg);
+#else
+	soup_server_unpause_message(server, msg);
+#endif
+	g_object_unref(msg);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+server_callback(SoupServer *server, SoupServerMessage *msg,
+		const char *path G_GNUC_UNUSED, GHashTable *query G_GNUC_UNUSED,
+		gpointer user_data)
+{
+	ServerStats *stats = user_data;
+
+	stats->in_flight++;
+	stats->max_in_flight = MAX(stats->max_in_flight, stats->in_flight);
+	g_signal_connect(msg, "finished", G_CALLBACK(on_server_message_finished), stats);
+
+	g_object_set_data(G_OBJECT(msg), "server", server);
+#if SOUP_CHECK_VERSION(3, 2, 0)
+	soup_server_message_pause(msg);
+#else
+	soup_server_pause_message(server, msg);
+#endif
+	g_timeout_add(50, (GSourceFunc) when_server_reply, g_object_ref(msg));
+}
+
+static void
+on_prober_finished(GvProber *prober G_GNUC_UNUSED, gboolean *finished)
+{
+	*finished = TRUE;
+}
+
+static gboolean
+when_timeout(gboolean *timed_out)
+{
+	*timed_out = TRUE;
+	return G_SOURCE_REMOVE;
+}
+
+static void
+prober_max_probes(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	ServerStats stats = { 0 };
+	SoupServer *server;
+	GSList *uris;
+	GvStationList *sl;
+	GvProber *p;
+	GvProbeResult *res;
+	gboolean finished = FALSE;
+	gboolean timed_out = FALSE;
+	gchar *base_uri;
+	gchar *first_uri = NULL;
+	gchar *filename;
+	guint timeout_id;
+	guint i;
+
+	server = soup_server_new(NULL, NULL);
+	soup_server_add_handler(server, NULL, server_callback, &stats, NULL);
+	g_assert_true(soup_server_listen_local(server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, NULL));
+	uris = soup_server_get_uris(server);
+	base_uri = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify) g_uri_unref);
+
+	filename = tmp_file_new("probes");
+
+	sl = gv_station_list_new_from_paths("/dev/null", "/dev/null");
+	gv_station_list_load(sl);
+	for (i = 0; i < N_STATIONS; i++) {
+		gchar *uri = g_strdup_printf("%s/%u.mp3", base_uri, i);
+		gv_station_list_append(sl, gv_station_new(NULL, uri));
+		if (first_uri == NULL)
+			first_uri = uri;
+		else
+			g_free(uri);
+	}
+
+	p = gv_prober_new(sl, filename);
+	gv_prober_set_max_probes(p, MAX_PROBES);
+	g_signal_connect(p, "finished", G_CALLBACK(on_prober_finished), &finished);
+	timeout_id = g_timeout_add_seconds(10, (GSourceFunc) when_timeout, &timed_out);
+
+	gv_prober_start(p);
+	while (finished == FALSE && timed_out == FALSE)
+		g_main_context_iteration(NULL, TRUE);
+
+	mutest_expect("probes finished in time",
+		      mutest_bool_value(timed_out),
+		      mutest_to_be_false,
+		      NULL);
+	mutest_expect("never more probes than allowed",
+		      mutest_bool_value(stats.max_in_flight <= MAX_PROBES),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("probes ran concurrently",
+		      mutest_int_value(stats.max_in_flight),
+		      mutest_to_be, MAX_PROBES,
+		      NULL);
+
+	res = gv_prober_lookup(p, first_uri);
+	mutest_expect("station was probed reachable",
+		      mutest_bool_value(res != NULL && res->reachable),
+		      mutest_to_be_true,
+		      NULL);
+
+	if (timed_out == FALSE)
+		g_source_remove(timeout_id);
+	g_object_unref(p);
+	g_object_unref(sl);
+	g_object_unref(server);
+
+	tmp_file_free(filename);
+	g_free(first_uri);
+	g_free(base_uri);
+}
+
+static void
+prober_suite(mutest_suite_t *suite G_GNUC_UNUSED)
+{
+	mutest_it("loads results and tells dead stations", prober_load_results);
+	mutest_it("lets the player skip dead stations", prober_skip_dead);
+	mutest_it("never runs more than max-probes at once", prober_max_probes);
+}
+
+MUTEST_MAIN(
+	gst_init(NULL, NULL);
+	log_init(NULL, TRUE, NULL);
+	g_setenv("GOODVIBES_IN_TEST_SUITE", "1", TRUE);
+	/* The prober doesn't start while the network is unavailable */
+	g_setenv("GIO_USE_NETWORK_MONITOR", "base", TRUE);
+	mutest_describe("gv-prober", prober_suite);
+)
@@ -0,0 +1,148 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2020-2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+#include <mutest.h>
+
+#include "base/log.h"
+#include "core/gv-recorder.h"
+
+static GstBuffer *
+make_buffer(const gchar *data)
+{
+	return gst_buffer_new_memdup(data, strlen(data));
+}
+
+static GPtrArray *
+list_files(const gchar *dirname)
+{
+	GPtrArray *files;
+	const gchar *name;
+	GDir *dir;
+
+	files = g_ptr_array_new_with_free_func(g_free);
+	dir = g_dir_open(dirname, 0, NULL);
+	while ((name = g_dir_read_name(dir)) != NULL)
+		g_ptr_array_add(files, g_build_filename(dirname, name, NULL));
+	g_dir_close(dir);
+
+	return files;
+}
+
+static void
+remove_dir(const gchar *dirname)
+{
+	GPtrArray *files;
+	guint i;
+
+	files = list_files(dirname);
+	for (i = 0; i < files->len; i++)
+		g_unlink(files->pdata[i]);
+	g_ptr_array_unref(files);
+	g_rmdir(dirname);
+}
+
+static void
+recorder_split(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvRecorder *r;
+	GstBuffer *b;
+	GPtrArray *files;
+	gchar *dirname;
+	gchar *contents;
+	guint i, n_found = 0;
+
+	dirname = g_dir_make_tmp("goodvibes-XXXXXX", NULL);
+	r = gv_recorder_new(dirname);
+
+	/* Nothing is written before the first split */
+	b = make_buffer("dropped");
+	gv_recorder_write(r, b);
+	gst_buffer_unref(b);
+
+	gv_recorder_split(r, "Artist - Title");
+	b = make_buffer("ID3 first");
+	gv_recorder_write(r, b);
+	gst_buffer_unref(b);
+
+	gv_recorder_split(r, "Artist - Other/Title");
+	b = make_buffer("second");
+	gv_recorder_write(r, b);
+	gst_buffer_unref(b);
+
+	/* Wait for the writer thread to be done */
+	g_object_unref(r);
+
+	files = list_files(dirname);
+	mutest_expect("there's one file per split",
+		      mutest_int_value(files->len),
+		      mutest_to_be, 2,
+		      NULL);
+
+	for (i = 0; i < files->len; i++) {
+		const gchar *path = files->pdata[i];
+
+		mutest_expect("extension is guessed from the first file",
+			      mutest_bool_value(g_str_has_suffix(path, ".mp3")),
+			      mutest_to_be_true,
+			      NULL);
+
+		g_file_get_contents(path, &contents, NULL, NULL);
+		if (g_str_has_suffix(path, "Artist - Title.mp3")) {
+			mutest_expect("first file has the data of the first title",
+				      mutest_string_value(contents),
+				      mutest_to_be, "ID3 first",
+				      NULL);
+			n_found++;
+		} else if (g_str_has_suffix(path, "Artist - Other_Title.mp3")) {
+			mutest_expect("second file has the data of the second title",
+				      mutest_string_value(contents),
+				      mutest_to_be, "second",
+				      NULL);
+			n_found++;
+		}
+		g_free(contents);
+	}
+
+	mutest_expect("files are named after the titles",
+		      mutest_int_value(n_found),
+		      mutest_to_be, 2,
+		      NULL);
+
+	g_ptr_array_unref(files);
+	remove_dir(dirname);
+	g_free(dirname);
+}
+
+static void
+recorder_suite(mutest_suite_t *suite G_GNUC_UNUSED)
+{
+	mutest_it("starts a new file on each split", recorder_split);
+}
+
+MUTEST_MAIN(
+	gst_init(NULL, NULL);
+	log_init(NULL, TRUE, NULL);
+	g_setenv("GOODVIBES_IN_TEST_SUITE", "1", TRUE);
+	mutest_describe("gv-recorder", recorder_suite);
+)
@@ -0,0 +1,90 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <mutest.h>
+
+#include "base/log.h"
+#include "core/gv-redirect-cache.h"
+#include "core/tests/tmp-utils.h"
+
+#define STREAM_URI "http://example.com/radio"
+#define TARGET_URI "https://lb3.example.com/radio.mp3"
+
+static void
+redirect_cache_learn_forget(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvRedirectCache *c;
+	gchar *filename;
+
+	filename = tmp_file_new("redirects");
+
+	/* Nothing known at first */
+	c = gv_redirect_cache_new(filename);
+	mutest_expect("unknown uri is a miss",
+		      mutest_pointer((void *) gv_redirect_cache_lookup(c, STREAM_URI)),
+		      mutest_to_be_null,
+		      NULL);
+
+	/* Learn a redirect, then look it up */
+	gv_redirect_cache_learn(c, STREAM_URI, TARGET_URI);
+	mutest_expect("learned uri is a hit",
+		      mutest_string_value(gv_redirect_cache_lookup(c, STREAM_URI)),
+		      mutest_to_be, TARGET_URI,
+		      NULL);
+	mutest_expect("one hit was counted",
+		      mutest_int_value(gv_redirect_cache_get_n_hits(c)),
+		      mutest_to_be, 1,
+		      NULL);
+	mutest_expect("one miss was counted",
+		      mutest_int_value(gv_redirect_cache_get_n_misses(c)),
+		      mutest_to_be, 1,
+		      NULL);
+	g_object_unref(c);
+
+	/* It survives a restart */
+	c = gv_redirect_cache_new(filename);
+	mutest_expect("redirect was saved",
+		      mutest_string_value(gv_redirect_cache_lookup(c, STREAM_URI)),
+		      mutest_to_be, TARGET_URI,
+		      NULL);
+
+	/* And it goes away when forgotten */
+	gv_redirect_cache_forget(c, STREAM_URI);
+	mutest_expect("forgotten uri is a miss",
+		      mutest_pointer((void *) gv_redirect_cache_lookup(c, STREAM_URI)),
+		      mutest_to_be_null,
+		      NULL);
+	g_object_unref(c);
+
+	tmp_file_free(filename);
+}
+
+static void
+redirect_cache_suite(mutest_suite_t *suite G_GNUC_UNUSED)
+{
+	mutest_it("learns and forgets redirects", redirect_cache_learn_forget);
+}
+
+MUTEST_MAIN(
+	log_init(NULL, TRUE, NULL);
+	g_setenv("GOODVIBES_IN_TEST_SUITE", "1", TRUE);
+	mutest_describe("gv-redirect-cache", redirect_cache_suite);
+)
@@ -0,0 +1,153 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <glib.h>
+#include <gst/gst.h>
+#include <mutest.h>
+
+#include "base/log.h"
+#include "core/gv-engine.h"
+#include "core/retry-utils.h"
+
+#define MAX_ATTEMPT 24
+#define N_DRAWS     50
+
+static void
+retry_find_policy(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	struct {
+		GQuark domain;
+		gint code;
+		const gchar *policy;
+	} tests[] = {
+		{ GV_ENGINE_ERROR,     GV_ENGINE_ERROR_STALLED,           "stall" },
+		{ GST_RESOURCE_ERROR,  GST_RESOURCE_ERROR_NOT_FOUND,      "not-found" },
+		{ GST_RESOURCE_ERROR,  GST_RESOURCE_ERROR_NOT_AUTHORIZED, "not-authorized" },
+		{ GST_RESOURCE_ERROR,  GST_RESOURCE_ERROR_OPEN_READ,      "network" },
+		{ GST_RESOURCE_ERROR,  GST_RESOURCE_ERROR_READ,           "network" },
+		{ GST_STREAM_ERROR,    GST_STREAM_ERROR_DECODE,           "stream" },
+		{ GST_STREAM_ERROR,    GST_STREAM_ERROR_TYPE_NOT_FOUND,   "stream" },
+		{ GST_CORE_ERROR,      GST_CORE_ERROR_FAILED,             "default" },
+		{ G_IO_ERROR,          G_IO_ERROR_NOT_FOUND,              "default" },
+	};
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(tests); i++) {
+		const GvRetryPolicy *policy;
+		GError *err;
+
+		err = g_error_new_literal(tests[i].domain, tests[i].code, "error");
+		policy = gv_find_retry_policy(err);
+		mutest_expect(tests[i].policy,
+			      mutest_string_value(policy->name),
+			      mutest_to_be, tests[i].policy,
+			      NULL);
+		g_error_free(err);
+	}
+
+	mutest_expect("no error gets the default policy",
+		      mutest_string_value(gv_find_retry_policy(NULL)->name),
+		      mutest_to_be, "default",
+		      NULL);
+	mutest_expect("end of stream has a policy of its own",
+		      mutest_string_value(gv_get_eos_retry_policy()->name),
+		      mutest_to_be, "end-of-stream",
+		      NULL);
+}
+
+static gboolean
+check_delays(const GvRetryPolicy *policy)
+{
+	guint attempt, i;
+
+	for (attempt = 1; attempt <= MAX_ATTEMPT; attempt++) {
+		guint64 max;
+
+		/* Immediate attempts first, then the delay doubles, up to the
+		 * max delay, and half of it is jitter */
+		if (attempt <= policy->immediate)
+			max = 0;
+		else
+			max = MIN((guint64) policy->base_delay <<
+				  MIN(attempt - policy->immediate - 1, 16),
+				  policy->max_delay);
+
+		for (i = 0; i < N_DRAWS; i++) {
+			guint delay = gv_get_retry_delay(policy, attempt);
+
+			if (delay < max / 2 || delay > max)
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static void
+retry_delay_bounds(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GError *err;
+
+	err = g_error_new_literal(GV_ENGINE_ERROR, GV_ENGINE_ERROR_STALLED, "stalled");
+	mutest_expect("stall delays are within bounds",
+		      mutest_bool_value(check_delays(gv_find_retry_policy(err))),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("first stall retries are immediate",
+		      mutest_int_value(gv_get_retry_delay(gv_find_retry_policy(err), 2)),
+		      mutest_to_be, 0,
+		      NULL);
+	g_error_free(err);
+
+	err = g_error_new_literal(GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_NOT_FOUND, "404");
+	mutest_expect("not-found delays are within bounds",
+		      mutest_bool_value(check_delays(gv_find_retry_policy(err))),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("delays never go past the max delay",
+		      mutest_bool_value(gv_get_retry_delay(gv_find_retry_policy(err), 1000) <=
+					gv_find_retry_policy(err)->max_delay),
+		      mutest_to_be_true,
+		      NULL);
+	g_error_free(err);
+
+	mutest_expect("default delays are within bounds",
+		      mutest_bool_value(check_delays(gv_find_retry_policy(NULL))),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("end-of-stream delays are within bounds",
+		      mutest_bool_value(check_delays(gv_get_eos_retry_policy())),
+		      mutest_to_be_true,
+		      NULL);
+}
+
+static void
+retry_suite(mutest_suite_t *suite G_GNUC_UNUSED)
+{
+	mutest_it("matches errors to policies", retry_find_policy);
+	mutest_it("keeps delays within bounds", retry_delay_bounds);
+}
+
+MUTEST_MAIN(
+	log_init(NULL, TRUE, NULL);
+	g_setenv("GOODVIBES_IN_TEST_SUITE", "1", TRUE);
+	mutest_describe("retry-utils", retry_suite);
+)
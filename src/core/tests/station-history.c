@@ -0,0 +1,154 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <mutest.h>
+
+#include "base/log.h"
+#include "core/gv-station-history.h"
+#include "core/tests/tmp-utils.h"
+
+#define PLAYLIST_URI "http://example.com/radio.m3u"
+#define FAST_URI     "http://fast.example.com/radio"
+#define SLOW_URI     "http://slow.example.com/radio"
+#define BROKEN_URI   "http://broken.example.com/radio"
+#define NEW_URI      "http://new.example.com/radio"
+
+static GSList *
+make_uris(void)
+{
+	GSList *uris = NULL;
+
+	uris = g_slist_append(uris, g_strdup(BROKEN_URI));
+	uris = g_slist_append(uris, g_strdup(NEW_URI));
+	uris = g_slist_append(uris, g_strdup(SLOW_URI));
+	uris = g_slist_append(uris, g_strdup(FAST_URI));
+
+	return uris;
+}
+
+static void
+expect_order(GvStationHistory *h, const gchar *what)
+{
+	GSList *uris;
+
+	uris = gv_station_history_order(h, make_uris());
+
+	mutest_expect(what,
+		      mutest_int_value(g_slist_length(uris)),
+		      mutest_to_be, 3,
+		      NULL);
+	mutest_expect("fast stream comes first",
+		      mutest_string_value(g_slist_nth_data(uris, 0)),
+		      mutest_to_be, FAST_URI,
+		      NULL);
+	mutest_expect("slow stream comes next",
+		      mutest_string_value(g_slist_nth_data(uris, 1)),
+		      mutest_to_be, SLOW_URI,
+		      NULL);
+	mutest_expect("unknown stream comes last",
+		      mutest_string_value(g_slist_nth_data(uris, 2)),
+		      mutest_to_be, NEW_URI,
+		      NULL);
+
+	g_slist_free_full(uris, g_free);
+}
+
+static void
+station_history_order(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvStationHistory *h;
+	GSList *uris;
+	gchar *filename;
+	guint i;
+
+	filename = tmp_file_new("history");
+
+	/* Nothing known at first, the order is kept */
+	h = gv_station_history_new(filename);
+	uris = gv_station_history_order(h, make_uris());
+	mutest_expect("order is kept when nothing is known",
+		      mutest_string_value(uris->data),
+		      mutest_to_be, BROKEN_URI,
+		      NULL);
+	g_slist_free_full(uris, g_free);
+
+	/* Learn how the streams behave */
+	gv_station_history_record_success(h, SLOW_URI, 800, 2500);
+	gv_station_history_record_success(h, FAST_URI, 100, 300);
+	gv_station_history_record_success(h, FAST_URI, 150, 400);
+	for (i = 0; i < 3; i++)
+		gv_station_history_record_failure(h, BROKEN_URI);
+	gv_station_history_set_stream(h, PLAYLIST_URI, FAST_URI);
+
+	mutest_expect("broken stream is failing",
+		      mutest_bool_value(gv_station_history_is_failing(h, BROKEN_URI)),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("slow stream is not failing",
+		      mutest_bool_value(gv_station_history_is_failing(h, SLOW_URI)),
+		      mutest_to_be_false,
+		      NULL);
+	expect_order(h, "failing stream is left aside");
+	g_object_unref(h);
+
+	/* It survives a restart */
+	h = gv_station_history_new(filename);
+	expect_order(h, "history was saved");
+	mutest_expect("stream that worked was saved",
+		      mutest_string_value(gv_station_history_get_stream(h, PLAYLIST_URI)),
+		      mutest_to_be, FAST_URI,
+		      NULL);
+
+	/* Streams are given another chance once they work again */
+	gv_station_history_record_success(h, BROKEN_URI, 200, 600);
+	mutest_expect("broken stream is not failing anymore",
+		      mutest_bool_value(gv_station_history_is_failing(h, BROKEN_URI)),
+		      mutest_to_be_false,
+		      NULL);
+
+	/* A single failure doesn't rule a stream out, it only demotes it */
+	gv_station_history_record_failure(h, FAST_URI);
+	uris = gv_station_history_order(h, make_uris());
+	mutest_expect("all streams are kept",
+		      mutest_int_value(g_slist_length(uris)),
+		      mutest_to_be, 4,
+		      NULL);
+	mutest_expect("fast stream that failed is demoted",
+		      mutest_string_value(uris->data),
+		      mutest_to_be, BROKEN_URI,
+		      NULL);
+	g_slist_free_full(uris, g_free);
+	g_object_unref(h);
+
+	tmp_file_free(filename);
+}
+
+static void
+station_history_suite(mutest_suite_t *suite G_GNUC_UNUSED)
+{
+	mutest_it("orders streams by past performance", station_history_order);
+}
+
+MUTEST_MAIN(
+	log_init(NULL, TRUE, NULL);
+	g_setenv("GOODVIBES_IN_TEST_SUITE", "1", TRUE);
+	mutest_describe("gv-station-history", station_history_suite);
+)
@@ -0,0 +1,223 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measure how the station list scales, from a hundred stations up to the
+ * size of a directory import. For each size, the list is filled, then we
+ * report the average cost of an append, of the lookups by uid, name and
+ * uri, of the positional access, and of a move. All of these should stay
+ * flat as the list grows, except for the move which is linear:
+ *
+ *   meson test --benchmark -C build
+ *
+ * GOODVIBES_BENCH_STATIONS (the largest list) and GOODVIBES_BENCH_LOOKUPS
+ * can be used to tune the run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include "core/gv-station-list.h"
+#include "core/gv-station.h"
+
+#define DEFAULT_STATIONS 1000000
+#define DEFAULT_LOOKUPS  100000
+#define MIN_STATIONS     100
+#define MAX_MOVES        1000
+
+/*
+ * Benchmark
+ */
+
+typedef enum {
+	LOOKUP_UID,
+	LOOKUP_NAME,
+	LOOKUP_URI,
+	LOOKUP_AT,
+} LookupKind;
+
+static gdouble
+elapsed_ns(gint64 start, guint n_ops)
+{
+	return (gdouble) (g_get_monotonic_time() - start) * 1000 / MAX(n_ops, 1);
+}
+
+static gdouble
+run_lookups(GvStationList *list, GPtrArray *stations, LookupKind kind,
+	    guint n_lookups, gboolean *failed)
+{
+	GRand *rand;
+	gint64 start;
+	guint i;
+
+	/* Same seed for every kind of lookup, so that they're comparable */
+	rand = g_rand_new_with_seed(42);
+	start = g_get_monotonic_time();
+
+	for (i = 0; i < n_lookups; i++) {
+		guint n = g_rand_int_range(rand, 0, stations->len);
+		GvStation *expected = g_ptr_array_index(stations, n);
+		GvStation *found = NULL;
+
+		switch (kind) {
+		case LOOKUP_UID:
+			found = gv_station_list_find_by_uid(list, gv_station_get_uid(expected));
+			break;
+		case LOOKUP_NAME:
+			found = gv_station_list_find_by_name(list, gv_station_get_name(expected));
+			break;
+		case LOOKUP_URI:
+			found = gv_station_list_find_by_uri(list, gv_station_get_uri(expected));
+			break;
+		case LOOKUP_AT:
+			found = gv_station_list_at(list, n);
+			break;
+		}
+
+		if (found != expected)
+			*failed = TRUE;
+	}
+
+	g_rand_free(rand);
+
+	return elapsed_ns(start, n_lookups);
+}
+
+static gdouble
+run_moves(GvStationList *list, GPtrArray *stations, guint n_moves)
+{
+	GRand *rand;
+	gint64 start;
+	guint i;
+
+	rand = g_rand_new_with_seed(42);
+	start = g_get_monotonic_time();
+
+	for (i = 0; i < n_moves; i++) {
+		GvStation *station;
+		gint pos;
+
+		station = g_ptr_array_index(stations, g_rand_int_range(rand, 0, stations->len));
+		pos = g_rand_int_range(rand, 0, stations->len);
+		gv_station_list_move(list, station, pos);
+	}
+
+	g_rand_free(rand);
+
+	return elapsed_ns(start, n_moves);
+}
+
+static gboolean
+run_bench(guint n_stations, guint n_lookups)
+{
+	GvStationList *list;
+	GPtrArray *stations;
+	gdouble append_ns, uid_ns, name_ns, uri_ns, at_ns, move_ns;
+	gboolean failed = FALSE;
+	gint64 start;
+	guint n_moves;
+	guint i;
+
+	list = gv_station_list_new_from_paths("/dev/null", "/dev/null");
+	gv_station_list_load(list);
+
+	/* The list owns the stations, we just keep pointers around */
+	stations = g_ptr_array_sized_new(n_stations);
+	for (i = 0; i < n_stations; i++) {
+		GvStation *station;
+		gchar *name, *uri;
+
+		name = g_strdup_printf("Station %u", i);
+		uri = g_strdup_printf("http://stream%u.example.com:8000/live", i);
+		station = gv_station_new(name, uri);
+		g_ptr_array_add(stations, station);
+		g_free(name);
+		g_free(uri);
+	}
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < n_stations; i++)
+		gv_station_list_append(list, g_ptr_array_index(stations, i));
+	append_ns = elapsed_ns(start, n_stations);
+
+	if (gv_station_list_length(list) != n_stations)
+		failed = TRUE;
+
+	uid_ns = run_lookups(list, stations, LOOKUP_UID, n_lookups, &failed);
+	name_ns = run_lookups(list, stations, LOOKUP_NAME, n_lookups, &failed);
+	uri_ns = run_lookups(list, stations, LOOKUP_URI, n_lookups, &failed);
+	at_ns = run_lookups(list, stations, LOOKUP_AT, n_lookups, &failed);
+
+	n_moves = MIN(n_stations, MAX_MOVES);
+	move_ns = run_moves(list, stations, n_moves);
+
+	g_print("%8u stations: append %7.0f, uid %5.0f, name %5.0f, uri %5.0f, "
+		"at %5.0f, move %9.0f ns/op\n",
+		n_stations, append_ns, uid_ns, name_ns, uri_ns, at_ns, move_ns);
+
+	g_ptr_array_unref(stations);
+	g_object_unref(list);
+
+	return !failed;
+}
+
+static guint
+getenv_uint(const gchar *name, guint default_value)
+{
+	const gchar *str = g_getenv(name);
+	guint64 value;
+
+	if (str == NULL)
+		return default_value;
+
+	if (!g_ascii_string_to_unsigned(str, 10, 1, G_MAXUINT, &value, NULL)) {
+		g_printerr("Invalid value for %s: '%s'\n", name, str);
+		exit(EXIT_FAILURE);
+	}
+
+	return value;
+}
+
+int
+main(int argc G_GNUC_UNUSED, char *argv[] G_GNUC_UNUSED)
+{
+	guint max_stations, n_lookups, n_stations;
+	gboolean failed = FALSE;
+
+	max_stations = getenv_uint("GOODVIBES_BENCH_STATIONS", DEFAULT_STATIONS);
+	n_lookups = getenv_uint("GOODVIBES_BENCH_LOOKUPS", DEFAULT_LOOKUPS);
+
+	g_print("%u lookups per size\n", n_lookups);
+
+	for (n_stations = MIN_STATIONS; n_stations <= max_stations; n_stations *= 10) {
+		if (run_bench(n_stations, n_lookups) == FALSE) {
+			g_printerr("%u stations: lookups returned the wrong station\n",
+				   n_stations);
+			failed = TRUE;
+		}
+
+		if (n_stations > G_MAXUINT / 10)
+			break;
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -583,6 +583,103 @@ station_list_add_move_remove(mutest_spec_t *spec G_GNUC_UNUSED)
 		      NULL);
 }
 
+static void
+station_list_find(mutest_spec_t *spec G_GNUC_UNUSED)
+{
+	GvStationList *s;
+	GvStation *ss[3];
+	guint i;
+
+	s = gv_station_list_new_from_paths("/dev/null", "/dev/null");
+	g_object_add_weak_pointer(G_OBJECT(s), (gpointer *) &s);
+
+	ss[0] = gv_station_new("Foo", "http://foo.org");
+	ss[1] = gv_station_new("Bar", "http://bar.org");
+	ss[2] = gv_station_new("Baz", "http://baz.org");
+	for (i = 0; i < 3; i++) {
+		g_object_add_weak_pointer(G_OBJECT(ss[i]), (gpointer *) &ss[i]);
+		gv_station_list_append(s, ss[i]);
+	}
+
+	mutest_expect("find_by_name() finds foo",
+		      mutest_bool_value(gv_station_list_find_by_name(s, "Foo") == ss[0]),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("find_by_uri() finds bar",
+		      mutest_bool_value(gv_station_list_find_by_uri(s, "http://bar.org") == ss[1]),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("find_by_uid() finds baz",
+		      mutest_bool_value(gv_station_list_find_by_uid(s,
+				      gv_station_get_uid(ss[2])) == ss[2]),
+		      mutest_to_be_true,
+		      NULL);
+
+	/* Rename and change the uri of foo */
+	gv_station_set_name(ss[0], "Qux");
+	gv_station_set_uri(ss[0], "http://qux.org");
+	mutest_expect("find_by_name() does not find the old name",
+		      mutest_pointer(gv_station_list_find_by_name(s, "Foo")),
+		      mutest_to_be_null,
+		      NULL);
+	mutest_expect("find_by_uri() does not find the old uri",
+		      mutest_pointer(gv_station_list_find_by_uri(s, "http://foo.org")),
+		      mutest_to_be_null,
+		      NULL);
+	mutest_expect("find_by_name() finds the new name",
+		      mutest_bool_value(gv_station_list_find_by_name(s, "Qux") == ss[0]),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("find_by_uri() finds the new uri",
+		      mutest_bool_value(gv_station_list_find_by_uri(s, "http://qux.org") == ss[0]),
+		      mutest_to_be_true,
+		      NULL);
+
+	/* Give baz the same name as bar, then remove bar */
+	gv_station_set_name(ss[2], "Bar");
+	mutest_expect("find_by_name() finds the first station named bar",
+		      mutest_bool_value(gv_station_list_find_by_name(s, "Bar") == ss[1]),
+		      mutest_to_be_true,
+		      NULL);
+	gv_station_list_remove(s, ss[1]);
+	mutest_expect("find_by_name() finds the other station named bar",
+		      mutest_bool_value(gv_station_list_find_by_name(s, "Bar") == ss[2]),
+		      mutest_to_be_true,
+		      NULL);
+
+	/* Positions follow the moves */
+	gv_station_list_move_first(s, ss[2]);
+	mutest_expect("list is [2, 0]",
+		      mutest_pointer(s),
+		      match_station_list_against_array,
+		      mutest_pointer(make_station_array(ss, 2, 0, -1)),
+		      NULL);
+	mutest_expect("next() follows the move",
+		      mutest_bool_value(gv_station_list_next(s, ss[2], FALSE, FALSE) == ss[0]),
+		      mutest_to_be_true,
+		      NULL);
+	mutest_expect("prev() follows the move",
+		      mutest_pointer(gv_station_list_prev(s, ss[2], FALSE, FALSE)),
+		      mutest_to_be_null,
+		      NULL);
+
+	gv_station_list_empty(s);
+	mutest_expect("find_by_name() finds nothing after empty()",
+		      mutest_pointer(gv_station_list_find_by_name(s, "Bar")),
+		      mutest_to_be_null,
+		      NULL);
+
+	for (i = 0; i < 3; i++)
+		g_assert_null(ss[i]);
+
+	g_object_unref(s);
+
+	mutest_expect("finalize() was called",
+		      mutest_pointer(s),
+		      mutest_to_be_null,
+		      NULL);
+}
+
 static void
 station_list_suite(mutest_suite_t *suite G_GNUC_UNUSED)
 {
@@ -609,6 +706,7 @@ station_list_suite(mutest_suite_t *suite G_GNUC_UNUSED)
 	mutest_it("save station list twice (regular and symlink)", station_list_save_twice);
 	mutest_it("empty the station list", station_list_empty);
 	mutest_it("add, move and remove stations", station_list_add_move_remove);
+	mutest_it("find stations by uid, name and uri", station_list_find);
 
 	g_assert_true(g_rmdir(tmpdir) == 0);
 	g_free(tmpdir);
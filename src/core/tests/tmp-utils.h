@@ -0,0 +1,99 @@
+/*
+ * Goodvibes Radio Player
+ *
+ * Copyright (C) 2024 Arnaud Rebillout
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Temporary files for the unit tests. Each file gets its own directory, so
+ * that whatever the code under test writes next to it (temporary files,
+ * sub-directories) goes away with it.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+static inline void
+tmp_dir_remove(const gchar *dirname)
+{
+	const gchar *name;
+	GDir *dir;
+
+	dir = g_dir_open(dirname, 0, NULL);
+	if (dir == NULL)
+		return;
+
+	while ((name = g_dir_read_name(dir)) != NULL) {
+		gchar *path = g_build_filename(dirname, name, NULL);
+
+		if (g_file_test(path, G_FILE_TEST_IS_DIR) &&
+		    !g_file_test(path, G_FILE_TEST_IS_SYMLINK))
+			tmp_dir_remove(path);
+		else
+			g_unlink(path);
+		g_free(path);
+	}
+	g_dir_close(dir);
+
+	g_assert_true(g_rmdir(dirname) == 0);
+}
+
+/* Returns a new, empty directory, to be freed with tmp_dir_free() */
+static inline gchar *
+tmp_dir_new(void)
+{
+	gchar *dirname;
+
+	dirname = g_dir_make_tmp("goodvibes-test-XXXXXX", NULL);
+	g_assert_nonnull(dirname);
+
+	return dirname;
+}
+
+static inline void
+tmp_dir_free(gchar *dirname)
+{
+	tmp_dir_remove(dirname);
+	g_free(dirname);
+}
+
+/* Returns the path to a file that doesn't exist yet, in a new directory.
+ * To be freed with tmp_file_free(), along with the directory. */
+static inline gchar *
+tmp_file_new(const gchar *basename)
+{
+	gchar *dirname;
+	gchar *filename;
+
+	dirname = tmp_dir_new();
+	filename = g_build_filename(dirname, basename, NULL);
+	g_free(dirname);
+
+	return filename;
+}
+
+static inline void
+tmp_file_free(gchar *filename)
+{
+	gchar *dirname;
+
+	dirname = g_path_get_dirname(filename);
+	tmp_dir_free(dirname);
+	g_free(filename);
+}
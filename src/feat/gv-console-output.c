@@ -139,6 +139,38 @@ print_metadata(GvMetadata *metadata)
 		PRINT("           %s", genre);
 }
 
+static void
+print_monitor_slot(GvMonitor *monitor, guint slot, const gchar *property_name)
+{
+	GvStation *station = gv_monitor_get_station(monitor, slot);
+	GvPlayback *playback = gv_monitor_get_playback(monitor, slot);
+	const gchar *name = gv_station_get_name_or_uri(station);
+
+	if (!g_strcmp0(property_name, "state")) {
+		if (gv_playback_get_state(playback) == GV_PLAYBACK_STATE_PLAYING)
+			PRINT(VT_BOLD("> %s [%s] Playing"), time_now(), name);
+	} else if (!g_strcmp0(property_name, "metadata")) {
+		GvMetadata *metadata = gv_playback_get_metadata(playback);
+		const gchar *title;
+
+		if (metadata == NULL)
+			return;
+
+		title = gv_metadata_get_title(metadata);
+		PRINT(". %s [%s] %s", time_now(), name,
+		      title ? title : "(Unknown title)");
+	} else if (!g_strcmp0(property_name, "error")) {
+		GvPlaybackError *error = gv_playback_get_error(playback);
+
+		if (error == NULL)
+			return;
+
+		PRINT(VT_BOLD("Error!") " [%s] %s", name, error->message);
+		if (error->details != NULL)
+			PRINT("       %s", error->details);
+	}
+}
+
 /*
  * Signal handlers
  */
@@ -167,6 +199,13 @@ on_playback_notify(GvPlayback *playback, GParamSpec *pspec, GvConsoleOutput *sel
 	}
 }
 
+static void
+on_monitor_slot_changed(GvMonitor *monitor, guint slot, const gchar *property_name,
+			GvConsoleOutput *self G_GNUC_UNUSED)
+{
+	print_monitor_slot(monitor, slot, property_name);
+}
+
 static void
 on_errorable_error(GvErrorable *errorable G_GNUC_UNUSED, const gchar *message,
 		   const gchar *details, GvConsoleOutput *self G_GNUC_UNUSED)
@@ -196,6 +235,8 @@ gv_console_output_disable(GvFeature *feature)
 
 	/* Disconnect playback signal handlers */
 	g_signal_handlers_disconnect_by_data(playback, feature);
+	if (gv_core_monitor != NULL)
+		g_signal_handlers_disconnect_by_data(gv_core_monitor, feature);
 
 	/* Say good-bye */
 	print_goodbye_line();
@@ -219,6 +260,9 @@ gv_console_output_enable(GvFeature *feature)
 	/* Connect playback signal handlers */
 	g_signal_connect_object(playback, "notify",
 			G_CALLBACK(on_playback_notify), feature, 0);
+	if (gv_core_monitor != NULL)
+		g_signal_connect_object(gv_core_monitor, "slot-changed",
+				G_CALLBACK(on_monitor_slot_changed), feature, 0);
 
 	/* Connect error signal handlers */
 	for (item = gv_base_get_objects(); item; item = item->next) {
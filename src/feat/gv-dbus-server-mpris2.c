@@ -93,6 +93,7 @@ static const gchar *DBUS_INTROSPECTION =
 	"        <property name='CanPause'       type='b'     access='read'/>"
 	"        <property name='CanGoNext'      type='b'     access='read'/>"
 	"        <property name='CanGoPrevious'  type='b'     access='read'/>"
+	"        <property name='Position'       type='x'     access='read'/>"
 	"        <property name='CanSeek'        type='b'     access='read'/>"
 	"        <property name='CanControl'     type='b'     access='read'/>"
 	"    </interface>"
@@ -420,12 +421,46 @@ end:
 static GVariant *
 g_variant_new_playback_status(GvPlayer *player)
 {
+	GvPlayback *playback = gv_core_playback;
 	gboolean playing;
 
 	playing = gv_player_get_playing(player);
+	if (playing == FALSE &&
+	    gv_playback_get_state(playback) == GV_PLAYBACK_STATE_PAUSED)
+		return g_variant_new_string("Paused");
+
 	return g_variant_new_string(playing ? "Playing" : "Stopped");
 }
 
+static GVariant *
+g_variant_new_can_seek(GvPlayer *player)
+{
+	gboolean can_seek;
+
+	can_seek = gv_player_get_can_seek(player);
+	return g_variant_new_boolean(can_seek);
+}
+
+/* Pausing, rather than stopping, needs the time-shift source, just like
+ * seeking does */
+static GVariant *
+g_variant_new_can_pause(GvPlayer *player)
+{
+	gboolean can_pause;
+
+	can_pause = gv_player_get_can_seek(player);
+	return g_variant_new_boolean(can_pause);
+}
+
+static GVariant *
+g_variant_new_position(GvPlayer *player)
+{
+	gint64 position;
+
+	position = gv_player_get_position(player);
+	return g_variant_new_int64(MAX(position, 0));
+}
+
 static GVariant *
 g_variant_new_loop_status(GvPlayer *player)
 {
@@ -558,6 +593,18 @@ method_stop(GvDbusServer *dbus_server G_GNUC_UNUSED,
 	return NULL;
 }
 
+static GVariant *
+method_pause(GvDbusServer *dbus_server G_GNUC_UNUSED,
+	     GVariant *params G_GNUC_UNUSED,
+	     GError **err G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+
+	gv_player_pause(player);
+
+	return NULL;
+}
+
 static GVariant *
 method_toggle(GvDbusServer *dbus_server G_GNUC_UNUSED,
 	      GVariant *params G_GNUC_UNUSED,
@@ -596,6 +643,63 @@ method_prev(GvDbusServer *dbus_server G_GNUC_UNUSED,
 	return NULL;
 }
 
+static GVariant *
+method_seek(GvDbusServer *dbus_server,
+	    GVariant *params,
+	    GError **err G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+	gint64 offset;
+
+	g_variant_get(params, "(x)", &offset);
+
+	/* Seeking is only possible within the time-shift window,
+	 * otherwise the call is ignored, as the spec says */
+	if (gv_player_get_can_seek(player) == FALSE)
+		return NULL;
+
+	gv_player_seek(player, offset);
+
+	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_PLAYER, "Seeked",
+				   g_variant_new("(@x)", g_variant_new_position(player)));
+
+	return NULL;
+}
+
+static GVariant *
+method_set_position(GvDbusServer *dbus_server,
+		    GVariant *params,
+		    GError **err G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+	GvStation *station;
+	const gchar *track_id;
+	gchar *current_track_id;
+	gint64 position;
+	gboolean is_current;
+
+	g_variant_get(params, "(&ox)", &track_id, &position);
+
+	if (gv_player_get_can_seek(player) == FALSE)
+		return NULL;
+
+	/* The track must be the current one, otherwise the call is ignored */
+	station = gv_player_get_station(player);
+	current_track_id = make_track_id(station);
+	is_current = g_strcmp0(track_id, current_track_id) == 0;
+	g_free(current_track_id);
+
+	if (is_current == FALSE)
+		return NULL;
+
+	gv_player_set_position(player, position);
+
+	gv_dbus_server_emit_signal(dbus_server, DBUS_IFACE_PLAYER, "Seeked",
+				   g_variant_new("(@x)", g_variant_new_position(player)));
+
+	return NULL;
+}
+
 static GVariant *
 method_open_uri(GvDbusServer *dbus_server G_GNUC_UNUSED,
 		GVariant *params G_GNUC_UNUSED,
@@ -633,16 +737,16 @@ method_open_uri(GvDbusServer *dbus_server G_GNUC_UNUSED,
 
 static GvDbusMethod player_methods[] = {
 	// clang-format off
-	{ "Play",        method_play     },
-	{ "Pause",       method_stop     },
-	{ "PlayPause",   method_toggle   },
-	{ "Stop",        method_stop     },
-	{ "Next",        method_next     },
-	{ "Previous",    method_prev     },
-	{ "Seek",        NULL            },
-	{ "SetPosition", NULL            },
-	{ "OpenUri",     method_open_uri },
-	{ NULL,          NULL            }
+	{ "Play",        method_play         },
+	{ "Pause",       method_pause        },
+	{ "PlayPause",   method_toggle       },
+	{ "Stop",        method_stop         },
+	{ "Next",        method_next         },
+	{ "Previous",    method_prev         },
+	{ "Seek",        method_seek         },
+	{ "SetPosition", method_set_position },
+	{ "OpenUri",     method_open_uri     },
+	{ NULL,          NULL                }
 	// clang-format on
 };
 
@@ -1048,6 +1152,30 @@ prop_get_can_play(GvDbusServer *dbus_server G_GNUC_UNUSED)
 	return g_variant_new_can_play(station_list);
 }
 
+static GVariant *
+prop_get_position(GvDbusServer *dbus_server G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+
+	return g_variant_new_position(player);
+}
+
+static GVariant *
+prop_get_can_seek(GvDbusServer *dbus_server G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+
+	return g_variant_new_can_seek(player);
+}
+
+static GVariant *
+prop_get_can_pause(GvDbusServer *dbus_server G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+
+	return g_variant_new_can_pause(player);
+}
+
 static GVariant *
 prop_get_can_go_prev(GvDbusServer *dbus_server G_GNUC_UNUSED)
 {
@@ -1075,10 +1203,11 @@ static GvDbusProperty player_properties[] = {
 	{ "MaximumRate",    prop_get_rate,            NULL },
 	{ "Metadata",       prop_get_metadata,        NULL },
 	{ "CanPlay",        prop_get_can_play,        NULL },
-	{ "CanPause",       prop_get_can_play,        NULL },
+	{ "CanPause",       prop_get_can_pause,       NULL },
 	{ "CanGoNext",      prop_get_can_go_next,     NULL },
 	{ "CanGoPrevious",  prop_get_can_go_prev,     NULL },
-	{ "CanSeek",        prop_get_false,           NULL },
+	{ "Position",       prop_get_position,        NULL },
+	{ "CanSeek",        prop_get_can_seek,        NULL },
 	{ "CanControl",     prop_get_true,            NULL },
 	{ NULL,             NULL,                     NULL }
 	// clang-format on
@@ -1222,6 +1351,17 @@ on_playback_notify(GvPlayback *playback, GParamSpec *pspec, GvDbusServerMpris2 *
 		gv_dbus_server_emit_signal_property_changed(
 			dbus_server, DBUS_IFACE_PLAYER, "Metadata",
 			g_variant_new_metadata_map(station, metadata));
+
+	} else if (!g_strcmp0(property_name, "state")) {
+		GvPlayer *player = gv_core_player;
+
+		/* This signal should be sent only if there was a change */
+		gv_dbus_server_emit_signal_property_changed(
+			dbus_server, DBUS_IFACE_PLAYER, "CanSeek",
+			g_variant_new_can_seek(player));
+		gv_dbus_server_emit_signal_property_changed(
+			dbus_server, DBUS_IFACE_PLAYER, "CanPause",
+			g_variant_new_can_pause(player));
 	}
 }
 
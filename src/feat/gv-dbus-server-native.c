@@ -55,6 +55,8 @@ static const gchar *DBUS_INTROSPECTION =
 	"        <property name='Shuffle' type='b'     access='readwrite'/>"
 	"        <property name='Volume'  type='u'     access='readwrite'/>"
 	"        <property name='Mute'    type='b'     access='readwrite'/>"
+	"        <property name='Stats'   type='a{sv}' access='read'/>"
+	"        <property name='Recording' type='b'   access='readwrite'/>"
 	"    </interface>"
 	"    <interface name='" DBUS_IFACE_STATIONS "'>"
 	"        <method name='List'>"
@@ -98,7 +100,7 @@ G_DEFINE_TYPE(GvDbusServerNative, gv_dbus_server_native, GV_TYPE_DBUS_SERVER)
  */
 
 static GVariant *
-g_variant_new_station(GvStation *station, GvMetadata *metadata)
+g_variant_new_station(GvStation *station, GvMetadata *metadata, GvProbeResult *probe)
 {
 	GVariantBuilder b;
 	const gchar *uri;
@@ -124,6 +126,19 @@ g_variant_new_station(GvStation *station, GvMetadata *metadata)
 	if (name)
 		g_variant_builder_add_dictentry_string(&b, "name", name);
 
+	/* Health, as seen by the prober */
+	if (probe) {
+		g_variant_builder_add_dictentry_boolean(&b, "reachable", probe->reachable);
+		g_variant_builder_add_dictentry_int64(&b, "probe-time",
+				probe->timestamp / G_USEC_PER_SEC);
+		if (probe->reachable)
+			g_variant_builder_add_dictentry_uint32(&b, "latency", probe->latency);
+		if (probe->codec)
+			g_variant_builder_add_dictentry_string(&b, "codec", probe->codec);
+		if (probe->bitrate)
+			g_variant_builder_add_dictentry_uint32(&b, "bitrate", probe->bitrate);
+	}
+
 	/* Metadata if any */
 	if (metadata == NULL)
 		goto end;
@@ -156,6 +171,27 @@ end:
 	return g_variant_builder_end(&b);
 }
 
+static GVariant *
+g_variant_new_stats(const GvEngineStats *stats)
+{
+	GVariantBuilder b;
+
+	g_variant_builder_init(&b, G_VARIANT_TYPE("a{sv}"));
+
+	g_variant_builder_add_dictentry_uint32(&b, "connect-time", stats->connect_time);
+	g_variant_builder_add_dictentry_uint32(&b, "first-buffer-time", stats->first_buffer_time);
+	g_variant_builder_add_dictentry_uint32(&b, "playing-time", stats->playing_time);
+	g_variant_builder_add_dictentry_uint32(&b, "buffering-count", stats->buffering_count);
+	g_variant_builder_add_dictentry_uint32(&b, "buffering-time", stats->buffering_time);
+	g_variant_builder_add_dictentry_uint64(&b, "bytes-received", stats->bytes_received);
+	g_variant_builder_add_dictentry_uint32(&b, "input-bitrate", stats->input_bitrate);
+	g_variant_builder_add_dictentry_uint32(&b, "decoder-cpu-time", stats->decoder_cpu_time);
+	g_variant_builder_add_dictentry_uint32(&b, "bus-messages", stats->bus_messages);
+	g_variant_builder_add_dictentry_uint32(&b, "bus-coalesced", stats->bus_coalesced);
+
+	return g_variant_builder_end(&b);
+}
+
 /*
  * Dbus method handlers
  */
@@ -289,8 +325,15 @@ method_list(GvDbusServer *dbus_server G_GNUC_UNUSED,
 	g_variant_builder_init(&b, G_VARIANT_TYPE("aa{sv}"));
 	iter = gv_station_list_iter_new(station_list);
 
-	while (gv_station_list_iter_loop(iter, &station))
-		g_variant_builder_add_value(&b, g_variant_new_station(station, NULL));
+	while (gv_station_list_iter_loop(iter, &station)) {
+		GvProbeResult *probe = NULL;
+		const gchar *uri = gv_station_get_uri(station);
+
+		if (gv_core_prober && uri)
+			probe = gv_prober_lookup(gv_core_prober, uri);
+
+		g_variant_builder_add_value(&b, g_variant_new_station(station, NULL, probe));
+	}
 
 	gv_station_list_iter_free(iter);
 	return g_variant_builder_end(&b);
@@ -472,7 +515,7 @@ prop_get_current(GvDbusServer *dbus_server G_GNUC_UNUSED)
 	station = gv_playback_get_station(playback);
 	metadata = gv_playback_get_metadata(playback);
 
-	return g_variant_new_station(station, metadata);
+	return g_variant_new_station(station, metadata, NULL);
 }
 
 static GVariant *
@@ -586,15 +629,53 @@ prop_set_mute(GvDbusServer *dbus_server G_GNUC_UNUSED,
 	return TRUE;
 }
 
+static GVariant *
+prop_get_stats(GvDbusServer *dbus_server G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+	const GvEngineStats *stats;
+
+	stats = gv_player_get_stats(player);
+
+	return g_variant_new_stats(stats);
+}
+
+static GVariant *
+prop_get_recording(GvDbusServer *dbus_server G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+	gboolean recording;
+
+	recording = gv_player_get_recording(player);
+
+	return g_variant_new_boolean(recording);
+}
+
+static gboolean
+prop_set_recording(GvDbusServer *dbus_server G_GNUC_UNUSED,
+		   GVariant *value,
+		   GError **err G_GNUC_UNUSED)
+{
+	GvPlayer *player = gv_core_player;
+	gboolean recording;
+
+	recording = g_variant_get_boolean(value);
+	gv_player_set_recording(player, recording);
+
+	return TRUE;
+}
+
 static GvDbusProperty player_properties[] = {
 	// clang-format off
-	{ "Current", prop_get_current, NULL             },
-	{ "Playing", prop_get_playing, NULL             },
-	{ "Repeat",  prop_get_repeat,  prop_set_repeat  },
-	{ "Shuffle", prop_get_shuffle, prop_set_shuffle },
-	{ "Volume",  prop_get_volume,  prop_set_volume  },
-	{ "Mute",    prop_get_mute,    prop_set_mute    },
-	{ NULL,      NULL,                        NULL  }
+	{ "Current",   prop_get_current,   NULL               },
+	{ "Playing",   prop_get_playing,   NULL               },
+	{ "Repeat",    prop_get_repeat,    prop_set_repeat    },
+	{ "Shuffle",   prop_get_shuffle,   prop_set_shuffle   },
+	{ "Volume",    prop_get_volume,    prop_set_volume    },
+	{ "Mute",      prop_get_mute,      prop_set_mute      },
+	{ "Stats",     prop_get_stats,     NULL               },
+	{ "Recording", prop_get_recording, prop_set_recording },
+	{ NULL,        NULL,               NULL               }
 	// clang-format on
 };
 
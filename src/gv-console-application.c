@@ -95,6 +95,8 @@ gv_console_application_startup(GApplication *app)
 	DEBUG_NO_CONTEXT("---- Initializing ----");
 	gv_base_init();
 	gv_core_init(app, DEFAULT_STATIONS);
+	if (options.monitor)
+		gv_core_get_monitor();
 	gv_feat_init();
 	gv_base_init_completed();
 
@@ -118,6 +120,15 @@ when_idle_go_player(gpointer user_data)
 	return G_SOURCE_REMOVE;
 }
 
+static gboolean
+when_idle_start_monitor(gpointer user_data G_GNUC_UNUSED)
+{
+	gv_monitor_add_station_list(gv_core_monitor, gv_core_station_list);
+	gv_monitor_start(gv_core_monitor);
+
+	return G_SOURCE_REMOVE;
+}
+
 static void
 gv_console_application_activate(GApplication *app G_GNUC_UNUSED)
 {
@@ -134,8 +145,12 @@ gv_console_application_activate(GApplication *app G_GNUC_UNUSED)
 		 * (as much as possible) that this init code is run before we
 		 * start the playback. Therefore we schedule with a low priority.
 		 */
-		g_idle_add_full(G_PRIORITY_LOW, when_idle_go_player,
-				(void *) options.uri_to_play, NULL);
+		if (options.monitor)
+			g_idle_add_full(G_PRIORITY_LOW, when_idle_start_monitor,
+					NULL, NULL);
+		else
+			g_idle_add_full(G_PRIORITY_LOW, when_idle_go_player,
+					(void *) options.uri_to_play, NULL);
 	}
 }
 
@@ -242,6 +242,8 @@ gv_graphical_application_startup(GApplication *app)
 	DEBUG_NO_CONTEXT("---- Initializing ----");
 	gv_base_init();
 	gv_core_init(app, DEFAULT_STATIONS);
+	if (options.monitor)
+		gv_core_get_monitor();
 	gv_ui_init(app, options.status_icon);
 	gv_feat_init();
 	gv_base_init_completed();
@@ -267,6 +269,15 @@ when_idle_go_player(gpointer user_data)
 	return G_SOURCE_REMOVE;
 }
 
+static gboolean
+when_idle_start_monitor(gpointer user_data G_GNUC_UNUSED)
+{
+	gv_monitor_add_station_list(gv_core_monitor, gv_core_station_list);
+	gv_monitor_start(gv_core_monitor);
+
+	return G_SOURCE_REMOVE;
+}
+
 static void
 gv_graphical_application_activate(GApplication *app G_GNUC_UNUSED)
 {
@@ -283,8 +294,12 @@ gv_graphical_application_activate(GApplication *app G_GNUC_UNUSED)
 		 * (as much as possible) that this init code is run before we
 		 * start the playback. Therefore we schedule with a low priority.
 		 */
-		g_idle_add_full(G_PRIORITY_LOW, when_idle_go_player,
-				(void *) options.uri_to_play, NULL);
+		if (options.monitor)
+			g_idle_add_full(G_PRIORITY_LOW, when_idle_start_monitor,
+					NULL, NULL);
+		else
+			g_idle_add_full(G_PRIORITY_LOW, when_idle_go_player,
+					(void *) options.uri_to_play, NULL);
 
 		/* Present the main window, depending on options */
 		if (!options.without_ui) {
@@ -40,6 +40,8 @@ static GOptionEntry entries[] = {
 	  "Disable colors in log messages", NULL },
 	{ "log-level", 'l', 0, G_OPTION_ARG_STRING, &options.log_level,
 	  "Set the log level, amongst: trace, debug, info, warning, critical, error.", "warning" },
+	{ "monitor", 'm', 0, G_OPTION_ARG_NONE, &options.monitor,
+	  "Monitor all the stations at once, without audio output", NULL },
 	{ "output-file", 'o', 0, G_OPTION_ARG_STRING, &options.output_file,
 	  "Redirect log messages to a file", "file" },
 	{ "version", 'v', 0, G_OPTION_ARG_NONE, &options.print_version,
@@ -25,6 +25,7 @@ struct options {
 	gboolean     background;
 	gboolean     colorless;
 	const gchar *log_level;
+	gboolean     monitor;
 	const gchar *output_file;
 	gboolean     print_version;
 #ifdef GV_UI_ENABLED
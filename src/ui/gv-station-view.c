@@ -232,29 +232,32 @@ make_channels_string(guint channels)
 }
 
 static gchar *
-make_stream_type_string(GvStreamType stream_type)
+make_stream_type_string(GvStreamType stream_type, guint variant_bitrate,
+			guint variant_switches)
 {
-	const gchar *str;
+	guint kbps = variant_bitrate / 1000;
 
 	switch (stream_type) {
 	case GV_STREAM_TYPE_HTTP:
-		str = "HTTP";
-		break;
+		return g_strdup("HTTP");
 	case GV_STREAM_TYPE_HTTP_ICY:
-		str = "HTTP+ICY";
-		break;
+		return g_strdup("HTTP+ICY");
 	case GV_STREAM_TYPE_HLS:
-		str = "HLS";
-		break;
+		if (variant_bitrate == 0)
+			return g_strdup("HLS");
+		/* TRANSLATORS: we talk about the variant of an adaptive stream,
+		 * its bitrate, and how many times we switched to another one. */
+		return g_strdup_printf(_("HLS (variant: %u kbps, switches: %u)"),
+				       kbps, variant_switches);
 	case GV_STREAM_TYPE_DASH:
-		str = "MPEG-DASH";
-		break;
+		if (variant_bitrate == 0)
+			return g_strdup("MPEG-DASH");
+		/* TRANSLATORS: same as above, for MPEG-DASH streams. */
+		return g_strdup_printf(_("MPEG-DASH (variant: %u kbps, switches: %u)"),
+				       kbps, variant_switches);
 	default:
-		str = NULL;
-		break;
+		return NULL;
 	}
-
-	return g_strdup(str);
 }
 
 static gchar *
@@ -418,7 +421,9 @@ set_streaminfo(GvStationViewPrivate *priv, GvStreaminfo *streaminfo)
 	gv_prop_set(&priv->sample_rate_prop, str);
 	g_free(str);
 
-	str = make_stream_type_string(gv_streaminfo_get_stream_type(streaminfo));
+	str = make_stream_type_string(gv_streaminfo_get_stream_type(streaminfo),
+				      gv_streaminfo_get_variant_bitrate(streaminfo),
+				      gv_streaminfo_get_variant_switches(streaminfo));
 	gv_prop_set(&priv->stream_type_prop, str);
 	g_free(str);
 }
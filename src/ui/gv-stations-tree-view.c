@@ -52,6 +52,8 @@ struct _GvStationsTreeViewPrivate {
 	gboolean is_dragging;
 	GvStation *station_dragged;
 	gint station_new_pos;
+	/* Rows of the list store, by station uri */
+	GHashTable *rows;
 };
 
 typedef struct _GvStationsTreeViewPrivate GvStationsTreeViewPrivate;
@@ -121,6 +123,60 @@ on_player_notify_station(GvPlayer *player,
 	}
 }
 
+static PangoStyle
+get_station_style(GvStation *station)
+{
+	/* Dead stations are in italic */
+	if (gv_core_prober && gv_prober_is_dead(gv_core_prober, station))
+		return PANGO_STYLE_ITALIC;
+
+	return PANGO_STYLE_NORMAL;
+}
+
+static void
+on_prober_station_probed(GvProber *prober G_GNUC_UNUSED,
+			 const gchar *uri,
+			 GvStationsTreeView *self)
+{
+	GvStationsTreeViewPrivate *priv = self->priv;
+	GtkTreeView *tree_view = GTK_TREE_VIEW(self);
+	GtkTreeModel *tree_model = gtk_tree_view_get_model(tree_view);
+	GPtrArray *rows;
+	guint i;
+
+	/* Several stations might share the same uri */
+	rows = g_hash_table_lookup(priv->rows, uri);
+	if (rows == NULL)
+		return;
+
+	for (i = 0; i < rows->len; i++) {
+		GtkTreeRowReference *row = rows->pdata[i];
+		GvStation *station;
+		GtkTreePath *path;
+		GtkTreeIter iter;
+
+		path = gtk_tree_row_reference_get_path(row);
+		if (path == NULL)
+			continue;
+
+		/* Update the style of the station that was probed */
+		if (gtk_tree_model_get_iter(tree_model, &iter, path)) {
+			gtk_tree_model_get(tree_model, &iter,
+					   STATION_COLUMN, &station,
+					   -1);
+			if (station) {
+				gtk_list_store_set(GTK_LIST_STORE(tree_model), &iter,
+						   STATION_STYLE_COLUMN,
+						   get_station_style(station),
+						   -1);
+				g_object_unref(station);
+			}
+		}
+
+		gtk_tree_path_free(path);
+	}
+}
+
 /*
  * Station List signal handlers
  * Needed to update the internal list store when the station list is modified.
@@ -526,6 +582,7 @@ station_cell_data_func(GtkTreeViewColumn *tree_column G_GNUC_UNUSED,
 void
 gv_stations_tree_view_populate(GvStationsTreeView *self)
 {
+	GvStationsTreeViewPrivate *priv = self->priv;
 	GtkTreeView *tree_view = GTK_TREE_VIEW(self);
 	GtkTreeModel *tree_model = gtk_tree_view_get_model(tree_view);
 	GtkListStore *list_store = GTK_LIST_STORE(tree_model);
@@ -540,6 +597,7 @@ gv_stations_tree_view_populate(GvStationsTreeView *self)
 
 	/* Make station list empty */
 	gtk_list_store_clear(list_store);
+	g_hash_table_remove_all(priv->rows);
 
 	/* Handle the special-case: empty station list */
 	if (gv_station_list_length(station_list) == 0) {
@@ -568,6 +626,9 @@ gv_stations_tree_view_populate(GvStationsTreeView *self)
 
 		while (gv_station_list_iter_loop(iter, &station)) {
 			GtkTreeIter tree_iter;
+			GtkTreePath *path;
+			GPtrArray *rows;
+			const gchar *station_uri;
 			const gchar *station_name;
 			PangoWeight weight;
 
@@ -583,8 +644,24 @@ gv_stations_tree_view_populate(GvStationsTreeView *self)
 					   STATION_COLUMN, station,
 					   STATION_NAME_COLUMN, station_name,
 					   STATION_WEIGHT_COLUMN, weight,
-					   STATION_STYLE_COLUMN, PANGO_STYLE_NORMAL,
+					   STATION_STYLE_COLUMN, get_station_style(station),
 					   -1);
+
+			/* Index the row, for the prober updates */
+			station_uri = gv_station_get_uri(station);
+			if (station_uri == NULL)
+				continue;
+
+			rows = g_hash_table_lookup(priv->rows, station_uri);
+			if (rows == NULL) {
+				rows = g_ptr_array_new_with_free_func
+					((GDestroyNotify) gtk_tree_row_reference_free);
+				g_hash_table_insert(priv->rows, g_strdup(station_uri), rows);
+			}
+
+			path = gtk_tree_model_get_path(tree_model, &tree_iter);
+			g_ptr_array_add(rows, gtk_tree_row_reference_new(tree_model, path));
+			gtk_tree_path_free(path);
 		}
 		gv_station_list_iter_free(iter);
 
@@ -655,7 +732,7 @@ gv_stations_tree_view_constructed(GObject *object)
 	 * - the station object
 	 * - the station represented by a string (for displaying)
 	 * - the station's font weight (bold characters for current station)
-	 * - the station's font style (italic characters if no station)
+	 * - the station's font style (italic characters if no station, or dead station)
 	 */
 
 	/* Create a new list store */
@@ -721,11 +798,27 @@ gv_stations_tree_view_constructed(GObject *object)
 	g_signal_connect_object(player, "notify::station",
 				G_CALLBACK(on_player_notify_station), self, 0);
 	g_signal_handlers_connect_object(station_list, station_list_handlers, self, 0);
+	g_signal_connect_object(gv_core_prober, "station-probed",
+				G_CALLBACK(on_prober_station_probed), self, 0);
 
 	/* Chain up */
 	G_OBJECT_CHAINUP_CONSTRUCTED(gv_stations_tree_view, object);
 }
 
+static void
+gv_stations_tree_view_finalize(GObject *object)
+{
+	GvStationsTreeView *self = GV_STATIONS_TREE_VIEW(object);
+	GvStationsTreeViewPrivate *priv = self->priv;
+
+	TRACE("%p", object);
+
+	g_hash_table_unref(priv->rows);
+
+	/* Chain up */
+	G_OBJECT_CHAINUP_FINALIZE(gv_stations_tree_view, object);
+}
+
 static void
 gv_stations_tree_view_init(GvStationsTreeView *self)
 {
@@ -736,6 +829,8 @@ gv_stations_tree_view_init(GvStationsTreeView *self)
 
 	/* Initialize internal state */
 	self->priv->station_new_pos = -1;
+	self->priv->rows = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, (GDestroyNotify) g_ptr_array_unref);
 }
 
 static void
@@ -746,6 +841,7 @@ gv_stations_tree_view_class_init(GvStationsTreeViewClass *class)
 	TRACE("%p", class);
 
 	/* Override GObject methods */
+	object_class->finalize = gv_stations_tree_view_finalize;
 	object_class->constructed = gv_stations_tree_view_constructed;
 
 	/* Signals */